@@ -0,0 +1,313 @@
+"""Python bindings for librosetta6502 (include/rosetta6502.h).
+
+The CPU always runs inside the library: Machine.run executes a whole batch
+of cycles or instructions per call, so scripts pay for one foreign call per
+batch rather than per instruction. Machine.memory is a writable memoryview
+over the emulator's 64 KB of storage, shared with the core without copying.
+Devices written in Python are called only for accesses to their range.
+
+    from rosetta6502 import Machine
+
+    with Machine("firmware/mmio.cfg") as m:
+        m.load("firmware.bin")
+        m.reset()
+        stop = m.run(cycles=1_000_000)
+        print(stop, hex(m.pc), m.memory[0x0200])
+
+The library is looked up in $ROSETTA6502_LIB, then next to the top-level
+Makefile (build it with `make lib`), then on the system library path. Like
+the C API, a process holds one Machine at a time.
+"""
+
+import ctypes
+import ctypes.util
+import enum
+import os
+
+__all__ = ["Machine", "Snapshot", "Stop", "RosettaError"]
+
+API_VERSION = 1
+
+UNTIL_PC = 0x1
+UNTIL_TRAP = 0x2
+
+
+class Stop(enum.IntEnum):
+    """Why Machine.run returned (RosettaStop)."""
+
+    BUDGET = 0
+    CONDITION = 1
+    TRAP = 2
+    BREAKPOINT = 3
+    EXIT = 4
+
+
+class RosettaError(RuntimeError):
+    pass
+
+
+class _Registers(ctypes.Structure):
+    _fields_ = [
+        ("a", ctypes.c_uint8),
+        ("x", ctypes.c_uint8),
+        ("y", ctypes.c_uint8),
+        ("sp", ctypes.c_uint8),
+        ("p", ctypes.c_uint8),
+        ("pc", ctypes.c_uint16),
+        ("cycles", ctypes.c_uint64),
+        ("instructions", ctypes.c_uint64),
+    ]
+
+
+_READ = ctypes.CFUNCTYPE(ctypes.c_uint8, ctypes.c_void_p, ctypes.c_uint16,
+                         ctypes.c_uint64)
+_WRITE = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_uint16,
+                          ctypes.c_uint8, ctypes.c_uint64)
+
+_MEMORY_SIZE = 0x10000
+
+
+def _find_library():
+    path = os.environ.get("ROSETTA6502_LIB")
+    if path:
+        return path
+    here = os.path.dirname(os.path.abspath(__file__))
+    local = os.path.join(here, "..", "..", "librosetta6502.so")
+    if os.path.exists(local):
+        return local
+    found = ctypes.util.find_library("rosetta6502")
+    if found:
+        return found
+    raise RosettaError("librosetta6502.so not found; run `make lib` or set "
+                       "ROSETTA6502_LIB")
+
+
+def _declare(lib):
+    vp, u8p = ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint8)
+    u16, u64 = ctypes.c_uint16, ctypes.c_uint64
+    regs = ctypes.POINTER(_Registers)
+    signatures = {
+        "rosetta_api_version": (ctypes.c_int, []),
+        "rosetta_create": (vp, []),
+        "rosetta_destroy": (None, [vp]),
+        "rosetta_configure": (ctypes.c_bool, [vp, ctypes.c_char_p]),
+        "rosetta_load_image": (ctypes.c_bool,
+                               [vp, ctypes.c_char_p, ctypes.c_int32]),
+        "rosetta_reset": (None, [vp]),
+        "rosetta_set_throttle": (None, [vp, ctypes.c_bool]),
+        "rosetta_run_cycles": (ctypes.c_int, [vp, u64]),
+        "rosetta_run_instructions": (ctypes.c_int, [vp, u64]),
+        "rosetta_run_until": (ctypes.c_int,
+                              [vp, ctypes.c_uint, u16, u64, u64]),
+        "rosetta_exit_code": (ctypes.c_int, [vp]),
+        "rosetta_get_registers": (None, [vp, regs]),
+        "rosetta_set_registers": (None, [vp, regs]),
+        "rosetta_peek": (None, [vp, u16, u8p, ctypes.c_size_t]),
+        "rosetta_poke": (None, [vp, u16, u8p, ctypes.c_size_t]),
+        "rosetta_memory": (u8p, [vp]),
+        "rosetta_add_device": (ctypes.c_bool, [vp, ctypes.c_char_p, u16, u16,
+                                               _READ, _WRITE, vp]),
+        "rosetta_set_input": (ctypes.c_bool,
+                              [vp, ctypes.c_char_p, u8p, ctypes.c_size_t]),
+        "rosetta_snapshot_take": (vp, [vp]),
+        "rosetta_snapshot_restore": (ctypes.c_bool, [vp, vp]),
+        "rosetta_snapshot_free": (None, [vp]),
+        "rosetta_snapshot_save": (ctypes.c_bool, [vp, ctypes.c_char_p]),
+        "rosetta_snapshot_load": (ctypes.c_bool, [vp, ctypes.c_char_p]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+    return lib
+
+
+_lib = None
+
+
+def _library():
+    global _lib
+    if _lib is None:
+        lib = _declare(ctypes.CDLL(_find_library()))
+        if lib.rosetta_api_version() != API_VERSION:
+            raise RosettaError("librosetta6502 API version %d, expected %d"
+                               % (lib.rosetta_api_version(), API_VERSION))
+        _lib = lib
+    return _lib
+
+
+def _path(path):
+    return os.fsencode(path)
+
+
+class Snapshot:
+    """Machine state taken with Machine.snapshot, restorable many times."""
+
+    def __init__(self, handle):
+        self._handle = handle
+
+    def __del__(self):
+        if self._handle and _lib is not None:
+            _lib.rosetta_snapshot_free(self._handle)
+            self._handle = None
+
+
+def _register(name):
+    def get(self):
+        return getattr(self.registers(), name)
+
+    def set(self, value):
+        registers = self.registers()
+        setattr(registers, name, value)
+        _lib.rosetta_set_registers(self._handle, ctypes.byref(registers))
+
+    return property(get, set, doc="The %s register." % name.upper())
+
+
+class Machine:
+    """One emulated 6502 machine, configured from an optional mmio.cfg."""
+
+    def __init__(self, config=None, throttle=False):
+        lib = _library()
+        self._handle = lib.rosetta_create()
+        if not self._handle:
+            raise RosettaError("another Machine exists in this process")
+        self._devices = []  # Keeps device callbacks alive
+        if config is not None and not lib.rosetta_configure(self._handle,
+                                                            _path(config)):
+            self.close()
+            raise RosettaError("cannot configure from %s" % config)
+        if throttle:
+            lib.rosetta_set_throttle(self._handle, True)
+
+        storage = ctypes.cast(lib.rosetta_memory(self._handle),
+                              ctypes.POINTER(ctypes.c_uint8 * _MEMORY_SIZE))
+        self._storage = storage.contents
+        self.memory = memoryview(self._storage).cast("B")
+
+    def close(self):
+        if getattr(self, "_handle", None):
+            if hasattr(self, "memory"):
+                self.memory.release()  # The storage is freed below
+            _lib.rosetta_destroy(self._handle)
+            self._handle = None
+            self._devices = []
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    # Program
+
+    def load(self, path, address=None):
+        """Loads a binary at `address`, or at the start of ROM with the
+        reset vector pointed at it."""
+        start = -1 if address is None else address
+        if not _lib.rosetta_load_image(self._handle, _path(path), start):
+            raise RosettaError("cannot load %s" % path)
+
+    def reset(self):
+        _lib.rosetta_reset(self._handle)
+
+    def run(self, cycles=None, instructions=None, until_pc=None,
+            until_trap=False):
+        """Runs one batch inside the library and returns a Stop.
+
+        Without any argument it runs until the program exits or hits a
+        breakpoint."""
+        if until_pc is None and not until_trap:
+            if cycles is not None and instructions is None:
+                return Stop(_lib.rosetta_run_cycles(self._handle, cycles))
+            if instructions is not None and cycles is None:
+                return Stop(_lib.rosetta_run_instructions(self._handle,
+                                                          instructions))
+        until = (UNTIL_PC if until_pc is not None else 0) | (
+            UNTIL_TRAP if until_trap else 0)
+        return Stop(_lib.rosetta_run_until(self._handle, until,
+                                           until_pc or 0, cycles or 0,
+                                           instructions or 0))
+
+    @property
+    def exit_code(self):
+        return _lib.rosetta_exit_code(self._handle)
+
+    # Registers
+
+    def registers(self):
+        registers = _Registers()
+        _lib.rosetta_get_registers(self._handle, ctypes.byref(registers))
+        return registers
+
+    a = _register("a")
+    x = _register("x")
+    y = _register("y")
+    sp = _register("sp")
+    p = _register("p")
+    pc = _register("pc")
+
+    @property
+    def cycles(self):
+        return self.registers().cycles
+
+    @property
+    def instructions(self):
+        return self.registers().instructions
+
+    # Memory through the bus layout (self.memory is raw storage)
+
+    def peek(self, address, length=1):
+        buffer = (ctypes.c_uint8 * length)()
+        _lib.rosetta_peek(self._handle, address, buffer, length)
+        return bytes(buffer)
+
+    def poke(self, address, data):
+        buffer = (ctypes.c_uint8 * len(data)).from_buffer_copy(bytes(data))
+        _lib.rosetta_poke(self._handle, address, buffer, len(data))
+
+    # Devices
+
+    def add_device(self, name, start, end, read=None, write=None):
+        """Maps Python handlers at start..end.
+
+        read(address, cycle) returns a byte; write(address, value, cycle)
+        receives one. They are called only for accesses to the range.
+        Exceptions are printed and the access reads as 0."""
+        read_cb = _READ(lambda _, address, cycle: read(address, cycle) & 0xFF
+                        ) if read else _READ()
+        write_cb = _WRITE(lambda _, address, value, cycle:
+                          write(address, value, cycle)) if write else _WRITE()
+        if not _lib.rosetta_add_device(self._handle, name.encode(), start, end,
+                                       read_cb, write_cb, None):
+            raise RosettaError("cannot add device %s" % name)
+        self._devices.append((read_cb, write_cb))
+
+    def set_input(self, device, data):
+        buffer = (ctypes.c_uint8 * len(data)).from_buffer_copy(bytes(data))
+        if not _lib.rosetta_set_input(self._handle, device.encode(), buffer,
+                                      len(data)):
+            raise RosettaError("no keyboard device named %s" % device)
+
+    # Snapshots
+
+    def snapshot(self):
+        handle = _lib.rosetta_snapshot_take(self._handle)
+        if not handle:
+            raise RosettaError("cannot take a snapshot")
+        return Snapshot(handle)
+
+    def restore(self, snapshot):
+        if not _lib.rosetta_snapshot_restore(self._handle, snapshot._handle):
+            raise RosettaError("cannot restore the snapshot")
+
+    def save(self, path):
+        if not _lib.rosetta_snapshot_save(self._handle, _path(path)):
+            raise RosettaError("cannot save a snapshot to %s" % path)
+
+    def restore_file(self, path):
+        if not _lib.rosetta_snapshot_load(self._handle, _path(path)):
+            raise RosettaError("cannot load a snapshot from %s" % path)
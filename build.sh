@@ -16,6 +16,7 @@ ASM_DIR="$(cd "$ASM_DIR" && pwd)"
 ASM_FILE="$ASM_DIR/firmware.asm"
 OBJ_FILE="$ASM_DIR/firmware.o"
 BIN_FILE="$ASM_DIR/firmware.bin"
+DBG_FILE="$ASM_DIR/firmware.dbg"
 CFG_FILE="$ASM_DIR/none.cfg"
 MMIO_CONFIG="$ASM_DIR/mmio.cfg"
 
@@ -50,13 +51,20 @@ if ! command -v ld65 >/dev/null 2>&1; then
     exit 1
 fi
 
+# Device plugins shipped with the example (see include/mmio_plugin.h)
+for PLUGIN_SRC in "$ASM_DIR"/*.c; do
+    [ -f "$PLUGIN_SRC" ] || continue
+    echo "[0/4] Building plugin $(basename "$PLUGIN_SRC")..."
+    ${CC:-cc} -shared -fPIC -I"$ROOT_DIR/include" "$PLUGIN_SRC" -o "${PLUGIN_SRC%.c}.so"
+done
+
 # Assemble
 echo "[1/4] Assembling..."
-ca65 "$ASM_FILE" -o "$OBJ_FILE"
+ca65 -g "$ASM_FILE" -o "$OBJ_FILE"
 
 # Link
 echo "[2/4] Linking..."
-ld65 "$OBJ_FILE" -o "$BIN_FILE" -C "$CFG_FILE"
+ld65 "$OBJ_FILE" -o "$BIN_FILE" -C "$CFG_FILE" --dbgfile "$DBG_FILE"
 
 # Hexdump
 echo "[3/4] Firmware Preview:"
@@ -66,7 +74,7 @@ hexdump -C "$BIN_FILE" | head
 if [ -f "$ROOT_DIR/main" ]; then
     echo "[4/4] Running on Rosetta-6502..."
     echo "--------------------------------------"
-    "$ROOT_DIR/main" --bin "$BIN_FILE" --mmio "$MMIO_CONFIG"
+    "$ROOT_DIR/main" --bin "$BIN_FILE" --mmio "$MMIO_CONFIG" --symbols "$DBG_FILE"
 else
     echo "[4/4] main executable not found. Run 'make' in project root first."
 fi
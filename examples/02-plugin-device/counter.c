@@ -0,0 +1,91 @@
+#include "mmio_plugin.h"
+
+/*
+   Example MMIO plugin: an 8-bit up-counter.
+
+   Reading the register returns the current value and increments it; writing
+   loads a new value. Build it as a shared object:
+
+       cc -shared -fPIC -Iinclude examples/02-plugin-device/counter.c \
+          -o examples/02-plugin-device/counter.so
+
+   and map it in mmio.cfg with `plugin=counter.so args=<initial value>`.
+*/
+
+typedef struct
+{
+  Byte value;
+} Counter;
+
+static void *
+counter_create (const MMIOHost *host, Word start, Word end, const char *args)
+{
+  (void)host;
+  (void)start;
+  (void)end;
+
+  Counter *counter = calloc (1, sizeof (Counter));
+  if (counter && args[0])
+    counter->value = (Byte)strtoul (args, NULL, 0);
+  return counter;
+}
+
+static void
+counter_destroy (void *state)
+{
+  free (state);
+}
+
+static Byte
+counter_read (void *state, Word addr, QWord cycle)
+{
+  (void)addr;
+  (void)cycle;
+  Counter *counter = state;
+  return counter->value++;
+}
+
+static void
+counter_write (void *state, Word addr, Byte data, QWord cycle)
+{
+  (void)addr;
+  (void)cycle;
+  Counter *counter = state;
+  counter->value = data;
+}
+
+static size_t
+counter_save (void *state, Byte *buf, size_t size)
+{
+  Counter *counter = state;
+  if (size >= 1)
+    buf[0] = counter->value;
+  return 1;
+}
+
+static bool
+counter_restore (void *state, const Byte *buf, size_t size)
+{
+  Counter *counter = state;
+  if (size < 1)
+    return false;
+  counter->value = buf[0];
+  return true;
+}
+
+static const MMIOPlugin counter_plugin = {
+  .abi_version = MMIO_PLUGIN_ABI_VERSION,
+  .name = "counter",
+  .create = counter_create,
+  .destroy = counter_destroy,
+  .read = counter_read,
+  .write = counter_write,
+  .save = counter_save,
+  .restore = counter_restore,
+};
+
+const MMIOPlugin *
+rosetta_mmio_plugin (void)
+{
+  return &counter_plugin;
+}
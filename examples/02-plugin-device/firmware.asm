@@ -0,0 +1,24 @@
+.segment "CODE"
+
+reset:
+    sei                 ; Disable interrupts
+    cld                 ; Clear decimal mode
+
+    ; The COUNTER plugin starts at 'A' (args=0x41 in mmio.cfg)
+    ldx #$03
+next:
+    lda $D010           ; MMIO: read and advance the counter
+    sta $D000           ; MMIO: PRINTCHAR
+    dex
+    bne next
+
+    lda #$00
+    sta $D0FF           ; MMIO: EXIT (code 0)
+
+halt:
+    jmp halt
+
+.segment "VECTORS"
+    .word reset         ; NMI vector
+    .word reset         ; RESET vector
+    .word reset         ; IRQ / BRK vector
@@ -0,0 +1,41 @@
+; Interrupt-driven echo over the buffered UART device.
+; Every received byte is echoed back; 'q' ends the program.
+
+UART_DATA    = $D000
+UART_STATUS  = $D001
+UART_CONTROL = $D002
+EXIT         = $D0FF
+
+.segment "CODE"
+
+reset:
+    sei                 ; Disable interrupts while configuring
+    cld
+    ldx #$FF
+    txs
+
+    lda #$01
+    sta UART_CONTROL    ; Raise IRQ while the RX FIFO is not empty
+    cli
+
+idle:
+    jmp idle            ; All work happens in the IRQ handler
+
+irq:
+    lda UART_DATA       ; Pop one byte (the IRQ stays high while more wait)
+    sta UART_DATA       ; Echo it through the TX FIFO
+    cmp #'q'
+    beq quit
+    rti
+
+quit:
+    lda #$00
+    sta EXIT            ; MMIO: EXIT (code 0), flushes the TX FIFO
+
+halt:
+    jmp halt
+
+.segment "VECTORS"
+    .word reset         ; NMI vector
+    .word reset         ; RESET vector
+    .word irq           ; IRQ / BRK vector
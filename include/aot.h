@@ -0,0 +1,109 @@
+#ifndef AOT_H
+#define AOT_H
+
+#include "../src/cpu/Instructions/dispatch.h"
+#include "breakpoint.h"
+#include "cpu_exec.h"
+#include "mmio.h"
+
+/*
+   Ahead-of-time translation
+
+   tools/rosetta-aot.c translates a ROM image into C with one function per
+   basic block, found from the vectors, the load address and every JSR,
+   JMP and branch target it can see. A block calls the handlers of its
+   instructions directly (INSTRUCTION_CALL, handlers.h), so it runs exactly
+   the code the interpreter would, minus fetch and decode. The generated
+   file registers itself at startup; `make native ROM=...` links it into
+   main-native.
+
+   The run loops call the block starting at PC when there is one and its
+   bytes are still those of the image in ROM. Everything else is
+   interpreted: targets only known at run time (JMP indirect, RTS to a
+   pushed address), code in RAM, and entries into the middle of a block.
+   Blocks run under the same conditions as fused pairs (cpu_exec.c) and
+   check between two instructions what a fused pair checks, so state,
+   cycle counts and stops match the interpreter's.
+*/
+
+// One call of a block by a run loop.
+typedef struct
+{
+  Machine6502 *machine;
+  QWord end;  // Cycle budget of the loop
+  QWord left; // Instructions the block may run, at least 1
+  Word last;  // Address of the last instruction run
+} AotRun;
+
+typedef struct
+{
+  Word start, end; // First and last byte
+  bool (*run) (AotRun *run);
+} AotBlock;
+
+typedef struct
+{
+  Word origin;
+  DWord size;
+  const Byte *image;
+  const AotBlock *blocks;
+  DWord count;
+} AotImage;
+
+// Set by aot_register; NULL when no image is linked in.
+extern const AotBlock **aot_blocks;
+
+// Called by the generated file's constructor. One image per program.
+void aot_register (const AotImage *image);
+
+// The block starting at `pc`, or NULL if there is none or the ROM no
+// longer holds its bytes. Pages are compared with the image the first
+// time they are used and again after they were written (MemPage.Writes).
+const AotBlock *aot_lookup (const MEM6502 *memory, Word pc);
+
+/*
+   Helpers of the generated blocks. Every instruction is aot_fetch, the
+   handler call (INSTRUCTION_CALL) and aot_finish. A block runs its first
+   instruction unconditionally: the run loop has already checked
+   interrupts and PC breakpoints. Like run_fused_step it counts every
+   instruction but the last in machine->instructions and returns false
+   when a watchpoint fired.
+*/
+
+// Fetches the opcode at PC, `Ins`.
+static ALWAYS_INLINE void
+aot_fetch (AotRun *run, Byte Ins)
+{
+  Machine6502 *machine = run->machine;
+
+  FetchByte (machine->bus, machine->memory, machine->cpu);
+  machine->cpu->CurrentAccess = get_instruction_access_type (Ins);
+}
+
+// Catches the devices up. Returns false if a watchpoint fired.
+static ALWAYS_INLINE bool
+aot_finish (void)
+{
+  if (total_cycles_executed >= mmio_next_event)
+    mmio_run_events (total_cycles_executed);
+  return !breakpoint_stop_pending;
+}
+
+// Whether the instruction at `next` may run in the same call.
+static ALWAYS_INLINE bool
+aot_continue (AotRun *run, Word next)
+{
+  const CPU6502 *cpu = run->machine->cpu;
+
+  if (run->left <= 1 || cpu->PC != next || mmio_exit_requested
+      || total_cycles_executed >= run->end
+      || (mmio_irq_lines && !cpu->Flag.I)
+      || (debug_page_flags[next >> 8] & DEBUG_PAGE_EXEC))
+    return false;
+  run->left--;
+  run->machine->instructions++;
+  run->last = next;
+  return true;
+}
+
+#endif // AOT_H
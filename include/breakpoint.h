@@ -0,0 +1,147 @@
+#ifndef BREAKPOINT_H
+#define BREAKPOINT_H
+
+#include "config.h"
+#include "memory_map.h"
+
+struct CPU6502;
+
+/*
+   Breakpoints and watchpoints
+
+   Every breakpoint flags the pages it covers in debug_page_flags. Pages
+   with a read or write watchpoint lose their direct pointers in the page
+   table, so their accesses take the slow path where the flags are checked;
+   all other pages keep the single-lookup fast path. PC breakpoints are
+   checked before each opcode fetch, against the bitmap only when the page
+   of PC is flagged. With no breakpoints set, the core runs exactly as
+   before.
+
+   A watchpoint fires after the access; the instruction completes and the
+   run stops before the next one, like a hardware watchpoint. Read
+   watchpoints see data reads only, not opcode or operand fetches. An
+   access through a mirror (memory_map.h) also matches watchpoints on the
+   address it mirrors. A PC breakpoint stops before the instruction at
+   that address executes; it matches PC as is, not the mirrors of it.
+
+   Conditions are "<lhs><op><number>" where lhs is A, X, Y, SP, P, PC,
+   value (the byte read or written) or [addr] (a memory byte), and op is
+   one of == != < <= > >= & (non-zero bitwise and). Examples:
+     A==0x10   [0x0200]>=3   value&0x80
+*/
+
+#define BREAKPOINT_MAX 64
+
+// debug_page_flags bits.
+#define DEBUG_PAGE_EXEC 0x01
+#define DEBUG_PAGE_READ 0x02
+#define DEBUG_PAGE_WRITE 0x04
+
+typedef enum
+{
+  BREAK_EXEC = 0,
+  BREAK_READ,
+  BREAK_WRITE,
+  BREAK_ACCESS // Read or write
+} BreakKind;
+
+// Left-hand side of a condition.
+typedef enum
+{
+  COND_ALWAYS = 0, // Unconditional
+  COND_A,
+  COND_X,
+  COND_Y,
+  COND_SP,
+  COND_P,
+  COND_PC,
+  COND_VALUE,  // Byte read or written
+  COND_MEMORY  // [address]
+} CondOperand;
+
+typedef enum
+{
+  COND_EQ,
+  COND_NE,
+  COND_LT,
+  COND_LE,
+  COND_GT,
+  COND_GE,
+  COND_AND
+} CondOp;
+
+// A condition, parsed once when the breakpoint is added.
+typedef struct
+{
+  CondOperand lhs;
+  Word address; // For COND_MEMORY
+  CondOp op;
+  DWord rhs;
+} BreakCondition;
+
+typedef struct
+{
+  int id; // 0 if unused
+  BreakKind kind;
+  Word start;
+  Word end;
+  char condition[48]; // Empty for unconditional
+  BreakCondition test;
+  QWord hits;
+} Breakpoint;
+
+// What stopped the run.
+typedef struct
+{
+  int id;
+  BreakKind kind; // BREAK_READ or BREAK_WRITE for watchpoints
+  Word address;   // PC for breakpoints
+  Byte value;     // Byte read or written
+} BreakHit;
+
+extern Byte debug_page_flags[PAGE_COUNT];
+extern Breakpoint breakpoints[BREAKPOINT_MAX];
+
+// Set when a breakpoint fired; run_cpu_instruction returns false.
+extern bool breakpoint_stop_pending;
+extern BreakHit breakpoint_last_hit;
+
+// Adds a breakpoint over start..end. Returns its id (> 0), or -1 if the
+// table is full or the condition does not parse.
+int breakpoint_add (MEM6502 *memory, BreakKind kind, Word start, Word end,
+                    const char *condition);
+
+// Parses "[exec|read|write|access:]START[-END][:CONDITION]" (addresses in
+// hex or symbol names from symbols.h) and adds it. Returns the id or -1.
+int breakpoint_parse (MEM6502 *memory, const char *spec);
+
+bool breakpoint_remove (MEM6502 *memory, int id);
+void breakpoint_clear (MEM6502 *memory);
+
+// Called by the core when a flagged page is executed from or accessed.
+bool breakpoint_check_exec (const MEM6502 *memory,
+                            const struct CPU6502 *cpu);
+void breakpoint_check_access (const MEM6502 *memory,
+                              const struct CPU6502 *cpu, Word address,
+                              Byte value, bool write);
+
+// Clears the pending stop. If the run stopped on a PC breakpoint, that
+// breakpoint is skipped once so execution can continue past it.
+void breakpoint_resume (const struct CPU6502 *cpu);
+
+// Forgets a pending stop and the skip-once state, for when the machine
+// state was replaced (reverse execution).
+void breakpoint_rearm (void);
+
+// Stops again after the next instruction.
+void breakpoint_step (void);
+
+// Prints the last hit (nothing after a single step).
+void breakpoint_report (void);
+
+// Minimal monitor for a stopped run: reports the hit and reads commands
+// from the terminal. Returns true to continue, false to end the run (always
+// false when stdin is not a terminal).
+bool breakpoint_prompt (MEM6502 *memory, struct CPU6502 *cpu);
+
+#endif // BREAKPOINT_H
@@ -0,0 +1,66 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "config.h"
+
+/*
+   COVERAGE - Coverage of emulated code
+
+   Two independent recorders, each off while its pointer is NULL:
+
+   coverage_map (fuzzers): every control transfer (branches taken or not,
+   JMP, JSR, RTS, RTI, BRK and interrupt entry) bumps the 8-bit counter of
+   the edge from the instruction's address to the new PC, at an AFL-style
+   hash of the two. The map holds COVERAGE_MAP_SIZE counters and may be a
+   fuzzer's own (AFL's shared memory, libFuzzer extra counters).
+
+   coverage_bits (code coverage reports): one bit per address set when an
+   opcode is fetched there, and for branches one bit each for taken and
+   not taken. Files of bitmaps are merged by OR, so a test corpus can
+   accumulate into one file; rosetta-cov maps them back to source lines.
+*/
+
+#define COVERAGE_MAP_SIZE 65536
+#define COVERAGE_BITMAP_SIZE (65536 / 8)
+
+typedef struct
+{
+  Byte executed[COVERAGE_BITMAP_SIZE];
+  Byte taken[COVERAGE_BITMAP_SIZE];
+  Byte not_taken[COVERAGE_BITMAP_SIZE];
+} CoverageBits;
+
+extern Byte *coverage_map;
+extern CoverageBits *coverage_bits;
+
+static inline unsigned
+coverage_index (Word from, Word to)
+{
+  return ((from >> 1) ^ to) & (COVERAGE_MAP_SIZE - 1);
+}
+
+static inline void
+coverage_edge (Word from, Word to)
+{
+  coverage_map[coverage_index (from, to)]++;
+}
+
+static inline void
+coverage_bit_set (Byte *bitmap, Word address)
+{
+  bitmap[address >> 3] |= 1 << (address & 7);
+}
+
+static inline bool
+coverage_bit (const Byte *bitmap, Word address)
+{
+  return (bitmap[address >> 3] >> (address & 7)) & 1;
+}
+
+// ORs the bitmaps saved in `path` into `bits`. A missing file is an empty
+// one when `missing_ok` is set.
+bool coverage_bits_merge (CoverageBits *bits, const char *path,
+                          bool missing_ok);
+bool coverage_bits_write (const CoverageBits *bits, const char *path);
+
+#endif // COVERAGE_H
@@ -83,6 +83,12 @@ extern QWord total_cycles_executed;
 */
 extern struct timespec start_time;
 
+/*
+   clock_unthrottled - When set, sync_clock never sleeps and the core runs as
+   fast as the host allows (replaying history, batch runs).
+*/
+extern bool clock_unthrottled;
+
 /*
    clock_init - Initializes timing variables and marks the start time of
    emulation. Should be called once before starting CPU execution.
@@ -145,4 +151,11 @@ Word PopWordFromStack (Bus6502 *bus, MEM6502 *memory,
 Byte PopByteFromStack (Bus6502 *bus, MEM6502 *memory,
                        CPU6502 *cpu);
 
+// Interrupts:
+
+// This function services a maskable interrupt request: it pushes PC and the
+// status register (Break clear), sets the Interrupt Disable flag and jumps
+// through the IRQ vector at $FFFE/$FFFF.
+void InterruptRequest (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu);
+
 #endif // CPU6502_H
@@ -11,4 +11,51 @@
 bool run_cpu_instruction (Bus6502 *bus, MEM6502 *memory,
                           CPU6502 *cpu);
 
+/*
+   Bounded runs
+
+   run_cycles, run_instructions and run_until execute instructions in a
+   loop inside the core until a budget runs out or something stops the
+   machine, and say what it was. Budgets are checked between instructions,
+   so a cycle budget can be overrun by the last instruction (at most 7
+   cycles, or an interrupt sequence). When reverse execution is on, the
+   loops record through reverse_run_instruction.
+*/
+
+typedef struct Machine6502
+{
+  Bus6502 *bus;
+  MEM6502 *memory;
+  CPU6502 *cpu;
+  QWord instructions; // Executed by the run functions, never reset
+} Machine6502;
+
+typedef enum
+{
+  STOP_BUDGET,     // The cycles or instructions asked for were run
+  STOP_CONDITION,  // A RunCondition held
+  STOP_TRAP,       // An instruction jumped to itself
+  STOP_BREAKPOINT, // A breakpoint or watchpoint fired (breakpoint_last_hit)
+  STOP_EXIT        // The program asked to exit (mmio_exit_requested)
+} StopReason;
+
+// What run_until waits for; fields left zero are not checked. They are
+// checked after every instruction in this order.
+typedef struct
+{
+  bool at_pc;             // PC reached `pc`
+  Word pc;
+  bool on_trap;           // The instruction left PC unchanged
+  QWord max_cycles;       // Budgets, as for run_cycles/run_instructions
+  QWord max_instructions;
+  bool (*holds) (const Machine6502 *machine, void *arg);
+  void *arg;
+} RunCondition;
+
+StopReason run_cycles (Machine6502 *machine, QWord budget);
+StopReason run_instructions (Machine6502 *machine, QWord count);
+StopReason run_until (Machine6502 *machine, const RunCondition *condition);
+
+const char *stop_reason_name (StopReason reason);
+
 #endif // CPU_EXEC_H
@@ -2,6 +2,7 @@
 #define DEBUG_H
 
 #include "bus.h"
+#include "memory_map.h"
 
 struct CPU6502;
 
@@ -16,7 +17,8 @@ typedef enum {
 extern DebugLevel DEBUG_LEVEL;
 
 void debug_set_level(DebugLevel level);
-void debug_opcode(Word pc, Byte opcode);
+void debug_opcode(const MEM6502 *memory, Word pc);
+void debug_trace(const MEM6502 *memory, const struct CPU6502 *cpu);
 void debug_cpu_state(const struct CPU6502 *cpu);
 void debug_mem_read(Word addr, Byte val);
 void debug_mem_write(Word addr, Byte val);
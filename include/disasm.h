@@ -0,0 +1,41 @@
+#ifndef DISASM_H
+#define DISASM_H
+
+#include "../src/cpu/Instructions/opcode_table.h"
+#include "config.h"
+
+/*
+   Disassembler driven by OPCODE_TABLE.
+
+   opcode_info is expanded from the same table as the Instruction enum, so
+   the emulator and the disassembler always agree on which opcodes exist.
+   Unknown opcodes have a NULL mnemonic and disassemble as ".byte $nn".
+   Operand addresses are replaced by names from symbols.h when available.
+*/
+
+typedef struct
+{
+  const char *mnemonic;
+  AddressingMode mode;
+} OpcodeInfo;
+
+extern const OpcodeInfo opcode_info[256];
+
+// Length in bytes of the instruction starting with `opcode` (1 if unknown).
+static inline int
+disasm_length (Byte opcode)
+{
+  if (opcode_info[opcode].mnemonic == NULL)
+    return 1;
+  return addressing_mode_length (opcode_info[opcode].mode);
+}
+
+// Writes the instruction at `pc` ("LDA #$10") to `out`. `bytes` holds the
+// opcode followed by its operand bytes. Returns the instruction length.
+int disasm_instruction (Word pc, const Byte *bytes, char *out, size_t size);
+
+// Same, as a listing line with address and raw bytes:
+// "E000  A9 10     LDA #$10".
+int disasm_line (Word pc, const Byte *bytes, char *out, size_t size);
+
+#endif // DISASM_H
@@ -0,0 +1,31 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "config.h"
+#include <stdatomic.h>
+
+/*
+   Shared-memory layout published by device=framebuffer (shm=<name>).
+
+   The segment starts with this header, followed by width * height RGB
+   triplets (3 bytes per pixel, rows top to bottom). After each frame the
+   device rewrites only the dirty rows, records their range and then
+   increments `frame` with a release store, so a viewer can poll `frame`
+   (acquire) and copy rows dirty_first..dirty_last instead of the whole
+   image.
+*/
+
+#define FRAMEBUFFER_SHM_MAGIC 0x42465236 // "6RFB"
+
+typedef struct FramebufferShm
+{
+  uint32_t magic;
+  uint32_t width;
+  uint32_t height;
+  _Atomic uint32_t frame;  // Incremented once the rows below are complete
+  uint32_t dirty_first;    // Rows updated by the last frame
+  uint32_t dirty_last;
+  Byte pixels[];           // width * height * 3 bytes of RGB
+} FramebufferShm;
+
+#endif // FRAMEBUFFER_H
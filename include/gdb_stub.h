@@ -0,0 +1,36 @@
+#ifndef GDB_STUB_H
+#define GDB_STUB_H
+
+#include "bus.h"
+#include "config.h"
+#include "cpu6502.h"
+#include "mem6502.h"
+
+/*
+   GDB remote serial protocol stub
+
+   gdb_stub_listen waits for one debugger on a local socket:
+     1234, :1234, localhost:1234   TCP on 127.0.0.1
+     unix:/tmp/rosetta.sock        UNIX domain socket
+
+   gdb_stub_run then owns execution: the machine stays halted while the
+   debugger talks, and runs in timeslices of GDB_STUB_SLICE instructions
+   when it continues. Ctrl-C from the debugger is looked for only between
+   slices, so the instruction loop itself is unchanged; breakpoints and
+   watchpoints (Z0-Z4) use the page-flag machinery of breakpoint.h.
+
+   Registers, in 'g' packet order: a, x, y, p, sp (one byte each) and pc
+   (two bytes, little endian). Memory packets use mem6502_peek/poke and
+   never touch MMIO devices. With reverse execution recording (reverse.h),
+   bs and bc step and continue backwards.
+*/
+
+#define GDB_STUB_SLICE 10000
+
+bool gdb_stub_listen (const char *address);
+
+// Serves the debugger until it detaches (returns true: keep running
+// without it) or kills the target / the firmware exits (returns false).
+bool gdb_stub_run (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu);
+
+#endif // GDB_STUB_H
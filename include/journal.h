@@ -0,0 +1,75 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "config.h"
+#include "memory_map.h"
+
+struct CPU6502;
+
+/*
+   JOURNAL - Record and replay of host input
+
+   In deterministic mode emulated time is the only clock (sync_clock never
+   sleeps) and the only thing that can make two runs differ is input from
+   the host: bytes a UART reads from stdin, get_key, plugin devices. Those
+   devices are marked `journal` (by default: device=uart, read=get_key and
+   every plugin; override with journal=0|1 in mmio.cfg).
+
+   Recording writes, in order, the value of every read from a journaled
+   device and the cycle of every IRQ taken while a journaled device held
+   the line. Replaying feeds the same values back without calling the
+   devices' read handlers, ignores their IRQ line and raises the line at
+   the recorded cycles instead, so the run is reproduced exactly and at
+   full speed. Writes still reach the devices, so output is reproduced too.
+
+   File layout (integers little endian, counts as LEB128 varints):
+     "R6502JNL"  magic
+     u32         format version
+     chunks:     varint n, n read values, varint tag
+                 tag 0: end of journal, followed by the footer
+                 tag 1: more reads follow
+                 tag k >= 2: IRQ taken k - 2 cycles after the previous one
+     footer:     u64 cycles executed, u64 hash of registers and memory
+
+   At the end of a replay the footer is compared with the final machine
+   state, so a divergence is reported instead of going unnoticed.
+*/
+
+#define JOURNAL_VERSION 1
+
+typedef enum
+{
+  JOURNAL_OFF = 0,
+  JOURNAL_RECORD,
+  JOURNAL_REPLAY
+} JournalMode;
+
+extern JournalMode journal_mode;
+
+// Cycle at which the journal must raise the IRQ line (MMIO_NO_EVENT if
+// none); part of the MMIO event deadline.
+extern QWord journal_next_event;
+
+// Starts recording to / replaying from `path`. Call after mmio.cfg is
+// loaded: the set of journaled devices must be known.
+bool journal_record (const char *path);
+bool journal_replay (const char *path);
+
+// Ends the journal: writes the footer, or compares it with the final state.
+// Returns false if a replay diverged from its recording.
+bool journal_finish (const struct CPU6502 *cpu, const MEM6502 *memory);
+
+// Bus hooks for reads from journaled devices.
+void journal_log_read (Byte value);
+Byte journal_next_read (void);
+
+// Called by the core when it takes an IRQ.
+void journal_irq (QWord cycle);
+
+// Called from mmio_run_events when journal_next_event is due.
+void journal_tick (QWord now);
+
+// IRQ line bits of the journaled devices.
+QWord journal_irq_lines (void);
+
+#endif // JOURNAL_H
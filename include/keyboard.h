@@ -0,0 +1,16 @@
+#ifndef KEYBOARD_H
+#define KEYBOARD_H
+
+/*
+   Registers of device=keyboard, as offsets from the device start address.
+   Shared by the device (src/mmio/keyboard.c) and by lanes, which model it
+   once per lane.
+*/
+
+#define KEYBOARD_REG_DATA 0   // Read: next available byte, 0 if none
+#define KEYBOARD_REG_STATUS 1 // Read: KEYBOARD_STATUS_* bits
+
+#define KEYBOARD_STATUS_READY 0x01 // A byte is available
+#define KEYBOARD_STATUS_DONE 0x08  // The input is exhausted
+
+#endif // KEYBOARD_H
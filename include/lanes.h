@@ -0,0 +1,113 @@
+#ifndef LANES_H
+#define LANES_H
+
+#include "cpu6502.h"
+#include "mem6502.h"
+#include "mmio.h"
+
+/*
+   LANES - Lock-step execution of many copies of one machine
+
+   Input sweeps and fuzzing run the same firmware over and over with
+   different inputs. Lanes6502 holds up to LANES_MAX copies of a booted
+   machine with their registers stored as arrays indexed by lane. Each step
+   takes the running lanes with the lowest PC and executes that instruction
+   for all of them at once: it is decoded once, and register and flag
+   updates are loops over the lane arrays that the compiler turns into
+   SIMD code. On x86-64 GCC builds the step is cloned for AVX-512 and AVX2,
+   with the SSE2 baseline as fallback, and picked when the program loads;
+   the loops only vectorize in optimized builds (-O2 and up), so the
+   Makefile builds this module with -O2 whatever CFLAGS says.
+
+   Lanes whose control flow diverges are masked out and wait. Running the
+   lowest PC first brings them back together where if/else arms and loops
+   join, so lanes that share most of their control flow share most steps.
+
+   Every lane has its own 64 KB of storage, laid out by the machine's
+   memory map (mirrors included). Two devices are modelled per lane: the
+   keyboard given to lanes_init, whose input is set with lanes_set_input
+   and is available at once (no timed bytes), and exit devices
+   (write=mmio_exit). A lane that reads or writes any other device, or
+   reaches an undocumented opcode, stops. lanes_init fails if any device
+   can raise an IRQ (mmio_device_can_irq). Apart from that, lanes produce
+   the interpreter's registers, memory and cycle counts for the same input.
+*/
+
+#define LANES_MAX 32
+
+typedef enum
+{
+  LANE_RUNNING,
+  LANE_BUDGET,     // Spent the cycles given to lanes_run
+  LANE_TRAP,       // An instruction jumped to itself
+  LANE_BREAKPOINT, // Reached an address passed to lanes_break
+  LANE_EXIT,       // Wrote to an exit device
+  LANE_DEVICE,     // Accessed a device lanes do not model
+  LANE_OPCODE      // Reached an undocumented opcode
+} LaneState;
+
+typedef struct
+{
+  int count;
+
+  // Registers, one entry per lane.
+  Byte A[LANES_MAX], X[LANES_MAX], Y[LANES_MAX];
+  Byte SP[LANES_MAX], P[LANES_MAX];
+  Word PC[LANES_MAX];
+  QWord cycles[LANES_MAX]; // Continues the machine's total_cycles_executed
+
+  LaneState state[LANES_MAX];
+  Byte exit_code[LANES_MAX];
+
+  // Edge coverage per lane (coverage.h), when set.
+  Byte *coverage[LANES_MAX];
+
+  // Keyboard input per lane.
+  const Byte *input[LANES_MAX];
+  size_t input_length[LANES_MAX];
+  size_t input_position[LANES_MAX];
+
+  // Steps taken and lane-instructions executed by lanes_run, to measure
+  // how well lanes stay together.
+  QWord steps;
+  QWord instructions;
+
+  // Internal: storage, layout and the state lanes_reset returns to.
+  Byte *ram;     // count * 64 KB
+  Byte *initial; // 64 KB
+  Byte dirty[LANES_MAX][PAGE_COUNT];
+  LaneState event[LANES_MAX]; // Exit or device access in this instruction
+  Byte kind[PAGE_COUNT];
+  DWord backing[PAGE_COUNT];
+  Byte breakpoints[PAGE_COUNT * PAGE_SIZE / 8];
+  CPU6502 boot;
+  QWord boot_cycles;
+  const MEM6502 *memory;
+  const MMIODevice *keyboard;
+} Lanes6502;
+
+// Makes `count` copies of the machine: registers, cycle counter, memory
+// and its layout. `keyboard` (device=keyboard) may be NULL. Returns false
+// if count is out of range, a device can raise an IRQ or memory runs out.
+bool lanes_init (Lanes6502 *lanes, int count, const CPU6502 *cpu,
+                 const MEM6502 *memory, const MMIODevice *keyboard);
+void lanes_free (Lanes6502 *lanes);
+
+// Returns a lane to the state lanes_init copied, restoring only the
+// pages it wrote, and rewinds its input.
+void lanes_reset (Lanes6502 *lanes, int lane);
+
+// Sets the keyboard input of a lane. The data is not copied.
+void lanes_set_input (Lanes6502 *lanes, int lane, const Byte *data,
+                      size_t length);
+
+// Lanes stop before executing the instruction at `address`.
+void lanes_break (Lanes6502 *lanes, Word address);
+
+// Runs every running lane until it stops or has spent `max_cycles` in
+// this call (0 for no limit). Returns the number of lanes that ran.
+int lanes_run (Lanes6502 *lanes, QWord max_cycles);
+
+const char *lane_state_name (LaneState state);
+
+#endif // LANES_H
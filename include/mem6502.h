@@ -33,10 +33,38 @@ typedef struct CPU6502 CPU6502;
 // Maximum memory size for the 6502 system.
 extern const DWord MAX_MEM;
 
+struct MMIODevice;
+
+/*
+   MemPage - One 256-byte page of the compiled memory map.
+
+   `Read` and `Write` point straight into host storage when the page can be
+   accessed without any checks (plain RAM, or ROM for reads). They are NULL
+   when the access needs the slow path: ROM writes, unmapped pages and pages
+   that contain MMIO devices. `Devices` holds one entry per page offset and is
+   only allocated for pages that contain at least one device.
+
+   `Writes` counts CPU stores into the page's backing storage. Consumers that
+   need dirty-page information (RAM viewer, snapshots) remember the value
+   they last saw instead of clearing a flag, so several of them can track the
+   same page independently.
+*/
+typedef struct MemPage
+{
+  Byte *Read;                  // Direct read pointer, or NULL
+  Byte *Write;                 // Direct write pointer, or NULL
+  Byte *Backing;               // Storage behind the page (mirrors alias)
+  struct MMIODevice **Devices; // Per-offset MMIO devices, or NULL
+  RegionKind Kind;             // RAM, ROM or unmapped
+  Byte Alias;                  // Page devices see (the source of a mirror)
+  DWord Writes;                // Stores through this page
+} MemPage;
+
 // Structure representing the memory for the 6502 system.
 typedef struct MEM6502
 {
   Byte *Data; // Emulates RAM to allocate 65 Kilobytes for storing data.
+  MemPage Pages[PAGE_COUNT]; // Page table compiled from the memory map.
 } MEM6502;
 
 // Initializes memory to 65 Kilobytes (64 * 1024 Bytes).
@@ -45,7 +73,26 @@ void initializeMem6502 (MEM6502 *memory);
 // Frees 65 Kilobytes of RAM.
 void freeMem6502 (MEM6502 *memory);
 
+// Marks every page as written, after memory was changed behind the CPU's
+// back (loader, snapshot restore).
+void markMem6502Dirty (MEM6502 *memory);
+
+// Debugger access: reads and writes the storage behind an address without
+// going through MMIO devices, so inspecting memory has no side effects.
+// Pokes reach ROM too (patching firmware) but not unmapped pages.
+Byte mem6502_peek (const MEM6502 *memory, Word address);
+bool mem6502_poke (MEM6502 *memory, Word address, Byte value);
+
+// Storage page (index into Data) behind a page of the address space.
+static inline int
+mem6502_backing_page (const MEM6502 *memory, int page)
+{
+  return (int)((memory->Pages[page].Backing - memory->Data) / PAGE_SIZE);
+}
+
 void cpu_read (Bus6502 *bus, const MEM6502 *memory, Word address, CPU6502 *cpu);
+// cpu_read for instruction fetches, which read watchpoints ignore.
+void cpu_fetch (Bus6502 *bus, const MEM6502 *memory, Word address, CPU6502 *cpu);
 void cpu_write (Bus6502 *bus, MEM6502 *memory, Word address, Byte data, CPU6502 *cpu);
 
 #endif // MEM6502_H
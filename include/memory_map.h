@@ -1,6 +1,21 @@
 #ifndef MEMORY_MAP_H
 #define MEMORY_MAP_H
 
+#include "config.h"
+
+/*
+   MEMORY_MAP - Board memory layout
+
+   The address space is described as a list of regions (RAM, ROM, mirrors and
+   unmapped holes). The list is read from the `[memory]` section of the
+   configuration file and compiled once, at startup, into the 256-entry page
+   table held by MEM6502. cpu_read/cpu_write then resolve every access with a
+   single page lookup instead of re-checking region bounds.
+
+   The macros below describe the default board used when the configuration
+   file has no `[memory]` section.
+*/
+
 #define ZP_START  0x0000
 #define STACK_START 0x0100
 #define RAM_END   0xCFFF
@@ -9,4 +24,64 @@
 #define ROM_START  0xE000
 #define ROM_END    0xFFFF
 
-#endif
\ No newline at end of file
+#define PAGE_SIZE 256
+#define PAGE_COUNT 256
+#define MAX_MEMORY_REGIONS 64
+
+typedef struct MEM6502 MEM6502;
+
+// Kind of storage backing a page.
+typedef enum
+{
+  REGION_UNMAPPED = 0, // Reads return 0xFF, writes are dropped
+  REGION_RAM,          // Read/write storage
+  REGION_ROM,          // Read-only storage, writes are ignored
+  REGION_MIRROR        // Alias of another range (config only)
+} RegionKind;
+
+/*
+   MemoryRegion - One line of the `[memory]` section.
+
+   Regions are page aligned (start on a multiple of 0x100, end on 0xFF). For
+   mirrors, `source_start`/`source_end` name the aliased range; the range is
+   repeated as many times as needed to fill `start`..`end`.
+*/
+typedef struct
+{
+  RegionKind kind;
+  Word start;
+  Word end;
+  Word source_start;
+  Word source_end;
+} MemoryRegion;
+
+extern MemoryRegion memory_regions[MAX_MEMORY_REGIONS];
+extern int memory_region_count;
+
+// Restores the default board layout (RAM, unmapped MMIO hole, ROM).
+void memory_map_set_defaults (void);
+
+// Drops every region, leaving the whole address space unmapped.
+void memory_map_clear (void);
+
+// Appends a region to the layout. Returns false if it is malformed.
+bool memory_map_add_region (RegionKind kind, Word start, Word end,
+                            Word source_start, Word source_end);
+
+// Parses a `[memory]` line such as "RAM 0x0000 0x07FF" or
+// "MIRROR 0x0800 0x1FFF 0x0000 0x07FF". Returns false on syntax errors.
+bool memory_map_parse_line (const char *line);
+
+// Builds the page table of `memory` from the region list and the currently
+// loaded MMIO devices. Must be called again whenever either changes.
+void memory_map_compile (MEM6502 *memory);
+
+// Recomputes only the direct Read/Write pointers of the page table, e.g.
+// after watchpoints were added or removed.
+void memory_map_update_direct (MEM6502 *memory);
+
+// Returns the lowest address of the first ROM region, or ROM_START if the
+// layout has none. Used as the default firmware load address.
+Word memory_map_rom_start (void);
+
+#endif
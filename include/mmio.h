@@ -2,25 +2,101 @@
 #define MMIO_H
 
 #include "config.h"
+#include "mmio_plugin.h"
 
 extern int mmio_exit_requested;
 extern Byte mmio_exit_code;
 
-typedef Byte (*mmio_read_t)(Word addr);
-typedef void (*mmio_write_t)(Word addr, Byte data);
+// Write handler of exit devices (write=mmio_exit): requests the exit.
+void mmio_exit(void *ctx, Word addr, Byte data, QWord cycle);
 
-typedef struct {
+#define MMIO_MAX_DEVICES 64
+
+/*
+   MMIO handlers receive the device context (`ctx`) and the emulated cycle at
+   which the access happens, so devices can keep their own state and model
+   time without globals or polling.
+
+   `tick` is optional. It brings the device up to `until_cycle` and returns
+   the cycle of its next internal event (MMIO_NO_EVENT if none). It is called
+   lazily: before each access to the device and when the CPU reaches the
+   device's next event, never on every cycle.
+*/
+#define MMIO_NO_EVENT UINT64_MAX
+
+typedef Byte (*mmio_read_t)(void *ctx, Word addr, QWord cycle);
+typedef void (*mmio_write_t)(void *ctx, Word addr, Byte data, QWord cycle);
+typedef QWord (*mmio_tick_t)(void *ctx, QWord until_cycle);
+
+typedef struct MMIODevice {
     char name[32];
     Word start;
     Word end;
     mmio_read_t read;
     mmio_write_t write;
+    mmio_tick_t tick;
+    void *ctx;          // Passed back to every handler
+    QWord next_event;   // Cycle at which tick must run next
+
+    // Set for stateful devices, built in (device=) or loaded from a shared
+    // object (plugin=), see mmio_plugin.h.
+    const MMIOPlugin *plugin;
+    void *handle;
+    MMIOHost host;
+
+    // Reads depend on the host (stdin, plugins): recorded in the journal,
+    // see journal.h.
+    bool journal;
 } MMIODevice;
 
-extern MMIODevice mmio_devices[64];
+extern MMIODevice mmio_devices[MMIO_MAX_DEVICES];
 extern int mmio_device_count;
 
+// Earliest next_event over all devices, checked once per instruction.
+extern QWord mmio_next_event;
+
+// One bit per device holding the CPU IRQ line high.
+extern QWord mmio_irq_lines;
+
+// Built-in device types.
+extern const MMIOPlugin mmio_uart_device;
+extern const MMIOPlugin mmio_keyboard_device;
+extern const MMIOPlugin mmio_framebuffer_device;
+
 void mmio_load_config(const char *filename);
-MMIODevice *mmio_find_device(Word addr);
+
+// Adds a device with plain handlers, as a read=/write= line of mmio.cfg
+// would (NULL handlers behave like `0`). Returns NULL if the table is full.
+// The page table must be recompiled afterwards.
+MMIODevice *mmio_add_device(const char *name, Word start, Word end,
+                            mmio_read_t read, mmio_write_t write, void *ctx);
+
+MMIODevice *mmio_find_device_by_name(const char *name);
+void mmio_unload_all(void);
+
+// Has every device write out the output it buffers.
+void mmio_flush_devices(void);
+
+// Runs tick for every device whose next event is due at `now`.
+void mmio_run_events(QWord now);
+
+// Catches a device up to `now` and refreshes the global event deadline.
+void mmio_sync_device(MMIODevice *dev, QWord now);
+
+bool mmio_device_attach(MMIODevice *dev, const MMIOPlugin *plugin,
+                        const char *args);
+bool mmio_plugin_attach(MMIODevice *dev, const char *path, const char *args);
+void mmio_plugin_detach(MMIODevice *dev);
+
+// True if the device may drive the IRQ line: a keyboard with irq=1, a UART
+// (its CONTROL register enables the IRQ) or a plugin from a shared object.
+bool mmio_device_can_irq(const MMIODevice *dev);
+
+// True if `dev` is a keyboard created with irq=1.
+bool mmio_keyboard_irq(const MMIODevice *dev);
+
+// Replaces the input of a device=keyboard instance with a pre-loaded buffer
+// and rewinds it. Returns false if `dev` is not a keyboard.
+bool mmio_keyboard_set_input(MMIODevice *dev, const Byte *data, size_t length);
 
 #endif
@@ -0,0 +1,82 @@
+#ifndef MMIO_PLUGIN_H
+#define MMIO_PLUGIN_H
+
+#include "config.h"
+
+/*
+   MMIO_PLUGIN - Shared-object device ABI
+
+   Board-specific peripherals can be built as shared objects and referenced
+   from mmio.cfg:
+
+       UART 0xD010 0xD013 plugin=./uart.so args=fifo=64
+
+   The object must export a function named `rosetta_mmio_plugin` returning a
+   pointer to a static MMIOPlugin table. The table is resolved once, when the
+   configuration is loaded; the bus then calls `read`/`write` directly with
+   the per-instance state returned by `create`, so no name lookup happens on
+   the access path.
+
+   Every callback except `create` receives the opaque state pointer. Optional
+   callbacks may be NULL. `read`, `write` and `tick` share the signatures of
+   the built-in handlers in mmio.h: accesses carry the current emulated
+   cycle, and `tick` returns the cycle of the device's next event.
+*/
+
+#define MMIO_PLUGIN_ABI_VERSION 4
+#define MMIO_PLUGIN_ENTRY "rosetta_mmio_plugin"
+
+/*
+   MMIOHost - Services the emulator offers to a device instance. The pointer
+   passed to `create` stays valid for the lifetime of the instance.
+*/
+typedef struct MMIOHost
+{
+  void *token; // Identifies the instance, pass it back to the callbacks
+
+  // Drives the CPU IRQ line. The line is level triggered and shared: the CPU
+  // is interrupted while any device holds it high and I is clear.
+  void (*set_irq) (void *token, bool level);
+} MMIOHost;
+
+typedef struct MMIOPlugin
+{
+  unsigned abi_version; // Must be MMIO_PLUGIN_ABI_VERSION
+  const char *name;     // Human-readable device name
+
+  // Creates one device instance mapped at start..end. `args` is the text
+  // after `args=` in mmio.cfg, or an empty string. Returns NULL on failure.
+  void *(*create) (const MMIOHost *host, Word start, Word end,
+                   const char *args);
+
+  // Releases an instance (optional).
+  void (*destroy) (void *state);
+
+  // Bus accesses at emulated cycle `cycle`. NULL handlers behave like
+  // `read=0` / `write=0` in mmio.cfg.
+  Byte (*read) (void *state, Word addr, QWord cycle);
+  void (*write) (void *state, Word addr, Byte data, QWord cycle);
+
+  // Catches the device up to `until_cycle` and returns the cycle of its next
+  // event, or UINT64_MAX if it has none (optional). Called before each
+  // access and when the returned cycle is reached. `until_cycle` moves
+  // backwards after a reset or restore; reschedule from it rather than
+  // waiting for an old deadline.
+  QWord (*tick) (void *state, QWord until_cycle);
+
+  // Serialises the instance into `buf` (optional). Returns the number of
+  // bytes needed; nothing is written when `size` is too small.
+  size_t (*save) (void *state, Byte *buf, size_t size);
+
+  // Restores an instance from a buffer produced by `save` (optional).
+  bool (*restore) (void *state, const Byte *buf, size_t size);
+
+  // Writes out output the instance buffers (optional). Called when the host
+  // collects what the devices printed, e.g. at the end of a server job.
+  void (*flush) (void *state);
+} MMIOPlugin;
+
+// Signature of the exported `rosetta_mmio_plugin` entry point.
+typedef const MMIOPlugin *(*mmio_plugin_entry_t) (void);
+
+#endif // MMIO_PLUGIN_H
@@ -0,0 +1,75 @@
+#ifndef REVERSE_H
+#define REVERSE_H
+
+#include "bus.h"
+#include "config.h"
+#include "mem6502.h"
+
+struct CPU6502;
+
+/*
+   Reverse execution
+
+   While recording, a checkpoint is taken every `interval` instructions:
+   CPU registers, cycle count and the memory pages written since the
+   previous checkpoint (found through MemPage.Writes; the first checkpoint
+   holds every page). Alongside, an event log keeps what the CPU cannot
+   recompute: the value of every MMIO read and the instruction at which
+   each IRQ was taken.
+
+   Going back restores the nearest earlier checkpoint and replays forward
+   to the wanted instruction. During a replay devices are not called at
+   all: reads come from the log, writes are dropped and IRQs are raised
+   from the log, so the replay is exact and devices stay at the present.
+   When execution reaches the newest recorded instruction (the frontier),
+   recording resumes seamlessly.
+
+   Memory use is bounded by `budget` bytes: when there are more than
+   REVERSE_MAX_CHECKPOINTS checkpoints every second one is merged into its
+   successor and the interval doubles, and when the budget is exceeded the
+   oldest checkpoint is dropped along with its part of the log.
+
+   Changes made to memory or registers while in the past do not rewrite
+   history; replaying forward from them gives undefined results.
+*/
+
+#define REVERSE_DEFAULT_INTERVAL 100000     // Instructions
+#define REVERSE_DEFAULT_BUDGET (64u << 20) // Bytes
+#define REVERSE_MAX_CHECKPOINTS 256
+
+typedef enum
+{
+  REVERSE_OFF = 0,
+  REVERSE_RECORD, // At the frontier, devices live
+  REVERSE_REPLAY  // In the past, devices answered from the log
+} ReverseMode;
+
+extern ReverseMode reverse_mode;
+
+// Starts recording from the current state. interval/budget of 0 select the
+// defaults.
+bool reverse_start (MEM6502 *memory, const struct CPU6502 *cpu,
+                    QWord interval, size_t budget);
+void reverse_stop (void);
+
+// Drop-in replacement for run_cpu_instruction that records or replays.
+bool reverse_run_instruction (Bus6502 *bus, MEM6502 *memory,
+                              struct CPU6502 *cpu);
+
+// Goes back one instruction. Returns false at the start of history.
+bool reverse_step (MEM6502 *memory, struct CPU6502 *cpu);
+
+// Goes back to the latest breakpoint or watchpoint hit before the current
+// instruction and fills breakpoint_last_hit. Returns false if there is
+// none; the machine is then at the start of history.
+bool reverse_continue (MEM6502 *memory, struct CPU6502 *cpu);
+
+// Instructions executed since recording started, and the frontier.
+QWord reverse_position (void);
+QWord reverse_frontier (void);
+
+// Event log hooks for the bus (MMIO reads).
+void reverse_log_read (Byte value);
+Byte reverse_next_read (void);
+
+#endif // REVERSE_H
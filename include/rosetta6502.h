@@ -0,0 +1,162 @@
+#ifndef ROSETTA6502_H
+#define ROSETTA6502_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+   ROSETTA6502 - Embedding API (librosetta6502.a / librosetta6502.so)
+
+   The only header an embedder needs. A machine is created, configured
+   with an mmio.cfg (devices and [memory] layout; the default board
+   otherwise), loaded and then driven with the batch run calls, which keep
+   the instruction loop inside the library: the host crosses the API once
+   per batch, never per instruction. Memory is read and written in blocks
+   without device side effects.
+
+   The core keeps its state in globals, so a process holds one machine at
+   a time; rosetta_create returns NULL while another exists. Fleets run one
+   machine per process. Machines run unthrottled unless
+   rosetta_set_throttle says otherwise.
+
+   Functions returning bool report failures on stdout, as the emulator
+   does, and leave the machine unchanged.
+*/
+
+#define ROSETTA6502_API_VERSION 1
+
+// librosetta6502.so exports these functions only.
+#if defined(__GNUC__)
+#define ROSETTA_API __attribute__ ((visibility ("default")))
+#else
+#define ROSETTA_API
+#endif
+
+typedef struct Rosetta6502 Rosetta6502;
+typedef struct RosettaSnapshot RosettaSnapshot;
+
+// Why a run returned. Same values as StopReason in cpu_exec.h.
+typedef enum
+{
+  ROSETTA_STOP_BUDGET,     // The cycles or instructions asked for were run
+  ROSETTA_STOP_CONDITION,  // The PC given to rosetta_run_until was reached
+  ROSETTA_STOP_TRAP,       // An instruction jumped to itself
+  ROSETTA_STOP_BREAKPOINT, // A breakpoint or watchpoint fired
+  ROSETTA_STOP_EXIT        // The program wrote to the exit device
+} RosettaStop;
+
+// Conditions for rosetta_run_until.
+#define ROSETTA_UNTIL_PC 0x1
+#define ROSETTA_UNTIL_TRAP 0x2
+
+typedef struct
+{
+  uint8_t a, x, y, sp, p;
+  uint16_t pc;
+  uint64_t cycles;       // Emulated cycles since creation or reset
+  uint64_t instructions; // Executed by the run calls
+} RosettaRegisters;
+
+// Returns ROSETTA6502_API_VERSION of the library, to be compared with the
+// header's when the library is loaded at run time.
+ROSETTA_API int rosetta_api_version (void);
+
+ROSETTA_API Rosetta6502 *rosetta_create (void);
+ROSETTA_API void rosetta_destroy (Rosetta6502 *machine);
+
+// Loads devices and memory layout from an mmio.cfg. Call before loading
+// images; a machine is configured once.
+ROSETTA_API bool rosetta_configure (Rosetta6502 *machine,
+                                    const char *mmio_cfg);
+
+// Loads a binary file at `address`, or at the start of ROM with the reset
+// vector pointed at it when `address` is negative (what `main -b` does).
+ROSETTA_API bool rosetta_load_image (Rosetta6502 *machine, const char *path,
+                                     int32_t address);
+
+// Resets the CPU through the reset vector and zeroes the cycle counter;
+// devices are rescheduled against the new count.
+ROSETTA_API void rosetta_reset (Rosetta6502 *machine);
+
+// Runs in real time (CPU_FREQ_HZ) instead of as fast as possible.
+ROSETTA_API void rosetta_set_throttle (Rosetta6502 *machine, bool throttle);
+
+// Batch runs. Budgets are checked between instructions.
+ROSETTA_API RosettaStop rosetta_run_cycles (Rosetta6502 *machine,
+                                            uint64_t cycles);
+ROSETTA_API RosettaStop rosetta_run_instructions (Rosetta6502 *machine,
+                                                  uint64_t count);
+
+// Runs until the conditions in `until` (ROSETTA_UNTIL_*) hold or a budget
+// runs out; a budget of 0 is unlimited.
+ROSETTA_API RosettaStop rosetta_run_until (Rosetta6502 *machine,
+                                           unsigned until, uint16_t pc,
+                                           uint64_t max_cycles,
+                                           uint64_t max_instructions);
+
+// Value the program wrote to the exit device.
+ROSETTA_API int rosetta_exit_code (const Rosetta6502 *machine);
+
+ROSETTA_API void rosetta_get_registers (const Rosetta6502 *machine,
+                                        RosettaRegisters *registers);
+
+// Sets the CPU registers; cycles and instructions are left alone.
+ROSETTA_API void rosetta_set_registers (Rosetta6502 *machine,
+                                        const RosettaRegisters *registers);
+
+// Block memory access without device side effects. Unmapped addresses
+// read as 0xFF and ignore writes; writes reach ROM. Addresses wrap at
+// $FFFF.
+ROSETTA_API void rosetta_peek (const Rosetta6502 *machine, uint16_t address,
+                               uint8_t *buffer, size_t length);
+ROSETTA_API void rosetta_poke (Rosetta6502 *machine, uint16_t address,
+                               const uint8_t *buffer, size_t length);
+
+// The 64 KB of storage behind the address space (MEM6502.Data), for
+// zero-copy access. On the default board an address is its own index;
+// mirrored regions share storage. Unlike rosetta_poke, writes through the
+// pointer are not counted as page writes.
+ROSETTA_API uint8_t *rosetta_memory (Rosetta6502 *machine);
+
+// Device handlers implemented by the host. They are called only for
+// accesses to the device's range, with the emulated cycle of the access.
+typedef uint8_t (*RosettaRead) (void *user, uint16_t address,
+                                uint64_t cycle);
+typedef void (*RosettaWrite) (void *user, uint16_t address, uint8_t value,
+                              uint64_t cycle);
+
+// Maps host handlers at start..end, over whatever was there. A NULL read
+// returns 0 and a NULL write ignores the value.
+ROSETTA_API bool rosetta_add_device (Rosetta6502 *machine, const char *name,
+                                     uint16_t start, uint16_t end,
+                                     RosettaRead read, RosettaWrite write,
+                                     void *user);
+
+// Replaces the input script of a keyboard device (device=keyboard).
+ROSETTA_API bool rosetta_set_input (Rosetta6502 *machine, const char *device,
+                                    const uint8_t *data, size_t length);
+
+// Snapshots of the whole machine: registers, cycles, memory and device
+// state. They are restored into the machine configuration they were taken
+// from.
+ROSETTA_API RosettaSnapshot *rosetta_snapshot_take (
+    const Rosetta6502 *machine);
+ROSETTA_API bool rosetta_snapshot_restore (Rosetta6502 *machine,
+                                           const RosettaSnapshot *snapshot);
+ROSETTA_API void rosetta_snapshot_free (RosettaSnapshot *snapshot);
+
+ROSETTA_API bool rosetta_snapshot_save (const Rosetta6502 *machine,
+                                        const char *path);
+ROSETTA_API bool rosetta_snapshot_load (Rosetta6502 *machine,
+                                        const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ROSETTA6502_H
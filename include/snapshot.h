@@ -0,0 +1,54 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "config.h"
+#include "cpu6502.h"
+#include "mem6502.h"
+#include "mmio.h"
+
+/*
+   SNAPSHOT - Machine state capture
+
+   A snapshot holds everything needed to resume a run: CPU registers, the
+   cycle counter, the 64 KB memory image and the saved state of every
+   stateful MMIO device (UART FIFOs, keyboard script position, plugin
+   state). Device states are matched by their position in mmio.cfg, so a
+   snapshot must be restored with the same configuration it was taken with.
+
+   Snapshots can also be written to and read from files, which lets batch
+   runs boot once and restart many times from the same point.
+*/
+
+typedef struct Snapshot
+{
+  CPU6502 cpu;
+  QWord cycles;
+  Byte *ram; // MAX_MEM bytes
+
+  int device_count;
+  Byte *device_state[MMIO_MAX_DEVICES];
+  size_t device_size[MMIO_MAX_DEVICES];
+} Snapshot;
+
+// Captures the current machine state. `snap` must be zeroed or freed first.
+bool snapshot_take (Snapshot *snap, const CPU6502 *cpu, const MEM6502 *memory);
+
+// Puts the machine back in the captured state.
+bool snapshot_restore (const Snapshot *snap, CPU6502 *cpu, MEM6502 *memory);
+
+// Fast restore for loops that return to the same snapshot many times
+// (fuzzing): only pages written since the last restore are copied back.
+// `seen` holds PAGE_COUNT write counters; snapshot_mark_clean fills it
+// when the machine matches the snapshot, right after taking it.
+void snapshot_mark_clean (const MEM6502 *memory, DWord *seen);
+bool snapshot_restore_dirty (const Snapshot *snap, CPU6502 *cpu,
+                             MEM6502 *memory, DWord *seen);
+
+// Releases the buffers of a snapshot and zeroes it.
+void snapshot_free (Snapshot *snap);
+
+// Writes / reads a snapshot file. snapshot_read expects a zeroed snapshot.
+bool snapshot_write (const Snapshot *snap, const char *filename);
+bool snapshot_read (Snapshot *snap, const char *filename);
+
+#endif // SNAPSHOT_H
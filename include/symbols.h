@@ -0,0 +1,27 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include "config.h"
+
+/*
+   Symbol table for the disassembler and the debugger.
+
+   symbols_load understands the files produced by the cc65 tool chain:
+     - ld65 debug info (--dbgfile firmware.dbg): `sym` lines with a value
+     - VICE label files (-Ln firmware.lbl): "al 00E000 .reset"
+     - ld65 map files (-m firmware.map): the "Exports list" section
+   Several files can be loaded; labels win over constants at the same
+   address.
+*/
+
+bool symbols_load (const char *path);
+void symbols_clear (void);
+int symbols_count (void);
+
+// Name of the symbol at exactly `address`, or NULL.
+const char *symbols_lookup (Word address);
+
+// Address of the symbol called `name`. Returns false if unknown.
+bool symbols_find (const char *name, Word *address);
+
+#endif // SYMBOLS_H
@@ -0,0 +1,310 @@
+#include "rosetta6502.h"
+#include "breakpoint.h"
+#include "cpu_exec.h"
+#include "loader.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "snapshot.h"
+
+/*
+   ROSETTA6502 - Embedding API over the core (see rosetta6502.h)
+
+   A Rosetta6502 owns the CPU, bus and memory that main.c keeps on its
+   stack; everything else (memory map, devices, cycle counter) is the
+   core's global state, which is why only one machine can exist.
+*/
+
+_Static_assert ((int)ROSETTA_STOP_EXIT == (int)STOP_EXIT,
+                "RosettaStop and StopReason must match");
+
+struct Rosetta6502
+{
+  CPU6502 cpu;
+  Bus6502 bus;
+  MEM6502 mem;
+  Machine6502 machine;
+  bool configured;
+};
+
+struct RosettaSnapshot
+{
+  Snapshot snap;
+};
+
+static bool in_use = false;
+
+int
+rosetta_api_version (void)
+{
+  return ROSETTA6502_API_VERSION;
+}
+
+Rosetta6502 *
+rosetta_create (void)
+{
+  if (in_use)
+    {
+      printf ("[ROSETTA] Only one machine per process\n");
+      return NULL;
+    }
+
+  Rosetta6502 *m = calloc (1, sizeof (*m));
+  if (m == NULL)
+    return NULL;
+
+  memory_map_set_defaults ();
+  initializeMem6502 (&m->mem);
+  m->machine = (Machine6502){ &m->bus, &m->mem, &m->cpu, 0 };
+
+  mmio_exit_requested = 0;
+  mmio_exit_code = 0;
+  total_cycles_executed = 0;
+  clock_unthrottled = true;
+  resetCPU (&m->cpu, &m->mem);
+
+  in_use = true;
+  return m;
+}
+
+void
+rosetta_destroy (Rosetta6502 *machine)
+{
+  if (machine == NULL)
+    return;
+
+  breakpoint_clear (&machine->mem);
+  mmio_unload_all ();
+  freeMem6502 (&machine->mem);
+  memory_map_clear ();
+  free (machine);
+  in_use = false;
+}
+
+bool
+rosetta_configure (Rosetta6502 *machine, const char *mmio_cfg)
+{
+  if (machine->configured)
+    {
+      printf ("[ROSETTA] Machine is already configured\n");
+      return false;
+    }
+
+  FILE *f = fopen (mmio_cfg, "r");
+  if (f == NULL)
+    {
+      perror (mmio_cfg);
+      return false;
+    }
+  fclose (f);
+
+  mmio_load_config (mmio_cfg);
+  memory_map_compile (&machine->mem);
+  machine->configured = true;
+  return true;
+}
+
+bool
+rosetta_load_image (Rosetta6502 *machine, const char *path, int32_t address)
+{
+  Word start = address < 0 ? memory_map_rom_start () : (Word)address;
+
+  if (!load_binary_to_memory (&machine->mem, path, start))
+    return false;
+  if (address < 0)
+    set_reset_vector (&machine->mem, start);
+  markMem6502Dirty (&machine->mem);
+  return true;
+}
+
+void
+rosetta_reset (Rosetta6502 *machine)
+{
+  resetCPU (&machine->cpu, &machine->mem);
+  total_cycles_executed = 0;
+  mmio_exit_requested = 0;
+
+  // Deadlines were scheduled against the old count; move them back too.
+  for (int i = 0; i < mmio_device_count; i++)
+    if (mmio_devices[i].tick)
+      mmio_sync_device (&mmio_devices[i], total_cycles_executed);
+  clock_init ();
+}
+
+void
+rosetta_set_throttle (Rosetta6502 *machine, bool throttle)
+{
+  (void)machine;
+  clock_unthrottled = !throttle;
+  clock_init ();
+}
+
+RosettaStop
+rosetta_run_cycles (Rosetta6502 *machine, uint64_t cycles)
+{
+  return (RosettaStop)run_cycles (&machine->machine, cycles);
+}
+
+RosettaStop
+rosetta_run_instructions (Rosetta6502 *machine, uint64_t count)
+{
+  return (RosettaStop)run_instructions (&machine->machine, count);
+}
+
+RosettaStop
+rosetta_run_until (Rosetta6502 *machine, unsigned until, uint16_t pc,
+                   uint64_t max_cycles, uint64_t max_instructions)
+{
+  RunCondition condition = {
+    .at_pc = (until & ROSETTA_UNTIL_PC) != 0,
+    .pc = pc,
+    .on_trap = (until & ROSETTA_UNTIL_TRAP) != 0,
+    .max_cycles = max_cycles,
+    .max_instructions = max_instructions,
+  };
+
+  return (RosettaStop)run_until (&machine->machine, &condition);
+}
+
+int
+rosetta_exit_code (const Rosetta6502 *machine)
+{
+  (void)machine;
+  return mmio_exit_code;
+}
+
+void
+rosetta_get_registers (const Rosetta6502 *machine,
+                       RosettaRegisters *registers)
+{
+  const CPU6502 *cpu = &machine->cpu;
+
+  registers->a = cpu->A;
+  registers->x = cpu->X;
+  registers->y = cpu->Y;
+  registers->sp = cpu->SP;
+  registers->p = cpu->PS;
+  registers->pc = cpu->PC;
+  registers->cycles = total_cycles_executed;
+  registers->instructions = machine->machine.instructions;
+}
+
+void
+rosetta_set_registers (Rosetta6502 *machine,
+                       const RosettaRegisters *registers)
+{
+  CPU6502 *cpu = &machine->cpu;
+
+  cpu->A = registers->a;
+  cpu->X = registers->x;
+  cpu->Y = registers->y;
+  cpu->SP = registers->sp;
+  cpu->PS = registers->p;
+  cpu->PC = registers->pc;
+}
+
+void
+rosetta_peek (const Rosetta6502 *machine, uint16_t address, uint8_t *buffer,
+              size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    buffer[i] = mem6502_peek (&machine->mem, (Word)(address + i));
+}
+
+void
+rosetta_poke (Rosetta6502 *machine, uint16_t address, const uint8_t *buffer,
+              size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    mem6502_poke (&machine->mem, (Word)(address + i), buffer[i]);
+}
+
+uint8_t *
+rosetta_memory (Rosetta6502 *machine)
+{
+  return machine->mem.Data;
+}
+
+bool
+rosetta_add_device (Rosetta6502 *machine, const char *name, uint16_t start,
+                    uint16_t end, RosettaRead read, RosettaWrite write,
+                    void *user)
+{
+  if (end < start
+      || !mmio_add_device (name, start, end, read, write, user))
+    return false;
+  memory_map_compile (&machine->mem);
+  return true;
+}
+
+bool
+rosetta_set_input (Rosetta6502 *machine, const char *device,
+                   const uint8_t *data, size_t length)
+{
+  (void)machine;
+  MMIODevice *dev = mmio_find_device_by_name (device);
+
+  if (dev == NULL || !mmio_keyboard_set_input (dev, data, length))
+    {
+      printf ("[ROSETTA] No keyboard device named %s\n", device);
+      return false;
+    }
+  return true;
+}
+
+RosettaSnapshot *
+rosetta_snapshot_take (const Rosetta6502 *machine)
+{
+  RosettaSnapshot *snapshot = calloc (1, sizeof (*snapshot));
+
+  if (snapshot == NULL)
+    return NULL;
+  if (!snapshot_take (&snapshot->snap, &machine->cpu, &machine->mem))
+    {
+      rosetta_snapshot_free (snapshot);
+      return NULL;
+    }
+  return snapshot;
+}
+
+bool
+rosetta_snapshot_restore (Rosetta6502 *machine,
+                          const RosettaSnapshot *snapshot)
+{
+  if (!snapshot_restore (&snapshot->snap, &machine->cpu, &machine->mem))
+    return false;
+  mmio_exit_requested = 0;
+  return true;
+}
+
+void
+rosetta_snapshot_free (RosettaSnapshot *snapshot)
+{
+  if (snapshot == NULL)
+    return;
+  snapshot_free (&snapshot->snap);
+  free (snapshot);
+}
+
+bool
+rosetta_snapshot_save (const Rosetta6502 *machine, const char *path)
+{
+  Snapshot snap = { 0 };
+  bool ok = snapshot_take (&snap, &machine->cpu, &machine->mem)
+            && snapshot_write (&snap, path);
+
+  snapshot_free (&snap);
+  return ok;
+}
+
+bool
+rosetta_snapshot_load (Rosetta6502 *machine, const char *path)
+{
+  Snapshot snap = { 0 };
+  bool ok = snapshot_read (&snap, path)
+            && snapshot_restore (&snap, &machine->cpu, &machine->mem);
+
+  snapshot_free (&snap);
+  if (ok)
+    mmio_exit_requested = 0;
+  return ok;
+}
@@ -2,6 +2,9 @@
 #include "cpu6502.h"
 #include "mmio.h"
 #include "debug.h"
+#include "breakpoint.h"
+#include "reverse.h"
+#include "journal.h"
 
 // Maximum memory size for the 6502 system.
 const DWord MAX_MEM = 1024 * 64;
@@ -28,20 +31,22 @@ const DWord MAX_MEM = 1024 * 64;
    65 Kilobytes of RAM.
    - freeMem6502: Frees the allocated memory used for emulating the 6502 memory
    system.
-   - ReadByte: Reads a byte of data from emulated memory at the specified
-   address.
-   - ReadWord: Reads a 16-bit word of data from emulated memory at the
-   specified address.
-   - WriteByte: Writes a byte of data to emulated memory at the specified
-   address.
-   - WriteWord: Writes a 16-bit word of data to emulated memory at the
-   specified address.
+   - cpu_read: Reads a byte through the page table, dispatching to MMIO
+   devices, ROM or RAM.
+   - cpu_write: Writes a byte through the page table. ROM writes are ignored
+   and unmapped accesses are reported.
+   - markMem6502Dirty: Bumps the write counter of every page.
+   - mem6502_peek / mem6502_poke: Side-effect free accesses for debuggers.
+
+   The page table itself is built by memory_map_compile (memory_map.c).
 
    For more information about the instructions and addressing modes, refer to
    Instructions.MD.
 */
 
-// Initializes memory to 65 Kilobytes (64 * 1024 Bytes).
+// Initializes memory to 65 Kilobytes (64 * 1024 Bytes) and compiles the
+// page table from the current memory map (the default board if no
+// configuration has been loaded yet).
 void
 initializeMem6502 (MEM6502 *memory)
 {
@@ -53,67 +58,110 @@ initializeMem6502 (MEM6502 *memory)
 
   // Initialize memory with zeros.
   memset (memory->Data, 0, MAX_MEM);
+
+  memset (memory->Pages, 0, sizeof (memory->Pages));
+  if (memory_region_count == 0)
+    memory_map_set_defaults ();
+  memory_map_compile (memory);
 }
 
-// Frees 65 Kilobytes of RAM.
+// Frees 65 Kilobytes of RAM and the MMIO tables of the page table.
 void
 freeMem6502 (MEM6502 *memory)
 {
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      free (memory->Pages[page].Devices);
+      memory->Pages[page].Devices = NULL;
+      memory->Pages[page].Read = NULL;
+      memory->Pages[page].Write = NULL;
+    }
+
   free (memory->Data);
   memory->Data
       = NULL; // Optional: define data as null after freeing the memory.
 }
 
-// Read a byte of data from emulated memory at the specified address.
-static Byte
-ReadByte (Word Address, const MEM6502 *memory)
+void
+markMem6502Dirty (MEM6502 *memory)
 {
-  // Read the byte from memory.
-  Byte Data = memory->Data[Address];
-
-  // Adjust the cycle count.
-  
-
-  return Data;
+  for (int page = 0; page < PAGE_COUNT; page++)
+    memory->Pages[page].Writes++;
 }
 
-// Write a byte of data to emulated memory at the specified address.
-static void
-WriteByte (Word Value, MEM6502 *mem, DWord Address)
+Byte
+mem6502_peek (const MEM6502 *memory, Word address)
 {
-  // Write the byte to memory.
-  mem->Data[Address] = Value;
+  const MemPage *page = &memory->Pages[address >> 8];
+  if (page->Kind == REGION_UNMAPPED && page->Devices == NULL)
+    return 0xFF;
+  return page->Backing[address & 0xFF];
+}
 
-  // Adjust the cycle count.
-  
+bool
+mem6502_poke (MEM6502 *memory, Word address, Byte value)
+{
+  MemPage *page = &memory->Pages[address >> 8];
+  if (page->Kind == REGION_UNMAPPED)
+    return false;
+  page->Backing[address & 0xFF] = value;
+  page->Writes++;
+  return true;
 }
 
-void cpu_read(Bus6502 *bus, const MEM6502 *memory, Word addr, CPU6502 *cpu)
+/*
+   cpu_read / cpu_write - Bus accesses through the compiled page table.
+
+   The common case (RAM, ROM reads) is a single page lookup followed by a
+   direct load or store. Pages flagged for the slow path are handled by
+   cpu_read_slow/cpu_write_slow, which dispatch to MMIO devices and report
+   ROM writes and unmapped accesses.
+*/
+
+// The address a device sees: mirrored pages show their source page.
+static Word
+device_address(const MemPage *page, Word addr)
 {
-    AccessType accessType = cpu->CurrentAccess;
-    bus->address = addr;
-    bus->rw = true;
+    return (Word)((page->Alias << 8) | (addr & 0xFF));
+}
 
-    MMIODevice *dev = mmio_find_device(addr);
-    if (dev) {
-        if (dev->read) {
-            Byte val = dev->read(addr);
+static void
+cpu_read_slow (Bus6502 *bus, const MemPage *page, Word addr)
+{
+    if (page->Devices) {
+        MMIODevice *dev = page->Devices[addr & 0xFF];
+        if (dev && dev->read) {
+            Byte val;
+            if (reverse_mode == REVERSE_REPLAY) {
+                // Replaying history: the device answered this read already.
+                val = reverse_next_read();
+            } else if (dev->journal && journal_mode == JOURNAL_REPLAY) {
+                // Host input comes from the journal, not from the host.
+                val = journal_next_read();
+                if (reverse_mode == REVERSE_RECORD)
+                    reverse_log_read(val);
+            } else {
+                // Let the device catch up to the current cycle first.
+                if (dev->tick)
+                    mmio_sync_device(dev, total_cycles_executed);
+                val = dev->read(dev->ctx, device_address(page, addr),
+                                total_cycles_executed);
+                // Reads can consume data and move the next event too.
+                if (dev->tick)
+                    mmio_sync_device(dev, total_cycles_executed);
+                if (dev->journal && journal_mode == JOURNAL_RECORD)
+                    journal_log_read(val);
+                if (reverse_mode == REVERSE_RECORD)
+                    reverse_log_read(val);
+            }
             bus->data = val;
             debug_mem_read(addr, val);
             return;
         }
     }
 
-    // ROM: Read always allowed
-    if (addr >= ROM_START && addr <= ROM_END) {
-        bus->data = ReadByte(addr, memory);
-        debug_mem_read(addr, bus->data);
-        return;
-    }
-
-    // Default RAM
-    if (addr <= RAM_END) {
-        bus->data = ReadByte(addr, memory);
+    if (page->Kind != REGION_UNMAPPED) {
+        bus->data = page->Backing[addr & 0xFF];
         debug_mem_read(addr, bus->data);
         return;
     }
@@ -123,37 +171,106 @@ void cpu_read(Bus6502 *bus, const MEM6502 *memory, Word addr, CPU6502 *cpu)
     bus->data = 0xFF;
 }
 
-void cpu_write(Bus6502 *bus, MEM6502 *memory, Word addr, Byte data, CPU6502 *cpu)
+static void
+cpu_write_slow (Bus6502 *bus, MemPage *page, Word addr, Byte data)
 {
-    AccessType accessType = cpu->CurrentAccess;
-    bus->address = addr;
-    bus->data = data;
-    bus->rw = false;
-
-    MMIODevice *dev = mmio_find_device(addr);
-
-    if (dev) {
+    (void)bus;
 
-        if (dev->write) {
-            dev->write(addr, data);
-            debug_mem_write(addr, data);
+    if (page->Devices) {
+        MMIODevice *dev = page->Devices[addr & 0xFF];
+        if (dev) {
+            // Writes replayed from history reached the device long ago.
+            if (dev->write && reverse_mode != REVERSE_REPLAY) {
+                if (dev->tick)
+                    mmio_sync_device(dev, total_cycles_executed);
+                dev->write(dev->ctx, device_address(page, addr), data,
+                           total_cycles_executed);
+                // A write may have scheduled a new event.
+                if (dev->tick)
+                    mmio_sync_device(dev, total_cycles_executed);
+                debug_mem_write(addr, data);
+            }
+            return;
         }
-        return;
     }
 
     // ROM: Writing is blocked
-    if (addr >= ROM_START && addr <= ROM_END) {
+    if (page->Kind == REGION_ROM) {
         printf("ROM write ignored %04X = %02X\n", addr, data);
         debug_mem_write(addr, data);
         return;
     }
 
-    // Default RAM
-    if (addr <= RAM_END) {
-        WriteByte(data, memory, addr);
+    if (page->Kind == REGION_RAM) {
+        page->Backing[addr & 0xFF] = data;
+        page->Writes++;
         debug_mem_write(addr, data);
         return;
     }
 
     fprintf(stderr, "Memory write out of bounds: %04X\n", addr);
 }
+
+// Watch flags of the page and, for a mirror, of the page it shows.
+static Byte
+watch_flags(const MemPage *page, Word addr)
+{
+    return debug_page_flags[addr >> 8] | debug_page_flags[page->Alias];
+}
+
+void cpu_read(Bus6502 *bus, const MEM6502 *memory, Word addr, CPU6502 *cpu)
+{
+    const MemPage *page = &memory->Pages[addr >> 8];
+    bus->address = addr;
+    bus->rw = true;
+
+    if (page->Read) {
+        bus->data = page->Read[addr & 0xFF];
+        debug_mem_read(addr, bus->data);
+        return;
+    }
+
+    cpu_read_slow(bus, page, addr);
+
+    // Watched pages have no direct pointer, so only they get here.
+    if (watch_flags(page, addr) & DEBUG_PAGE_READ)
+        breakpoint_check_access(memory, cpu, addr, bus->data, false);
+}
+
+// Opcode and operand fetches: the same access, but read watchpoints only
+// cover data reads.
+void cpu_fetch(Bus6502 *bus, const MEM6502 *memory, Word addr, CPU6502 *cpu)
+{
+    (void)cpu;
+    const MemPage *page = &memory->Pages[addr >> 8];
+    bus->address = addr;
+    bus->rw = true;
+
+    if (page->Read) {
+        bus->data = page->Read[addr & 0xFF];
+        debug_mem_read(addr, bus->data);
+        return;
+    }
+
+    cpu_read_slow(bus, page, addr);
+}
+
+void cpu_write(Bus6502 *bus, MEM6502 *memory, Word addr, Byte data, CPU6502 *cpu)
+{
+    MemPage *page = &memory->Pages[addr >> 8];
+    bus->address = addr;
+    bus->data = data;
+    bus->rw = false;
+
+    if (page->Write) {
+        page->Write[addr & 0xFF] = data;
+        page->Writes++;
+        debug_mem_write(addr, data);
+        return;
+    }
+
+    cpu_write_slow(bus, page, addr, data);
+
+    if (watch_flags(page, addr) & DEBUG_PAGE_WRITE)
+        breakpoint_check_access(memory, cpu, addr, data, true);
+}
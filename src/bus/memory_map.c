@@ -0,0 +1,278 @@
+#include "memory_map.h"
+#include "mem6502.h"
+#include "mmio.h"
+#include "breakpoint.h"
+
+/*
+   MEMORY_MAP - Board memory layout
+
+   This file keeps the list of memory regions described by the configuration
+   file and compiles it into the page table used by cpu_read/cpu_write.
+
+   Compilation happens in four passes:
+   - plain regions (RAM, ROM, UNMAPPED) are applied in declaration order, so
+     later lines override earlier ones;
+   - MMIO devices are attached to the pages they cover, byte by byte;
+   - mirrors are applied next and copy the kind, backing storage and devices
+     of the pages they alias. A mirror of a mirror is followed to the page
+     that is not one, whatever the order of the lines;
+   - finally the direct Read/Write pointers are set for every page that does
+     not need the slow path.
+*/
+
+MemoryRegion memory_regions[MAX_MEMORY_REGIONS];
+int memory_region_count = 0;
+
+// Drops every region, leaving the whole address space unmapped.
+void
+memory_map_clear (void)
+{
+  memory_region_count = 0;
+}
+
+// Restores the default board layout (RAM, unmapped MMIO hole, ROM).
+void
+memory_map_set_defaults (void)
+{
+  memory_map_clear ();
+  memory_map_add_region (REGION_RAM, ZP_START, RAM_END, 0, 0);
+  memory_map_add_region (REGION_UNMAPPED, MMIO_START, MMIO_END, 0, 0);
+  memory_map_add_region (REGION_ROM, ROM_START, ROM_END, 0, 0);
+}
+
+// Appends a region to the layout. Regions must be page aligned; a mirror
+// source that is smaller than the mirror is repeated to fill it.
+bool
+memory_map_add_region (RegionKind kind, Word start, Word end,
+                       Word source_start, Word source_end)
+{
+  if (memory_region_count >= MAX_MEMORY_REGIONS)
+    {
+      printf ("[MAP] Too many memory regions (max %d)\n", MAX_MEMORY_REGIONS);
+      return false;
+    }
+
+  if (start > end || (start & 0xFF) != 0x00 || (end & 0xFF) != 0xFF)
+    {
+      printf ("[MAP] Region %04X-%04X is not page aligned\n", start, end);
+      return false;
+    }
+
+  if (kind == REGION_MIRROR
+      && (source_start > source_end || (source_start & 0xFF) != 0x00
+          || (source_end & 0xFF) != 0xFF))
+    {
+      printf ("[MAP] Mirror source %04X-%04X is not page aligned\n",
+              source_start, source_end);
+      return false;
+    }
+
+  MemoryRegion *region = &memory_regions[memory_region_count++];
+  region->kind = kind;
+  region->start = start;
+  region->end = end;
+  region->source_start = source_start;
+  region->source_end = source_end;
+  return true;
+}
+
+// Parses one `[memory]` line. The mirror source end is optional and defaults
+// to a source of the same size as the mirror.
+bool
+memory_map_parse_line (const char *line)
+{
+  char kind_name[16] = { 0 };
+  unsigned start = 0, end = 0, source_start = 0, source_end = 0;
+
+  int n = sscanf (line, "%15s %x %x %x %x", kind_name, &start, &end,
+                  &source_start, &source_end);
+  if (n < 3 || start > 0xFFFF || end > 0xFFFF)
+    return false;
+
+  if (strcmp (kind_name, "RAM") == 0)
+    return memory_map_add_region (REGION_RAM, start, end, 0, 0);
+  if (strcmp (kind_name, "ROM") == 0)
+    return memory_map_add_region (REGION_ROM, start, end, 0, 0);
+  if (strcmp (kind_name, "UNMAPPED") == 0)
+    return memory_map_add_region (REGION_UNMAPPED, start, end, 0, 0);
+
+  if (strcmp (kind_name, "MIRROR") == 0 && n >= 4)
+    {
+      if (n < 5)
+        source_end = source_start + (end - start);
+      if (source_end > 0xFFFF)
+        return false;
+      return memory_map_add_region (REGION_MIRROR, start, end, source_start,
+                                    source_end);
+    }
+
+  return false;
+}
+
+// The page `page` shows through the last mirror declared over it, or -1 if
+// no mirror covers it (or the mirror maps it onto itself).
+static int
+mirror_source (int page)
+{
+  int source = -1;
+
+  for (int i = 0; i < memory_region_count; i++)
+    {
+      const MemoryRegion *region = &memory_regions[i];
+      if (region->kind != REGION_MIRROR || page < region->start >> 8
+          || page > region->end >> 8)
+        continue;
+
+      int source_first = region->source_start >> 8;
+      int source_pages = (region->source_end >> 8) - source_first + 1;
+      source = source_first + (page - (region->start >> 8)) % source_pages;
+      if (source == page)
+        source = -1;
+    }
+  return source;
+}
+
+// Follows mirrors from `page` to the page that is not one. Returns -1 for
+// mirrors that loop back on themselves.
+static int
+resolve_page (int page)
+{
+  for (int hops = 0; hops < PAGE_COUNT; hops++)
+    {
+      int source = mirror_source (page);
+      if (source < 0)
+        return page;
+      page = source;
+    }
+  return -1;
+}
+
+// Builds the page table of `memory` from the region list and the currently
+// loaded MMIO devices.
+void
+memory_map_compile (MEM6502 *memory)
+{
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      MemPage *entry = &memory->Pages[page];
+      free (entry->Devices);
+
+      entry->Devices = NULL;
+      entry->Kind = REGION_UNMAPPED;
+      entry->Backing = &memory->Data[page * PAGE_SIZE];
+      entry->Alias = page;
+    }
+
+  // Pass 1: plain regions.
+  for (int i = 0; i < memory_region_count; i++)
+    {
+      const MemoryRegion *region = &memory_regions[i];
+      if (region->kind == REGION_MIRROR)
+        continue;
+
+      for (int page = region->start >> 8; page <= region->end >> 8; page++)
+        {
+          memory->Pages[page].Kind = region->kind;
+          memory->Pages[page].Backing = &memory->Data[page * PAGE_SIZE];
+        }
+    }
+
+  // Pass 2: MMIO devices. The first device covering an address wins, as in
+  // the order of the configuration file. Mirrored pages show their source
+  // instead.
+  for (int i = 0; i < mmio_device_count; i++)
+    {
+      MMIODevice *dev = &mmio_devices[i];
+      bool shadowed = false;
+
+      for (DWord addr = dev->start; addr <= dev->end; addr++)
+        {
+          if (mirror_source (addr >> 8) >= 0)
+            {
+              shadowed = true;
+              continue;
+            }
+
+          MemPage *entry = &memory->Pages[addr >> 8];
+          if (entry->Devices == NULL)
+            {
+              entry->Devices = calloc (PAGE_SIZE, sizeof (MMIODevice *));
+              if (entry->Devices == NULL)
+                exit (EXIT_FAILURE);
+            }
+          if (entry->Devices[addr & 0xFF] == NULL)
+            entry->Devices[addr & 0xFF] = dev;
+        }
+
+      if (shadowed)
+        printf ("[MAP] %s at %04X-%04X is partly hidden by a mirror\n",
+                dev->name, dev->start, dev->end);
+    }
+
+  // Pass 3: mirrors alias the kind, storage and devices of their source
+  // pages. Devices see the source address.
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      if (mirror_source (page) < 0)
+        continue;
+
+      MemPage *entry = &memory->Pages[page];
+      int source = resolve_page (page);
+      if (source < 0)
+        {
+          printf ("[MAP] Mirror at %04X loops back on itself\n",
+                  page * PAGE_SIZE);
+          continue;
+        }
+
+      const MemPage *origin = &memory->Pages[source];
+      entry->Kind = origin->Kind;
+      entry->Backing = origin->Backing;
+      entry->Alias = source;
+      if (origin->Devices)
+        {
+          entry->Devices = malloc (PAGE_SIZE * sizeof (MMIODevice *));
+          if (entry->Devices == NULL)
+            exit (EXIT_FAILURE);
+          memcpy (entry->Devices, origin->Devices,
+                  PAGE_SIZE * sizeof (MMIODevice *));
+        }
+    }
+
+  memory_map_update_direct (memory);
+}
+
+// Pass 4: direct pointers for pages that never need the slow path. Pages
+// with devices, or watched by a read/write watchpoint directly or through
+// the page they mirror, have none.
+void
+memory_map_update_direct (MEM6502 *memory)
+{
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      MemPage *entry = &memory->Pages[page];
+      bool direct = (entry->Devices == NULL);
+      Byte watch = debug_page_flags[page] | debug_page_flags[entry->Alias];
+      bool watch_read = watch & DEBUG_PAGE_READ;
+      bool watch_write = watch & DEBUG_PAGE_WRITE;
+
+      entry->Read = (direct && !watch_read && entry->Kind != REGION_UNMAPPED)
+                        ? entry->Backing
+                        : NULL;
+      entry->Write
+          = (direct && !watch_write && entry->Kind == REGION_RAM)
+                ? entry->Backing
+                : NULL;
+    }
+}
+
+// Returns the start of the first ROM region, used as the default firmware
+// load address.
+Word
+memory_map_rom_start (void)
+{
+  for (int i = 0; i < memory_region_count; i++)
+    if (memory_regions[i].kind == REGION_ROM)
+      return memory_regions[i].start;
+  return ROM_START;
+}
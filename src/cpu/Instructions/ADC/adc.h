@@ -14,206 +14,42 @@
 */
 
 /*
-   This function sets the Flags for the Status register
-   to represent the result of the ADC instruction.
-*/
-
-static inline void
-ADCSetStatus (CPU6502 *cpu, Byte before, Byte value)
-{
-  cpu->Flag.Z = (cpu->A == 0);
-  cpu->Flag.N = (cpu->A & 0x80) > 0;
-  cpu->Flag.V = (~(before ^ value) & (before ^ cpu->A) & 0x80) != 0;
-  cpu->Flag.C = (cpu->A < before);
-}
-
-/*
-   ADC_IM - Add Immediate value and the carry flag (if set) to the Accumulator.
-   This function fetches a byte from memory and adds it and the carry flag (if
-   set) to the Accumulator (A). It then sets the status flags.
-*/
-
-static inline void
-ADC_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte Value = FetchByte (bus, memory, cpu);
-
-  Byte Before = cpu->A;
-  cpu->A += Value + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, Value);
-  spend_cycles (2);
-}
-
-/*
-   ADC_ZP - Add value from Zero Page and the carry flag (if set) to the
-   Accumulator. This function fetches a byte representing a zero-page address
-   from memory, reads the value at that address, and adds it and the carry flag
-   (if set) to the Accumulator (A). It then sets the status flags.
-*/
-
-static inline void
-ADC_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-
-  Byte Before = cpu->A;
-  cpu->A += bus->data + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, bus->data);
-  spend_cycles (3);
-}
-
-/*
-   ADC_ZPX - Add value from Zero Page with X Offset and the carry flag (if set)
-   to the Accumulator. This function fetches a byte representing a zero-page
-   address from memory, adds the X register to this address, reads the value at
-   the resultant address, and adds it and the carry flag (if set) to the
-   Accumulator (A). It then sets the status flags.
-*/
-
-static inline void
-ADC_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
+   ADC - Adds `value` and the carry flag to the Accumulator and sets the
+   Flags for the Status register to represent the result.
 
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-
-  Byte Before = cpu->A;
-  cpu->A += bus->data + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, bus->data);
-  spend_cycles (4);
-}
-
-/*
-   ADC_ABS - Add value from Absolute address and the carry flag (if set) to the
-   Accumulator. This function fetches an absolute address from memory, reads
-   the value at that address, and adds it and the carry flag (if set) to the
-   Accumulator (A). It then sets the status flags.
+   In decimal mode both operands are packed BCD. As on the NMOS 6502, Z
+   still reflects the binary sum, while N and V are taken after the low
+   digit has been adjusted.
 */
 
 static inline void
-ADC_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+ADC (CPU6502 *cpu, Byte value)
 {
-  Word Absolute = FetchWord (bus, memory, cpu);
-
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte Before = cpu->A;
-  cpu->A += bus->data + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, bus->data);
-  spend_cycles (4);
-}
-
-/*
-   ADC_ABSX - Add value from Absolute address with X Offset and the carry flag
-   (if set) to the Accumulator. This function fetches an absolute address from
-   memory, adds the X register to this address, reads the value at the
-   resultant address, and adds it and the carry flag (if set) to the
-   Accumulator (A). It then sets the status flags.
-*/
+  Byte before = cpu->A;
+  Word sum = before + value + cpu->Flag.C;
 
-static inline void
-ADC_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Word NewAddress = Absolute + cpu->X;
-
-  if ((NewAddress & 0xFF00) != (Absolute & 0xFF00))
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, NewAddress, cpu);
-  Byte Before = cpu->A;
-  cpu->A += bus->data + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, bus->data);
-  spend_cycles (4);
-}
-
-/*
-   ADC_ABSY - Add value from Absolute address with Y Offset and the carry flag
-   (if set) to the Accumulator. This function fetches an absolute address from
-   memory, adds the Y register to this address, reads the value at the
-   resultant address, and adds it and the carry flag (if set) to the
-   Accumulator (A). It then sets the status flags.
-*/
-
-static inline void
-ADC_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Word NewAddress = Absolute + cpu->Y;
-
-  if ((NewAddress & 0xFF00) != (Absolute & 0xFF00))
+  if (!cpu->Flag.D)
     {
-      
-      spend_cycle ();
+      cpu->A = (Byte)sum;
+      cpu->Flag.Z = (cpu->A == 0);
+      cpu->Flag.N = (cpu->A & 0x80) > 0;
+      cpu->Flag.V = (~(before ^ value) & (before ^ cpu->A) & 0x80) != 0;
+      cpu->Flag.C = sum > 0xFF;
+      return;
     }
 
-  cpu_read (bus, memory, NewAddress, cpu);
-  Byte Before = cpu->A;
-  cpu->A += bus->data + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, bus->data);
-  spend_cycles (4);
-}
-
-/*
-   ADC_INDX - Add with Carry using (Indirect, X) addressing mode.
-   In this mode, the operand is a zero-page base address. The X register is
-   added to this address (with wrap-around) to get a new zero-page pointer.
-   The two bytes read from that pointer form the effective 16-bit address.
-   The value at that address is added to A along with the Carry flag.
-*/
-
-static inline void
-ADC_INDX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  zp += cpu->X; // zero-page wrap
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word addr = (hi << 8) | lo;
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte Value = bus->data;
-  Byte Before = cpu->A;
-
-  cpu->A += Value + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, Value);
-  spend_cycles (6);
-}
-
-/*
-   ADC_INDY - Add with Carry using (Indirect), Y addressing mode.
-   The operand is a zero-page pointer to a 16-bit base address.
-   The Y register is added to this base to form the effective address.
-   The byte read from that address is added to A along with the Carry flag.
-   If a page boundary is crossed, one extra cycle is consumed.
-*/
-
-static inline void
-ADC_INDY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word base = (hi << 8) | lo;
-  Word addr = base + cpu->Y;
-
-  if ((base & 0xFF00) != (addr & 0xFF00)) // page boundary crossed
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte Value = bus->data;
-  Byte Before = cpu->A;
-
-  cpu->A += Value + cpu->Flag.C;
-  ADCSetStatus (cpu, Before, Value);
-  spend_cycles (5);
+  int lo = (before & 0x0F) + (value & 0x0F) + cpu->Flag.C;
+  if (lo > 9)
+    lo += 6;
+  int hi = (before >> 4) + (value >> 4) + (lo > 0x0F);
+
+  cpu->Flag.Z = ((Byte)sum == 0);
+  cpu->Flag.N = (hi & 0x08) != 0;
+  cpu->Flag.V = (~(before ^ value) & (before ^ (hi << 4)) & 0x80) != 0;
+  if (hi > 9)
+    hi += 6;
+  cpu->Flag.C = hi > 0x0F;
+  cpu->A = (Byte)((hi << 4) | (lo & 0x0F));
 }
 
 #endif // ADC_H
@@ -30,114 +30,19 @@
 */
 
 /*
-   This function sets the Flags in the Status register to reflect
-   the outcome of the ASL operation on the Accumulator.
+   ASL - Shifts `value` left, sets the Flags in the Status register to
+   reflect the outcome and returns the result.
 */
 
-static inline void
-ASLSetStatus (Byte value, CPU6502 *cpu)
+static inline Byte
+ASL (CPU6502 *cpu, Byte value)
 {
-  cpu->Flag.C = (value & 0x80) ? 1 : 0;
-  cpu->Flag.Z = (cpu->A == 0);
-  cpu->Flag.N = (cpu->A & 0x80) != 0;
-}
-
-/*
-   ASL_ACC - Arithmetic Shift Left on the Accumulator.
-   This function fetches a byte from memory, shifts it left by one bit,
-   stores the result in the Accumulator, and sets the status flags.
-*/
-
-static inline void
-ASL_ACC (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte value = FetchByte (bus, memory, cpu);
-  cpu->A = value << 1;
-  ASLSetStatus (value, cpu);
-}
-
-/*
-   ASL_ZP - Arithmetic Shift Left on a Zero Page address.
-   This function fetches a zero page address from memory, reads the value at
-   that address, shifts it left by one bit, stores the result back if needed
-   (not shown here), and sets the status flags. It adjusts the cycle count
-   accordingly.
-*/
-
-static inline void
-ASL_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zero_page_addr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, zero_page_addr, cpu);
-  Byte value = bus->data;
-
-  cpu->A = value << 1;
-  ;
-  ASLSetStatus (value, cpu);
-  spend_cycles (5);
-}
-
-/*
-   ASL_ZPX - Arithmetic Shift Left on a Zero Page address with X offset.
-   This function adds the X register to the zero page address, reads the value,
-   shifts it left by one bit, stores the result, adjusts cycles, and sets
-   flags.
-*/
+  Byte result = value << 1;
 
-static inline void
-ASL_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zero_page_addr = FetchByte (bus, memory, cpu);
-  zero_page_addr += cpu->X;
-  
-
-  cpu_read (bus, memory, zero_page_addr, cpu);
-  Byte value = bus->data;
-  cpu->A = value << 1;
-  ;
-  ASLSetStatus (value, cpu);
-  spend_cycles (6);
-}
-
-/*
-   ASL_ABS - Arithmetic Shift Left on an Absolute address.
-   This function fetches a two-byte absolute address, reads the value,
-   shifts it left by one bit, stores the result, adjusts cycles, and sets
-   flags.
-*/
-
-static inline void
-ASL_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, absolute, cpu);
-  Byte value = bus->data;
-
-  cpu->A = value << 1;
-  ;
-  ASLSetStatus (value, cpu);
-  spend_cycles (6);
-}
-
-/*
-   ASL_ABSX - Arithmetic Shift Left on an Absolute address with X offset.
-   This function adds the X register to the absolute address, reads the value,
-   shifts it left by one bit, stores the result, adjusts cycles, and sets
-   flags.
-*/
-
-static inline void
-ASL_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word absolute = FetchWord (bus, memory, cpu);
-  absolute += cpu->X;
-
-  cpu_read (bus, memory, absolute, cpu);
-  Byte value = bus->data;
-  cpu->A = value << 1;
-  ;
-  ASLSetStatus (value, cpu);
-  spend_cycles (6);
+  cpu->Flag.C = (value & 0x80) ? 1 : 0;
+  cpu->Flag.Z = (result == 0);
+  cpu->Flag.N = (result & 0x80) != 0;
+  return result;
 }
 
-#endif /* ASL_H */
+#endif // ASL_H
@@ -35,35 +35,13 @@ BITSetStatus (Byte Value, CPU6502 *cpu)
 }
 
 /*
-   BIT_ZP - Bit Test with Zero Page addressing.
-   This function fetches a byte representing a zero-page address from memory,
-   reads the value at that address, and performs the BIT test.
-   It then sets the status flags accordingly.
+   BIT - Tests `value` against the Accumulator.
 */
 
 static inline void
-BIT_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+BIT (CPU6502 *cpu, Byte value)
 {
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  BITSetStatus (bus->data, cpu);
-  spend_cycles (3);
-}
-
-/*
-   BIT_ABS - Bit Test with Absolute addressing.
-   This function fetches a two-byte absolute address from memory,
-   reads the value at that address, and performs the BIT test.
-   It then sets the status flags accordingly.
-*/
-
-static inline void
-BIT_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  BITSetStatus (bus->data, cpu);
-  spend_cycles (4);
+  BITSetStatus (value, cpu);
 }
 
 #endif // BIT_H
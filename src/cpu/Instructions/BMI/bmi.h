@@ -23,11 +23,12 @@
 static inline void
 BMI (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
 {
+  Byte relative_offset = FetchByte (bus, memory, cpu);
+
   if (cpu->Flag.N != 0)
     {
-      Byte relative_offset = FetchByte (bus, memory, cpu);
       Word old_pc = cpu->PC;
-      cpu->PC += (char)relative_offset;
+      cpu->PC += (SignedByte)relative_offset;
 
       
       spend_cycle ();
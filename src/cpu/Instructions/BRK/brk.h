@@ -31,12 +31,12 @@
 static inline void
 BRK (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
 {
-  cpu->PC += 2;
-  
+  // The byte after BRK is padding: the return address skips it.
+  cpu->PC += 1;
 
   PushPCToStack (bus, memory, cpu);
 
-  Byte status_with_B = cpu->PS | 0x10;
+  Byte status_with_B = cpu->PS | 0x30;
 
   PushByteToStack (bus, memory, status_with_B, cpu);
 
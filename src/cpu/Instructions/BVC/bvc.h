@@ -22,9 +22,10 @@
 static inline void
 BVC (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
 {
+  Byte Sub_Addr = FetchByte (bus, memory, cpu);
+
   if (cpu->Flag.V == 0)
     {
-      Byte Sub_Addr = FetchByte (bus, memory, cpu);
       Word old_pc = cpu->PC;
       cpu->PC += (SignedByte)Sub_Addr;
 
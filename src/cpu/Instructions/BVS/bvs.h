@@ -22,9 +22,10 @@
 static inline void
 BVS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
 {
+  Byte relative_offset = FetchByte (bus, memory, cpu);
+
   if (cpu->Flag.V == 1)
     {
-      Byte relative_offset = FetchByte (bus, memory, cpu);
       Word old_pc = cpu->PC;
       cpu->PC += (SignedByte)relative_offset;
 
@@ -30,164 +30,14 @@ CMPSetStatus (Byte Result, CPU6502 *cpu)
 }
 
 /*
-   CMP_IM - Compare Accumulator with Immediate value.
-   Fetches a byte from memory, compares it with A, and updates status flags.
+   CMP - Compares the Accumulator with `value`.
 */
-static inline void
-CMP_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte Value = FetchByte (bus, memory, cpu);
-  Byte Result = cpu->A - Value;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (2);
-}
 
-/*
-   CMP_ZP - Compare Accumulator with value from Zero Page address.
-   Fetches a zero-page address from memory, reads the value at that address,
-   compares it with A, and updates status flags.
-*/
 static inline void
-CMP_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+CMP (CPU6502 *cpu, Byte value)
 {
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (3);
-}
-
-/*
-   CMP_ZPX - Compare Accumulator with value from Zero Page address with X
-   offset. Adds X to the zero-page address before reading the value. Compares
-   it with A and updates status flags.
-*/
-static inline void
-CMP_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
-  
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (4);
-}
-
-/*
-   CMP_ABS - Compare Accumulator with value from Absolute address.
-   Fetches a two-byte absolute address, reads the value,
-   compares it with A, and updates status flags.
-*/
-static inline void
-CMP_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (4);
-}
-
-/*
-   CMP_ABSX - Compare Accumulator with value from Absolute address with X
-   offset. Adds X to the absolute address before reading the value. If page
-   boundary is crossed, consumes extra cycle. Compares with A and updates
-   status flags.
-*/
-static inline void
-CMP_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Word NewAddress = Absolute + cpu->X;
-
-  if ((NewAddress & 0xFF00) != (Absolute & 0xFF00))
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, NewAddress, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (4);
-}
-
-/*
-   CMP_ABSY - Compare Accumulator with value from Absolute address with Y
-   offset. Adds Y to the absolute address before reading the value. If page
-   boundary is crossed, consumes extra cycle. Compares with A and updates
-   status flags.
-*/
-static inline void
-CMP_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Word NewAddress = Absolute + cpu->Y;
-
-  if ((NewAddress & 0xFF00) != (Absolute & 0xFF00))
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, NewAddress, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (4);
-}
-
-/*
-   CMP_INDX - Compare Accumulator with value using (Indirect, X) addressing mode.
-   The operand is a zero-page address. The X register is added to this address
-   (wrapping within zero-page) to form a new pointer location. The two bytes
-   read from this pointer form the 16-bit effective address. The byte at that
-   address is compared with A. Updates Carry, Zero, and Negative flags.
-*/
-
-static inline void
-CMP_INDX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  zp += cpu->X; // zero-page wraparound
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word addr = (hi << 8) | lo;
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte Result = cpu->A - bus->data;
-  CMPSetStatus (Result, cpu);
-  spend_cycles (6);
-}
-
-/*
-   CMP_INDY - Compare Accumulator with value using (Indirect), Y addressing mode.
-   The operand is a zero-page address pointing to a 16-bit base address.
-   The Y register is added to that base to form the effective address.
-   If the addition crosses a page boundary, one extra cycle is consumed.
-   The value read from that address is compared with A.
-   Updates Carry, Zero, and Negative flags.
-*/
-
-static inline void
-CMP_INDY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word base = (hi << 8) | lo;
-  Word addr = base + cpu->Y;
-
-  if ((base & 0xFF00) != (addr & 0xFF00)) // page boundary crossed
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte Result = cpu->A - bus->data;
+  Byte Result = cpu->A - value;
   CMPSetStatus (Result, cpu);
-  spend_cycles (5);
 }
 
 #endif // CMP_H
@@ -30,46 +30,14 @@ CPXSetStatus (Byte Result, CPU6502 *cpu)
 }
 
 /*
-   CPX_IM - Compare X register with Immediate value.
-   Fetches a byte from memory, compares it with X, and updates status flags.
+   CPX - Compares the X register with `value`.
 */
-static inline void
-CPX_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte Value = FetchByte (bus, memory, cpu);
-  Byte Result = cpu->X - Value;
-  CPXSetStatus (Result, cpu);
-  spend_cycles (2);
-}
 
-/*
-   CPX_ZP - Compare X register with value from Zero Page address.
-   Fetches a zero-page address from memory, reads the value at that address,
-   compares it with X, and updates status flags.
-*/
-static inline void
-CPX_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte Result = cpu->X - bus->data;
-  CPXSetStatus (Result, cpu);
-  spend_cycles (3);
-}
-
-/*
-   CPX_ABS - Compare X register with value from Absolute address.
-   Fetches a two-byte absolute address, reads the value,
-   compares it with X, and updates status flags.
-*/
 static inline void
-CPX_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+CPX (CPU6502 *cpu, Byte value)
 {
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte Result = cpu->X - bus->data;
+  Byte Result = cpu->X - value;
   CPXSetStatus (Result, cpu);
-  spend_cycles (4);
 }
 
 #endif // CPX_H
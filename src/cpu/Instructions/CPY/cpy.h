@@ -30,46 +30,14 @@ CPYSetStatus (Byte Result, CPU6502 *cpu)
 }
 
 /*
-   CPY_IM - Compare Y register with Immediate value.
-   Fetches a byte from memory, compares it with Y, and updates status flags.
+   CPY - Compares the Y register with `value`.
 */
-static inline void
-CPY_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte Value = FetchByte (bus, memory, cpu);
-  Byte Result = cpu->Y - Value;
-  CPYSetStatus (Result, cpu);
-  spend_cycles (2);
-}
 
-/*
-   CPY_ZP - Compare Y register with value from Zero Page address.
-   Fetches a zero-page address from memory, reads the value at that address,
-   compares it with Y, and updates status flags.
-*/
-static inline void
-CPY_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte Result = cpu->Y - bus->data;
-  CPYSetStatus (Result, cpu);
-  spend_cycles (3);
-}
-
-/*
-   CPY_ABS - Compare Y register with value from Absolute address.
-   Fetches a two-byte absolute address, reads the value,
-   compares it with Y, and updates status flags.
-*/
 static inline void
-CPY_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+CPY (CPU6502 *cpu, Byte value)
 {
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte Result = cpu->Y - bus->data;
+  Byte Result = cpu->Y - value;
   CPYSetStatus (Result, cpu);
-  spend_cycles (4);
 }
 
 #endif // CPY_H
@@ -5,7 +5,6 @@
 #include "config.h"
 #include "cpu6502.h"
 #include "mem6502.h"
-#include <complex.h>
 
 /*
    This is a header file for the INC (Increment Memory) instruction for MOS
@@ -34,74 +33,16 @@ INCSetStatus (CPU6502 *cpu, Byte value)
 }
 
 /*
-   INC_ZP - Increment Memory at Zero Page address.
-   Fetches a zero-page address from memory, reads the value at that address,
-   increments it by one, writes it back to memory, then updates the flags.
+   INC - Returns `value` plus one.
 */
-static inline void
-INC_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte IncrementedValue = bus->data + 1;
-
-  cpu_write (bus, memory, ZeroPageAddr, IncrementedValue, cpu);
-  INCSetStatus (cpu, IncrementedValue);
-  spend_cycles (5);
-}
-
-/*
-   INC_ZPX - Increment Memory at Zero Page address offset by X.
-   Fetches a zero-page address, adds the X register, reads the value,
-   increments it, writes it back, then updates the flags.
-*/
-static inline void
-INC_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  Byte IncrementedValue = bus->data + 1;
-
-  cpu_write (bus, memory, ZeroPageAddr, IncrementedValue, cpu);
-  INCSetStatus (cpu, IncrementedValue);
-  spend_cycles (6);
-}
 
-/*
-   INC_ABS - Increment Memory at Absolute address.
-   Fetches a 16-bit absolute address, reads the value at that address,
-   increments it, writes it back, then updates the flags.
-*/
-static inline void
-INC_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+INC (CPU6502 *cpu, Byte value)
 {
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte IncrementedValue = bus->data + 1;
-
-  cpu_write (bus, memory, Absolute, I, cpu);
-  INCSetStatus (cpu, IncrementedValue);
-  spend_cycles (6);
-}
-
-/*
-   INC_ABSX - Increment Memory at Absolute address offset by X.
-   Fetches a 16-bit absolute address, adds the X register,
-   reads the value, increments it, writes it back, then updates the flags.
-*/
-static inline void
-INC_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Absolute += cpu->X;
-
-  cpu_read (bus, memory, Absolute, cpu);
-  Byte IncrementedValue = bus->data + 1;
+  Byte result = value + 1;
 
-  cpu_write (bus, memory, Absolute, IncrementedValue, cpu);
-  INCSetStatus (cpu, IncrementedValue);
-  spend_cycles (6);
+  INCSetStatus (cpu, result);
+  return result;
 }
 
 #endif // INC_H
@@ -31,100 +31,14 @@ LDXSetStatus (CPU6502 *cpu)
 */
 
 /*
-   LDX_IM - Load Index Register X with Immediate value.
-   This function fetches a byte from memory and loads it into the Index
-   Register X (X). It then sets the status flags using LDXSetStatus.
+   LDX - Loads `value` into the Index Register X.
 */
 
 static inline void
-LDX_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+LDX (CPU6502 *cpu, Byte value)
 {
-  Byte Value = FetchByte (bus, memory, cpu);
-  cpu->X = Value;
+  cpu->X = value;
   LDXSetStatus (cpu);
-  spend_cycles (2);
-}
-
-/*
-   LDX_ZP - Load Index Register X from Zero Page.
-   This function fetches a byte representing a zero-page address from memory,
-   reads the value at that address, and loads it into the Index Register X (X).
-   It then sets the status flags.
-*/
-
-static inline void
-LDX_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  cpu->X = bus->data;
-  LDXSetStatus (cpu);
-  spend_cycles (3);
-}
-
-/*
-   LDX_ZPX - Load Index Register X from Zero Page with X Offset.
-   Similar to LDX_ZP, but adds the Y register value to the zero-page address
-   before reading the value from memory. It adjusts the cycle count accordingly
-   and sets the status flags.
-*/
-
-static inline void
-LDX_ZPY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->Y;
-  
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  cpu->X = bus->data;
-  LDXSetStatus (cpu);
-  spend_cycles (4);
-}
-
-/*
-   LDX_ABS - Load Index Register X from Absolute address.
-   This function fetches a two-byte absolute address from memory, reads the
-   value at that address, and loads it into the Index Register X (X). It then
-   sets the status flags.
-*/
-
-static inline void
-LDX_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  cpu->X = bus->data;
-  LDXSetStatus (cpu);
-  spend_cycles (4);
-}
-
-/*
-   LDX_ABSY - Load Index Register X from Absolute address with Y Offset.
-   Similar to LDX_ABS, but adds the Y register value to the absolute address
-   before reading the value from memory. It adjusts the cycle count accordingly
-   and sets the status flags.
-*/
-
-static inline void
-LDX_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-
-  Word OldPage = Absolute & 0xFF00;
-  Absolute += cpu->Y;
-  Word NewPage = Absolute & 0xFF00;
-
-  // Add an extra cycle if page is crossed
-  if (OldPage != NewPage)
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, Absolute, cpu);
-  cpu->X = bus->data;
-  LDXSetStatus (cpu);
-  spend_cycles (4);
 }
 
 #endif // LDX_H
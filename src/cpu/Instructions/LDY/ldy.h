@@ -31,100 +31,14 @@ LDYSetStatus (CPU6502 *cpu)
 */
 
 /*
-   LDY_IM - Load Index Register Y with Immediate value.
-   This function fetches a byte from memory and loads it into the Index
-   Register Y (Y). It then sets the status flags using LDYSetStatus.
+   LDY - Loads `value` into the Index Register Y.
 */
 
 static inline void
-LDY_IM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+LDY (CPU6502 *cpu, Byte value)
 {
-  Byte Value = FetchByte (bus, memory, cpu);
-  cpu->Y = Value;
+  cpu->Y = value;
   LDYSetStatus (cpu);
-  spend_cycles (2);
-}
-
-/*
-   LDY_ZP - Load Index Register Y from Zero Page.
-   This function fetches a byte representing a zero-page address from memory,
-   reads the value at that address, and loads it into the Index Register Y (Y).
-   It then sets the status flags.
-*/
-
-static inline void
-LDY_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  cpu->Y = bus->data;
-  LDYSetStatus (cpu);
-  spend_cycles (3);
-}
-
-/*
-   LDY_ZPX - Load Index Register Y from Zero Page with X Offset.
-   Similar to LDY_ZP, but adds the X register value to the zero-page address
-   before reading the value from memory. It adjusts the cycle count accordingly
-   and sets the status flags.
-*/
-
-static inline void
-LDY_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
-  
-  cpu_read (bus, memory, ZeroPageAddr, cpu);
-  cpu->Y = bus->data;
-  LDYSetStatus (cpu);
-  spend_cycles (4);
-}
-
-/*
-   LDY_ABS - Load Index Register Y from Absolute address.
-   This function fetches a two-byte absolute address from memory, reads the
-   value at that address, and loads it into the Index Register Y (Y). It then
-   sets the status flags.
-*/
-
-static inline void
-LDY_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_read (bus, memory, Absolute, cpu);
-  cpu->Y = bus->data;
-  LDYSetStatus (cpu);
-  spend_cycles (4);
-}
-
-/*
-   LDY_ABSX - Load Index Register Y from Absolute address with X Offset.
-   Similar to LDY_ABS, but adds the X register value to the absolute address
-   before reading the value from memory. It adjusts the cycle count accordingly
-   and sets the status flags.
-*/
-
-static inline void
-LDY_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-
-  Word OldPage = Absolute & 0xFF00;
-  Absolute += cpu->X;
-  Word NewPage = Absolute & 0xFF00;
-
-  // Add an extra cycle if page is crossed
-  if (OldPage != NewPage)
-    {
-      
-      spend_cycle ();
-    }
-
-  cpu_read (bus, memory, Absolute, cpu);
-  cpu->Y = bus->data;
-  LDYSetStatus (cpu);
-  spend_cycles (4);
 }
 
 #endif // LDY_H
@@ -19,9 +19,9 @@
 */
 
 static inline void
-NOP ()
+NOP (CPU6502 *cpu)
 {
-        // Decrease the cycle count by one
+  (void)cpu;
   spend_cycles (2); // Simulate 2 CPU cycles typically used by NOP
 }
 
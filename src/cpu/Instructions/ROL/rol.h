@@ -35,112 +35,16 @@ ROLSetStatus (Byte originalValue, Byte result, CPU6502 *cpu)
 }
 
 /*
-   ROL_ACC - Rotate Left the Accumulator.
-   This function rotates the bits of the accumulator left by one,
-   incorporating the carry flag, updates the accumulator,
-   sets the status flags, and spends cycles.
+   ROL - Rotates `value` left through the carry and returns the result.
 */
-static inline void
-ROL_ACC (CPU6502 *cpu)
-{
-  Byte oldCarry = cpu->Flag.C;
-  Byte original = cpu->A;
-
-  Byte result = (original << 1) | oldCarry;
-  cpu->A = result;
-  
-
-  ROLSetStatus (original, result, cpu);
-  spend_cycles (2);
-}
 
-/*
-   ROL_ZP - Rotate Left the byte at Zero Page address.
-   This function fetches a zero page address from memory,
-   reads the byte at that address, rotates it left with carry,
-   writes the result back, updates status flags, and spends cycles.
-*/
-static inline void
-ROL_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+ROL (CPU6502 *cpu, Byte value)
 {
-  Byte addr = FetchByte (bus, memory, cpu);
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original << 1) | oldCarry;
-  cpu_write (bus, memory, addr, result, cpu);
-
-  ROLSetStatus (original, result, cpu);
-  spend_cycles (5);
-}
-
-/*
-   ROL_ZPX - Rotate Left the byte at Zero Page address plus X offset.
-   Similar to ROL_ZP, but adds the X register to the zero page address before
-   rotation.
-*/
-static inline void
-ROL_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte addr = FetchByte (bus, memory, cpu);
-  addr += cpu->X;
-  
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original << 1) | oldCarry;
-  cpu_write (bus, memory, addr, result, cpu);
-
-  ROLSetStatus (original, result, cpu);
-  spend_cycles (6);
-}
-
-/*
-   ROL_ABS - Rotate Left the byte at Absolute address.
-   This function fetches a two-byte absolute address,
-   rotates the byte at that address left with carry,
-   writes the result back, sets flags, and spends cycles.
-*/
-static inline void
-ROL_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word addr = FetchWord (bus, memory, cpu);
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original << 1) | oldCarry;
-  cpu_write (bus, memory, addr, result, cpu);
-
-  ROLSetStatus (original, result, cpu);
-  spend_cycles (6);
-}
-
-/*
-   ROL_ABSX - Rotate Left the byte at Absolute address plus X offset.
-   Similar to ROL_ABS, but adds the X register to the absolute address before
-   rotation.
-*/
-static inline void
-ROL_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word addr = FetchWord (bus, memory, cpu);
-  addr += cpu->X;
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original << 1) | oldCarry;
-  cpu_write (bus, memory, addr, result, cpu);
+  Byte result = (value << 1) | cpu->Flag.C;
 
-  ROLSetStatus (original, result, cpu);
-  spend_cycles (7);
+  ROLSetStatus (value, result, cpu);
+  return result;
 }
 
 #endif // ROL_H
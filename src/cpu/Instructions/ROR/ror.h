@@ -35,107 +35,16 @@ RORSetStatus (Byte originalValue, Byte result, CPU6502 *cpu)
 }
 
 /*
-   ROR_ACC - Rotate Right the Accumulator.
-   This function rotates the bits of the accumulator right by one,
-   incorporating the carry flag into bit 7,
-   updates the accumulator, sets status flags, and spends cycles.
+   ROR - Rotates `value` right through the carry and returns the result.
 */
-static inline void
-ROR_ACC (CPU6502 *cpu)
-{
-  Byte original = cpu->A;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original >> 1) | (oldCarry << 7);
-  cpu->A = result;
-  
-
-  RORSetStatus (original, result, cpu);
-}
 
-/*
-   ROR_ZP - Rotate Right the byte at Zero Page address.
-   This function fetches a zero page address from memory,
-   reads the byte at that address, rotates it right with carry,
-   writes the result back, updates status flags, and spends cycles.
-*/
-static inline void
-ROR_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+ROR (CPU6502 *cpu, Byte value)
 {
-  Byte addr = FetchByte (bus, memory, cpu);
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original >> 1) | (oldCarry << 7);
-  cpu_write (bus, memory, addr, result, cpu);
-
-  RORSetStatus (original, result, cpu);
-}
-
-/*
-   ROR_ZPX - Rotate Right the byte at Zero Page address plus X offset.
-   Similar to ROR_ZP, but adds the X register to the zero page address before
-   rotation.
-*/
-static inline void
-ROR_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte addr = FetchByte (bus, memory, cpu);
-  addr += cpu->X;
-  
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original >> 1) | (oldCarry << 7);
-  cpu_write (bus, memory, addr, result, cpu);
-
-  RORSetStatus (original, result, cpu);
-}
-
-/*
-   ROR_ABS - Rotate Right the byte at Absolute address.
-   This function fetches a two-byte absolute address,
-   rotates the byte at that address right with carry,
-   writes the result back, sets flags, and spends cycles.
-*/
-static inline void
-ROR_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word addr = FetchWord (bus, memory, cpu);
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original >> 1) | (oldCarry << 7);
-  cpu_write (bus, memory, addr, result, cpu);
-
-  RORSetStatus (original, result, cpu);
-}
-
-/*
-   ROR_ABSX - Rotate Right the byte at Absolute address plus X offset.
-   Similar to ROR_ABS, but adds the X register to the absolute address before
-   rotation.
-*/
-static inline void
-ROR_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word addr = FetchWord (bus, memory, cpu);
-  addr += cpu->X;
-
-  cpu_read (bus, memory, addr, cpu);
-  Byte original = bus->data;
-  Byte oldCarry = cpu->Flag.C;
-
-  Byte result = (original >> 1) | (oldCarry << 7);
-  cpu_write (bus, memory, addr, result, cpu);
+  Byte result = (value >> 1) | (cpu->Flag.C << 7);
 
-  RORSetStatus (original, result, cpu);
+  RORSetStatus (value, result, cpu);
+  return result;
 }
 
 #endif // ROR_H
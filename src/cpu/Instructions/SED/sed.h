@@ -0,0 +1,27 @@
+#ifndef SED_H
+#define SED_H
+
+#include "config.h"
+#include "cpu6502.h"
+
+/*
+   This is a header file for the SED (Set Decimal Flag) instruction for MOS
+   Technology 6502. SED sets the Decimal Flag in the Status register. For more
+   information about the instructions, refer to Instructions.MD
+*/
+
+/*
+   SED - Set Decimal Flag:
+   This function sets the Decimal Flag (D) to 1.
+   It adjusts the cycle count accordingly.
+*/
+
+static inline void
+SED (CPU6502 *cpu)
+{
+  cpu->Flag.D = 1;
+  
+  spend_cycles (2);
+}
+
+#endif // SED_H
@@ -20,118 +20,13 @@
 */
 
 /*
-   STA_ZP - Store Accumulator into Zero Page address.
-   This function fetches a zero-page address from memory, then writes the value
-   of A into that address. It consumes 3 CPU cycles.
+   STA - Returns the value to store, the Accumulator.
 */
 
-static inline void
-STA_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+STA (CPU6502 *cpu)
 {
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_write (bus, memory, ZeroPageAddr, cpu->A, cpu);
-  spend_cycles (3);
-}
-
-/*
-   STA_ZPX - Store Accumulator into Zero Page address offset by X.
-   This function fetches a zero-page address, adds the X register to it, and
-   writes A to the resulting address. It consumes 4 CPU cycles.
-*/
-
-static inline void
-STA_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
-  cpu_write (bus, memory, ZeroPageAddr, cpu->A, cpu);
-  spend_cycles (4);
-}
-
-/*
-   STA_ABS - Store Accumulator into Absolute address.
-   This function fetches a 16-bit absolute address from memory, then writes A
-   to that address. It consumes 4 CPU cycles.
-*/
-
-static inline void
-STA_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_write (bus, memory, Absolute, cpu->A, cpu);
-  spend_cycles (4);
-}
-
-/*
-   STA_ABSX - Store Accumulator into Absolute address offset by X.
-   This function fetches an absolute address, adds X to it, and writes A to the
-   resulting address. It consumes 5 CPU cycles.
-*/
-
-static inline void
-STA_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Absolute += cpu->X;
-  cpu_write (bus, memory, Absolute, cpu->A, cpu);
-  spend_cycles (5);
-}
-
-/*
-   STA_ABSY - Store Accumulator into Absolute address offset by Y.
-   This function fetches an absolute address, adds Y to it, and writes A to the
-   resulting address. It consumes 5 CPU cycles.
-*/
-
-static inline void
-STA_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  Absolute += cpu->Y;
-  cpu_write (bus, memory, Absolute, cpu->A, cpu);
-  spend_cycles (5);
-}
-
-/*
-   STA_INDX - Store Accumulator using (Indirect, X) addressing mode.
-   In this mode, the operand is a zero-page base address. The X register
-   is added to this base address (wrapping in zero-page), forming a new
-   zero-page pointer location. The two bytes at that location are used
-   as the low/high bytes of the effective 16-bit address where the value
-   of A will be stored.
-*/
-
-static inline void
-STA_INDX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  zp += cpu->X;  // zero-page wraparound
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word addr = (hi << 8) | lo;
-
-  cpu_write (bus, memory, addr, cpu->A, cpu);
-  spend_cycles (6);
-}
-
-/*
-   STA_INDY - Store Accumulator using (Indirect), Y addressing mode.
-   In this mode, the operand is a zero-page address pointing to a 16-bit base
-   address. The Y register is then added to that base to form the final target
-   address.
-*/
-
-static inline void
-STA_INDY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte zp = FetchByte (bus, memory, cpu);
-  Byte lo = memory->Data[zp];
-  Byte hi = memory->Data[(Byte)(zp + 1)];
-  Word base = (hi << 8) | lo;
-  Word addr = base + cpu->Y;
-
-  cpu_write (bus, memory, addr, cpu->A, cpu);
-  spend_cycles (6);
+  return cpu->A;
 }
 
 #endif // STA_H
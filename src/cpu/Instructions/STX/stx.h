@@ -19,46 +19,13 @@
 */
 
 /*
-   STX_ZP - Store X Register into Zero Page address.
-   This function fetches a zero-page address from memory and writes the value
-   of X into that address. It consumes 3 CPU cycles.
+   STX - Returns the value to store, the X register.
 */
 
-static inline void
-STX_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+STX (CPU6502 *cpu)
 {
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_write (bus, memory, ZeroPageAddr, cpu->X, cpu);
-  spend_cycles (3);
-}
-
-/*
-   STX_ZPY - Store X Register into Zero Page address offset by Y.
-   This function fetches a zero-page address, adds the Y register to it, and
-   writes X to the resulting address. It consumes 4 CPU cycles.
-*/
-
-static inline void
-STX_ZPY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->Y;
-  cpu_write (bus, memory, ZeroPageAddr, cpu->X, cpu);
-  spend_cycles (4);
-}
-
-/*
-   STX_ABS - Store X Register into Absolute address.
-   This function fetches a 16-bit absolute address from memory, then writes X
-   to that address. It consumes 4 CPU cycles.
-*/
-
-static inline void
-STX_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_write (bus, memory, Absolute, cpu->X, cpu);
-  spend_cycles (4);
+  return cpu->X;
 }
 
 #endif // STX_H
@@ -19,43 +19,13 @@
 */
 
 /*
-   STY_ZP - Store Y Register into Zero Page address.
-   This function fetches a zero-page address from memory and writes the value
-   of Y into that address. It consumes 3 CPU cycles.
+   STY - Returns the value to store, the Y register.
 */
-static inline void
-STY_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  cpu_write (bus, memory, ZeroPageAddr, cpu->Y, cpu);
-  spend_cycles (3);
-}
 
-/*
-   STY_ZPX - Store Y Register into Zero Page address offset by X.
-   This function fetches a zero-page address, adds the X register to it, and
-   writes Y to the resulting address. It consumes 4 CPU cycles.
-*/
-static inline void
-STY_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
-{
-  Byte ZeroPageAddr = FetchByte (bus, memory, cpu);
-  ZeroPageAddr += cpu->X;
-  cpu_write (bus, memory, ZeroPageAddr, cpu->Y, cpu);
-  spend_cycles (4);
-}
-
-/*
-   STY_ABS - Store Y Register into Absolute address.
-   This function fetches a 16-bit absolute address from memory, then writes Y
-   to that address. It consumes 4 CPU cycles.
-*/
-static inline void
-STY_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+static inline Byte
+STY (CPU6502 *cpu)
 {
-  Word Absolute = FetchWord (bus, memory, cpu);
-  cpu_write (bus, memory, Absolute, cpu->Y, cpu);
-  spend_cycles (4);
+  return cpu->Y;
 }
 
 #endif // STY_H
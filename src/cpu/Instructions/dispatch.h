@@ -0,0 +1,69 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+/*
+   Opcode dispatch
+
+   dispatch_instruction runs the handler of one opcode whose byte has
+   already been fetched. It is always inlined: called with a constant
+   opcode, only that opcode's handler is left, which is how fused pairs
+   (cpu_exec.c) and translated blocks (aot.h) call the handlers without a
+   dispatch of their own.
+*/
+
+#include "access_type.h"
+#include "handlers.h"
+#include <stdio.h>
+
+/*
+   Memory an instruction accesses besides its own bytes, by kind: operands
+   in memory may be RAM or a device, the stack is RAM, and immediate and
+   accumulator operands, branches and jumps touch neither.
+*/
+
+#define OPERAND_ACCESS(mode)                                                  \
+  ((mode) == AM_IMM || (mode) == AM_ACC ? ACCESS_NONE                         \
+                                        : ACCESS_RAM | ACCESS_MMIO)
+
+#define ACCESS_OF_READ(mode) OPERAND_ACCESS (mode)
+#define ACCESS_OF_WRITE(mode) OPERAND_ACCESS (mode)
+#define ACCESS_OF_MODIFY(mode) OPERAND_ACCESS (mode)
+#define ACCESS_OF_STACK(mode) ACCESS_RAM
+#define ACCESS_OF_BRANCH(mode) ACCESS_NONE
+#define ACCESS_OF_JUMP(mode) ACCESS_NONE
+#define ACCESS_OF_IMPLIED(mode) ACCESS_NONE
+
+static const AccessType instruction_access[256] = {
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+  [opcode] = ACCESS_OF_##kind (AM_##mode),
+  OPCODE_TABLE (X)
+#undef X
+};
+
+static inline AccessType
+get_instruction_access_type (Byte opcode)
+{
+  return instruction_access[opcode];
+}
+
+static ALWAYS_INLINE void
+dispatch_instruction (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu, Byte Ins)
+{
+  cpu->CurrentAccess = get_instruction_access_type (Ins);
+
+  switch (Ins)
+    {
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+    case name:                                                                \
+      INSTRUCTION_CALL (kind, mnemonic, mode);                                \
+      break;
+      OPCODE_TABLE (X)
+#undef X
+
+    default:
+      printf ("Instruction not handled 0x%02X\n", Ins);
+      break;
+    }
+}
+
+#endif // DISPATCH_H
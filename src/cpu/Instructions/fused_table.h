@@ -0,0 +1,40 @@
+#ifndef FUSED_TABLE_H
+#define FUSED_TABLE_H
+
+/*
+   FUSED_TABLE - Opcode pairs the run loops dispatch as one step.
+
+   Each line names two opcodes that firmware commonly executes back to
+   back. cpu_exec.c expands every pair into one case holding both
+   handlers, so the second instruction needs no dispatch of its own (see
+   "Superinstructions" there). The first opcode must fall through to the
+   next instruction: no jumps, branches, calls or returns.
+
+   `make fused-table PROFILE="firmware.bin mmio.cfg"` rewrites this file
+   with the most frequent pairs of a profiled run (tools/rosetta-pairs.c).
+
+   Usage: define X (first, second) and expand FUSED_TABLE (X).
+*/
+
+#define FUSED_TABLE(X)            \
+  X (INS_DEX,      INS_BNE)       \
+  X (INS_DEY,      INS_BNE)       \
+  X (INS_INX,      INS_BNE)       \
+  X (INS_INY,      INS_BNE)       \
+  X (INS_INC_ZP,   INS_BNE)       \
+  X (INS_DEC_ZP,   INS_BNE)       \
+  X (INS_CMP_IM,   INS_BEQ)       \
+  X (INS_CMP_IM,   INS_BNE)       \
+  X (INS_CPX,      INS_BNE)       \
+  X (INS_CPY,      INS_BNE)       \
+  X (INS_AND_IM,   INS_BEQ)       \
+  X (INS_AND_IM,   INS_BNE)       \
+  X (INS_LDA_ZP,   INS_STA_ABS)   \
+  X (INS_LDA_IM,   INS_STA_ABS)   \
+  X (INS_LDA_ABSX, INS_STA_ABSX)  \
+  X (INS_LDA_INDY, INS_STA_INDY)  \
+  X (INS_LDA_INDY, INS_BEQ)       \
+  X (INS_LDA_ABS,  INS_BEQ)       \
+  X (INS_STA_INDY, INS_INY)
+
+#endif // FUSED_TABLE_H
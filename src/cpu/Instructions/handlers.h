@@ -0,0 +1,237 @@
+#ifndef HANDLERS_H
+#define HANDLERS_H
+
+/*
+   Handlers expanded from OPCODE_TABLE
+
+   The READ, WRITE and MODIFY instructions differ only in their operation,
+   the function named after the mnemonic in its header (LDA, STA, ASL...),
+   and in their addressing mode. Each mode's address calculation is written
+   once below, and every such row of OPCODE_TABLE becomes a handler named
+   MNEMONIC_MODE (LDA_IMM, STA_ZPX, ASL_ACC...) that computes the address,
+   reads, applies the operation, writes back and spends the row's cycles.
+
+   Indexed reads spend one more cycle when the index crosses a page, before
+   the read; indexed writes and read-modify-writes always take the longer
+   count, which is already in their row.
+*/
+
+#include "instructions.h"
+
+#if defined(__GNUC__)
+#define ALWAYS_INLINE inline __attribute__ ((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+/*
+   Effective addresses
+*/
+
+static ALWAYS_INLINE Word
+address_ZP (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  return FetchByte (bus, memory, cpu);
+}
+
+// Indexed zero page addresses wrap within the zero page.
+static ALWAYS_INLINE Word
+address_ZPX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Byte address = FetchByte (bus, memory, cpu);
+  address += cpu->X;
+  return address;
+}
+
+static ALWAYS_INLINE Word
+address_ZPY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Byte address = FetchByte (bus, memory, cpu);
+  address += cpu->Y;
+  return address;
+}
+
+static ALWAYS_INLINE Word
+address_ABS (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  return FetchWord (bus, memory, cpu);
+}
+
+static ALWAYS_INLINE Word
+address_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Word address = FetchWord (bus, memory, cpu);
+  return address + cpu->X;
+}
+
+static ALWAYS_INLINE Word
+address_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Word address = FetchWord (bus, memory, cpu);
+  return address + cpu->Y;
+}
+
+// The pointer of the indirect modes is read from the zero page directly,
+// without a bus access.
+static ALWAYS_INLINE Word
+zero_page_pointer (const MEM6502 *memory, Byte zp)
+{
+  Byte lo = memory->Data[zp];
+  Byte hi = memory->Data[(Byte)(zp + 1)];
+  return (hi << 8) | lo;
+}
+
+static ALWAYS_INLINE Word
+address_INDX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Byte zp = FetchByte (bus, memory, cpu);
+  zp += cpu->X;
+  return zero_page_pointer (memory, zp);
+}
+
+static ALWAYS_INLINE Word
+address_INDY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Byte zp = FetchByte (bus, memory, cpu);
+  return zero_page_pointer (memory, zp) + cpu->Y;
+}
+
+/*
+   Operands of READ instructions
+*/
+
+static ALWAYS_INLINE Byte
+read_at (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu, Word address)
+{
+  cpu_read (bus, memory, address, cpu);
+  return bus->data;
+}
+
+// `base` + `index`, spending a cycle if that crosses a page.
+static ALWAYS_INLINE Word
+page_crossing (Word base, Byte index)
+{
+  Word address = base + index;
+  if ((base & 0xFF00) != (address & 0xFF00))
+    spend_cycle ();
+  return address;
+}
+
+static ALWAYS_INLINE Byte
+operand_IMM (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  return FetchByte (bus, memory, cpu);
+}
+
+#define OPERAND_AT(mode)                                                      \
+  static ALWAYS_INLINE Byte operand_##mode (Bus6502 *bus, MEM6502 *memory,    \
+                                            CPU6502 *cpu)                     \
+  {                                                                           \
+    return read_at (bus, memory, cpu, address_##mode (bus, memory, cpu));     \
+  }
+
+OPERAND_AT (ZP)
+OPERAND_AT (ZPX)
+OPERAND_AT (ZPY)
+OPERAND_AT (ABS)
+OPERAND_AT (INDX)
+#undef OPERAND_AT
+
+static ALWAYS_INLINE Byte
+operand_ABSX (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Word base = FetchWord (bus, memory, cpu);
+  return read_at (bus, memory, cpu, page_crossing (base, cpu->X));
+}
+
+static ALWAYS_INLINE Byte
+operand_ABSY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Word base = FetchWord (bus, memory, cpu);
+  return read_at (bus, memory, cpu, page_crossing (base, cpu->Y));
+}
+
+static ALWAYS_INLINE Byte
+operand_INDY (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  Byte zp = FetchByte (bus, memory, cpu);
+  Word base = zero_page_pointer (memory, zp);
+  return read_at (bus, memory, cpu, page_crossing (base, cpu->Y));
+}
+
+/*
+   Handlers, one per READ, WRITE and MODIFY row. The other kinds are
+   written by hand in their headers.
+*/
+
+#define HANDLER_READ(mnemonic, mode, cycles)                                  \
+  static inline void mnemonic##_##mode (Bus6502 *bus, MEM6502 *memory,        \
+                                        CPU6502 *cpu)                         \
+  {                                                                           \
+    mnemonic (cpu, operand_##mode (bus, memory, cpu));                        \
+    spend_cycles (cycles);                                                    \
+  }
+
+#define HANDLER_WRITE(mnemonic, mode, cycles)                                 \
+  static inline void mnemonic##_##mode (Bus6502 *bus, MEM6502 *memory,        \
+                                        CPU6502 *cpu)                         \
+  {                                                                           \
+    Word address = address_##mode (bus, memory, cpu);                         \
+    cpu_write (bus, memory, address, mnemonic (cpu), cpu);                    \
+    spend_cycles (cycles);                                                    \
+  }
+
+#define HANDLER_MODIFY(mnemonic, mode, cycles)                                \
+  MODIFY_##mode (mnemonic, cycles)
+
+#define MODIFY_ACC(mnemonic, cycles)                                          \
+  static inline void mnemonic##_ACC (Bus6502 *bus, MEM6502 *memory,           \
+                                     CPU6502 *cpu)                            \
+  {                                                                           \
+    (void)bus;                                                                \
+    (void)memory;                                                             \
+    cpu->A = mnemonic (cpu, cpu->A);                                          \
+    spend_cycles (cycles);                                                    \
+  }
+
+#define MODIFY_MEMORY(mnemonic, mode, cycles)                                 \
+  static inline void mnemonic##_##mode (Bus6502 *bus, MEM6502 *memory,        \
+                                        CPU6502 *cpu)                         \
+  {                                                                           \
+    Word address = address_##mode (bus, memory, cpu);                         \
+    cpu_read (bus, memory, address, cpu);                                     \
+    cpu_write (bus, memory, address, mnemonic (cpu, bus->data), cpu);         \
+    spend_cycles (cycles);                                                    \
+  }
+
+#define MODIFY_ZP(mnemonic, cycles) MODIFY_MEMORY (mnemonic, ZP, cycles)
+#define MODIFY_ZPX(mnemonic, cycles) MODIFY_MEMORY (mnemonic, ZPX, cycles)
+#define MODIFY_ABS(mnemonic, cycles) MODIFY_MEMORY (mnemonic, ABS, cycles)
+#define MODIFY_ABSX(mnemonic, cycles) MODIFY_MEMORY (mnemonic, ABSX, cycles)
+
+#define HANDLER_STACK(mnemonic, mode, cycles)
+#define HANDLER_BRANCH(mnemonic, mode, cycles)
+#define HANDLER_JUMP(mnemonic, mode, cycles)
+#define HANDLER_IMPLIED(mnemonic, mode, cycles)
+
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+  HANDLER_##kind (mnemonic, mode, cycles)
+OPCODE_TABLE (X)
+#undef X
+
+/*
+   INSTRUCTION_CALL - The call that executes a row, written against `bus`,
+   `memory` and `cpu`.
+*/
+
+#define INSTRUCTION_CALL(kind, mnemonic, mode) CALL_##kind (mnemonic, mode)
+
+#define CALL_READ(mnemonic, mode) mnemonic##_##mode (bus, memory, cpu)
+#define CALL_WRITE(mnemonic, mode) mnemonic##_##mode (bus, memory, cpu)
+#define CALL_MODIFY(mnemonic, mode) mnemonic##_##mode (bus, memory, cpu)
+#define CALL_JUMP(mnemonic, mode) mnemonic##_##mode (bus, memory, cpu)
+#define CALL_STACK(mnemonic, mode) mnemonic (bus, memory, cpu)
+#define CALL_BRANCH(mnemonic, mode) mnemonic (bus, memory, cpu)
+#define CALL_IMPLIED(mnemonic, mode) mnemonic (cpu)
+
+#endif // HANDLERS_H
@@ -0,0 +1,225 @@
+#ifndef OPCODE_TABLE_H
+#define OPCODE_TABLE_H
+
+/*
+   OPCODE_TABLE - Instruction specification for the MOS Technology 6502.
+
+   One line per supported opcode: enum name, opcode value, mnemonic,
+   addressing mode, kind and cycles (before page crossings and taken
+   branches). Everything the emulator knows about an opcode is expanded
+   from this list: the Instruction enum (instructions.h), the handlers of
+   the READ, WRITE and MODIFY kinds (handlers.h), dispatch and the access
+   classification (dispatch.h), the disassembler, the lock-step core
+   (lanes.c) and the tools. Adding an opcode here makes it known to every
+   consumer at once.
+
+   The kind says how the opcode executes:
+
+     READ     the operand is passed to MNEMONIC (cpu, value)
+     WRITE    MNEMONIC (cpu) returns the byte stored
+     MODIFY   MNEMONIC (cpu, value) returns the byte written back
+     STACK    hand-written MNEMONIC (bus, memory, cpu), using the stack
+     BRANCH   hand-written MNEMONIC (bus, memory, cpu)
+     JUMP     hand-written MNEMONIC_MODE (bus, memory, cpu)
+     IMPLIED  hand-written MNEMONIC (cpu)
+
+   Hand-written handlers spend their cycles themselves; their rows must
+   agree (rosetta-cycles checks both against the reference core).
+
+   docs/instructions.md is prose written by hand and is not generated from
+   this table; keep its modes and cycle counts in step when rows change.
+
+   Usage: define X (name, opcode, mnemonic, mode, kind, cycles) and expand
+   OPCODE_TABLE (X).
+*/
+
+typedef enum
+{
+  AM_IMP,  // Implied
+  AM_ACC,  // Accumulator
+  AM_IMM,  // #$nn
+  AM_ZP,   // $nn
+  AM_ZPX,  // $nn,X
+  AM_ZPY,  // $nn,Y
+  AM_ABS,  // $nnnn
+  AM_ABSX, // $nnnn,X
+  AM_ABSY, // $nnnn,Y
+  AM_IND,  // ($nnnn)
+  AM_INDX, // ($nn,X)
+  AM_INDY, // ($nn),Y
+  AM_REL   // Branch target, signed 8-bit offset
+} AddressingMode;
+
+// Instruction length in bytes (opcode + operand) for each addressing mode.
+static inline int
+addressing_mode_length (AddressingMode mode)
+{
+  switch (mode)
+    {
+    case AM_IMP:
+    case AM_ACC:
+      return 1;
+    case AM_ABS:
+    case AM_ABSX:
+    case AM_ABSY:
+    case AM_IND:
+      return 3;
+    default:
+      return 2;
+    }
+}
+
+#define OPCODE_TABLE(X)                          \
+  X (INS_LDA_IM,    0xA9, LDA, IMM,  READ,    2) \
+  X (INS_LDA_ZP,    0xA5, LDA, ZP,   READ,    3) \
+  X (INS_LDA_ZPX,   0xB5, LDA, ZPX,  READ,    4) \
+  X (INS_LDA_ABS,   0xAD, LDA, ABS,  READ,    4) \
+  X (INS_LDA_ABSX,  0xBD, LDA, ABSX, READ,    4) \
+  X (INS_LDA_ABSY,  0xB9, LDA, ABSY, READ,    4) \
+  X (INS_LDA_INDX,  0xA1, LDA, INDX, READ,    6) \
+  X (INS_LDA_INDY,  0xB1, LDA, INDY, READ,    5) \
+  X (INS_LDX_IM,    0xA2, LDX, IMM,  READ,    2) \
+  X (INS_LDX_ZP,    0xA6, LDX, ZP,   READ,    3) \
+  X (INS_LDX_ZPY,   0xB6, LDX, ZPY,  READ,    4) \
+  X (INS_LDX_ABS,   0xAE, LDX, ABS,  READ,    4) \
+  X (INS_LDX_ABSY,  0xBE, LDX, ABSY, READ,    4) \
+  X (INS_LDY_IM,    0xA0, LDY, IMM,  READ,    2) \
+  X (INS_LDY_ZP,    0xA4, LDY, ZP,   READ,    3) \
+  X (INS_LDY_ZPX,   0xB4, LDY, ZPX,  READ,    4) \
+  X (INS_LDY_ABS,   0xAC, LDY, ABS,  READ,    4) \
+  X (INS_LDY_ABSX,  0xBC, LDY, ABSX, READ,    4) \
+  X (INS_STA_ZP,    0x85, STA, ZP,   WRITE,   3) \
+  X (INS_STA_ZPX,   0x95, STA, ZPX,  WRITE,   4) \
+  X (INS_STA_ABS,   0x8D, STA, ABS,  WRITE,   4) \
+  X (INS_STA_ABSX,  0x9D, STA, ABSX, WRITE,   5) \
+  X (INS_STA_ABSY,  0x99, STA, ABSY, WRITE,   5) \
+  X (INS_STA_INDX,  0x81, STA, INDX, WRITE,   6) \
+  X (INS_STA_INDY,  0x91, STA, INDY, WRITE,   6) \
+  X (INS_STX_ZP,    0x86, STX, ZP,   WRITE,   3) \
+  X (INS_STX_ZPY,   0x96, STX, ZPY,  WRITE,   4) \
+  X (INS_STX_ABS,   0x8E, STX, ABS,  WRITE,   4) \
+  X (INS_STY_ZP,    0x84, STY, ZP,   WRITE,   3) \
+  X (INS_STY_ZPX,   0x94, STY, ZPX,  WRITE,   4) \
+  X (INS_STY_ABS,   0x8C, STY, ABS,  WRITE,   4) \
+  X (INS_TSX,       0xBA, TSX, IMP,  IMPLIED, 2) \
+  X (INS_TXS,       0x9A, TXS, IMP,  IMPLIED, 2) \
+  X (INS_PHA,       0x48, PHA, IMP,  STACK,   3) \
+  X (INS_PLA,       0x68, PLA, IMP,  STACK,   4) \
+  X (INS_PHP,       0x08, PHP, IMP,  STACK,   3) \
+  X (INS_PLP,       0x28, PLP, IMP,  STACK,   4) \
+  X (INS_JMP_ABS,   0x4C, JMP, ABS,  JUMP,    3) \
+  X (INS_JMP_IND,   0x6C, JMP, IND,  JUMP,    5) \
+  X (INS_JSR,       0x20, JSR, ABS,  STACK,   6) \
+  X (INS_RTS,       0x60, RTS, IMP,  STACK,   6) \
+  X (INS_AND_IM,    0x29, AND, IMM,  READ,    2) \
+  X (INS_AND_ZP,    0x25, AND, ZP,   READ,    3) \
+  X (INS_AND_ZPX,   0x35, AND, ZPX,  READ,    4) \
+  X (INS_AND_ABS,   0x2D, AND, ABS,  READ,    4) \
+  X (INS_AND_ABSX,  0x3D, AND, ABSX, READ,    4) \
+  X (INS_AND_ABSY,  0x39, AND, ABSY, READ,    4) \
+  X (INS_AND_INDX,  0x21, AND, INDX, READ,    6) \
+  X (INS_AND_INDY,  0x31, AND, INDY, READ,    5) \
+  X (INS_ORA_IM,    0x09, ORA, IMM,  READ,    2) \
+  X (INS_ORA_ZP,    0x05, ORA, ZP,   READ,    3) \
+  X (INS_ORA_ZPX,   0x15, ORA, ZPX,  READ,    4) \
+  X (INS_ORA_ABS,   0x0D, ORA, ABS,  READ,    4) \
+  X (INS_ORA_ABSX,  0x1D, ORA, ABSX, READ,    4) \
+  X (INS_ORA_ABSY,  0x19, ORA, ABSY, READ,    4) \
+  X (INS_ORA_INDX,  0x01, ORA, INDX, READ,    6) \
+  X (INS_ORA_INDY,  0x11, ORA, INDY, READ,    5) \
+  X (INS_EOR_IM,    0x49, EOR, IMM,  READ,    2) \
+  X (INS_EOR_ZP,    0x45, EOR, ZP,   READ,    3) \
+  X (INS_EOR_ZPX,   0x55, EOR, ZPX,  READ,    4) \
+  X (INS_EOR_ABS,   0x4D, EOR, ABS,  READ,    4) \
+  X (INS_EOR_ABSX,  0x5D, EOR, ABSX, READ,    4) \
+  X (INS_EOR_ABSY,  0x59, EOR, ABSY, READ,    4) \
+  X (INS_EOR_INDX,  0x41, EOR, INDX, READ,    6) \
+  X (INS_EOR_INDY,  0x51, EOR, INDY, READ,    5) \
+  X (INS_BIT_ZP,    0x24, BIT, ZP,   READ,    3) \
+  X (INS_BIT_ABS,   0x2C, BIT, ABS,  READ,    4) \
+  X (INS_TAX,       0xAA, TAX, IMP,  IMPLIED, 2) \
+  X (INS_TAY,       0xA8, TAY, IMP,  IMPLIED, 2) \
+  X (INS_TXA,       0x8A, TXA, IMP,  IMPLIED, 2) \
+  X (INS_TYA,       0x98, TYA, IMP,  IMPLIED, 2) \
+  X (INS_INX,       0xE8, INX, IMP,  IMPLIED, 2) \
+  X (INS_INY,       0xC8, INY, IMP,  IMPLIED, 2) \
+  X (INS_DEY,       0x88, DEY, IMP,  IMPLIED, 2) \
+  X (INS_DEX,       0xCA, DEX, IMP,  IMPLIED, 2) \
+  X (INS_DEC_ZP,    0xC6, DEC, ZP,   MODIFY,  5) \
+  X (INS_DEC_ZPX,   0xD6, DEC, ZPX,  MODIFY,  6) \
+  X (INS_DEC_ABS,   0xCE, DEC, ABS,  MODIFY,  6) \
+  X (INS_DEC_ABSX,  0xDE, DEC, ABSX, MODIFY,  7) \
+  X (INS_INC_ZP,    0xE6, INC, ZP,   MODIFY,  5) \
+  X (INS_INC_ZPX,   0xF6, INC, ZPX,  MODIFY,  6) \
+  X (INS_INC_ABS,   0xEE, INC, ABS,  MODIFY,  6) \
+  X (INS_INC_ABSX,  0xFE, INC, ABSX, MODIFY,  7) \
+  X (INS_BEQ,       0xF0, BEQ, REL,  BRANCH,  2) \
+  X (INS_BNE,       0xD0, BNE, REL,  BRANCH,  2) \
+  X (INS_BCS,       0xB0, BCS, REL,  BRANCH,  2) \
+  X (INS_BCC,       0x90, BCC, REL,  BRANCH,  2) \
+  X (INS_BMI,       0x30, BMI, REL,  BRANCH,  2) \
+  X (INS_BPL,       0x10, BPL, REL,  BRANCH,  2) \
+  X (INS_BVC,       0x50, BVC, REL,  BRANCH,  2) \
+  X (INS_BVS,       0x70, BVS, REL,  BRANCH,  2) \
+  X (INS_CLC,       0x18, CLC, IMP,  IMPLIED, 2) \
+  X (INS_SEC,       0x38, SEC, IMP,  IMPLIED, 2) \
+  X (INS_CLD,       0xD8, CLD, IMP,  IMPLIED, 2) \
+  X (INS_SED,       0xF8, SED, IMP,  IMPLIED, 2) \
+  X (INS_CLI,       0x58, CLI, IMP,  IMPLIED, 2) \
+  X (INS_SEI,       0x78, SEI, IMP,  IMPLIED, 2) \
+  X (INS_CLV,       0xB8, CLV, IMP,  IMPLIED, 2) \
+  X (INS_ADC_IM,    0x69, ADC, IMM,  READ,    2) \
+  X (INS_ADC_ZP,    0x65, ADC, ZP,   READ,    3) \
+  X (INS_ADC_ZPX,   0x75, ADC, ZPX,  READ,    4) \
+  X (INS_ADC_ABS,   0x6D, ADC, ABS,  READ,    4) \
+  X (INS_ADC_ABSX,  0x7D, ADC, ABSX, READ,    4) \
+  X (INS_ADC_ABSY,  0x79, ADC, ABSY, READ,    4) \
+  X (INS_ADC_INDX,  0x61, ADC, INDX, READ,    6) \
+  X (INS_ADC_INDY,  0x71, ADC, INDY, READ,    5) \
+  X (INS_SBC_IM,    0xE9, SBC, IMM,  READ,    2) \
+  X (INS_SBC_ZP,    0xE5, SBC, ZP,   READ,    3) \
+  X (INS_SBC_ZPX,   0xF5, SBC, ZPX,  READ,    4) \
+  X (INS_SBC_ABS,   0xED, SBC, ABS,  READ,    4) \
+  X (INS_SBC_ABSX,  0xFD, SBC, ABSX, READ,    4) \
+  X (INS_SBC_ABSY,  0xF9, SBC, ABSY, READ,    4) \
+  X (INS_SBC_INDX,  0xE1, SBC, INDX, READ,    6) \
+  X (INS_SBC_INDY,  0xF1, SBC, INDY, READ,    5) \
+  X (INS_CMP_IM,    0xC9, CMP, IMM,  READ,    2) \
+  X (INS_CMP_ZP,    0xC5, CMP, ZP,   READ,    3) \
+  X (INS_CMP_ZPX,   0xD5, CMP, ZPX,  READ,    4) \
+  X (INS_CMP_ABS,   0xCD, CMP, ABS,  READ,    4) \
+  X (INS_CMP_ABSX,  0xDD, CMP, ABSX, READ,    4) \
+  X (INS_CMP_ABSY,  0xD9, CMP, ABSY, READ,    4) \
+  X (INS_CMP_INDX,  0xC1, CMP, INDX, READ,    6) \
+  X (INS_CMP_INDY,  0xD1, CMP, INDY, READ,    5) \
+  X (INS_CPX,       0xE0, CPX, IMM,  READ,    2) \
+  X (INS_CPY,       0xC0, CPY, IMM,  READ,    2) \
+  X (INS_CPX_ZP,    0xE4, CPX, ZP,   READ,    3) \
+  X (INS_CPY_ZP,    0xC4, CPY, ZP,   READ,    3) \
+  X (INS_CPX_ABS,   0xEC, CPX, ABS,  READ,    4) \
+  X (INS_CPY_ABS,   0xCC, CPY, ABS,  READ,    4) \
+  X (INS_ASL_ACC,   0x0A, ASL, ACC,  MODIFY,  2) \
+  X (INS_ASL_ZP,    0x06, ASL, ZP,   MODIFY,  5) \
+  X (INS_ASL_ZPX,   0x16, ASL, ZPX,  MODIFY,  6) \
+  X (INS_ASL_ABS,   0x0E, ASL, ABS,  MODIFY,  6) \
+  X (INS_ASL_ABSX,  0x1E, ASL, ABSX, MODIFY,  7) \
+  X (INS_LSR,       0x4A, LSR, ACC,  MODIFY,  2) \
+  X (INS_LSR_ZP,    0x46, LSR, ZP,   MODIFY,  5) \
+  X (INS_LSR_ZPX,   0x56, LSR, ZPX,  MODIFY,  6) \
+  X (INS_LSR_ABS,   0x4E, LSR, ABS,  MODIFY,  6) \
+  X (INS_LSR_ABSX,  0x5E, LSR, ABSX, MODIFY,  7) \
+  X (INS_ROL,       0x2A, ROL, ACC,  MODIFY,  2) \
+  X (INS_ROL_ZP,    0x26, ROL, ZP,   MODIFY,  5) \
+  X (INS_ROL_ZPX,   0x36, ROL, ZPX,  MODIFY,  6) \
+  X (INS_ROL_ABS,   0x2E, ROL, ABS,  MODIFY,  6) \
+  X (INS_ROL_ABSX,  0x3E, ROL, ABSX, MODIFY,  7) \
+  X (INS_ROR,       0x6A, ROR, ACC,  MODIFY,  2) \
+  X (INS_ROR_ZP,    0x66, ROR, ZP,   MODIFY,  5) \
+  X (INS_ROR_ZPX,   0x76, ROR, ZPX,  MODIFY,  6) \
+  X (INS_ROR_ABS,   0x6E, ROR, ABS,  MODIFY,  6) \
+  X (INS_ROR_ABSX,  0x7E, ROR, ABSX, MODIFY,  7) \
+  X (INS_NOP,       0xEA, NOP, IMP,  IMPLIED, 2) \
+  X (INS_BRK,       0x00, BRK, IMP,  STACK,   7) \
+  X (INS_RTI,       0x40, RTI, IMP,  STACK,   6)
+
+#endif // OPCODE_TABLE_H
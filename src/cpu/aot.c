@@ -0,0 +1,103 @@
+#include "aot.h"
+#include "memory_map.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+   AOT - Registry of translated blocks
+
+   aot_blocks maps every address to the block starting there. Whether a
+   block may run is cached in `valid`, recomputed for the blocks on a page
+   whenever the page's storage or write count differs from when it was
+   last checked.
+*/
+
+const AotBlock **aot_blocks = NULL;
+
+static const AotImage *image;
+static bool *valid;
+
+static struct
+{
+  const Byte *read;
+  DWord writes;
+  bool checked;
+} pages[PAGE_COUNT];
+
+void
+aot_register (const AotImage *registered)
+{
+  if (aot_blocks != NULL)
+    {
+      printf ("[AOT] Only one translated image can be linked in\n");
+      return;
+    }
+
+  aot_blocks = calloc (0x10000, sizeof (*aot_blocks));
+  valid = calloc (registered->count, sizeof (*valid));
+  if (aot_blocks == NULL || valid == NULL)
+    {
+      free (aot_blocks);
+      free (valid);
+      aot_blocks = NULL;
+      valid = NULL;
+      return;
+    }
+
+  image = registered;
+  for (DWord i = 0; i < image->count; i++)
+    aot_blocks[image->blocks[i].start] = &image->blocks[i];
+}
+
+// Whether ROM holds the bytes of `block` as they are in the image.
+static bool
+block_matches (const MEM6502 *memory, const AotBlock *block)
+{
+  for (unsigned page = block->start >> 8; page <= (unsigned)block->end >> 8;
+       page++)
+    if (memory->Pages[page].Kind != REGION_ROM
+        || memory->Pages[page].Read == NULL)
+      return false;
+
+  for (unsigned address = block->start; address <= block->end; address++)
+    if (memory->Pages[address >> 8].Read[address & 0xFF]
+        != image->image[address - image->origin])
+      return false;
+  return true;
+}
+
+static void
+check_page (const MEM6502 *memory, unsigned page)
+{
+  for (DWord i = 0; i < image->count; i++)
+    {
+      const AotBlock *block = &image->blocks[i];
+      if ((unsigned)block->start >> 8 <= page
+          && page <= (unsigned)block->end >> 8)
+        valid[i] = block_matches (memory, block);
+    }
+  pages[page].read = memory->Pages[page].Read;
+  pages[page].writes = memory->Pages[page].Writes;
+  pages[page].checked = true;
+}
+
+static inline bool
+page_current (const MEM6502 *memory, unsigned page)
+{
+  return pages[page].checked && pages[page].read == memory->Pages[page].Read
+         && pages[page].writes == memory->Pages[page].Writes;
+}
+
+const AotBlock *
+aot_lookup (const MEM6502 *memory, Word pc)
+{
+  const AotBlock *block = aot_blocks[pc];
+  if (block == NULL)
+    return NULL;
+
+  for (unsigned page = block->start >> 8; page <= (unsigned)block->end >> 8;
+       page++)
+    if (!page_current (memory, page))
+      check_page (memory, page);
+  return valid[block - image->blocks] ? block : NULL;
+}
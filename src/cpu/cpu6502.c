@@ -31,6 +31,8 @@
    - PushPCToStack: Push the current program counter onto the stack.
    - PopWordFromStack: Pop a 16-bit word from the stack.
    - PopByteFromStack: Pop a single byte from the stack.
+   - InterruptRequest: Enter the IRQ handler when a device holds the IRQ
+     line and interrupts are enabled.
 
    Timing control:
    - The CPU execution is synchronized to real time based on the CPU clock
@@ -43,12 +45,18 @@
 
 QWord total_cycles_executed = 0;
 struct timespec start_time;
+bool clock_unthrottled = false;
+
+// Cycle count at the last clock_init, so pacing restarts cleanly after a
+// snapshot restore moves total_cycles_executed.
+static QWord start_cycles = 0;
 
 // Initialize the monotonic clock to start timing CPU cycles.
 void
 clock_init ()
 {
   clock_gettime (CLOCK_MONOTONIC_RAW, &start_time);
+  start_cycles = total_cycles_executed;
 }
 
 // Synchronize the emulated CPU clock with real elapsed time.
@@ -58,7 +66,11 @@ clock_init ()
 void
 sync_clock ()
 {
-  double expected_time_sec = (double)total_cycles_executed / (CPU_FREQ_HZ);
+  if (clock_unthrottled)
+    return;
+
+  double expected_time_sec
+      = (double)(total_cycles_executed - start_cycles) / (CPU_FREQ_HZ);
   struct timespec now;
   clock_gettime (CLOCK_MONOTONIC_RAW, &now);
 
@@ -101,9 +113,10 @@ void
 spend_cycle ()
 {
   total_cycles_executed++;
-  fprintf (log_file,
-           "[spend_cycle] total_cycles_executed incremented to %llu\n",
-           (unsigned long long)total_cycles_executed);
+  if (log_file)
+    fprintf (log_file,
+             "[spend_cycle] total_cycles_executed incremented to %llu\n",
+             (unsigned long long)total_cycles_executed);
   sync_clock ();
 }
 
@@ -138,7 +151,7 @@ resetCPU(CPU6502 *cpu, MEM6502 *memory)
 Byte 
 FetchByte(Bus6502 *bus, const MEM6502 *memory, CPU6502 *cpu)
 {
-    cpu_read(bus, memory, cpu->PC, cpu);
+    cpu_fetch(bus, memory, cpu->PC, cpu);
     cpu->PC++;
     return bus->data;
 }
@@ -216,3 +229,22 @@ PopByteFromStack(Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
     cpu_read(bus, memory, SPToAddress(cpu), cpu);
     return bus->data;
 }
+
+// Service an IRQ: push PC and status (with Break clear and the unused bit
+// set, which is how hardware interrupts differ from BRK), disable further
+// interrupts and jump through the IRQ vector. Takes 7 cycles.
+void
+InterruptRequest (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  PushPCToStack (bus, memory, cpu);
+  PushByteToStack (bus, memory, (cpu->PS & ~0x10) | 0x20, cpu);
+  cpu->Flag.I = 1;
+
+  cpu_read (bus, memory, 0xFFFE, cpu);
+  Byte lo = bus->data;
+  cpu_read (bus, memory, 0xFFFF, cpu);
+  Byte hi = bus->data;
+  cpu->PC = ((Word)hi << 8) | lo;
+
+  spend_cycles (7);
+}
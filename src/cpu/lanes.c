@@ -0,0 +1,975 @@
+#include "lanes.h"
+#include "coverage.h"
+#include "disasm.h"
+#include "keyboard.h"
+
+/*
+   LANES - Lock-step execution of many copies of one machine (see lanes.h)
+
+   Lane loops run over all LANES_MAX entries under a 0x00/0xFF mask per
+   lane, so they have a fixed trip count and vectorize without remainder
+   handling; masked-out lanes compute garbage that BLEND discards. Memory
+   accesses differ per lane and stay scalar loops.
+
+   Behaviour follows the interpreter rather than the datasheet where the two
+   differ: PHP leaves B and the unused bit set in P, PLP clears them and RTI
+   restores P as pulled.
+*/
+
+#define FLAG_C 0x01
+#define FLAG_Z 0x02
+#define FLAG_I 0x04
+#define FLAG_D 0x08
+#define FLAG_B 0x10
+#define FLAG_U 0x20
+#define FLAG_V 0x40
+#define FLAG_N 0x80
+
+#define FOR_LANES(i) for (int i = 0; i < LANES_MAX; i++)
+#define BLEND(mask, new, old) (((new) & (mask)) | ((old) & ~(mask)))
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define LANES_CLONES                                                          \
+  __attribute__ ((                                                            \
+      target_clones ("arch=skylake-avx512", "avx2", "default")))
+#else
+#define LANES_CLONES
+#endif
+
+typedef enum
+{
+  LANE_PAGE_RAM,
+  LANE_PAGE_ROM,
+  LANE_PAGE_UNMAPPED,
+  LANE_PAGE_DEVICES // Resolved per address, see device_read
+} LanePageKind;
+
+typedef enum
+{
+  OP_ADC, OP_AND, OP_ASL, OP_BCC, OP_BCS, OP_BEQ, OP_BIT, OP_BMI,
+  OP_BNE, OP_BPL, OP_BRK, OP_BVC, OP_BVS, OP_CLC, OP_CLD, OP_CLI,
+  OP_CLV, OP_CMP, OP_CPX, OP_CPY, OP_DEC, OP_DEX, OP_DEY, OP_EOR,
+  OP_INC, OP_INX, OP_INY, OP_JMP, OP_JSR, OP_LDA, OP_LDX, OP_LDY,
+  OP_LSR, OP_NOP, OP_ORA, OP_PHA, OP_PHP, OP_PLA, OP_PLP, OP_ROL,
+  OP_ROR, OP_RTI, OP_RTS, OP_SBC, OP_SEC, OP_SED, OP_SEI, OP_STA,
+  OP_STX, OP_STY, OP_TAX, OP_TAY, OP_TSX, OP_TXA, OP_TXS, OP_TYA
+} LaneOp;
+
+typedef struct
+{
+  Byte op;
+  Byte mode;
+  Byte cycles; // Before page crossings and taken branches
+  bool known;
+} Decoded;
+
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+  [opcode] = { OP_##mnemonic, AM_##mode, cycles, true },
+static const Decoded decode[256] = { OPCODE_TABLE (X) };
+#undef X
+
+/*
+   Memory
+*/
+
+static inline Byte *
+storage (Lanes6502 *l, int lane, Word address)
+{
+  return l->ram + ((size_t)lane << 16) + l->backing[address >> 8]
+         + (address & 0xFF);
+}
+
+static Byte
+device_read (Lanes6502 *l, int lane, Word address)
+{
+  const MemPage *page = &l->memory->Pages[address >> 8];
+  const MMIODevice *dev = page->Devices[address & 0xFF];
+
+  if (dev && dev == l->keyboard)
+    {
+      size_t position = l->input_position[lane];
+      bool available = position < l->input_length[lane];
+
+      switch (((page->Alias << 8) | (address & 0xFF)) - dev->start)
+        {
+        case KEYBOARD_REG_DATA:
+          if (!available)
+            return 0;
+          l->input_position[lane]++;
+          return l->input[lane][position];
+        case KEYBOARD_REG_STATUS:
+          return available ? KEYBOARD_STATUS_READY : KEYBOARD_STATUS_DONE;
+        default:
+          return 0;
+        }
+    }
+  if (dev && dev->read)
+    {
+      l->event[lane] = LANE_DEVICE;
+      return 0;
+    }
+  if (page->Kind == REGION_UNMAPPED)
+    return 0xFF;
+  return *storage (l, lane, address);
+}
+
+static void
+device_write (Lanes6502 *l, int lane, Word address, Byte value)
+{
+  const MemPage *page = &l->memory->Pages[address >> 8];
+  const MMIODevice *dev = page->Devices[address & 0xFF];
+
+  if (dev && dev->write == mmio_exit)
+    {
+      l->exit_code[lane] = value;
+      if (l->event[lane] == LANE_RUNNING)
+        l->event[lane] = LANE_EXIT;
+      return;
+    }
+  if (dev && dev->write)
+    l->event[lane] = LANE_DEVICE;
+  else if (dev == NULL && page->Kind == REGION_RAM)
+    {
+      *storage (l, lane, address) = value;
+      l->dirty[lane][l->backing[address >> 8] >> 8] = 1;
+    }
+}
+
+static inline Byte
+lane_read (Lanes6502 *l, int lane, Word address)
+{
+  Byte kind = l->kind[address >> 8];
+
+  if (kind <= LANE_PAGE_ROM)
+    return *storage (l, lane, address);
+  if (kind == LANE_PAGE_UNMAPPED)
+    return 0xFF;
+  return device_read (l, lane, address);
+}
+
+static inline void
+lane_write (Lanes6502 *l, int lane, Word address, Byte value)
+{
+  Byte kind = l->kind[address >> 8];
+
+  if (kind == LANE_PAGE_RAM)
+    {
+      *storage (l, lane, address) = value;
+      l->dirty[lane][l->backing[address >> 8] >> 8] = 1;
+    }
+  else if (kind == LANE_PAGE_DEVICES)
+    device_write (l, lane, address, value);
+}
+
+static inline void
+push (Lanes6502 *l, int lane, Byte value)
+{
+  lane_write (l, lane, 0x0100 | l->SP[lane]--, value);
+}
+
+static inline Byte
+pull (Lanes6502 *l, int lane)
+{
+  return lane_read (l, lane, 0x0100 | ++l->SP[lane]);
+}
+
+/*
+   Setup
+*/
+
+bool
+lanes_init (Lanes6502 *l, int count, const CPU6502 *cpu,
+            const MEM6502 *memory, const MMIODevice *keyboard)
+{
+  if (count < 1 || count > LANES_MAX)
+    return false;
+
+  // Lanes run without interrupts.
+  for (int i = 0; i < mmio_device_count; i++)
+    if (mmio_device_can_irq (&mmio_devices[i]))
+      {
+        printf ("[LANES] %s can raise an IRQ, which lanes do not model\n",
+                mmio_devices[i].name);
+        return false;
+      }
+
+  memset (l, 0, sizeof (*l));
+  l->ram = malloc ((size_t)count << 16);
+  l->initial = malloc (MAX_MEM);
+  if (l->ram == NULL || l->initial == NULL)
+    {
+      lanes_free (l);
+      return false;
+    }
+
+  l->count = count;
+  l->memory = memory;
+  l->keyboard = keyboard;
+  l->boot = *cpu;
+  l->boot_cycles = total_cycles_executed;
+  memcpy (l->initial, memory->Data, MAX_MEM);
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      const MemPage *p = &memory->Pages[page];
+
+      if (p->Devices)
+        l->kind[page] = LANE_PAGE_DEVICES;
+      else if (p->Kind == REGION_RAM)
+        l->kind[page] = LANE_PAGE_RAM;
+      else if (p->Kind == REGION_ROM)
+        l->kind[page] = LANE_PAGE_ROM;
+      else
+        l->kind[page] = LANE_PAGE_UNMAPPED;
+
+      if (p->Kind != REGION_UNMAPPED)
+        l->backing[page] = (DWord)mem6502_backing_page (memory, page)
+                           * PAGE_SIZE;
+    }
+
+  for (int lane = 0; lane < count; lane++)
+    {
+      memset (l->dirty[lane], 1, PAGE_COUNT); // Copies all of it
+      lanes_reset (l, lane);
+    }
+  return true;
+}
+
+void
+lanes_free (Lanes6502 *l)
+{
+  free (l->ram);
+  free (l->initial);
+  l->ram = l->initial = NULL;
+  l->count = 0;
+}
+
+void
+lanes_reset (Lanes6502 *l, int lane)
+{
+  Byte *ram = l->ram + ((size_t)lane << 16);
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    if (l->dirty[lane][page])
+      {
+        memcpy (ram + page * PAGE_SIZE, l->initial + page * PAGE_SIZE,
+                PAGE_SIZE);
+        l->dirty[lane][page] = 0;
+      }
+
+  l->A[lane] = l->boot.A;
+  l->X[lane] = l->boot.X;
+  l->Y[lane] = l->boot.Y;
+  l->SP[lane] = l->boot.SP;
+  l->P[lane] = l->boot.PS;
+  l->PC[lane] = l->boot.PC;
+  l->cycles[lane] = l->boot_cycles;
+  l->state[lane] = LANE_RUNNING;
+  l->event[lane] = LANE_RUNNING;
+  l->exit_code[lane] = 0;
+  l->input_position[lane] = 0;
+}
+
+void
+lanes_set_input (Lanes6502 *l, int lane, const Byte *data, size_t length)
+{
+  l->input[lane] = data;
+  l->input_length[lane] = length;
+  l->input_position[lane] = 0;
+}
+
+void
+lanes_break (Lanes6502 *l, Word address)
+{
+  l->breakpoints[address >> 3] |= 1 << (address & 7);
+}
+
+/*
+   Operations. `on` is the lane mask, `value` the operand of each lane.
+*/
+
+static inline Byte
+nz (Byte p, Byte v)
+{
+  return (p & ~(FLAG_N | FLAG_Z)) | (v & FLAG_N) | (v == 0 ? FLAG_Z : 0);
+}
+
+// Binary ADC for every lane, then the NMOS decimal mode one by one: Z
+// comes from the binary sum, N and V from the sum after the low digit is
+// adjusted.
+static void
+op_adc (Lanes6502 *l, const Byte *on, const Byte *value)
+{
+  FOR_LANES (i)
+    {
+      Byte a = l->A[i], v = value[i], p = l->P[i];
+      unsigned sum = a + v + (p & FLAG_C);
+      Byte r = (Byte)sum;
+      Byte flags = (nz (p, r) & ~(FLAG_C | FLAG_V)) | (Byte)(sum >> 8)
+                   | (Byte)((~(a ^ v) & (a ^ r) & 0x80) >> 1);
+      Byte binary = on[i] & (Byte)(((p >> 3) & 1) - 1);
+
+      l->A[i] = BLEND (binary, r, a);
+      l->P[i] = BLEND (binary, flags, p);
+    }
+
+  for (int i = 0; i < l->count; i++)
+    if (on[i] && (l->P[i] & FLAG_D))
+      {
+        Byte a = l->A[i], v = value[i], p = l->P[i];
+        int carry = p & FLAG_C;
+        int lo = (a & 0x0F) + (v & 0x0F) + carry;
+        if (lo > 9)
+          lo += 6;
+        int hi = (a >> 4) + (v >> 4) + (lo > 0x0F);
+
+        p &= ~(FLAG_Z | FLAG_N | FLAG_V | FLAG_C);
+        p |= (Byte)(a + v + carry) == 0 ? FLAG_Z : 0;
+        p |= hi & 0x08 ? FLAG_N : 0;
+        p |= ~(a ^ v) & (a ^ (hi << 4)) & 0x80 ? FLAG_V : 0;
+        if (hi > 9)
+          hi += 6;
+        p |= hi > 0x0F ? FLAG_C : 0;
+        l->A[i] = (Byte)((hi << 4) | (lo & 0x0F));
+        l->P[i] = p;
+      }
+}
+
+// Flags always come from the binary difference; decimal lanes only get a
+// different A.
+static void
+op_sbc (Lanes6502 *l, const Byte *on, const Byte *value)
+{
+  Byte a_in[LANES_MAX], p_in[LANES_MAX];
+
+  FOR_LANES (i)
+    {
+      Byte a = l->A[i], v = value[i], p = l->P[i];
+      unsigned diff = a - v - !(p & FLAG_C);
+      Byte r = (Byte)diff;
+      Byte flags = (nz (p, r) & ~(FLAG_C | FLAG_V))
+                   | (Byte)(((diff >> 8) & 1) ^ 1)
+                   | (Byte)(((a ^ v) & (a ^ r) & 0x80) >> 1);
+
+      a_in[i] = a;
+      p_in[i] = p;
+      l->A[i] = BLEND (on[i], r, a);
+      l->P[i] = BLEND (on[i], flags, p);
+    }
+
+  for (int i = 0; i < l->count; i++)
+    if (on[i] && (p_in[i] & FLAG_D))
+      {
+        Byte a = a_in[i], v = value[i];
+        int borrow = !(p_in[i] & FLAG_C);
+        int lo = (a & 0x0F) - (v & 0x0F) - borrow;
+        int hi = (a >> 4) - (v >> 4);
+        if (lo < 0)
+          {
+            lo -= 6;
+            hi--;
+          }
+        if (hi < 0)
+          hi -= 6;
+        l->A[i] = (Byte)((hi << 4) | (lo & 0x0F));
+      }
+}
+
+static void
+op_compare (Lanes6502 *l, const Byte *on, const Byte *reg, const Byte *value)
+{
+  FOR_LANES (i)
+    {
+      Byte r = reg[i] - value[i];
+      Byte flags = (nz (l->P[i], r) & ~FLAG_C)
+                   | (reg[i] >= value[i] ? FLAG_C : 0);
+      l->P[i] = BLEND (on[i], flags, l->P[i]);
+    }
+}
+
+// Shifts, rotates, INC and DEC: `result` gets the new value of each lane.
+static void
+op_modify (Lanes6502 *l, LaneOp op, const Byte *on, const Byte *value,
+           Byte *result)
+{
+  Byte *P = l->P;
+
+  switch (op)
+    {
+    case OP_ASL:
+      FOR_LANES (i)
+        {
+          result[i] = value[i] << 1;
+          Byte flags = (nz (P[i], result[i]) & ~FLAG_C) | (value[i] >> 7);
+          P[i] = BLEND (on[i], flags, P[i]);
+        }
+      break;
+    case OP_LSR:
+      FOR_LANES (i)
+        {
+          result[i] = value[i] >> 1;
+          Byte flags = (nz (P[i], result[i]) & ~FLAG_C) | (value[i] & 1);
+          P[i] = BLEND (on[i], flags, P[i]);
+        }
+      break;
+    case OP_ROL:
+      FOR_LANES (i)
+        {
+          result[i] = (value[i] << 1) | (P[i] & FLAG_C);
+          Byte flags = (nz (P[i], result[i]) & ~FLAG_C) | (value[i] >> 7);
+          P[i] = BLEND (on[i], flags, P[i]);
+        }
+      break;
+    case OP_ROR:
+      FOR_LANES (i)
+        {
+          result[i] = (value[i] >> 1) | (Byte)((P[i] & FLAG_C) << 7);
+          Byte flags = (nz (P[i], result[i]) & ~FLAG_C) | (value[i] & 1);
+          P[i] = BLEND (on[i], flags, P[i]);
+        }
+      break;
+    case OP_INC:
+    case OP_DEC:
+      FOR_LANES (i)
+        {
+          result[i] = value[i] + (op == OP_INC ? 1 : -1);
+          P[i] = BLEND (on[i], nz (P[i], result[i]), P[i]);
+        }
+      break;
+    default:
+      break;
+    }
+}
+
+// Loads `value` into `reg` with N and Z.
+static void
+op_load (Lanes6502 *l, const Byte *on, Byte *reg, const Byte *value)
+{
+  FOR_LANES (i)
+    {
+      reg[i] = BLEND (on[i], value[i], reg[i]);
+      l->P[i] = BLEND (on[i], nz (l->P[i], value[i]), l->P[i]);
+    }
+}
+
+static void
+op_flag (Lanes6502 *l, const Byte *on, Byte flag, bool set)
+{
+  FOR_LANES (i)
+    {
+      Byte p = set ? l->P[i] | flag : l->P[i] & ~flag;
+      l->P[i] = BLEND (on[i], p, l->P[i]);
+    }
+}
+
+static void
+op_branch (Lanes6502 *l, const Byte *on, Byte flag, bool when_set,
+           Word next, Word target)
+{
+  // A taken branch costs one cycle, two if it lands on another page.
+  QWord extra = (next ^ target) >> 8 ? 2 : 1;
+
+  FOR_LANES (i)
+    {
+      bool taken = on[i] && ((l->P[i] & flag) != 0) == when_set;
+      l->PC[i] = taken ? target : l->PC[i];
+      l->cycles[i] += taken ? extra : 0;
+    }
+}
+
+/*
+   Execution
+*/
+
+// Effective addresses of the lanes in `on` for the memory modes; `cross`
+// is set where indexing crossed a page.
+static void
+effective_addresses (Lanes6502 *l, const Byte *on, AddressingMode mode,
+                     Word operand, Word *addr, Byte *cross)
+{
+  switch (mode)
+    {
+    case AM_ZP:
+    case AM_ABS:
+      FOR_LANES (i) addr[i] = operand;
+      break;
+    case AM_ZPX:
+      FOR_LANES (i) addr[i] = (Byte)(operand + l->X[i]);
+      break;
+    case AM_ZPY:
+      FOR_LANES (i) addr[i] = (Byte)(operand + l->Y[i]);
+      break;
+    case AM_ABSX:
+    case AM_ABSY:
+      FOR_LANES (i)
+        {
+          addr[i] = operand + (mode == AM_ABSX ? l->X[i] : l->Y[i]);
+          cross[i] = ((operand ^ addr[i]) >> 8) != 0;
+        }
+      break;
+    case AM_INDX:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            Byte zp = operand + l->X[i];
+            addr[i] = lane_read (l, i, zp)
+                      | lane_read (l, i, (Byte)(zp + 1)) << 8;
+          }
+      break;
+    case AM_INDY:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            Word base = lane_read (l, i, operand)
+                        | lane_read (l, i, (Byte)(operand + 1)) << 8;
+            addr[i] = base + l->Y[i];
+            cross[i] = ((base ^ addr[i]) >> 8) != 0;
+          }
+      break;
+    default:
+      break;
+    }
+}
+
+// Executes the instruction `code` at `pc` for the lanes in `on`.
+LANES_CLONES static void
+execute (Lanes6502 *l, const Byte *on, Word pc, const Byte *code)
+{
+  const Decoded *d = &decode[code[0]];
+  AddressingMode mode = d->mode;
+  Word operand = code[1] | code[2] << 8;
+  Word next = pc + addressing_mode_length (mode);
+  Byte cycles = d->cycles;
+  Word addr[LANES_MAX] = { 0 };
+  Byte value[LANES_MAX] = { 0 };
+  Byte cross[LANES_MAX] = { 0 };
+  Byte result[LANES_MAX];
+
+  effective_addresses (l, on, mode, operand, addr, cross);
+
+  FOR_LANES (i)
+    {
+      l->PC[i] = on[i] ? next : l->PC[i];
+      l->cycles[i] += cycles & on[i];
+    }
+
+  switch (d->op)
+    {
+    // Reads
+    case OP_LDA:
+    case OP_LDX:
+    case OP_LDY:
+    case OP_ADC:
+    case OP_SBC:
+    case OP_AND:
+    case OP_ORA:
+    case OP_EOR:
+    case OP_CMP:
+    case OP_CPX:
+    case OP_CPY:
+    case OP_BIT:
+      if (mode == AM_IMM)
+        FOR_LANES (i) value[i] = (Byte)operand;
+      else
+        for (int i = 0; i < l->count; i++)
+          if (on[i])
+            value[i] = lane_read (l, i, addr[i]);
+      FOR_LANES (i) l->cycles[i] += cross[i] & on[i];
+
+      switch (d->op)
+        {
+        case OP_LDA:
+          op_load (l, on, l->A, value);
+          break;
+        case OP_LDX:
+          op_load (l, on, l->X, value);
+          break;
+        case OP_LDY:
+          op_load (l, on, l->Y, value);
+          break;
+        case OP_ADC:
+          op_adc (l, on, value);
+          break;
+        case OP_SBC:
+          op_sbc (l, on, value);
+          break;
+        case OP_AND:
+          FOR_LANES (i) result[i] = l->A[i] & value[i];
+          op_load (l, on, l->A, result);
+          break;
+        case OP_ORA:
+          FOR_LANES (i) result[i] = l->A[i] | value[i];
+          op_load (l, on, l->A, result);
+          break;
+        case OP_EOR:
+          FOR_LANES (i) result[i] = l->A[i] ^ value[i];
+          op_load (l, on, l->A, result);
+          break;
+        case OP_CMP:
+          op_compare (l, on, l->A, value);
+          break;
+        case OP_CPX:
+          op_compare (l, on, l->X, value);
+          break;
+        case OP_CPY:
+          op_compare (l, on, l->Y, value);
+          break;
+        default: // BIT
+          FOR_LANES (i)
+            {
+              Byte p = (l->P[i] & ~(FLAG_N | FLAG_V | FLAG_Z))
+                       | (value[i] & (FLAG_N | FLAG_V))
+                       | ((l->A[i] & value[i]) == 0 ? FLAG_Z : 0);
+              l->P[i] = BLEND (on[i], p, l->P[i]);
+            }
+          break;
+        }
+      break;
+
+    // Stores
+    case OP_STA:
+    case OP_STX:
+    case OP_STY:
+      {
+        const Byte *reg = d->op == OP_STA   ? l->A
+                          : d->op == OP_STX ? l->X
+                                            : l->Y;
+        for (int i = 0; i < l->count; i++)
+          if (on[i])
+            lane_write (l, i, addr[i], reg[i]);
+      }
+      break;
+
+    // Read-modify-write
+    case OP_ASL:
+    case OP_LSR:
+    case OP_ROL:
+    case OP_ROR:
+    case OP_INC:
+    case OP_DEC:
+      if (mode == AM_ACC)
+        {
+          op_modify (l, d->op, on, l->A, result);
+          FOR_LANES (i) l->A[i] = BLEND (on[i], result[i], l->A[i]);
+          break;
+        }
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          value[i] = lane_read (l, i, addr[i]);
+      op_modify (l, d->op, on, value, result);
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          lane_write (l, i, addr[i], result[i]);
+      break;
+
+    // Registers
+    case OP_TAX:
+      op_load (l, on, l->X, l->A);
+      break;
+    case OP_TAY:
+      op_load (l, on, l->Y, l->A);
+      break;
+    case OP_TXA:
+      op_load (l, on, l->A, l->X);
+      break;
+    case OP_TYA:
+      op_load (l, on, l->A, l->Y);
+      break;
+    case OP_TSX:
+      op_load (l, on, l->X, l->SP);
+      break;
+    case OP_TXS:
+      FOR_LANES (i) l->SP[i] = BLEND (on[i], l->X[i], l->SP[i]);
+      break;
+    case OP_INX:
+    case OP_DEX:
+      FOR_LANES (i) result[i] = l->X[i] + (d->op == OP_INX ? 1 : -1);
+      op_load (l, on, l->X, result);
+      break;
+    case OP_INY:
+    case OP_DEY:
+      FOR_LANES (i) result[i] = l->Y[i] + (d->op == OP_INY ? 1 : -1);
+      op_load (l, on, l->Y, result);
+      break;
+
+    // Flags
+    case OP_CLC:
+      op_flag (l, on, FLAG_C, false);
+      break;
+    case OP_SEC:
+      op_flag (l, on, FLAG_C, true);
+      break;
+    case OP_CLI:
+      op_flag (l, on, FLAG_I, false);
+      break;
+    case OP_SEI:
+      op_flag (l, on, FLAG_I, true);
+      break;
+    case OP_CLV:
+      op_flag (l, on, FLAG_V, false);
+      break;
+    case OP_CLD:
+      op_flag (l, on, FLAG_D, false);
+      break;
+    case OP_SED:
+      op_flag (l, on, FLAG_D, true);
+      break;
+
+    // Branches: the target is the same for every lane.
+    case OP_BPL:
+    case OP_BMI:
+    case OP_BVC:
+    case OP_BVS:
+    case OP_BCC:
+    case OP_BCS:
+    case OP_BNE:
+    case OP_BEQ:
+      {
+        static const Byte flags[4] = { FLAG_N, FLAG_V, FLAG_C, FLAG_Z };
+        Word target = next + (SignedByte)code[1];
+        op_branch (l, on, flags[code[0] >> 6], (code[0] >> 5) & 1, next,
+                   target);
+      }
+      break;
+
+    // Stack
+    case OP_PHA:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          push (l, i, l->A[i]);
+      break;
+    case OP_PHP:
+      op_flag (l, on, FLAG_B | FLAG_U, true);
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          push (l, i, l->P[i]);
+      break;
+    case OP_PLA:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          value[i] = pull (l, i);
+      op_load (l, on, l->A, value);
+      break;
+    case OP_PLP:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          l->P[i] = pull (l, i) & ~(FLAG_B | FLAG_U);
+      break;
+
+    // Jumps and subroutines
+    case OP_JMP:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            if (mode == AM_ABS)
+              l->PC[i] = operand;
+            else // The pointer's high byte does not carry into its page.
+              l->PC[i] = lane_read (l, i, operand)
+                         | lane_read (l, i, (operand & 0xFF00)
+                                                | (Byte)(operand + 1))
+                               << 8;
+          }
+      break;
+    case OP_JSR:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            push (l, i, (next - 1) >> 8);
+            push (l, i, (next - 1) & 0xFF);
+            l->PC[i] = operand;
+          }
+      break;
+    case OP_RTS:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            Word lo = pull (l, i);
+            l->PC[i] = (lo | pull (l, i) << 8) + 1;
+          }
+      break;
+    case OP_RTI:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            l->P[i] = pull (l, i);
+            Word lo = pull (l, i);
+            l->PC[i] = lo | pull (l, i) << 8;
+          }
+      break;
+    case OP_BRK:
+      for (int i = 0; i < l->count; i++)
+        if (on[i])
+          {
+            push (l, i, (pc + 2) >> 8);
+            push (l, i, (pc + 2) & 0xFF);
+            push (l, i, l->P[i] | FLAG_B | FLAG_U);
+            l->P[i] |= FLAG_I;
+            l->PC[i] = lane_read (l, i, 0xFFFE)
+                       | lane_read (l, i, 0xFFFF) << 8;
+          }
+      break;
+
+    case OP_NOP:
+      break;
+    }
+}
+
+/*
+   Scheduling
+*/
+
+// Reads the instruction at `pc` as lane `lane` sees it. Fails when it lies
+// on a page with devices.
+static bool
+fetch_code (Lanes6502 *l, int lane, Word pc, Byte *code)
+{
+  code[1] = code[2] = 0;
+  for (int k = 0; k < 3; k++)
+    {
+      Word address = pc + k;
+      Byte kind = l->kind[address >> 8];
+
+      if (kind == LANE_PAGE_DEVICES)
+        return false;
+      code[k] = kind == LANE_PAGE_UNMAPPED ? 0xFF
+                                           : *storage (l, lane, address);
+      if (k == 0 && !decode[code[0]].known)
+        return true;
+      if (k + 1 >= addressing_mode_length (decode[code[0]].mode))
+        return true;
+    }
+  return true;
+}
+
+static bool
+transfers_control (LaneOp op, AddressingMode mode)
+{
+  return mode == AM_REL || op == OP_JMP || op == OP_JSR || op == OP_RTS
+         || op == OP_RTI || op == OP_BRK;
+}
+
+int
+lanes_run (Lanes6502 *l, QWord max_cycles)
+{
+  QWord end[LANES_MAX];
+  int ran = 0;
+
+  for (int i = 0; i < l->count; i++)
+    {
+      end[i] = max_cycles ? l->cycles[i] + max_cycles : ~0ULL;
+      ran += l->state[i] == LANE_RUNNING;
+    }
+
+  for (;;)
+    {
+      // The running lanes with the lowest PC go next.
+      int leader = -1;
+      Word pc = 0;
+
+      for (int i = 0; i < l->count; i++)
+        if (l->state[i] == LANE_RUNNING && (leader < 0 || l->PC[i] < pc))
+          {
+            leader = i;
+            pc = l->PC[i];
+          }
+      if (leader < 0)
+        break;
+
+      Byte code[3];
+      LaneState stop = LANE_RUNNING;
+
+      if (l->breakpoints[pc >> 3] & (1 << (pc & 7)))
+        stop = LANE_BREAKPOINT;
+      else if (!fetch_code (l, leader, pc, code))
+        stop = LANE_DEVICE;
+      else if (!decode[code[0]].known)
+        stop = LANE_OPCODE;
+
+      // Other lanes at this PC may hold different code in RAM; they get
+      // their own turn.
+      if (stop == LANE_OPCODE)
+        {
+          l->state[leader] = stop;
+          continue;
+        }
+      if (stop != LANE_RUNNING)
+        {
+          for (int i = 0; i < l->count; i++)
+            if (l->state[i] == LANE_RUNNING && l->PC[i] == pc)
+              l->state[i] = stop;
+          continue;
+        }
+
+      // Lanes at the same PC whose code differs (self-modified RAM) wait
+      // for a step of their own.
+      Byte on[LANES_MAX] = { 0 };
+      int length = addressing_mode_length (decode[code[0]].mode);
+      int active = 0;
+
+      for (int i = 0; i < l->count; i++)
+        {
+          if (l->state[i] != LANE_RUNNING || l->PC[i] != pc)
+            continue;
+          if (i != leader && l->kind[pc >> 8] == LANE_PAGE_RAM)
+            {
+              Byte mine[3];
+              fetch_code (l, i, pc, mine);
+              if (memcmp (mine, code, length) != 0)
+                continue;
+            }
+          on[i] = 0xFF;
+          active++;
+        }
+
+      execute (l, on, pc, code);
+      l->steps++;
+      l->instructions += active;
+
+      const Decoded *d = &decode[code[0]];
+      bool edge = transfers_control (d->op, d->mode);
+
+      for (int i = 0; i < l->count; i++)
+        {
+          if (!on[i])
+            continue;
+          if (edge && l->coverage[i])
+            l->coverage[i][coverage_index (pc, l->PC[i])]++;
+
+          // Same order as run_until: trap, budget, then exit.
+          if (l->event[i] == LANE_DEVICE)
+            l->state[i] = LANE_DEVICE;
+          else if (l->PC[i] == pc)
+            l->state[i] = LANE_TRAP;
+          else if (l->cycles[i] >= end[i])
+            l->state[i] = LANE_BUDGET;
+          else if (l->event[i] == LANE_EXIT)
+            l->state[i] = LANE_EXIT;
+          l->event[i] = LANE_RUNNING;
+        }
+    }
+
+  return ran;
+}
+
+const char *
+lane_state_name (LaneState state)
+{
+  switch (state)
+    {
+    case LANE_RUNNING:
+      return "running";
+    case LANE_BUDGET:
+      return "budget";
+    case LANE_TRAP:
+      return "trap";
+    case LANE_BREAKPOINT:
+      return "breakpoint";
+    case LANE_EXIT:
+      return "exit";
+    case LANE_DEVICE:
+      return "device";
+    case LANE_OPCODE:
+      return "opcode";
+    }
+  return "unknown";
+}
@@ -0,0 +1,531 @@
+#include "breakpoint.h"
+#include "cpu6502.h"
+#include "disasm.h"
+#include "mem6502.h"
+#include "reverse.h"
+#include "symbols.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <strings.h>
+#include <unistd.h>
+
+Byte debug_page_flags[PAGE_COUNT];
+Breakpoint breakpoints[BREAKPOINT_MAX];
+bool breakpoint_stop_pending = false;
+BreakHit breakpoint_last_hit;
+
+// One bit per address, for PC breakpoints and for read/write watchpoints.
+static QWord exec_map[65536 / 64];
+static QWord read_map[65536 / 64];
+static QWord write_map[65536 / 64];
+
+static int next_id = 1;
+
+// PC breakpoint to step over once after a resume, -1 if none.
+static int skip_pc = -1;
+
+static const char *kind_names[] = { "exec", "read", "write", "access" };
+
+static bool
+map_test (const QWord *map, Word addr)
+{
+  return (map[addr >> 6] >> (addr & 63)) & 1;
+}
+
+static void
+map_set (QWord *map, Word addr)
+{
+  map[addr >> 6] |= (QWord)1 << (addr & 63);
+}
+
+/*
+   Conditions are parsed once, when the breakpoint is added, and evaluated
+   on every hit. Memory is read from the backing storage so evaluating a
+   condition never triggers MMIO side effects.
+*/
+static const struct
+{
+  const char *name;
+  CondOperand operand;
+} operand_names[] = {
+  { "A", COND_A },   { "X", COND_X },   { "Y", COND_Y },
+  { "SP", COND_SP }, { "P", COND_P },   { "PC", COND_PC },
+  { "value", COND_VALUE },
+};
+
+static const struct
+{
+  const char *text;
+  CondOp op;
+} op_names[] = {
+  // Two-character operators first, so "<=" is not read as "<".
+  { "==", COND_EQ }, { "!=", COND_NE }, { "<=", COND_LE },
+  { ">=", COND_GE }, { "<", COND_LT },  { ">", COND_GT },
+  { "&", COND_AND },
+};
+
+static bool
+parse_condition (const char *text, BreakCondition *test)
+{
+  memset (test, 0, sizeof (*test));
+  if (text == NULL || text[0] == '\0')
+    return true;
+
+  char compact[48];
+  size_t n = 0;
+  for (const char *p = text; *p && n + 1 < sizeof (compact); p++)
+    if (!isspace ((unsigned char)*p))
+      compact[n++] = *p;
+  compact[n] = '\0';
+
+  size_t len = strcspn (compact, "=!<>&");
+  if (len == 0 || compact[len] == '\0')
+    return false;
+
+  if (compact[0] == '[')
+    {
+      char *end;
+      unsigned long address = strtoul (compact + 1, &end, 0);
+      if (end == compact + 1 || *end != ']' || end + 1 != compact + len
+          || address > 0xFFFF)
+        return false;
+      test->lhs = COND_MEMORY;
+      test->address = (Word)address;
+    }
+  else
+    {
+      for (size_t i = 0; i < sizeof (operand_names) / sizeof (operand_names[0]);
+           i++)
+        if (strlen (operand_names[i].name) == len
+            && strncasecmp (compact, operand_names[i].name, len) == 0)
+          test->lhs = operand_names[i].operand;
+      if (test->lhs == COND_ALWAYS)
+        return false;
+    }
+
+  const char *p = compact + len;
+  size_t i = 0;
+  while (i < sizeof (op_names) / sizeof (op_names[0])
+         && strncmp (p, op_names[i].text, strlen (op_names[i].text)) != 0)
+    i++;
+  if (i == sizeof (op_names) / sizeof (op_names[0]))
+    return false;
+  test->op = op_names[i].op;
+  p += strlen (op_names[i].text);
+
+  char *end;
+  test->rhs = (DWord)strtoul (p, &end, 0);
+  return end != p && *end == '\0';
+}
+
+static bool
+read_operand (const BreakCondition *test, const MEM6502 *memory,
+              const CPU6502 *cpu, Byte value, DWord *out)
+{
+  switch (test->lhs)
+    {
+    case COND_VALUE:
+      *out = value;
+      return true;
+    case COND_MEMORY:
+      *out = memory->Pages[test->address >> 8].Backing[test->address & 0xFF];
+      return true;
+    default:
+      break;
+    }
+
+  if (cpu == NULL)
+    return false;
+  switch (test->lhs)
+    {
+    case COND_A:
+      *out = cpu->A;
+      return true;
+    case COND_X:
+      *out = cpu->X;
+      return true;
+    case COND_Y:
+      *out = cpu->Y;
+      return true;
+    case COND_SP:
+      *out = cpu->SP;
+      return true;
+    case COND_P:
+      *out = cpu->PS;
+      return true;
+    case COND_PC:
+      *out = cpu->PC;
+      return true;
+    default:
+      return false;
+    }
+}
+
+static bool
+condition_holds (const Breakpoint *bp, const MEM6502 *memory,
+                 const CPU6502 *cpu, Byte value)
+{
+  const BreakCondition *test = &bp->test;
+  DWord actual;
+
+  if (test->lhs == COND_ALWAYS)
+    return true;
+  if (!read_operand (test, memory, cpu, value, &actual))
+    return false;
+
+  switch (test->op)
+    {
+    case COND_EQ:
+      return actual == test->rhs;
+    case COND_NE:
+      return actual != test->rhs;
+    case COND_LT:
+      return actual < test->rhs;
+    case COND_LE:
+      return actual <= test->rhs;
+    case COND_GT:
+      return actual > test->rhs;
+    case COND_GE:
+      return actual >= test->rhs;
+    case COND_AND:
+      return (actual & test->rhs) != 0;
+    }
+  return false;
+}
+
+// Rebuilds the bitmaps and page flags from the table, then lets the page
+// table route watched pages through the slow path.
+static void
+rebuild (MEM6502 *memory)
+{
+  memset (exec_map, 0, sizeof (exec_map));
+  memset (read_map, 0, sizeof (read_map));
+  memset (write_map, 0, sizeof (write_map));
+  memset (debug_page_flags, 0, sizeof (debug_page_flags));
+
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    {
+      const Breakpoint *bp = &breakpoints[i];
+      if (bp->id == 0)
+        continue;
+
+      for (DWord addr = bp->start; addr <= bp->end; addr++)
+        {
+          Byte *flags = &debug_page_flags[addr >> 8];
+          if (bp->kind == BREAK_EXEC)
+            {
+              map_set (exec_map, (Word)addr);
+              *flags |= DEBUG_PAGE_EXEC;
+            }
+          if (bp->kind == BREAK_READ || bp->kind == BREAK_ACCESS)
+            {
+              map_set (read_map, (Word)addr);
+              *flags |= DEBUG_PAGE_READ;
+            }
+          if (bp->kind == BREAK_WRITE || bp->kind == BREAK_ACCESS)
+            {
+              map_set (write_map, (Word)addr);
+              *flags |= DEBUG_PAGE_WRITE;
+            }
+        }
+    }
+
+  if (memory)
+    memory_map_update_direct (memory);
+}
+
+int
+breakpoint_add (MEM6502 *memory, BreakKind kind, Word start, Word end,
+                const char *condition)
+{
+  BreakCondition test;
+  if (end < start || !parse_condition (condition, &test))
+    return -1;
+
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    {
+      Breakpoint *bp = &breakpoints[i];
+      if (bp->id != 0)
+        continue;
+
+      memset (bp, 0, sizeof (*bp));
+      bp->id = next_id++;
+      bp->kind = kind;
+      bp->start = start;
+      bp->end = end;
+      bp->test = test;
+      if (condition)
+        snprintf (bp->condition, sizeof (bp->condition), "%s", condition);
+      rebuild (memory);
+      return bp->id;
+    }
+  return -1;
+}
+
+// Parses a hex address or a symbol name up to one of `stops`. Returns the
+// end of the address in *end (== text if nothing parsed).
+static unsigned long
+parse_address (char *text, const char *stops, char **end)
+{
+  unsigned long value = strtoul (text, end, 16);
+  size_t len = strcspn (text, stops);
+
+  if (*end == text + len || len == 0)
+    return value;
+
+  char saved = text[len];
+  Word address;
+  text[len] = '\0';
+  bool found = symbols_find (text, &address);
+  text[len] = saved;
+
+  *end = found ? text + len : text;
+  return found ? address : 0;
+}
+
+int
+breakpoint_parse (MEM6502 *memory, const char *spec)
+{
+  char buf[96];
+  snprintf (buf, sizeof (buf), "%s", spec);
+
+  BreakKind kind = BREAK_EXEC;
+  char *range = buf;
+  char *colon = strchr (buf, ':');
+
+  if (colon)
+    {
+      *colon = '\0';
+      for (int k = BREAK_EXEC; k <= BREAK_ACCESS; k++)
+        if (strcasecmp (buf, kind_names[k]) == 0)
+          {
+            kind = (BreakKind)k;
+            range = colon + 1;
+            break;
+          }
+      if (range == buf)
+        *colon = ':'; // No kind prefix: the range comes first
+    }
+
+  char *condition = strchr (range, ':');
+  if (condition)
+    *condition++ = '\0';
+
+  char *end;
+  unsigned long start = parse_address (range, "-", &end);
+  unsigned long last = start;
+  if (end == range)
+    return -1;
+  if (*end == '-')
+    {
+      char *dash = end + 1;
+      last = parse_address (dash, "", &end);
+      if (end == dash)
+        return -1;
+    }
+  if (*end != '\0' || start > 0xFFFF || last > 0xFFFF)
+    return -1;
+
+  return breakpoint_add (memory, kind, (Word)start, (Word)last, condition);
+}
+
+bool
+breakpoint_remove (MEM6502 *memory, int id)
+{
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    if (breakpoints[i].id == id && id != 0)
+      {
+        breakpoints[i].id = 0;
+        rebuild (memory);
+        return true;
+      }
+  return false;
+}
+
+void
+breakpoint_clear (MEM6502 *memory)
+{
+  memset (breakpoints, 0, sizeof (breakpoints));
+  breakpoint_stop_pending = false;
+  skip_pc = -1;
+  rebuild (memory);
+}
+
+static void
+record_hit (Breakpoint *bp, BreakKind kind, Word address, Byte value)
+{
+  bp->hits++;
+  breakpoint_last_hit.id = bp->id;
+  breakpoint_last_hit.kind = kind;
+  breakpoint_last_hit.address = address;
+  breakpoint_last_hit.value = value;
+  breakpoint_stop_pending = true;
+}
+
+bool
+breakpoint_check_exec (const MEM6502 *memory, const CPU6502 *cpu)
+{
+  if (!map_test (exec_map, cpu->PC))
+    return false;
+
+  if (skip_pc == cpu->PC)
+    {
+      skip_pc = -1;
+      return false;
+    }
+
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    {
+      Breakpoint *bp = &breakpoints[i];
+      if (bp->id == 0 || bp->kind != BREAK_EXEC || cpu->PC < bp->start
+          || cpu->PC > bp->end || !condition_holds (bp, memory, cpu, 0))
+        continue;
+
+      record_hit (bp, BREAK_EXEC, cpu->PC, 0);
+      return true;
+    }
+  return false;
+}
+
+void
+breakpoint_check_access (const MEM6502 *memory, const CPU6502 *cpu,
+                         Word address, Byte value, bool write)
+{
+  // A mirrored page also matches watchpoints on the page it shows.
+  const QWord *map = write ? write_map : read_map;
+  Word alias = (Word)((memory->Pages[address >> 8].Alias << 8)
+                      | (address & 0xFF));
+  if (!map_test (map, address) && !map_test (map, alias))
+    return;
+
+  BreakKind kind = write ? BREAK_WRITE : BREAK_READ;
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    {
+      Breakpoint *bp = &breakpoints[i];
+      if (bp->id == 0 || (bp->kind != kind && bp->kind != BREAK_ACCESS)
+          || !((address >= bp->start && address <= bp->end)
+               || (alias >= bp->start && alias <= bp->end))
+          || !condition_holds (bp, memory, cpu, value))
+        continue;
+
+      record_hit (bp, kind, address, value);
+      return;
+    }
+}
+
+void
+breakpoint_resume (const CPU6502 *cpu)
+{
+  breakpoint_stop_pending = false;
+  if (breakpoint_last_hit.id != 0 && breakpoint_last_hit.kind == BREAK_EXEC)
+    skip_pc = cpu->PC;
+}
+
+void
+breakpoint_rearm (void)
+{
+  breakpoint_stop_pending = false;
+  skip_pc = -1;
+}
+
+void
+breakpoint_step (void)
+{
+  breakpoint_last_hit.id = 0;
+  breakpoint_stop_pending = true;
+}
+
+void
+breakpoint_report (void)
+{
+  const BreakHit *hit = &breakpoint_last_hit;
+
+  if (hit->id == 0)
+    return;
+  if (hit->kind == BREAK_EXEC)
+    printf ("[BREAK] #%d at PC=%04X\n", hit->id, hit->address);
+  else
+    printf ("[WATCH] #%d %s %04X %s %02X\n", hit->id,
+            kind_names[hit->kind], hit->address,
+            hit->kind == BREAK_WRITE ? "<=" : "=>", hit->value);
+}
+
+// Prints where the run stopped.
+static void
+show_stop (const MEM6502 *memory, const CPU6502 *cpu)
+{
+  breakpoint_report ();
+  printf ("[CPU] A=%02X X=%02X Y=%02X SP=%02X PC=%04X P=%02X\n", cpu->A,
+          cpu->X, cpu->Y, cpu->SP, cpu->PC, cpu->PS);
+  if (reverse_mode != REVERSE_OFF)
+    printf ("[REVERSE] instruction %llu of %llu\n",
+            (unsigned long long)reverse_position (),
+            (unsigned long long)reverse_frontier ());
+
+  Byte bytes[3];
+  char listing[128];
+  for (int i = 0; i < 3; i++)
+    bytes[i] = mem6502_peek (memory, (Word)(cpu->PC + i));
+  disasm_line (cpu->PC, bytes, listing, sizeof (listing));
+  printf ("%s\n", listing);
+}
+
+bool
+breakpoint_prompt (MEM6502 *memory, CPU6502 *cpu)
+{
+  show_stop (memory, cpu);
+
+  // Nobody to ask: a batch run ends at the first hit.
+  if (!isatty (STDIN_FILENO))
+    return false;
+
+  char line[128];
+  for (;;)
+    {
+      printf ("(c)ontinue (s)tep (b)reak SPEC (d)elete ID%s (q)uit > ",
+              reverse_mode != REVERSE_OFF ? " (r)everse step (rc)" : "");
+      fflush (stdout);
+      if (!fgets (line, sizeof (line), stdin))
+        return false;
+      line[strcspn (line, "\n")] = '\0';
+
+      switch (line[0])
+        {
+        case 'c':
+          breakpoint_resume (cpu);
+          return true;
+        case 's':
+          breakpoint_resume (cpu);
+          breakpoint_step ();
+          return true;
+        case 'r':
+          if (reverse_mode == REVERSE_OFF)
+            {
+              printf ("not recording (run with --reverse)\n");
+              break;
+            }
+          if (line[1] == 'c' ? !reverse_continue (memory, cpu)
+                             : !reverse_step (memory, cpu))
+            printf ("start of history\n");
+          show_stop (memory, cpu);
+          break;
+        case 'b':
+          {
+            int id = breakpoint_parse (memory, line + 1 + strspn (line + 1, " "));
+            if (id < 0)
+              printf ("invalid breakpoint\n");
+            else
+              printf ("breakpoint #%d\n", id);
+            break;
+          }
+        case 'd':
+          if (!breakpoint_remove (memory, atoi (line + 1)))
+            printf ("no such breakpoint\n");
+          break;
+        case 'q':
+          return false;
+        default:
+          break;
+        }
+    }
+}
@@ -1,5 +1,8 @@
 #include "debug.h"
 #include "cpu6502.h"
+#include "disasm.h"
+#include "mem6502.h"
+#include "symbols.h"
 #include <stdio.h>
 
 DebugLevel DEBUG_LEVEL = DEBUG_OFF;
@@ -8,9 +11,28 @@ void debug_set_level(DebugLevel level) {
     DEBUG_LEVEL = level;
 }
 
-void debug_opcode(Word pc, Byte opcode) {
-    if (DEBUG_LEVEL >= DEBUG_OPCODES)
-        printf("[OP ] PC=%04X OP=%02X\n", pc, opcode);
+// Disassembles the instruction at pc. Bytes are peeked, so tracing never
+// triggers MMIO side effects.
+void debug_opcode(const MEM6502 *memory, Word pc) {
+    if (DEBUG_LEVEL < DEBUG_OPCODES)
+        return;
+
+    Byte bytes[3];
+    char line[128];
+    for (int i = 0; i < 3; i++)
+        bytes[i] = mem6502_peek(memory, (Word)(pc + i));
+    disasm_line(pc, bytes, line, sizeof(line));
+
+    const char *label = symbols_lookup(pc);
+    if (label)
+        printf("[OP ] %s:\n", label);
+    printf("[OP ] %s\n", line);
+}
+
+// Called by the core before each instruction when a debug level is set.
+void debug_trace(const MEM6502 *memory, const CPU6502 *cpu) {
+    debug_opcode(memory, cpu->PC);
+    debug_cpu_state(cpu);
 }
 
 void debug_cpu_state(const CPU6502 *cpu) {
@@ -0,0 +1,110 @@
+#include "disasm.h"
+#include "symbols.h"
+#include <stdio.h>
+
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+  [opcode] = { #mnemonic, AM_##mode },
+const OpcodeInfo opcode_info[256] = { OPCODE_TABLE (X) };
+#undef X
+
+// Writes `address` as a symbol name when one is known, else as hex with
+// `digits` digits.
+static void
+format_address (char *out, size_t size, Word address, int digits)
+{
+  const char *name = symbols_lookup (address);
+
+  if (name)
+    snprintf (out, size, "%s", name);
+  else
+    snprintf (out, size, "$%0*X", digits, address);
+}
+
+int
+disasm_instruction (Word pc, const Byte *bytes, char *out, size_t size)
+{
+  const OpcodeInfo *info = &opcode_info[bytes[0]];
+
+  if (info->mnemonic == NULL)
+    {
+      snprintf (out, size, ".byte $%02X", bytes[0]);
+      return 1;
+    }
+
+  Byte zp = bytes[1];
+  Word abs = bytes[1] | (bytes[2] << 8);
+  char operand[64];
+
+  switch (info->mode)
+    {
+    case AM_ZP:
+    case AM_ZPX:
+    case AM_ZPY:
+    case AM_INDX:
+    case AM_INDY:
+      format_address (operand, sizeof (operand), zp, 2);
+      break;
+    case AM_ABS:
+    case AM_ABSX:
+    case AM_ABSY:
+    case AM_IND:
+      format_address (operand, sizeof (operand), abs, 4);
+      break;
+    case AM_REL:
+      format_address (operand, sizeof (operand),
+                      (Word)(pc + 2 + (SignedByte)zp), 4);
+      break;
+    default:
+      operand[0] = '\0';
+      break;
+    }
+
+  switch (info->mode)
+    {
+    case AM_IMP:
+      snprintf (out, size, "%s", info->mnemonic);
+      break;
+    case AM_ACC:
+      snprintf (out, size, "%s A", info->mnemonic);
+      break;
+    case AM_IMM:
+      snprintf (out, size, "%s #$%02X", info->mnemonic, zp);
+      break;
+    case AM_ZPX:
+    case AM_ABSX:
+      snprintf (out, size, "%s %s,X", info->mnemonic, operand);
+      break;
+    case AM_ZPY:
+    case AM_ABSY:
+      snprintf (out, size, "%s %s,Y", info->mnemonic, operand);
+      break;
+    case AM_IND:
+      snprintf (out, size, "%s (%s)", info->mnemonic, operand);
+      break;
+    case AM_INDX:
+      snprintf (out, size, "%s (%s,X)", info->mnemonic, operand);
+      break;
+    case AM_INDY:
+      snprintf (out, size, "%s (%s),Y", info->mnemonic, operand);
+      break;
+    default: // AM_ZP, AM_ABS, AM_REL
+      snprintf (out, size, "%s %s", info->mnemonic, operand);
+      break;
+    }
+
+  return addressing_mode_length (info->mode);
+}
+
+int
+disasm_line (Word pc, const Byte *bytes, char *out, size_t size)
+{
+  char text[96];
+  int length = disasm_instruction (pc, bytes, text, sizeof (text));
+  char hex[10] = "";
+
+  for (int i = 0; i < length; i++)
+    snprintf (hex + i * 3, sizeof (hex) - i * 3, "%02X ", bytes[i]);
+
+  snprintf (out, size, "%04X  %-9s %s", pc, hex, text);
+  return length;
+}
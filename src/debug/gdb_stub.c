@@ -0,0 +1,612 @@
+#include "gdb_stub.h"
+#include "breakpoint.h"
+#include "cpu_exec.h"
+#include "mmio.h"
+#include "reverse.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define GDB_PACKET_MAX 4096
+
+#define GDB_SIGINT 2
+#define GDB_SIGTRAP 5
+
+static int gdb_fd = -1;
+static bool no_ack = false;
+
+static const char target_xml[]
+    = "<?xml version=\"1.0\"?>"
+      "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+      "<target version=\"1.0\"><feature name=\"org.rosetta6502.cpu\">"
+      "<reg name=\"a\" bitsize=\"8\" type=\"uint8\"/>"
+      "<reg name=\"x\" bitsize=\"8\" type=\"uint8\"/>"
+      "<reg name=\"y\" bitsize=\"8\" type=\"uint8\"/>"
+      "<reg name=\"p\" bitsize=\"8\" type=\"uint8\"/>"
+      "<reg name=\"sp\" bitsize=\"8\" type=\"uint8\"/>"
+      "<reg name=\"pc\" bitsize=\"16\" type=\"code_ptr\"/>"
+      "</feature></target>";
+
+/*
+   Socket setup
+*/
+
+bool
+gdb_stub_listen (const char *address)
+{
+  int server;
+
+  if (strncmp (address, "unix:", 5) == 0)
+    {
+      struct sockaddr_un sun = { .sun_family = AF_UNIX };
+      snprintf (sun.sun_path, sizeof (sun.sun_path), "%s", address + 5);
+      unlink (sun.sun_path);
+
+      server = socket (AF_UNIX, SOCK_STREAM, 0);
+      if (server < 0
+          || bind (server, (struct sockaddr *)&sun, sizeof (sun)) < 0)
+        {
+          perror (address);
+          return false;
+        }
+    }
+  else
+    {
+      const char *port = strrchr (address, ':');
+      port = port ? port + 1 : address;
+
+      struct sockaddr_in sin = { .sin_family = AF_INET };
+      sin.sin_port = htons ((uint16_t)atoi (port));
+      sin.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+      int one = 1;
+      server = socket (AF_INET, SOCK_STREAM, 0);
+      if (server >= 0)
+        setsockopt (server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+      if (server < 0
+          || bind (server, (struct sockaddr *)&sin, sizeof (sin)) < 0)
+        {
+          perror (address);
+          return false;
+        }
+    }
+
+  printf ("[GDB] Waiting for debugger on %s\n", address);
+  fflush (stdout);
+
+  if (listen (server, 1) < 0 || (gdb_fd = accept (server, NULL, NULL)) < 0)
+    {
+      perror ("accept");
+      close (server);
+      return false;
+    }
+  close (server);
+
+  if (strncmp (address, "unix:", 5) == 0)
+    unlink (address + 5);
+
+  printf ("[GDB] Debugger attached\n");
+  return true;
+}
+
+/*
+   Packet layer: $<data>#<checksum>, acknowledged with '+' until the
+   debugger asks for QStartNoAckMode.
+*/
+
+static int
+read_char (void)
+{
+  unsigned char c;
+  for (;;)
+    {
+      ssize_t n = read (gdb_fd, &c, 1);
+      if (n == 1)
+        return c;
+      if (n < 0 && errno == EINTR)
+        continue;
+      return -1;
+    }
+}
+
+static void
+write_all (const char *data, size_t length)
+{
+  while (length > 0)
+    {
+      ssize_t n = write (gdb_fd, data, length);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return;
+      data += n;
+      length -= (size_t)n;
+    }
+}
+
+static void
+send_packet (const char *data)
+{
+  char frame[GDB_PACKET_MAX + 4];
+  Byte checksum = 0;
+
+  for (const char *p = data; *p; p++)
+    checksum += (Byte)*p;
+  int length = snprintf (frame, sizeof (frame), "$%s#%02x", data, checksum);
+  write_all (frame, (size_t)length);
+}
+
+// Returns the packet length, 0 for a Ctrl-C, or -1 when the debugger left.
+static int
+read_packet (char *buf, size_t size)
+{
+  int c;
+
+  for (;;)
+    {
+      // Skip acks and noise until a packet or an interrupt starts.
+      do
+        {
+          c = read_char ();
+          if (c < 0)
+            return -1;
+          if (c == 0x03)
+            return 0;
+        }
+      while (c != '$');
+
+      size_t length = 0;
+      Byte checksum = 0;
+      while ((c = read_char ()) >= 0 && c != '#')
+        {
+          if (length + 1 < size)
+            buf[length++] = (char)c;
+          checksum += (Byte)c;
+        }
+      buf[length] = '\0';
+
+      char hex[3] = { 0 };
+      int hi = read_char (), lo = read_char ();
+      if (c < 0 || hi < 0 || lo < 0)
+        return -1;
+      hex[0] = (char)hi;
+      hex[1] = (char)lo;
+
+      if (no_ack)
+        return (int)length;
+      if (strtoul (hex, NULL, 16) == checksum)
+        {
+          write_all ("+", 1);
+          return (int)length;
+        }
+      write_all ("-", 1);
+    }
+}
+
+static int
+hex_value (char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Decodes `count` hex byte pairs. Returns false on malformed input.
+static bool
+decode_hex (const char *hex, Byte *out, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    {
+      // A NUL high digit ends the string: never look past it.
+      int hi = hex_value (hex[2 * i]);
+      if (hi < 0)
+        return false;
+      int lo = hex_value (hex[2 * i + 1]);
+      if (lo < 0)
+        return false;
+      out[i] = (Byte)(hi << 4 | lo);
+    }
+  return true;
+}
+
+/*
+   Request handlers
+*/
+
+static void
+send_registers (const CPU6502 *cpu)
+{
+  char buf[16];
+  snprintf (buf, sizeof (buf), "%02x%02x%02x%02x%02x%02x%02x", cpu->A,
+            cpu->X, cpu->Y, cpu->PS, cpu->SP, cpu->PC & 0xFF, cpu->PC >> 8);
+  send_packet (buf);
+}
+
+static bool
+set_register (CPU6502 *cpu, int reg, const Byte *value)
+{
+  switch (reg)
+    {
+    case 0: cpu->A = value[0]; break;
+    case 1: cpu->X = value[0]; break;
+    case 2: cpu->Y = value[0]; break;
+    case 3: cpu->PS = value[0]; break;
+    case 4: cpu->SP = value[0]; break;
+    case 5: cpu->PC = (Word)(value[0] | value[1] << 8); break;
+    default: return false;
+    }
+  return true;
+}
+
+static void
+read_memory (const MEM6502 *memory, const char *args)
+{
+  char *end;
+  unsigned long addr = strtoul (args, &end, 16);
+  char buf[GDB_PACKET_MAX];
+
+  if (end == args || *end != ',')
+    {
+      send_packet ("E01");
+      return;
+    }
+  unsigned long length = strtoul (end + 1, NULL, 16);
+  if (length > (sizeof (buf) - 1) / 2)
+    length = (sizeof (buf) - 1) / 2;
+  for (unsigned long i = 0; i < length; i++)
+    snprintf (&buf[2 * i], 3, "%02x",
+              mem6502_peek (memory, (Word)(addr + i)));
+  buf[2 * length] = '\0';
+  send_packet (buf);
+}
+
+static void
+write_memory (MEM6502 *memory, const char *args)
+{
+  char *end;
+  unsigned long addr = strtoul (args, &end, 16);
+  Byte data[GDB_PACKET_MAX / 2];
+
+  if (end == args || *end != ',')
+    {
+      send_packet ("E01");
+      return;
+    }
+  unsigned long length = strtoul (end + 1, &end, 16);
+  if (*end != ':' || length > sizeof (data)
+      || !decode_hex (end + 1, data, length))
+    {
+      send_packet ("E01");
+      return;
+    }
+  for (unsigned long i = 0; i < length; i++)
+    mem6502_poke (memory, (Word)(addr + i), data[i]);
+  send_packet ("OK");
+}
+
+// Z/z packets: type 0-1 breakpoints, 2 write, 3 read, 4 access watchpoints.
+static void
+change_breakpoint (MEM6502 *memory, const char *packet)
+{
+  static const BreakKind kinds[] = { BREAK_EXEC, BREAK_EXEC, BREAK_WRITE,
+                                     BREAK_READ, BREAK_ACCESS };
+  bool insert = packet[0] == 'Z';
+  int type = packet[1] - '0';
+  char *end;
+  unsigned long addr = strtoul (packet + 3, &end, 16);
+  unsigned long length = (*end == ',') ? strtoul (end + 1, NULL, 16) : 1;
+
+  if (type < 0 || type > 4)
+    {
+      send_packet ("");
+      return;
+    }
+  if (type <= 1 || length == 0)
+    length = 1;
+
+  BreakKind kind = kinds[type];
+  Word last = (Word)(addr + length - 1);
+
+  if (insert)
+    {
+      bool ok = breakpoint_add (memory, kind, (Word)addr, last, NULL) > 0;
+      send_packet (ok ? "OK" : "E01");
+      return;
+    }
+
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    {
+      const Breakpoint *bp = &breakpoints[i];
+      if (bp->id && bp->kind == kind && bp->start == addr && bp->end == last
+          && bp->condition[0] == '\0')
+        {
+          breakpoint_remove (memory, bp->id);
+          break;
+        }
+    }
+  send_packet ("OK");
+}
+
+static void
+send_stop (int signal)
+{
+  char buf[48];
+  const BreakHit *hit = &breakpoint_last_hit;
+
+  if (signal == GDB_SIGTRAP && hit->id != 0 && hit->kind != BREAK_EXEC)
+    {
+      const Breakpoint *bp = NULL;
+      for (int i = 0; i < BREAKPOINT_MAX; i++)
+        if (breakpoints[i].id == hit->id)
+          bp = &breakpoints[i];
+
+      const char *name = "watch";
+      if (bp && bp->kind == BREAK_READ)
+        name = "rwatch";
+      else if (bp && bp->kind == BREAK_ACCESS)
+        name = "awatch";
+      snprintf (buf, sizeof (buf), "T%02x%s:%04x;", signal, name,
+                hit->address);
+    }
+  else
+    snprintf (buf, sizeof (buf), "S%02x", signal);
+  send_packet (buf);
+}
+
+static void
+handle_query (const char *packet)
+{
+  char buf[GDB_PACKET_MAX];
+
+  if (strncmp (packet, "qSupported", 10) == 0)
+    send_packet (reverse_mode != REVERSE_OFF
+                     ? "PacketSize=1000;qXfer:features:read+;QStartNoAckMode+;"
+                       "ReverseStep+;ReverseContinue+"
+                     : "PacketSize=1000;qXfer:features:read+;QStartNoAckMode+");
+  else if (strcmp (packet, "qAttached") == 0)
+    send_packet ("1");
+  else if (strcmp (packet, "qC") == 0)
+    send_packet ("QC1");
+  else if (strcmp (packet, "qfThreadInfo") == 0)
+    send_packet ("m1");
+  else if (strcmp (packet, "qsThreadInfo") == 0)
+    send_packet ("l");
+  else if (strncmp (packet, "qXfer:features:read:target.xml:", 31) == 0)
+    {
+      char *end;
+      unsigned long offset = strtoul (packet + 31, &end, 16);
+      size_t total = sizeof (target_xml) - 1;
+
+      if (end == packet + 31 || *end != ',')
+        {
+          send_packet ("E01");
+          return;
+        }
+      unsigned long length = strtoul (end + 1, NULL, 16);
+      if (offset >= total)
+        {
+          send_packet ("l");
+          return;
+        }
+      if (length > sizeof (buf) - 2)
+        length = sizeof (buf) - 2;
+      size_t chunk = total - offset < length ? total - offset : length;
+      buf[0] = (offset + chunk >= total) ? 'l' : 'm';
+      memcpy (buf + 1, target_xml + offset, chunk);
+      buf[chunk + 1] = '\0';
+      send_packet (buf);
+    }
+  else
+    send_packet ("");
+}
+
+// Has the debugger sent a Ctrl-C since the last slice?
+static bool
+interrupt_requested (void)
+{
+  struct pollfd pfd = { .fd = gdb_fd, .events = POLLIN };
+  if (poll (&pfd, 1, 0) <= 0)
+    return false;
+
+  unsigned char c;
+  return read (gdb_fd, &c, 1) == 1 && c == 0x03;
+}
+
+typedef enum
+{
+  RUN_STOPPED,  // Breakpoint, step done or interrupt: report and wait
+  RUN_EXITED,   // Firmware requested exit or the core gave up
+} RunResult;
+
+// Runs until a breakpoint, a single step or an interrupt from the
+// debugger, in timeslices so the socket is only polled between them.
+static RunResult
+resume (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu, bool step, int *signal)
+{
+  breakpoint_resume (cpu);
+  if (step)
+    breakpoint_step ();
+
+  for (;;)
+    {
+      for (int i = 0; i < GDB_STUB_SLICE; i++)
+        {
+          if (mmio_exit_requested)
+            return RUN_EXITED;
+          if (!reverse_run_instruction (bus, memory, cpu))
+            {
+              if (!breakpoint_stop_pending)
+                return RUN_EXITED;
+              breakpoint_stop_pending = false;
+              *signal = GDB_SIGTRAP;
+              return RUN_STOPPED;
+            }
+        }
+
+      if (interrupt_requested ())
+        {
+          *signal = GDB_SIGINT;
+          return RUN_STOPPED;
+        }
+    }
+}
+
+bool
+gdb_stub_run (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  char packet[GDB_PACKET_MAX];
+  int signal = GDB_SIGTRAP;
+  Byte value[2];
+
+  for (;;)
+    {
+      int length = read_packet (packet, sizeof (packet));
+      if (length < 0)
+        {
+          printf ("[GDB] Debugger disconnected\n");
+          breakpoint_clear (memory);
+          close (gdb_fd);
+          gdb_fd = -1;
+          return true;
+        }
+      if (length == 0)
+        {
+          send_stop (GDB_SIGINT); // Interrupt while already halted
+          continue;
+        }
+
+      switch (packet[0])
+        {
+        case '?':
+          send_stop (signal);
+          break;
+        case 'g':
+          send_registers (cpu);
+          break;
+        case 'G':
+          {
+            Byte regs[7];
+            if (!decode_hex (packet + 1, regs, sizeof (regs)))
+              {
+                send_packet ("E01");
+                break;
+              }
+            for (int reg = 0; reg <= 5; reg++)
+              set_register (cpu, reg, &regs[reg]); // pc takes regs[5..6]
+            send_packet ("OK");
+            break;
+          }
+        case 'p':
+          {
+            int reg = (int)strtol (packet + 1, NULL, 16);
+            Byte regs[] = { cpu->A, cpu->X, cpu->Y, cpu->PS, cpu->SP };
+            char buf[8];
+            if (reg == 5)
+              snprintf (buf, sizeof (buf), "%02x%02x", cpu->PC & 0xFF,
+                        cpu->PC >> 8);
+            else if (reg >= 0 && reg < 5)
+              snprintf (buf, sizeof (buf), "%02x", regs[reg]);
+            else
+              snprintf (buf, sizeof (buf), "E01");
+            send_packet (buf);
+            break;
+          }
+        case 'P':
+          {
+            char *end;
+            int reg = (int)strtol (packet + 1, &end, 16);
+            bool ok = *end == '=' && decode_hex (end + 1, value,
+                                                 reg == 5 ? 2 : 1)
+                      && set_register (cpu, reg, value);
+            send_packet (ok ? "OK" : "E01");
+            break;
+          }
+        case 'm':
+          read_memory (memory, packet + 1);
+          break;
+        case 'M':
+          write_memory (memory, packet + 1);
+          break;
+        case 'Z':
+        case 'z':
+          change_breakpoint (memory, packet);
+          break;
+        case 'c':
+        case 's':
+          if (packet[1])
+            cpu->PC = (Word)strtoul (packet + 1, NULL, 16);
+          if (resume (bus, memory, cpu, packet[0] == 's', &signal)
+              == RUN_EXITED)
+            {
+              char buf[8];
+              snprintf (buf, sizeof (buf), "W%02x", mmio_exit_code);
+              send_packet (buf);
+              close (gdb_fd);
+              gdb_fd = -1;
+              return false;
+            }
+          send_stop (signal);
+          break;
+        case 'b':
+          // bs / bc: reverse step and reverse continue.
+          if ((packet[1] != 's' && packet[1] != 'c') || packet[2])
+            {
+              send_packet ("");
+              break;
+            }
+          if (reverse_mode == REVERSE_OFF)
+            {
+              send_packet ("E01");
+              break;
+            }
+          signal = GDB_SIGTRAP;
+          if (packet[1] == 's' ? reverse_step (memory, cpu)
+                               : reverse_continue (memory, cpu))
+            send_stop (signal);
+          else
+            send_packet ("T05replaylog:begin;");
+          break;
+        case 'D':
+          send_packet ("OK");
+          printf ("[GDB] Debugger detached\n");
+          breakpoint_clear (memory);
+          close (gdb_fd);
+          gdb_fd = -1;
+          return true;
+        case 'k':
+          close (gdb_fd);
+          gdb_fd = -1;
+          return false;
+        case 'H':
+          send_packet ("OK");
+          break;
+        case 'T':
+          send_packet ("OK"); // The only thread is alive
+          break;
+        case 'q':
+          handle_query (packet);
+          break;
+        case 'Q':
+          if (strcmp (packet, "QStartNoAckMode") == 0)
+            {
+              send_packet ("OK");
+              no_ack = true;
+            }
+          else
+            send_packet ("");
+          break;
+        default:
+          send_packet (""); // Unsupported
+          break;
+        }
+    }
+}
@@ -0,0 +1,521 @@
+#include "reverse.h"
+#include "breakpoint.h"
+#include "cpu6502.h"
+#include "cpu_exec.h"
+#include "mmio.h"
+
+/*
+   Reverse execution (see reverse.h)
+
+   Checkpoint k stores the pages whose content changed between checkpoint
+   k-1 and k, so the memory of checkpoint k is, page by page, the copy held
+   by the newest checkpoint at or before k. The oldest checkpoint always
+   holds every page. Log positions are absolute indices; `*_base` is the
+   index of the first entry still kept in memory.
+*/
+
+#define DATA_PAGES PAGE_COUNT
+
+typedef struct
+{
+  QWord position; // Instructions executed before this checkpoint
+  QWord cycles;
+  CPU6502 cpu;
+  QWord read_pos;
+  QWord irq_pos;
+  int page_count;
+  Byte *pages[DATA_PAGES]; // NULL: unchanged since the previous one
+} Checkpoint;
+
+ReverseMode reverse_mode = REVERSE_OFF;
+
+static Checkpoint *checkpoints;
+static int checkpoint_count;
+static size_t checkpoint_capacity;
+
+static QWord interval;
+static QWord next_checkpoint;
+static size_t budget;
+static size_t bytes_used;
+
+static QWord position;
+static QWord frontier;
+
+static Byte *read_log;
+static QWord read_base, read_end, read_pos;
+static size_t read_capacity;
+
+static QWord *irq_log;
+static QWord irq_base, irq_end, irq_pos;
+static size_t irq_capacity;
+
+// Write counters per backing page at the last checkpoint.
+static DWord page_seen[DATA_PAGES];
+
+// Live device state, parked while replaying.
+static QWord live_irq_lines;
+static QWord live_next_event;
+static bool live_unthrottled;
+
+static Bus6502 replay_bus;
+
+static size_t
+checkpoint_bytes (const Checkpoint *cp)
+{
+  return sizeof (Checkpoint) + (size_t)cp->page_count * PAGE_SIZE;
+}
+
+static bool
+grow (void **buffer, size_t *capacity, size_t used, size_t item)
+{
+  if (used < *capacity)
+    return true;
+
+  size_t next = *capacity ? *capacity * 2 : 4096;
+  void *grown = realloc (*buffer, next * item);
+  if (grown == NULL)
+    return false;
+  *buffer = grown;
+  *capacity = next;
+  return true;
+}
+
+/*
+   Event log
+*/
+
+// A history with a missing event cannot be replayed: give it up.
+static void
+log_full (void)
+{
+  fprintf (stderr, "[REVERSE] Out of memory for the event log, recording "
+                   "stopped\n");
+  reverse_stop ();
+}
+
+void
+reverse_log_read (Byte value)
+{
+  if (!grow ((void **)&read_log, &read_capacity, read_end - read_base, 1))
+    {
+      log_full ();
+      return;
+    }
+  read_log[read_end++ - read_base] = value;
+  read_pos = read_end;
+  bytes_used++;
+}
+
+Byte
+reverse_next_read (void)
+{
+  if (read_pos < read_base || read_pos >= read_end)
+    return 0xFF; // Not recorded: only possible after editing the past
+  return read_log[read_pos++ - read_base];
+}
+
+static void
+log_irq (void)
+{
+  if (!grow ((void **)&irq_log, &irq_capacity, irq_end - irq_base,
+             sizeof (QWord)))
+    {
+      log_full ();
+      return;
+    }
+  irq_log[irq_end++ - irq_base] = position;
+  irq_pos = irq_end;
+  bytes_used += sizeof (QWord);
+}
+
+// Drops the log entries older than the oldest checkpoint.
+static void
+trim_logs (void)
+{
+  const Checkpoint *oldest = &checkpoints[0];
+
+  memmove (read_log, read_log + (oldest->read_pos - read_base),
+           read_end - oldest->read_pos);
+  bytes_used -= oldest->read_pos - read_base;
+  read_base = oldest->read_pos;
+
+  memmove (irq_log, irq_log + (oldest->irq_pos - irq_base),
+           (irq_end - oldest->irq_pos) * sizeof (QWord));
+  bytes_used -= (oldest->irq_pos - irq_base) * sizeof (QWord);
+  irq_base = oldest->irq_pos;
+}
+
+/*
+   Checkpoints
+*/
+
+// Current write version of each backing page (mirrors share storage).
+static void
+page_versions (const MEM6502 *memory, DWord versions[DATA_PAGES])
+{
+  memset (versions, 0, DATA_PAGES * sizeof (DWord));
+  for (int page = 0; page < PAGE_COUNT; page++)
+    versions[mem6502_backing_page (memory, page)]
+        += memory->Pages[page].Writes;
+}
+
+// Newest stored copy of a data page, or NULL before the first checkpoint.
+static const Byte *
+latest_copy (int page)
+{
+  for (int i = checkpoint_count - 1; i >= 0; i--)
+    if (checkpoints[i].pages[page])
+      return checkpoints[i].pages[page];
+  return NULL;
+}
+
+static bool
+take_checkpoint (const MEM6502 *memory, const CPU6502 *cpu)
+{
+  if (!grow ((void **)&checkpoints, &checkpoint_capacity,
+             checkpoint_count, sizeof (Checkpoint)))
+    return false;
+
+  Checkpoint *cp = &checkpoints[checkpoint_count];
+  memset (cp, 0, sizeof (*cp));
+  cp->position = position;
+  cp->cycles = total_cycles_executed;
+  cp->cpu = *cpu;
+  cp->read_pos = read_end;
+  cp->irq_pos = irq_end;
+
+  DWord versions[DATA_PAGES];
+  page_versions (memory, versions);
+
+  for (int page = 0; page < DATA_PAGES; page++)
+    {
+      if (checkpoint_count > 0 && versions[page] == page_seen[page])
+        continue;
+
+      // Written, but possibly with the same values (polling loops, replays).
+      const Byte *data = &memory->Data[page * PAGE_SIZE];
+      const Byte *previous = latest_copy (page);
+      page_seen[page] = versions[page];
+      if (previous && memcmp (previous, data, PAGE_SIZE) == 0)
+        continue;
+
+      cp->pages[page] = malloc (PAGE_SIZE);
+      if (cp->pages[page] == NULL)
+        continue; // Out of memory: history gets less exact
+      memcpy (cp->pages[page], data, PAGE_SIZE);
+      cp->page_count++;
+    }
+
+  checkpoint_count++;
+  bytes_used += checkpoint_bytes (cp);
+  next_checkpoint = position + interval;
+  return true;
+}
+
+// Folds checkpoint i into checkpoint i + 1 and removes it. Pages i + 1
+// does not have are the ones it would have taken from i.
+static void
+merge_checkpoint (int i)
+{
+  Checkpoint *cp = &checkpoints[i];
+  Checkpoint *next = &checkpoints[i + 1];
+
+  bytes_used -= checkpoint_bytes (cp) + checkpoint_bytes (next);
+  for (int page = 0; page < DATA_PAGES; page++)
+    {
+      if (cp->pages[page] == NULL)
+        continue;
+      if (next->pages[page] == NULL)
+        {
+          next->pages[page] = cp->pages[page];
+          next->page_count++;
+        }
+      else
+        free (cp->pages[page]);
+    }
+  bytes_used += checkpoint_bytes (next);
+
+  memmove (cp, next, (checkpoint_count - i - 1) * sizeof (Checkpoint));
+  checkpoint_count--;
+}
+
+// Keeps memory bounded: fewer, sparser checkpoints first, then a shorter
+// history.
+static void
+enforce_budget (void)
+{
+  if (checkpoint_count > REVERSE_MAX_CHECKPOINTS)
+    {
+      // Drop every second checkpoint, never the oldest or the newest.
+      for (int i = 1; i < checkpoint_count - 1; i++)
+        merge_checkpoint (i);
+      interval *= 2;
+    }
+
+  bool dropped = false;
+  while (bytes_used > budget && checkpoint_count > 1)
+    {
+      merge_checkpoint (0);
+      dropped = true;
+    }
+  if (dropped)
+    trim_logs ();
+}
+
+static void
+free_checkpoints (void)
+{
+  for (int i = 0; i < checkpoint_count; i++)
+    for (int page = 0; page < DATA_PAGES; page++)
+      free (checkpoints[i].pages[page]);
+  free (checkpoints);
+  checkpoints = NULL;
+  checkpoint_count = checkpoint_capacity = 0;
+}
+
+/*
+   Replay
+*/
+
+static void
+enter_replay (void)
+{
+  if (reverse_mode == REVERSE_REPLAY)
+    return;
+
+  live_irq_lines = mmio_irq_lines;
+  live_next_event = mmio_next_event;
+  live_unthrottled = clock_unthrottled;
+
+  // Devices are frozen at the present; nothing may tick them.
+  mmio_next_event = MMIO_NO_EVENT;
+  clock_unthrottled = true;
+  reverse_mode = REVERSE_REPLAY;
+}
+
+static void
+leave_replay (void)
+{
+  mmio_irq_lines = live_irq_lines;
+  mmio_next_event = live_next_event;
+  clock_unthrottled = live_unthrottled;
+  reverse_mode = REVERSE_RECORD;
+
+  // Pace from here, not from the time spent in the past.
+  clock_init ();
+}
+
+static void
+restore_checkpoint (int k, MEM6502 *memory, CPU6502 *cpu)
+{
+  const Checkpoint *cp = &checkpoints[k];
+  bool restored[DATA_PAGES] = { false };
+
+  enter_replay ();
+
+  for (int i = k; i >= 0; i--)
+    for (int page = 0; page < DATA_PAGES; page++)
+      if (!restored[page] && checkpoints[i].pages[page])
+        {
+          memcpy (&memory->Data[page * PAGE_SIZE], checkpoints[i].pages[page],
+                  PAGE_SIZE);
+          restored[page] = true;
+        }
+  markMem6502Dirty (memory);
+
+  *cpu = cp->cpu;
+  total_cycles_executed = cp->cycles;
+  position = cp->position;
+  read_pos = cp->read_pos;
+  irq_pos = cp->irq_pos;
+  breakpoint_rearm ();
+
+  if (position == frontier)
+    leave_replay ();
+}
+
+// Runs one instruction, recording or replaying its events. Returns what
+// run_cpu_instruction returned.
+static bool
+execute (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  bool irq;
+
+  if (reverse_mode == REVERSE_REPLAY)
+    {
+      irq = irq_pos < irq_end && irq_log[irq_pos - irq_base] == position;
+      mmio_irq_lines = irq ? 1 : 0;
+    }
+  else
+    irq = mmio_irq_lines && !cpu->Flag.I;
+
+  bool ok = run_cpu_instruction (bus, memory, cpu);
+
+  // Only a PC breakpoint stops before the instruction runs.
+  bool executed = ok || breakpoint_last_hit.id == 0
+                  || breakpoint_last_hit.kind != BREAK_EXEC;
+  if (!executed)
+    return false;
+
+  if (irq && reverse_mode == REVERSE_REPLAY)
+    irq_pos++;
+  else if (irq)
+    log_irq ();
+
+  position++;
+  if (reverse_mode == REVERSE_RECORD)
+    frontier = position;
+  else if (reverse_mode == REVERSE_REPLAY && position == frontier)
+    leave_replay ();
+  return ok;
+}
+
+// Replays up to `target`, stepping over breakpoints. Reports the last hit
+// before `target` through *hit_at (UINT64_MAX if none) and *hit.
+static void
+replay_to (MEM6502 *memory, CPU6502 *cpu, QWord target, QWord *hit_at,
+           BreakHit *hit)
+{
+  if (hit_at)
+    *hit_at = UINT64_MAX;
+
+  while (position < target && !mmio_exit_requested)
+    {
+      if (execute (&replay_bus, memory, cpu) || !breakpoint_stop_pending)
+        continue;
+
+      if (hit_at && breakpoint_last_hit.id != 0 && position < target)
+        {
+          *hit_at = position;
+          *hit = breakpoint_last_hit;
+        }
+      breakpoint_resume (cpu);
+    }
+  breakpoint_rearm ();
+}
+
+// Newest checkpoint at or before `target`.
+static int
+checkpoint_before (QWord target)
+{
+  int k = checkpoint_count - 1;
+  while (k > 0 && checkpoints[k].position > target)
+    k--;
+  return k;
+}
+
+static void
+seek (MEM6502 *memory, CPU6502 *cpu, QWord target)
+{
+  restore_checkpoint (checkpoint_before (target), memory, cpu);
+  replay_to (memory, cpu, target, NULL, NULL);
+}
+
+/*
+   Public interface
+*/
+
+bool
+reverse_start (MEM6502 *memory, const CPU6502 *cpu, QWord every,
+               size_t max_bytes)
+{
+  reverse_stop ();
+
+  interval = every ? every : REVERSE_DEFAULT_INTERVAL;
+  budget = max_bytes ? max_bytes : REVERSE_DEFAULT_BUDGET;
+  position = frontier = 0;
+  reverse_mode = REVERSE_RECORD;
+
+  if (!take_checkpoint (memory, cpu))
+    {
+      reverse_stop ();
+      return false;
+    }
+  return true;
+}
+
+void
+reverse_stop (void)
+{
+  if (reverse_mode == REVERSE_REPLAY)
+    leave_replay ();
+  reverse_mode = REVERSE_OFF;
+
+  free_checkpoints ();
+  free (read_log);
+  free (irq_log);
+  read_log = NULL;
+  irq_log = NULL;
+  read_capacity = irq_capacity = 0;
+  read_base = read_end = read_pos = 0;
+  irq_base = irq_end = irq_pos = 0;
+  bytes_used = 0;
+}
+
+bool
+reverse_run_instruction (Bus6502 *bus, MEM6502 *memory, CPU6502 *cpu)
+{
+  if (reverse_mode == REVERSE_OFF)
+    return run_cpu_instruction (bus, memory, cpu);
+
+  if (reverse_mode == REVERSE_RECORD && position >= next_checkpoint
+      && take_checkpoint (memory, cpu))
+    enforce_budget ();
+
+  return execute (bus, memory, cpu);
+}
+
+bool
+reverse_step (MEM6502 *memory, CPU6502 *cpu)
+{
+  if (reverse_mode == REVERSE_OFF || position <= checkpoints[0].position)
+    return false;
+
+  seek (memory, cpu, position - 1);
+  breakpoint_last_hit.id = 0;
+  return true;
+}
+
+bool
+reverse_continue (MEM6502 *memory, CPU6502 *cpu)
+{
+  if (reverse_mode == REVERSE_OFF)
+    return false;
+
+  QWord end = position;
+  for (int k = checkpoint_before (end); k >= 0; k--)
+    {
+      if (checkpoints[k].position >= end)
+        continue;
+
+      QWord hit_at;
+      BreakHit hit;
+      restore_checkpoint (k, memory, cpu);
+      replay_to (memory, cpu, end, &hit_at, &hit);
+
+      if (hit_at != UINT64_MAX)
+        {
+          seek (memory, cpu, hit_at);
+          breakpoint_last_hit = hit;
+          return true;
+        }
+      end = checkpoints[k].position;
+    }
+
+  // Nothing recorded before: stop at the start of history.
+  restore_checkpoint (0, memory, cpu);
+  breakpoint_last_hit.id = 0;
+  return false;
+}
+
+QWord
+reverse_position (void)
+{
+  return position;
+}
+
+QWord
+reverse_frontier (void)
+{
+  return frontier;
+}
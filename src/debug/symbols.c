@@ -0,0 +1,220 @@
+#include "symbols.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+   Symbols are kept in one array sorted by address; lookups are a binary
+   search. At equal addresses labels sort before constants so that the
+   name printed for a code address is the label, not an equate that
+   happens to share its value.
+*/
+
+typedef struct
+{
+  Word address;
+  bool label;
+  char *name;
+} Symbol;
+
+static Symbol *symbols;
+static int symbol_count;
+static int symbol_capacity;
+static bool sorted = true;
+
+static void
+symbols_add (const char *name, size_t len, unsigned long value, bool label)
+{
+  if (len == 0 || value > 0xFFFF)
+    return;
+
+  if (symbol_count == symbol_capacity)
+    {
+      int capacity = symbol_capacity ? symbol_capacity * 2 : 256;
+      Symbol *grown = realloc (symbols, capacity * sizeof (Symbol));
+      if (grown == NULL)
+        return;
+      symbols = grown;
+      symbol_capacity = capacity;
+    }
+
+  char *copy = malloc (len + 1);
+  if (copy == NULL)
+    return;
+  memcpy (copy, name, len);
+  copy[len] = '\0';
+
+  symbols[symbol_count].address = (Word)value;
+  symbols[symbol_count].label = label;
+  symbols[symbol_count].name = copy;
+  symbol_count++;
+  sorted = false;
+}
+
+static int
+compare_symbols (const void *a, const void *b)
+{
+  const Symbol *x = a, *y = b;
+
+  if (x->address != y->address)
+    return x->address < y->address ? -1 : 1;
+  if (x->label != y->label)
+    return x->label ? -1 : 1;
+  return strcmp (x->name, y->name);
+}
+
+static void
+sort_symbols (void)
+{
+  if (!sorted)
+    qsort (symbols, symbol_count, sizeof (Symbol), compare_symbols);
+  sorted = true;
+}
+
+// Value of `key=` in a cc65 .dbg line, or NULL.
+static const char *
+dbg_field (const char *line, const char *key)
+{
+  size_t len = strlen (key);
+
+  for (const char *p = line; (p = strstr (p, key)) != NULL; p += len)
+    if ((p == line || p[-1] == '\t' || p[-1] == ',') && p[len] == '=')
+      return p + len + 1;
+  return NULL;
+}
+
+// sym id=3,name="reset",addrsize=absolute,scope=0,def=12,val=0xE000,...
+static void
+parse_dbg_line (const char *line)
+{
+  const char *name = dbg_field (line, "name");
+  const char *value = dbg_field (line, "val");
+  const char *type = dbg_field (line, "type");
+
+  if (name == NULL || value == NULL || *name != '"')
+    return;
+
+  name++;
+  const char *end = strchr (name, '"');
+  if (end == NULL)
+    return;
+
+  bool label = type == NULL || strncmp (type, "lab", 3) == 0;
+  symbols_add (name, end - name, strtoul (value, NULL, 0), label);
+}
+
+// al 00E000 .reset
+static void
+parse_vice_line (const char *line)
+{
+  char *end;
+  unsigned long value = strtoul (line + 3, &end, 16);
+
+  while (*end == ' ' || *end == '\t')
+    end++;
+  if (*end == '.')
+    end++;
+  symbols_add (end, strcspn (end, " \t\r\n"), value, true);
+}
+
+// reset                     00E000 RLA    nmi                       00E040 RLA
+static void
+parse_map_exports (const char *line)
+{
+  char name[128], flags[8];
+  unsigned long value;
+  int used;
+
+  while (sscanf (line, " %127s %lx %7s%n", name, &value, flags, &used) == 3)
+    {
+      // Exports flagged 'L' are labels; the others are equates.
+      symbols_add (name, strlen (name), value, strchr (flags, 'L') != NULL);
+      line += used;
+    }
+}
+
+bool
+symbols_load (const char *path)
+{
+  FILE *f = fopen (path, "r");
+  if (f == NULL)
+    {
+      perror (path);
+      return false;
+    }
+
+  char line[1024];
+  bool in_exports = false;
+  int before = symbol_count;
+
+  while (fgets (line, sizeof (line), f))
+    {
+      if (strncmp (line, "sym\t", 4) == 0)
+        parse_dbg_line (line + 4);
+      else if (strncmp (line, "al ", 3) == 0)
+        parse_vice_line (line);
+      else if (strncmp (line, "Exports list", 12) == 0)
+        in_exports = true;
+      else if (in_exports && strncmp (line, "Imports list", 12) == 0)
+        in_exports = false;
+      else if (in_exports && line[0] != '-' && line[0] != '\n')
+        parse_map_exports (line);
+    }
+  fclose (f);
+
+  sort_symbols ();
+  if (symbol_count == before)
+    {
+      fprintf (stderr, "%s: no symbols found\n", path);
+      return false;
+    }
+  return true;
+}
+
+void
+symbols_clear (void)
+{
+  for (int i = 0; i < symbol_count; i++)
+    free (symbols[i].name);
+  free (symbols);
+  symbols = NULL;
+  symbol_count = symbol_capacity = 0;
+  sorted = true;
+}
+
+int
+symbols_count (void)
+{
+  return symbol_count;
+}
+
+const char *
+symbols_lookup (Word address)
+{
+  int lo = 0, hi = symbol_count;
+
+  // First entry at or above `address`.
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (symbols[mid].address < address)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo < symbol_count && symbols[lo].address == address)
+    return symbols[lo].name;
+  return NULL;
+}
+
+bool
+symbols_find (const char *name, Word *address)
+{
+  for (int i = 0; i < symbol_count; i++)
+    if (strcmp (symbols[i].name, name) == 0)
+      {
+        *address = symbols[i].address;
+        return true;
+      }
+  return false;
+}
@@ -5,14 +5,22 @@
 #include "mem6502.h"
 #include "render_ram.h"
 #include "mmio.h"
+#include "snapshot.h"
+#include "breakpoint.h"
+#include "gdb_stub.h"
+#include "symbols.h"
+#include "reverse.h"
+#include "journal.h"
+#include "coverage.h"
 
+#define RUN_SLICE 1024 // Instructions between RAM viewer polls
 
 int
 main (int argc, char *argv[])
 {
 
   char *bin_file = NULL;
-  Word load_addr = ROM_START;
+  Word load_addr;
 
   debug_set_level(DEBUG_OFF);
   int program_start;
@@ -23,7 +31,21 @@ main (int argc, char *argv[])
 
   FILE *fptr;
   int enable_ram_view = 0;
+  int ram_view_hz = RAM_VIEW_DEFAULT_HZ;
   char *mmio_file = NULL;
+  char *snapshot_in = NULL;
+  char *snapshot_out = NULL;
+  const char *break_specs[BREAKPOINT_MAX];
+  int break_count = 0;
+  char *gdb_address = NULL;
+  bool keep_running = true;
+  bool reverse = false;
+  QWord reverse_interval = 0;
+  size_t reverse_budget = 0;
+  char *journal_out = NULL;
+  char *journal_in = NULL;
+  bool replay_ok = true;
+  char *coverage_out = NULL;
 
   for (int i = 1; i < argc; i++)
     {
@@ -31,6 +53,10 @@ main (int argc, char *argv[])
         {
           enable_ram_view = 1;
         }
+      if (strcmp (argv[i], "--ram-hz") == 0 && i + 1 < argc)
+        {
+          ram_view_hz = atoi (argv[++i]);
+        }
       if ((strcmp(argv[i], "--bin") == 0 || strcmp(argv[i], "-b") == 0) && i + 1 < argc)
         {
             bin_file = argv[++i];
@@ -39,6 +65,64 @@ main (int argc, char *argv[])
         {
             mmio_file = argv[++i];
         }
+      if ((strcmp(argv[i], "--break") == 0 || strcmp(argv[i], "-B") == 0)
+          && i + 1 < argc && break_count < BREAKPOINT_MAX)
+        {
+            break_specs[break_count++] = argv[++i];
+        }
+      if (strcmp(argv[i], "--gdb") == 0 && i + 1 < argc)
+        {
+            gdb_address = argv[++i];
+        }
+      if (strcmp(argv[i], "--symbols") == 0 && i + 1 < argc)
+        {
+            if (!symbols_load (argv[++i]))
+              return 1;
+        }
+      if (strcmp(argv[i], "--trace") == 0)
+        {
+            debug_set_level(DEBUG_TRACE);
+        }
+      if (strcmp(argv[i], "--reverse") == 0)
+        {
+            reverse = true;
+        }
+      if (strcmp(argv[i], "--reverse-interval") == 0 && i + 1 < argc)
+        {
+            reverse = true;
+            reverse_interval = strtoull (argv[++i], NULL, 0);
+        }
+      if (strcmp(argv[i], "--reverse-budget") == 0 && i + 1 < argc)
+        {
+            reverse = true;
+            reverse_budget = (size_t)strtoull (argv[++i], NULL, 0) << 20;
+        }
+      if (strcmp(argv[i], "--deterministic") == 0)
+        {
+            clock_unthrottled = true;
+        }
+      if (strcmp(argv[i], "--journal-out") == 0 && i + 1 < argc)
+        {
+            clock_unthrottled = true;
+            journal_out = argv[++i];
+        }
+      if (strcmp(argv[i], "--journal-in") == 0 && i + 1 < argc)
+        {
+            clock_unthrottled = true;
+            journal_in = argv[++i];
+        }
+      if (strcmp(argv[i], "--snapshot-in") == 0 && i + 1 < argc)
+        {
+            snapshot_in = argv[++i];
+        }
+      if (strcmp(argv[i], "--snapshot-out") == 0 && i + 1 < argc)
+        {
+            snapshot_out = argv[++i];
+        }
+      if (strcmp(argv[i], "--coverage") == 0 && i + 1 < argc)
+        {
+            coverage_out = argv[++i];
+        }
 
     }
 
@@ -51,6 +135,14 @@ main (int argc, char *argv[])
       mmio_load_config("./firmware/mmio.cfg");
   }
 
+  // Rebuild the page table now that the board layout and devices are known.
+  memory_map_compile(&mem);
+  load_addr = memory_map_rom_start();
+
+  for (int i = 0; i < break_count; i++)
+    if (breakpoint_parse (&mem, break_specs[i]) < 0)
+      printf ("Invalid breakpoint: %s\n", break_specs[i]);
+
 
   printf("Trying to load file: %s\n", bin_file);
 
@@ -68,14 +160,86 @@ main (int argc, char *argv[])
   // init sync clock
   clock_init ();
 
+  // Resume from a saved machine state (same mmio.cfg) instead of reset.
+  if (snapshot_in)
+    {
+      Snapshot snap = { 0 };
+      if (!snapshot_read (&snap, snapshot_in)
+          || !snapshot_restore (&snap, &cpu, &mem))
+        return 1;
+      snapshot_free (&snap);
+      printf ("Resumed from %s at PC = %04X\n", snapshot_in, cpu.PC);
+    }
+
+  // Executed code accumulates into the file across runs.
+  if (coverage_out)
+    {
+      coverage_bits = calloc (1, sizeof (CoverageBits));
+      if (coverage_bits == NULL
+          || !coverage_bits_merge (coverage_bits, coverage_out, true))
+        return 1;
+    }
+
+  // Host input is recorded or replayed from here on.
+  if (journal_out && !journal_record (journal_out))
+    return 1;
+  if (journal_in && !journal_replay (journal_in))
+    return 1;
+
+  // Record history from here so debuggers can step backwards.
+  if (reverse && !reverse_start (&mem, &cpu, reverse_interval, reverse_budget))
+    return 1;
+
+  // A debugger drives execution until it detaches.
+  if (gdb_address)
+    {
+      if (!gdb_stub_listen (gdb_address))
+        return 1;
+      keep_running = gdb_stub_run (&bus, &mem, &cpu);
+    }
+
+  // The RAM viewer watches memory while the program runs.
+  if (enable_ram_view && !ram_view_start (&mem, ram_view_hz))
+    enable_ram_view = 0;
+
   // REMOVE THIS IF YOU DON'T WANT EXIT MMIO
-  while (!mmio_exit_requested && run_cpu_instruction(&bus, &mem, &cpu)) {
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  while (keep_running) {
+      StopReason stop = run_instructions (&machine, RUN_SLICE);
+      if (stop == STOP_EXIT)
+          break;
+      if (stop == STOP_BREAKPOINT) {
+          // Ask what to do next. Nothing serves the viewer meanwhile.
+          if (enable_ram_view)
+              ram_view_pause (&mem, true);
+          bool resume = breakpoint_stop_pending
+                        && breakpoint_prompt (&mem, &cpu);
+          if (enable_ram_view)
+              ram_view_pause (&mem, false);
+          if (!resume)
+              break;
+          continue;
+      }
+      ram_view_poll (&mem);
   }
 
+  if (journal_mode != JOURNAL_OFF)
+    replay_ok = journal_finish (&cpu, &mem);
+
+  if (snapshot_out)
+    {
+      Snapshot snap = { 0 };
+      if (snapshot_take (&snap, &cpu, &mem))
+        snapshot_write (&snap, snapshot_out);
+      snapshot_free (&snap);
+    }
+
+  if (coverage_out)
+    coverage_bits_write (coverage_bits, coverage_out);
 
   if (enable_ram_view)
     {
-      render_ram_matrix (mem);
+      ram_view_finish ();
     }
 
   goto end;
@@ -86,7 +250,10 @@ end:
   cpu_read(&bus, &mem, 0x42, &cpu);
 
   freeMem6502(&mem);
+  mmio_unload_all();
 
+  reverse_stop();
+  symbols_clear();
   close_log();
-  return 0;
+  return replay_ok ? 0 : 1;
 }
@@ -1,12 +1,16 @@
 #include "mmio.h"
 #include <stdio.h>
 
-Byte mmio_read_default(Word addr) {
+Byte mmio_read_default(void *ctx, Word addr, QWord cycle) {
+    (void)ctx;
+    (void)cycle;
     printf("[MMIO READ] %04X -> default\n", addr);
     return 0;
 }
 
-void mmio_write_default(Word addr, Byte data) {
+void mmio_write_default(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)ctx;
+    (void)cycle;
     printf("[MMIO WRITE] %04X <= %02X (default)\n", addr, data);
 }
 
@@ -15,8 +19,10 @@ void mmio_write_default(Word addr, Byte data) {
 int mmio_exit_requested = 0;
 Byte mmio_exit_code = 0;
 
-void mmio_exit(Word addr, Byte data) {
+void mmio_exit(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)ctx;
     (void)addr;
+    (void)cycle;
     mmio_exit_code = data;
     mmio_exit_requested = 1;
     printf("[EXIT] requested (code=%02X)\n", data);
@@ -24,7 +30,10 @@ void mmio_exit(Word addr, Byte data) {
 }
 
 
-Byte get_key(Word addr) {
+Byte get_key(void *ctx, Word addr, QWord cycle) {
+    (void)ctx;
+    (void)addr;
+    (void)cycle;
     printf("[MMIO KEYBD] waiting for key...\n");
     int c = getchar();
     printf("[MMIO KEYBD] got '%c' (%02X)\n", c, (unsigned char)c);
@@ -32,11 +41,16 @@ Byte get_key(Word addr) {
 }
 
 
-void print_char(Word addr, Byte data) {
+void print_char(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)ctx;
+    (void)addr;
+    (void)cycle;
     printf("[PRINTCHAR %02X '%c']\n", data, data);
     fflush(stdout);
 }
 
-void vram_write(Word addr, Byte data) {
+void vram_write(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)ctx;
+    (void)cycle;
     printf("[VRAM] %04X <= %02X\n", addr, data);
 }
@@ -0,0 +1,477 @@
+#include "mmio.h"
+#include "framebuffer.h"
+#include "cpu6502.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+   FRAMEBUFFER - Pixel memory device (device=framebuffer)
+
+   Maps the device range as video memory: bytes written by the firmware are
+   stored as packed pixels (and can be read back), while the host side only
+   sees finished frames. Writes mark the rows they touch as dirty; once per
+   frame period the dirty rows are converted to RGB and published, so a
+   frame where nothing changed costs nothing and a frame that changed one row
+   rewrites one row.
+
+   Pixels are packed most significant bits first, `8 / bpp` pixels per byte,
+   rows top to bottom. The range must be at least width * height * bpp / 8
+   bytes long.
+
+   mmio.cfg options (args=, comma separated):
+     width=<n> height=<n>   geometry in pixels (default 16x16)
+     bpp=1|2|4|8            bits per pixel (default 8)
+     palette=<name|path>    gray, c64, rgb332 or a file with one RRGGBB
+                            value per line (default rgb332 at 8 bpp, gray
+                            otherwise)
+     fps=<n>                frames per emulated second (default 30)
+     out=<path>             binary PPM kept up to date in place; a path
+                            with one %d or %0Nd (e.g. frame%05d.ppm)
+                            writes one file per presented frame instead
+     shm=<name>             POSIX shared memory segment, see framebuffer.h
+*/
+
+#define FB_DEFAULT_SIZE 16
+#define FB_DEFAULT_FPS 30
+#define FB_PPM_HEADER_MAX 32
+
+typedef struct {
+    int width;
+    int height;
+    int bpp;
+    size_t size;          // Bytes of video memory
+    Word base;
+
+    Byte *vram;
+    Byte palette[256][3];
+
+    Byte *rgb;            // width * height * 3, inside the shm segment if any
+    Byte *row_dirty;      // One flag per row
+    int dirty_first;      // Range of flagged rows, first > last when clean
+    int dirty_last;
+
+    QWord period;         // Cycles per frame
+    QWord next_frame;     // Next presentation, MMIO_NO_EVENT while clean
+    uint32_t frame;
+
+    char out_path[128];   // In-place PPM, or the part before %d
+    bool out_sequence;    // out= contains a %d conversion
+    int out_digits;       // Zero-padded width of the frame number
+    char out_suffix[64];  // Part of out= after %d
+    int out_fd;           // In-place PPM, -1 if unused
+    long ppm_header;      // Offset of the pixel data in the PPM
+
+    char shm_name[64];
+    FramebufferShm *shm;
+    size_t shm_size;
+} Framebuffer;
+
+static const Byte c64_palette[16][3] = {
+    {0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}, {0x88, 0x00, 0x00},
+    {0xAA, 0xFF, 0xEE}, {0xCC, 0x44, 0xCC}, {0x00, 0xCC, 0x55},
+    {0x00, 0x00, 0xAA}, {0xEE, 0xEE, 0x77}, {0xDD, 0x88, 0x55},
+    {0x66, 0x44, 0x00}, {0xFF, 0x77, 0x77}, {0x33, 0x33, 0x33},
+    {0x77, 0x77, 0x77}, {0xAA, 0xFF, 0x66}, {0x00, 0x88, 0xFF},
+    {0xBB, 0xBB, 0xBB},
+};
+
+static bool fb_load_palette(Framebuffer *fb, const char *name) {
+    int colors = 1 << fb->bpp;
+
+    if (strcmp(name, "gray") == 0) {
+        for (int i = 0; i < colors; i++) {
+            Byte level = (Byte)(i * 255 / (colors - 1));
+            fb->palette[i][0] = fb->palette[i][1] = fb->palette[i][2] = level;
+        }
+        return true;
+    }
+    if (strcmp(name, "rgb332") == 0) {
+        for (int i = 0; i < 256; i++) {
+            fb->palette[i][0] = (Byte)(((i >> 5) & 7) * 255 / 7);
+            fb->palette[i][1] = (Byte)(((i >> 2) & 7) * 255 / 7);
+            fb->palette[i][2] = (Byte)((i & 3) * 255 / 3);
+        }
+        return true;
+    }
+    if (strcmp(name, "c64") == 0) {
+        for (int i = 0; i < 256; i++)
+            memcpy(fb->palette[i], c64_palette[i % 16], 3);
+        return true;
+    }
+
+    FILE *f = fopen(name, "r");
+    if (!f) {
+        perror(name);
+        return false;
+    }
+    char line[64];
+    int i = 0;
+    while (i < 256 && fgets(line, sizeof(line), f)) {
+        const char *p = line;
+        while (isspace((unsigned char)*p) || *p == '#')
+            p++;
+        if (!isxdigit((unsigned char)*p))
+            continue;
+        unsigned long rgb = strtoul(p, NULL, 16);
+        fb->palette[i][0] = (Byte)(rgb >> 16);
+        fb->palette[i][1] = (Byte)(rgb >> 8);
+        fb->palette[i][2] = (Byte)rgb;
+        i++;
+    }
+    fclose(f);
+    return true;
+}
+
+static void fb_mark_all(Framebuffer *fb) {
+    memset(fb->row_dirty, 1, (size_t)fb->height);
+    fb->dirty_first = 0;
+    fb->dirty_last = fb->height - 1;
+}
+
+static void fb_mark_row(Framebuffer *fb, int row) {
+    if (row >= fb->height)
+        return;
+    fb->row_dirty[row] = 1;
+    if (row < fb->dirty_first)
+        fb->dirty_first = row;
+    if (row > fb->dirty_last)
+        fb->dirty_last = row;
+}
+
+static void fb_convert_row(Framebuffer *fb, int row) {
+    int per_byte = 8 / fb->bpp;
+    Byte mask = (Byte)((1 << fb->bpp) - 1);
+    size_t pixel = (size_t)row * fb->width;
+    Byte *out = fb->rgb + pixel * 3;
+
+    for (int x = 0; x < fb->width; x++, pixel++, out += 3) {
+        Byte packed = fb->vram[pixel / per_byte];
+        int shift = 8 - fb->bpp * (int)(pixel % per_byte + 1);
+        memcpy(out, fb->palette[(packed >> shift) & mask], 3);
+    }
+}
+
+static int fb_ppm_header(const Framebuffer *fb, char *buf, size_t size) {
+    return snprintf(buf, size, "P6\n%d %d\n255\n", fb->width, fb->height);
+}
+
+static void fb_write_sequence(Framebuffer *fb) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s%0*d%s", fb->out_path, fb->out_digits,
+             (int)fb->frame, fb->out_suffix);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return;
+    }
+    char header[FB_PPM_HEADER_MAX];
+    fwrite(header, 1, (size_t)fb_ppm_header(fb, header, sizeof(header)), f);
+    fwrite(fb->rgb, 3, (size_t)fb->width * fb->height, f);
+    fclose(f);
+}
+
+// Rewrites each run of dirty rows of the in-place PPM with one pwrite.
+static void fb_write_rows(Framebuffer *fb) {
+    size_t row_bytes = (size_t)fb->width * 3;
+    int row = fb->dirty_first;
+
+    while (row <= fb->dirty_last) {
+        if (!fb->row_dirty[row]) {
+            row++;
+            continue;
+        }
+        int first = row;
+        while (row <= fb->dirty_last && fb->row_dirty[row])
+            row++;
+        size_t length = (size_t)(row - first) * row_bytes;
+        off_t offset = fb->ppm_header + (off_t)(first * row_bytes);
+        if (pwrite(fb->out_fd, fb->rgb + first * row_bytes, length, offset) < 0)
+            perror(fb->out_path);
+    }
+}
+
+// Publishes the dirty rows, then forgets them.
+static void fb_present(Framebuffer *fb) {
+    if (fb->dirty_first > fb->dirty_last)
+        return;
+
+    for (int row = fb->dirty_first; row <= fb->dirty_last; row++)
+        if (fb->row_dirty[row])
+            fb_convert_row(fb, row);
+
+    if (fb->out_sequence)
+        fb_write_sequence(fb);
+    else if (fb->out_fd >= 0)
+        fb_write_rows(fb);
+
+    fb->frame++;
+    if (fb->shm) {
+        fb->shm->dirty_first = (uint32_t)fb->dirty_first;
+        fb->shm->dirty_last = (uint32_t)fb->dirty_last;
+        atomic_store_explicit(&fb->shm->frame, fb->frame,
+                              memory_order_release);
+    }
+
+    memset(fb->row_dirty + fb->dirty_first, 0,
+           (size_t)(fb->dirty_last - fb->dirty_first + 1));
+    fb->dirty_first = fb->height;
+    fb->dirty_last = -1;
+}
+
+// Splits an out= sequence pattern around its single %d or %0Nd. Any other
+// use of % is refused, the path is never used as a format string.
+static bool fb_split_pattern(Framebuffer *fb) {
+    char *percent = strchr(fb->out_path, '%');
+    if (!percent)
+        return true;
+
+    char *conversion = percent + 1;
+    long digits = 0;
+    if (*conversion == '0')
+        digits = strtol(conversion, &conversion, 10);
+    if (*conversion != 'd' || digits > 32 || strchr(conversion, '%')) {
+        printf("[FRAMEBUFFER] out=%s: expected a single %%d or %%0Nd\n",
+               fb->out_path);
+        return false;
+    }
+
+    snprintf(fb->out_suffix, sizeof(fb->out_suffix), "%s", conversion + 1);
+    *percent = '\0';
+    fb->out_digits = (int)digits;
+    fb->out_sequence = true;
+    return true;
+}
+
+static bool fb_open_ppm(Framebuffer *fb) {
+    fb->out_fd = open(fb->out_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fb->out_fd < 0) {
+        perror(fb->out_path);
+        return false;
+    }
+
+    char header[FB_PPM_HEADER_MAX];
+    int length = fb_ppm_header(fb, header, sizeof(header));
+    fb->ppm_header = length;
+
+    // Full-size file up front, so each frame only rewrites its dirty rows.
+    off_t total = length + (off_t)fb->width * fb->height * 3;
+    if (write(fb->out_fd, header, (size_t)length) != length
+        || ftruncate(fb->out_fd, total) < 0) {
+        perror(fb->out_path);
+        return false;
+    }
+    return true;
+}
+
+static bool fb_open_shm(Framebuffer *fb) {
+    fb->shm_size = sizeof(FramebufferShm) + (size_t)fb->width * fb->height * 3;
+
+    int fd = shm_open(fb->shm_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(fb->shm_name);
+        return false;
+    }
+    if (ftruncate(fd, (off_t)fb->shm_size) < 0) {
+        perror(fb->shm_name);
+        close(fd);
+        return false;
+    }
+    void *map = mmap(NULL, fb->shm_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(fb->shm_name);
+        return false;
+    }
+
+    fb->shm = map;
+    fb->shm->magic = FRAMEBUFFER_SHM_MAGIC;
+    fb->shm->width = (uint32_t)fb->width;
+    fb->shm->height = (uint32_t)fb->height;
+    return true;
+}
+
+static void fb_destroy(void *ctx) {
+    Framebuffer *fb = ctx;
+
+    fb_present(fb); // Last partial frame
+
+    if (fb->out_fd >= 0)
+        close(fb->out_fd);
+    if (fb->shm) {
+        munmap(fb->shm, fb->shm_size);
+        shm_unlink(fb->shm_name);
+    } else {
+        free(fb->rgb);
+    }
+    free(fb->vram);
+    free(fb->row_dirty);
+    free(fb);
+}
+
+static void *fb_create(const MMIOHost *host, Word start, Word end,
+                       const char *args) {
+    (void)host;
+
+    Framebuffer *fb = calloc(1, sizeof(Framebuffer));
+    if (!fb)
+        return NULL;
+    fb->width = FB_DEFAULT_SIZE;
+    fb->height = FB_DEFAULT_SIZE;
+    fb->bpp = 8;
+    fb->base = start;
+    fb->out_fd = -1;
+    fb->dirty_first = 0;
+    fb->dirty_last = -1;
+    fb->next_frame = MMIO_NO_EVENT;
+
+    char palette[128] = {0};
+    unsigned long fps = FB_DEFAULT_FPS;
+
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", args);
+    for (char *opt = strtok(buf, ","); opt; opt = strtok(NULL, ",")) {
+        if (strncmp(opt, "width=", 6) == 0)
+            fb->width = atoi(opt + 6);
+        else if (strncmp(opt, "height=", 7) == 0)
+            fb->height = atoi(opt + 7);
+        else if (strncmp(opt, "bpp=", 4) == 0)
+            fb->bpp = atoi(opt + 4);
+        else if (strncmp(opt, "palette=", 8) == 0)
+            snprintf(palette, sizeof(palette), "%s", opt + 8);
+        else if (strncmp(opt, "fps=", 4) == 0)
+            fps = strtoul(opt + 4, NULL, 0);
+        else if (strncmp(opt, "out=", 4) == 0)
+            snprintf(fb->out_path, sizeof(fb->out_path), "%s", opt + 4);
+        else if (strncmp(opt, "shm=", 4) == 0)
+            snprintf(fb->shm_name, sizeof(fb->shm_name), "%s", opt + 4);
+        else
+            printf("[FRAMEBUFFER] unknown option %s\n", opt);
+    }
+
+    size_t range = (size_t)(end - start) + 1;
+    fb->size = ((size_t)fb->width * fb->height * fb->bpp + 7) / 8;
+
+    if ((fb->bpp != 1 && fb->bpp != 2 && fb->bpp != 4 && fb->bpp != 8)
+        || fb->width <= 0 || fb->height <= 0 || fb->size > range) {
+        printf("[FRAMEBUFFER] %dx%d at %d bpp does not fit %zu bytes\n",
+               fb->width, fb->height, fb->bpp, range);
+        free(fb);
+        return NULL;
+    }
+
+    fb->period = CPU_FREQ_HZ / (fps ? fps : 1);
+    if (fb->period == 0)
+        fb->period = 1;
+    if (!fb_split_pattern(fb)) {
+        free(fb);
+        return NULL;
+    }
+
+    fb->vram = calloc(range, 1);
+    fb->row_dirty = calloc((size_t)fb->height, 1);
+    if (!fb->vram || !fb->row_dirty)
+        goto fail;
+
+    if (!fb_load_palette(fb, palette[0] ? palette
+                                        : fb->bpp == 8 ? "rgb332" : "gray"))
+        goto fail;
+
+    if (fb->shm_name[0]) {
+        if (!fb_open_shm(fb))
+            goto fail;
+        fb->rgb = fb->shm->pixels;
+    } else {
+        fb->rgb = calloc((size_t)fb->width * fb->height, 3);
+        if (!fb->rgb)
+            goto fail;
+    }
+
+    if (fb->out_path[0] && !fb->out_sequence && !fb_open_ppm(fb))
+        goto fail;
+
+    // The first frame shows the cleared screen.
+    fb_mark_all(fb);
+    return fb;
+
+fail:
+    fb_destroy(fb);
+    return NULL;
+}
+
+static Byte fb_read(void *ctx, Word addr, QWord cycle) {
+    (void)cycle;
+    Framebuffer *fb = ctx;
+    return fb->vram[addr - fb->base];
+}
+
+static void fb_write(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)cycle;
+    Framebuffer *fb = ctx;
+    size_t offset = (size_t)(addr - fb->base);
+
+    if (fb->vram[offset] == data)
+        return;
+    fb->vram[offset] = data;
+
+    if (offset >= fb->size)
+        return; // Spare bytes past the visible area
+
+    // A byte holds 8 / bpp pixels, which may straddle two rows.
+    size_t per_byte = 8 / (size_t)fb->bpp;
+    size_t first = offset * per_byte;
+    fb_mark_row(fb, (int)(first / (size_t)fb->width));
+    fb_mark_row(fb, (int)((first + per_byte - 1) / (size_t)fb->width));
+}
+
+/*
+   Frames are presented on multiples of the frame period. While nothing is
+   dirty there is no event at all; the write that dirties a row reschedules
+   the device (the bus syncs it after each write). The next boundary is
+   recomputed every time, so a clock moved backwards is followed too.
+*/
+static QWord fb_tick(void *ctx, QWord until_cycle) {
+    Framebuffer *fb = ctx;
+
+    if (until_cycle >= fb->next_frame)
+        fb_present(fb);
+
+    if (fb->dirty_first > fb->dirty_last)
+        fb->next_frame = MMIO_NO_EVENT;
+    else
+        fb->next_frame = (until_cycle / fb->period + 1) * fb->period;
+    return fb->next_frame;
+}
+
+// Saved state: the whole video memory.
+static size_t fb_save(void *ctx, Byte *buf, size_t size) {
+    Framebuffer *fb = ctx;
+    if (size >= fb->size)
+        memcpy(buf, fb->vram, fb->size);
+    return fb->size;
+}
+
+static bool fb_restore(void *ctx, const Byte *buf, size_t size) {
+    Framebuffer *fb = ctx;
+    if (size != fb->size)
+        return false;
+    memcpy(fb->vram, buf, size);
+    fb_mark_all(fb);
+    return true;
+}
+
+const MMIOPlugin mmio_framebuffer_device = {
+    .abi_version = MMIO_PLUGIN_ABI_VERSION,
+    .name = "framebuffer",
+    .create = fb_create,
+    .destroy = fb_destroy,
+    .read = fb_read,
+    .write = fb_write,
+    .tick = fb_tick,
+    .save = fb_save,
+    .restore = fb_restore,
+};
@@ -0,0 +1,314 @@
+#include "journal.h"
+#include "cpu6502.h"
+#include "mem6502.h"
+#include "mmio.h"
+#include "reverse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+   JOURNAL - Record and replay of host input (see journal.h)
+
+   Reads are buffered and written as one chunk per IRQ, or every
+   JOURNAL_CHUNK values in long stretches without interrupts. A replay
+   loads the whole journal; the IRQ closing the current chunk is known as
+   soon as the chunk starts, which is what journal_next_event exposes.
+*/
+
+#define JOURNAL_MAGIC "R6502JNL"
+#define JOURNAL_CHUNK 65536
+
+#define TAG_END 0
+#define TAG_MORE 1
+#define TAG_IRQ 2
+
+JournalMode journal_mode = JOURNAL_OFF;
+QWord journal_next_event = MMIO_NO_EVENT;
+
+static QWord journal_lines;
+static QWord last_irq;
+
+// Recording
+static FILE *out;
+static Byte pending[JOURNAL_CHUNK];
+static size_t pending_length;
+
+// Replaying
+static Byte *data;
+static size_t size;
+static size_t reads_at;     // Next value of the current chunk
+static size_t reads_left;
+static QWord tag;           // Tag closing the current chunk
+static size_t next_chunk;   // Offset after that tag
+static bool truncated;      // The journal ends without a footer
+static bool raised;
+static bool diverged;
+
+QWord journal_irq_lines(void) {
+    return journal_lines;
+}
+
+static void compute_lines(void) {
+    journal_lines = 0;
+    for (int i = 0; i < mmio_device_count; i++)
+        if (mmio_devices[i].journal)
+            journal_lines |= (QWord)1 << i;
+}
+
+static void put_varint(QWord value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, out);
+        value >>= 7;
+    }
+    fputc((int)value, out);
+}
+
+static bool get_varint(size_t *at, QWord *value) {
+    *value = 0;
+    for (int shift = 0; *at < size && shift < 64; shift += 7) {
+        Byte b = data[(*at)++];
+        *value |= (QWord)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void put_le(QWord value, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        fputc((int)((value >> (8 * i)) & 0xFF), out);
+}
+
+static QWord get_le(size_t at, int bytes) {
+    QWord value = 0;
+    for (int i = 0; i < bytes; i++)
+        value |= (QWord)data[at + i] << (8 * i);
+    return value;
+}
+
+// FNV-1a over the registers and the address space.
+static QWord state_hash(const CPU6502 *cpu, const MEM6502 *memory) {
+    Byte regs[] = { cpu->A, cpu->X, cpu->Y, cpu->SP, cpu->PS,
+                    (Byte)(cpu->PC & 0xFF), (Byte)(cpu->PC >> 8) };
+    QWord hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < sizeof(regs); i++)
+        hash = (hash ^ regs[i]) * 0x100000001b3ULL;
+    for (DWord i = 0; i < 0x10000; i++)
+        hash = (hash ^ memory->Data[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+static void replay_error(const char *what) {
+    if (!diverged)
+        printf("[JOURNAL] Replay diverged at cycle %llu: %s\n",
+               (unsigned long long)total_cycles_executed, what);
+    diverged = true;
+}
+
+/*
+   Recording
+*/
+
+static void flush_chunk(QWord chunk_tag) {
+    put_varint(pending_length);
+    fwrite(pending, 1, pending_length, out);
+    put_varint(chunk_tag);
+    pending_length = 0;
+}
+
+bool journal_record(const char *path) {
+    out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return false;
+    }
+
+    fwrite(JOURNAL_MAGIC, 1, 8, out);
+    put_le(JOURNAL_VERSION, 4);
+
+    compute_lines();
+    last_irq = 0;
+    pending_length = 0;
+    journal_mode = JOURNAL_RECORD;
+    return true;
+}
+
+void journal_log_read(Byte value) {
+    pending[pending_length++] = value;
+    if (pending_length == JOURNAL_CHUNK)
+        flush_chunk(TAG_MORE);
+}
+
+/*
+   Replaying
+*/
+
+// A recording that stopped without its footer (crash, kill) is replayed as
+// far as it goes; the devices take over from there.
+static void go_live(void) {
+    printf("[JOURNAL] Recording ends at cycle %llu, continuing live\n",
+           (unsigned long long)total_cycles_executed);
+    free(data);
+    data = NULL;
+    journal_mode = JOURNAL_OFF;
+    journal_next_event = MMIO_NO_EVENT;
+}
+
+// Parses the chunk at next_chunk and schedules the IRQ that closes it.
+static void start_chunk(void) {
+    QWord count;
+    size_t at = next_chunk;
+
+    if (!get_varint(&at, &count)) {
+        go_live();
+        return;
+    }
+    reads_at = at;
+    reads_left = count < size - at ? (size_t)count : size - at;
+    at += reads_left;
+
+    if (reads_left < count || !get_varint(&at, &tag)) {
+        truncated = true;
+        tag = TAG_END;
+        if (reads_left == 0)
+            go_live();
+        return;
+    }
+    next_chunk = at;
+
+    if (tag >= TAG_IRQ) {
+        journal_next_event = last_irq + (tag - TAG_IRQ);
+        if (journal_next_event < mmio_next_event)
+            mmio_next_event = journal_next_event;
+    }
+}
+
+bool journal_replay(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = length > 12 ? malloc((size_t)length) : NULL;
+    bool ok = data && fread(data, 1, (size_t)length, f) == (size_t)length
+              && memcmp(data, JOURNAL_MAGIC, 8) == 0;
+    fclose(f);
+
+    size = ok ? (size_t)length : 0;
+    if (!ok || get_le(8, 4) != JOURNAL_VERSION) {
+        printf("[JOURNAL] %s is not a valid journal\n", path);
+        free(data);
+        data = NULL;
+        return false;
+    }
+
+    compute_lines();
+    last_irq = 0;
+    raised = diverged = truncated = false;
+    next_chunk = 12;
+    journal_mode = JOURNAL_REPLAY;
+    start_chunk();
+    return true;
+}
+
+Byte journal_next_read(void) {
+    while (reads_left == 0) {
+        if (tag != TAG_MORE) {
+            replay_error(tag == TAG_END ? "read past the end of the journal"
+                                        : "read where an IRQ was recorded");
+            return 0xFF;
+        }
+        start_chunk();
+    }
+
+    Byte value = data[reads_at++];
+    if (--reads_left == 0 && truncated)
+        go_live();
+    return value;
+}
+
+void journal_tick(QWord now) {
+    if (journal_mode != JOURNAL_REPLAY || raised || now < journal_next_event)
+        return;
+
+    // Journaled devices do not drive the line during a replay, so the bit
+    // of the first one is free for the journal.
+    if (journal_lines == 0) {
+        replay_error("IRQ recorded but no journaled device is configured");
+        journal_next_event = MMIO_NO_EVENT;
+        return;
+    }
+    mmio_irq_lines |= journal_lines & -journal_lines;
+    raised = true;
+    journal_next_event = MMIO_NO_EVENT;
+}
+
+void journal_irq(QWord cycle) {
+    // Reverse execution replays interrupts from its own log.
+    if (reverse_mode == REVERSE_REPLAY)
+        return;
+
+    if (journal_mode == JOURNAL_RECORD) {
+        if (mmio_irq_lines & journal_lines) {
+            flush_chunk(TAG_IRQ + (cycle - last_irq));
+            last_irq = cycle;
+        }
+        return;
+    }
+
+    if (journal_mode != JOURNAL_REPLAY || !raised)
+        return; // Raised by a device that is not journaled
+
+    if (reads_left != 0)
+        replay_error("IRQ taken before all recorded reads");
+    mmio_irq_lines &= ~(journal_lines & -journal_lines);
+    raised = false;
+    last_irq = cycle;
+    start_chunk();
+}
+
+bool journal_finish(const CPU6502 *cpu, const MEM6502 *memory) {
+    QWord hash = state_hash(cpu, memory);
+    bool ok = true;
+
+    if (journal_mode == JOURNAL_RECORD) {
+        flush_chunk(TAG_END);
+        put_le(total_cycles_executed, 8);
+        put_le(hash, 8);
+        fclose(out);
+        out = NULL;
+    } else if (journal_mode == JOURNAL_REPLAY) {
+        while (reads_left == 0 && tag == TAG_MORE && journal_mode != JOURNAL_OFF)
+            start_chunk();
+
+        if (journal_mode != JOURNAL_REPLAY) {
+            // Went live at the end of a truncated recording
+        } else if (truncated) {
+            printf("[JOURNAL] Recording has no final state to compare\n");
+        } else if (reads_left != 0 || tag != TAG_END) {
+            replay_error("run ended before the end of the journal");
+        } else if (next_chunk + 16 > size) {
+            printf("[JOURNAL] Recording has no final state to compare\n");
+        } else if (get_le(next_chunk, 8) != total_cycles_executed
+                   || get_le(next_chunk + 8, 8) != hash) {
+            replay_error("final state differs from the recording");
+        } else if (!diverged) {
+            printf("[JOURNAL] Replay matches the recording (%llu cycles)\n",
+                   (unsigned long long)total_cycles_executed);
+        }
+        ok = !diverged;
+        free(data);
+        data = NULL;
+    }
+
+    journal_mode = JOURNAL_OFF;
+    journal_next_event = MMIO_NO_EVENT;
+    return ok;
+}
@@ -0,0 +1,286 @@
+#include "mmio.h"
+#include "keyboard.h"
+#include <ctype.h>
+#include <stdio.h>
+
+/*
+   KEYBOARD - Scripted input device (device=keyboard)
+
+   Replays keyboard input from a script or a pre-loaded buffer instead of the
+   real terminal, so headless runs are deterministic and run at full speed.
+
+   Registers (offsets from the device start address):
+     +0 DATA    read: next available byte (0 if none is available yet)
+     +1 STATUS  bit 0 byte available, bit 3 script exhausted
+
+   mmio.cfg options (args=, comma separated):
+     script=<path>   input script (see below)
+     text=<bytes>    pre-loaded input, with \n, \r, \t, \s (space), \xHH
+     irq=1           hold the IRQ line while a byte is available
+
+   Script format: whitespace separated items, `#` starts a comment.
+     "text"     bytes of the string (same escapes as text=)
+     0x41 65    single bytes, hex or decimal
+     @1000      following bytes become available at cycle 1000
+     @+500      ... 500 cycles after the previous timestamp
+     @*         following bytes are available on demand (the default)
+
+   Bytes are delivered in order; a timed byte is held back until its cycle is
+   reached. The read position is part of the device snapshot.
+*/
+
+#define KEYBOARD_ON_DEMAND 0
+
+typedef struct {
+    const MMIOHost *host;
+    Word base;
+    bool irq;
+
+    Byte *data;     // Input bytes
+    QWord *at;      // Cycle each byte becomes available (0: on demand)
+    size_t length;
+    size_t capacity;
+    size_t position; // Next byte to deliver
+
+    QWord now;       // Last cycle seen by tick
+} Keyboard;
+
+static bool keyboard_push(Keyboard *kbd, Byte value, QWord at) {
+    if (kbd->length == kbd->capacity) {
+        size_t capacity = kbd->capacity ? kbd->capacity * 2 : 64;
+        Byte *data = realloc(kbd->data, capacity);
+        if (!data)
+            return false;
+        kbd->data = data;
+        QWord *times = realloc(kbd->at, capacity * sizeof(QWord));
+        if (!times)
+            return false;
+        kbd->at = times;
+        kbd->capacity = capacity;
+    }
+    kbd->data[kbd->length] = value;
+    kbd->at[kbd->length] = at;
+    kbd->length++;
+    return true;
+}
+
+// Appends an escaped string. Returns a pointer past the last consumed
+// character (the closing quote, if `quote` is set).
+static const char *keyboard_push_text(Keyboard *kbd, const char *text,
+                                      bool quote, QWord at) {
+    while (*text && !(quote && *text == '"')) {
+        Byte value = (Byte)*text++;
+        if (value == '\\' && *text) {
+            char escape = *text++;
+            switch (escape) {
+            case 'n': value = '\n'; break;
+            case 'r': value = '\r'; break;
+            case 't': value = '\t'; break;
+            case 's': value = ' '; break;
+            case 'x': {
+                // At most two digits: "\x41BC" is 'A', 'B', 'C'.
+                char hex[3] = { 0 };
+                for (int n = 0; n < 2 && isxdigit((unsigned char)*text); n++)
+                    hex[n] = *text++;
+                value = (Byte)strtoul(hex, NULL, 16);
+                break;
+            }
+            default: value = (Byte)escape; break;
+            }
+        }
+        keyboard_push(kbd, value, at);
+    }
+    return (quote && *text == '"') ? text + 1 : text;
+}
+
+static bool keyboard_load_script(Keyboard *kbd, const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    QWord at = KEYBOARD_ON_DEMAND;
+    QWord last = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = line;
+        while (*p) {
+            if (isspace((unsigned char)*p)) {
+                p++;
+            } else if (*p == '#') {
+                break;
+            } else if (*p == '"') {
+                p = keyboard_push_text(kbd, p + 1, true, at);
+            } else if (*p == '@') {
+                p++;
+                if (*p == '*') {
+                    at = KEYBOARD_ON_DEMAND;
+                    p++;
+                } else {
+                    bool relative = (*p == '+');
+                    QWord value = strtoull(p + relative, (char **)&p, 0);
+                    at = relative ? last + value : value;
+                    last = at;
+                }
+            } else {
+                char *end;
+                unsigned long value = strtoul(p, &end, 0);
+                if (end == p) {
+                    printf("[KEYBOARD] %s: bad token: %s", path, p);
+                    break;
+                }
+                keyboard_push(kbd, (Byte)value, at);
+                p = end;
+            }
+        }
+    }
+
+    fclose(f);
+    return true;
+}
+
+static bool keyboard_available(const Keyboard *kbd) {
+    return kbd->position < kbd->length
+           && kbd->at[kbd->position] <= kbd->now;
+}
+
+static void keyboard_update_irq(Keyboard *kbd) {
+    if (kbd->irq)
+        kbd->host->set_irq(kbd->host->token, keyboard_available(kbd));
+}
+
+static void *keyboard_create(const MMIOHost *host, Word start, Word end,
+                             const char *args) {
+    (void)end;
+
+    Keyboard *kbd = calloc(1, sizeof(Keyboard));
+    if (!kbd)
+        return NULL;
+    kbd->host = host;
+    kbd->base = start;
+
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", args);
+    for (char *opt = strtok(buf, ","); opt; opt = strtok(NULL, ",")) {
+        if (strncmp(opt, "script=", 7) == 0) {
+            if (!keyboard_load_script(kbd, opt + 7)) {
+                free(kbd->data);
+                free(kbd->at);
+                free(kbd);
+                return NULL;
+            }
+        } else if (strncmp(opt, "text=", 5) == 0) {
+            keyboard_push_text(kbd, opt + 5, false, KEYBOARD_ON_DEMAND);
+        } else if (strncmp(opt, "irq=", 4) == 0) {
+            kbd->irq = strtoul(opt + 4, NULL, 0) != 0;
+        } else {
+            printf("[KEYBOARD] unknown option %s\n", opt);
+        }
+    }
+    return kbd;
+}
+
+static void keyboard_destroy(void *ctx) {
+    Keyboard *kbd = ctx;
+    free(kbd->data);
+    free(kbd->at);
+    free(kbd);
+}
+
+static Byte keyboard_read(void *ctx, Word addr, QWord cycle) {
+    Keyboard *kbd = ctx;
+    kbd->now = cycle;
+
+    switch (addr - kbd->base) {
+    case KEYBOARD_REG_DATA: {
+        if (!keyboard_available(kbd))
+            return 0;
+        Byte value = kbd->data[kbd->position++];
+        keyboard_update_irq(kbd);
+        return value;
+    }
+    case KEYBOARD_REG_STATUS: {
+        Byte status = 0;
+        if (keyboard_available(kbd))
+            status |= KEYBOARD_STATUS_READY;
+        if (kbd->position >= kbd->length)
+            status |= KEYBOARD_STATUS_DONE;
+        return status;
+    }
+    default:
+        return 0;
+    }
+}
+
+// Timed bytes raise the IRQ exactly when they become available.
+static QWord keyboard_tick(void *ctx, QWord until_cycle) {
+    Keyboard *kbd = ctx;
+    kbd->now = until_cycle;
+    keyboard_update_irq(kbd);
+
+    if (kbd->irq && kbd->position < kbd->length
+        && kbd->at[kbd->position] > until_cycle)
+        return kbd->at[kbd->position];
+    return MMIO_NO_EVENT;
+}
+
+// Saved state: the read position (8 bytes, little endian).
+static size_t keyboard_save(void *ctx, Byte *buf, size_t size) {
+    Keyboard *kbd = ctx;
+    if (size < 8)
+        return 8;
+    for (int i = 0; i < 8; i++)
+        buf[i] = (Byte)((QWord)kbd->position >> (8 * i));
+    return 8;
+}
+
+static bool keyboard_restore(void *ctx, const Byte *buf, size_t size) {
+    Keyboard *kbd = ctx;
+    if (size != 8)
+        return false;
+
+    QWord position = 0;
+    for (int i = 0; i < 8; i++)
+        position |= (QWord)buf[i] << (8 * i);
+    if (position > kbd->length)
+        return false;
+
+    kbd->position = (size_t)position;
+    keyboard_update_irq(kbd);
+    return true;
+}
+
+bool mmio_keyboard_irq(const MMIODevice *dev) {
+    if (dev->plugin != &mmio_keyboard_device)
+        return false;
+
+    const Keyboard *kbd = dev->ctx;
+    return kbd->irq;
+}
+
+bool mmio_keyboard_set_input(MMIODevice *dev, const Byte *data, size_t length) {
+    if (dev->plugin != &mmio_keyboard_device)
+        return false;
+
+    Keyboard *kbd = dev->ctx;
+    kbd->length = 0;
+    kbd->position = 0;
+    for (size_t i = 0; i < length; i++)
+        if (!keyboard_push(kbd, data[i], KEYBOARD_ON_DEMAND))
+            return false;
+    keyboard_update_irq(kbd);
+    return true;
+}
+
+const MMIOPlugin mmio_keyboard_device = {
+    .abi_version = MMIO_PLUGIN_ABI_VERSION,
+    .name = "keyboard",
+    .create = keyboard_create,
+    .destroy = keyboard_destroy,
+    .read = keyboard_read,
+    .tick = keyboard_tick,
+    .save = keyboard_save,
+    .restore = keyboard_restore,
+};
@@ -18,6 +18,5 @@ extern MMIODevice mmio_devices[64];
 extern int mmio_device_count;
 
 void mmio_load_config(const char *filename);
-MMIODevice *mmio_find_device(Word addr);
 
 #endif
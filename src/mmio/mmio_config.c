@@ -1,19 +1,23 @@
 #include "mmio.h"
+#include "memory_map.h"
+#include "journal.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
-MMIODevice mmio_devices[64];
+MMIODevice mmio_devices[MMIO_MAX_DEVICES];
 int mmio_device_count = 0;
+QWord mmio_next_event = MMIO_NO_EVENT;
+QWord mmio_irq_lines = 0;
 
 // Forward declaration of handlers implemented in default_handlers.c
-extern void mmio_exit(Word addr, Byte data);
-extern Byte get_key(Word addr);
-extern void print_char(Word addr, Byte data);
-extern void vram_write(Word addr, Byte data);
+extern void mmio_exit(void *ctx, Word addr, Byte data, QWord cycle);
+extern Byte get_key(void *ctx, Word addr, QWord cycle);
+extern void print_char(void *ctx, Word addr, Byte data, QWord cycle);
+extern void vram_write(void *ctx, Word addr, Byte data, QWord cycle);
 
-extern Byte mmio_read_default(Word addr);
-extern void mmio_write_default(Word addr, Byte data);
+extern Byte mmio_read_default(void *ctx, Word addr, QWord cycle);
+extern void mmio_write_default(void *ctx, Word addr, Byte data, QWord cycle);
 
 static mmio_read_t resolve_read(const char *name) {
     if (strcmp(name, "get_key") == 0) return get_key;
@@ -27,14 +31,50 @@ static mmio_write_t resolve_write(const char *name) {
     return mmio_write_default;
 }
 
-MMIODevice *mmio_find_device(Word addr) {
+// Built-in stateful devices, selected with device=<name>.
+static const MMIOPlugin *resolve_device(const char *name) {
+    if (strcmp(name, "uart") == 0) return &mmio_uart_device;
+    if (strcmp(name, "keyboard") == 0) return &mmio_keyboard_device;
+    if (strcmp(name, "framebuffer") == 0) return &mmio_framebuffer_device;
+    return NULL;
+}
+
+MMIODevice *mmio_find_device_by_name(const char *name) {
     for (int i = 0; i < mmio_device_count; i++)
-        if (addr >= mmio_devices[i].start &&
-            addr <= mmio_devices[i].end)
+        if (strcmp(mmio_devices[i].name, name) == 0)
             return &mmio_devices[i];
     return NULL;
 }
 
+// Plugin paths are relative to the directory holding the config file, so an
+// example directory can ship its own devices.
+static void resolve_plugin_path(const char *config, const char *path,
+                                char *out, size_t size) {
+    const char *slash = strrchr(config, '/');
+    if (path[0] == '/') {
+        snprintf(out, size, "%s", path);
+        return;
+    }
+    if (slash == NULL) {
+        // Keep dlopen from searching the library path.
+        snprintf(out, size, "./%s", path);
+        return;
+    }
+    snprintf(out, size, "%.*s/%s", (int)(slash - config), config, path);
+}
+
+// Copies an option value, refusing one that does not fit its buffer.
+static bool copy_option(const char *device, const char *key,
+                        const char *value, char *out, size_t size) {
+    if (strlen(value) >= size) {
+        printf("[MMIO] %s: %s value is longer than %zu characters\n",
+               device, key, size - 1);
+        return false;
+    }
+    strcpy(out, value);
+    return true;
+}
+
 void mmio_load_config(const char *filename) {
     FILE *f = fopen(filename, "r");
     if (!f) {
@@ -44,49 +84,208 @@ void mmio_load_config(const char *filename) {
 
     char line[256];
 
+    // Lines before any section header describe devices, which keeps older
+    // configuration files working unchanged.
+    enum { SECTION_DEVICES, SECTION_MEMORY } section = SECTION_DEVICES;
+    bool memory_section_seen = false;
+
     while (fgets(line, sizeof(line), f)) {
 
         if (line[0] == '#' || line[0] == '\n')
             continue;
 
-        MMIODevice dev = {0};
+        if (line[0] == '[') {
+            if (strncmp(line, "[memory]", 8) == 0) {
+                // A [memory] section replaces the default board layout.
+                if (!memory_section_seen)
+                    memory_map_clear();
+                memory_section_seen = true;
+                section = SECTION_MEMORY;
+            } else if (strncmp(line, "[devices]", 9) == 0) {
+                section = SECTION_DEVICES;
+            } else {
+                printf("[MMIO] Unknown section: %s", line);
+            }
+            continue;
+        }
+
+        if (section == SECTION_MEMORY) {
+            if (!memory_map_parse_line(line))
+                printf("[MAP] Invalid line: %s", line);
+            continue;
+        }
+
+        if (mmio_device_count >= MMIO_MAX_DEVICES) {
+            printf("[MMIO] Too many devices, ignoring: %s", line);
+            continue;
+        }
+
+        // Devices are built in place: handlers may keep a pointer to them.
+        MMIODevice *dev = &mmio_devices[mmio_device_count];
+        memset(dev, 0, sizeof(*dev));
 
-        dev.read  = mmio_read_default;
-        dev.write = mmio_write_default;
+        dev->read  = mmio_read_default;
+        dev->write = mmio_write_default;
+        dev->next_event = MMIO_NO_EVENT;
 
         char read_handler[32] = {0};
         char write_handler[32] = {0};
+        char device_type[32] = {0};
+        char plugin_path[192] = {0};
+        char plugin_args[128] = {0};
+        int journal = -1; // Default for the device type
 
         unsigned start_hex = 0;
         unsigned end_hex = 0;
-        
-        
+        int consumed = 0;
+
+        int n = sscanf(line, "%31s %x %x %n",
+            dev->name, &start_hex, &end_hex, &consumed);
 
-        int n = sscanf(line,
-            "%31s %x %x read=%31s write=%31s",
-            dev.name, &start_hex, &end_hex, read_handler, write_handler);
-        
         if (n < 3) {
             printf("[MMIO] Invalid line: %s", line);
             continue;
         }
-        
 
-        dev.start = (Word)start_hex;
-        dev.end   = (Word)end_hex;
+        // Remaining tokens are key=value options in any order. A token
+        // can be as long as the line, so it is never split.
+        char token[sizeof(line)];
+        int used = 0;
+        bool valid = true;
+        const char *opts = line + consumed;
+        while (valid && sscanf(opts, "%255s%n", token, &used) == 1) {
+            opts += used;
+            if (strncmp(token, "read=", 5) == 0)
+                valid = copy_option(dev->name, "read", token + 5,
+                                    read_handler, sizeof(read_handler));
+            else if (strncmp(token, "write=", 6) == 0)
+                valid = copy_option(dev->name, "write", token + 6,
+                                    write_handler, sizeof(write_handler));
+            else if (strncmp(token, "device=", 7) == 0)
+                valid = copy_option(dev->name, "device", token + 7,
+                                    device_type, sizeof(device_type));
+            else if (strncmp(token, "plugin=", 7) == 0)
+                valid = copy_option(dev->name, "plugin", token + 7,
+                                    plugin_path, sizeof(plugin_path));
+            else if (strncmp(token, "args=", 5) == 0)
+                valid = copy_option(dev->name, "args", token + 5,
+                                    plugin_args, sizeof(plugin_args));
+            else if (strncmp(token, "journal=", 8) == 0)
+                journal = atoi(token + 8) != 0;
+            else
+                printf("[MMIO] %s: unknown option %s\n", dev->name, token);
+        }
+        if (!valid)
+            continue;
+
+        dev->start = (Word)start_hex;
+        dev->end   = (Word)end_hex;
 
+        if (plugin_path[0]) {
+            char resolved[512];
+            resolve_plugin_path(filename, plugin_path, resolved,
+                                sizeof(resolved));
+            if (!mmio_plugin_attach(dev, resolved, plugin_args))
+                continue;
+            dev->journal = true; // Unknown device: assume host input
+        } else if (device_type[0]) {
+            const MMIOPlugin *type = resolve_device(device_type);
+            if (!type) {
+                printf("[MMIO] %s: unknown device type %s\n",
+                       dev->name, device_type);
+                continue;
+            }
+            if (!mmio_device_attach(dev, type, plugin_args))
+                continue;
+            dev->journal = type == &mmio_uart_device;
+        } else {
+            if (strlen(read_handler) > 0 && strcmp(read_handler, "0") != 0)
+                dev->read = resolve_read(read_handler);
+            dev->journal = dev->read == get_key;
 
-        if (strlen(read_handler) > 0 && strcmp(read_handler, "0") != 0)
-            dev.read = resolve_read(read_handler);
+            if (strlen(write_handler) > 0 && strcmp(write_handler, "0") != 0)
+                dev->write = resolve_write(write_handler);
+        }
 
-        if (strlen(write_handler) > 0 && strcmp(write_handler, "0") != 0)
-            dev.write = resolve_write(write_handler);
+        if (journal >= 0)
+            dev->journal = journal;
 
-        mmio_devices[mmio_device_count++] = dev;
+        mmio_device_count++;
+        if (dev->tick)
+            mmio_sync_device(dev, 0);
 
         printf("[MMIO] Loaded: %-10s  %04X-%04X\n",
-               dev.name, dev.start, dev.end);
+               dev->name, dev->start, dev->end);
     }
 
     fclose(f);
 }
+
+MMIODevice *mmio_add_device(const char *name, Word start, Word end,
+                            mmio_read_t read, mmio_write_t write, void *ctx) {
+    if (mmio_device_count >= MMIO_MAX_DEVICES) {
+        printf("[MMIO] Too many devices, ignoring: %s\n", name);
+        return NULL;
+    }
+
+    MMIODevice *dev = &mmio_devices[mmio_device_count++];
+    memset(dev, 0, sizeof(*dev));
+    snprintf(dev->name, sizeof(dev->name), "%s", name);
+    dev->start = start;
+    dev->end = end;
+    dev->read = read ? read : mmio_read_default;
+    dev->write = write ? write : mmio_write_default;
+    dev->ctx = ctx;
+    dev->next_event = MMIO_NO_EVENT;
+    dev->journal = read != NULL; // Answered by the host
+
+    printf("[MMIO] Loaded: %-10s  %04X-%04X\n", dev->name, dev->start, dev->end);
+    return dev;
+}
+
+void mmio_unload_all(void) {
+    for (int i = 0; i < mmio_device_count; i++)
+        mmio_plugin_detach(&mmio_devices[i]);
+    mmio_device_count = 0;
+    mmio_next_event = MMIO_NO_EVENT;
+    mmio_irq_lines = 0;
+}
+
+void mmio_flush_devices(void) {
+    for (int i = 0; i < mmio_device_count; i++) {
+        MMIODevice *dev = &mmio_devices[i];
+        if (dev->plugin && dev->plugin->flush)
+            dev->plugin->flush(dev->ctx);
+    }
+}
+
+// Recomputes the earliest pending event over all devices and the journal.
+static void mmio_update_deadline(void) {
+    QWord next = journal_next_event;
+    for (int i = 0; i < mmio_device_count; i++)
+        if (mmio_devices[i].next_event < next)
+            next = mmio_devices[i].next_event;
+    mmio_next_event = next;
+}
+
+void mmio_sync_device(MMIODevice *dev, QWord now) {
+    QWord previous = dev->next_event;
+    dev->next_event = dev->tick(dev->ctx, now);
+
+    // Only rescan when this device could have been the earliest one.
+    if (dev->next_event < mmio_next_event)
+        mmio_next_event = dev->next_event;
+    else if (previous == mmio_next_event)
+        mmio_update_deadline();
+}
+
+void mmio_run_events(QWord now) {
+    for (int i = 0; i < mmio_device_count; i++) {
+        MMIODevice *dev = &mmio_devices[i];
+        if (dev->tick && dev->next_event <= now)
+            dev->next_event = dev->tick(dev->ctx, now);
+    }
+    if (journal_next_event <= now)
+        journal_tick(now);
+    mmio_update_deadline();
+}
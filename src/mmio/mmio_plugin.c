@@ -0,0 +1,108 @@
+#include "mmio.h"
+#include "journal.h"
+#include <dlfcn.h>
+#include <stdio.h>
+
+// Fallback handlers implemented in default_handlers.c
+extern Byte mmio_read_default(void *ctx, Word addr, QWord cycle);
+extern void mmio_write_default(void *ctx, Word addr, Byte data, QWord cycle);
+
+/*
+   Loading of shared-object MMIO devices (see mmio_plugin.h).
+
+   mmio_plugin_attach opens the object, checks its ABI version and creates
+   one instance for the device; built-in devices (device=<name>) go through
+   mmio_device_attach directly. The plugin callbacks share the signatures of
+   the built-in handlers, so they are copied into the MMIODevice together
+   with the instance state and the bus calls them like any other device.
+*/
+
+bool mmio_plugin_attach(MMIODevice *dev, const char *path, const char *args) {
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        printf("[MMIO] %s: cannot load plugin: %s\n", dev->name, dlerror());
+        return false;
+    }
+
+    mmio_plugin_entry_t entry;
+    *(void **)&entry = dlsym(handle, MMIO_PLUGIN_ENTRY);
+    const MMIOPlugin *plugin = entry ? entry() : NULL;
+
+    if (!plugin || plugin->abi_version != MMIO_PLUGIN_ABI_VERSION) {
+        printf("[MMIO] %s: %s is not a v%d device plugin\n",
+               dev->name, path, MMIO_PLUGIN_ABI_VERSION);
+        dlclose(handle);
+        return false;
+    }
+
+    if (!mmio_device_attach(dev, plugin, args)) {
+        dlclose(handle);
+        return false;
+    }
+
+    dev->handle = handle;
+    return true;
+}
+
+bool mmio_device_can_irq(const MMIODevice *dev) {
+    if (dev->plugin == NULL || dev->plugin == &mmio_framebuffer_device)
+        return false;
+    if (dev->plugin == &mmio_keyboard_device)
+        return mmio_keyboard_irq(dev);
+    return true;
+}
+
+// Drives the CPU IRQ line on behalf of a device. The line stays asserted
+// while at least one device holds it.
+static void mmio_host_set_irq(void *token, bool level) {
+    MMIODevice *dev = token;
+    QWord line = (QWord)1 << (dev - mmio_devices);
+
+    // A journal replay raises the line at the recorded cycles instead.
+    if (dev->journal && journal_mode == JOURNAL_REPLAY)
+        return;
+
+    if (level)
+        mmio_irq_lines |= line;
+    else
+        mmio_irq_lines &= ~line;
+}
+
+bool mmio_device_attach(MMIODevice *dev, const MMIOPlugin *plugin,
+                        const char *args) {
+    dev->host.token = dev;
+    dev->host.set_irq = mmio_host_set_irq;
+
+    void *state = NULL;
+    if (plugin->create) {
+        state = plugin->create(&dev->host, dev->start, dev->end, args);
+        if (!state) {
+            printf("[MMIO] %s: %s failed to create device\n",
+                   dev->name, plugin->name);
+            return false;
+        }
+    }
+
+    dev->plugin = plugin;
+    dev->ctx = state;
+    dev->read = plugin->read ? plugin->read : mmio_read_default;
+    dev->write = plugin->write ? plugin->write : mmio_write_default;
+    dev->tick = plugin->tick;
+    return true;
+}
+
+void mmio_plugin_detach(MMIODevice *dev) {
+    if (!dev->plugin)
+        return;
+
+    if (dev->plugin->destroy)
+        dev->plugin->destroy(dev->ctx);
+    if (dev->handle)
+        dlclose(dev->handle);
+    mmio_host_set_irq(dev, false);
+
+    dev->plugin = NULL;
+    dev->ctx = NULL;
+    dev->handle = NULL;
+    dev->tick = NULL;
+}
@@ -0,0 +1,331 @@
+#include "mmio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+/*
+   UART - Buffered serial console device (device=uart)
+
+   A UART-style device with a receive FIFO, a transmit FIFO and status
+   registers. Data moves between the FIFOs and the host (stdio, files or
+   pipes) in large chunks, from the device tick, so neither direction blocks
+   the emulation loop and output no longer costs a printf per byte.
+
+   Registers (offsets from the device start address):
+     +0 DATA     read: pop a byte from the RX FIFO (0 if empty)
+                 write: push a byte to the TX FIFO
+     +1 STATUS   bit 0 RX ready, bit 1 TX ready, bit 2 RX overrun
+                 (cleared when STATUS is read), bit 3 input closed,
+                 bit 7 IRQ pending
+     +2 CONTROL  bit 0 raise IRQ while the RX FIFO is not empty
+
+   mmio.cfg options (args=, comma separated):
+     in=stdin|none|<path>      input source (default stdin)
+     out=stdout|stderr|<path>  output sink (default stdout)
+     poll=<cycles>             host I/O interval (default 1000 cycles)
+*/
+
+#define UART_RX_SIZE 256
+#define UART_TX_SIZE 4096
+#define UART_DEFAULT_POLL 1000
+
+#define UART_REG_DATA 0
+#define UART_REG_STATUS 1
+#define UART_REG_CONTROL 2
+
+#define UART_STATUS_RX_READY 0x01
+#define UART_STATUS_TX_READY 0x02
+#define UART_STATUS_OVERRUN 0x04
+#define UART_STATUS_CLOSED 0x08
+#define UART_STATUS_IRQ 0x80
+
+#define UART_CONTROL_RX_IRQ 0x01
+
+typedef struct {
+    const MMIOHost *host;
+    Word base;
+
+    int in_fd;          // -1 once input is closed
+    int out_fd;
+    bool close_in;      // fds we opened ourselves
+    bool close_out;
+
+    Byte rx[UART_RX_SIZE];
+    int rx_head;
+    int rx_count;
+
+    Byte tx[UART_TX_SIZE];
+    int tx_count;
+
+    Byte control;
+    bool overrun;
+
+    QWord poll_interval;
+    QWord next_poll;
+} UART;
+
+static void uart_flush(UART *uart) {
+    if (uart->tx_count == 0)
+        return;
+
+    // Keep ordering with anything the emulator printed through stdio.
+    if (uart->out_fd == STDOUT_FILENO)
+        fflush(stdout);
+    else if (uart->out_fd == STDERR_FILENO)
+        fflush(stderr);
+
+    int done = 0;
+    while (done < uart->tx_count) {
+        ssize_t n = write(uart->out_fd, uart->tx + done, uart->tx_count - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break; // Sink is gone: drop the rest
+        done += (int)n;
+    }
+    uart->tx_count = 0;
+}
+
+static void uart_update_irq(UART *uart) {
+    bool level = (uart->control & UART_CONTROL_RX_IRQ) && uart->rx_count > 0;
+    uart->host->set_irq(uart->host->token, level);
+}
+
+// Moves whatever input is available into the RX FIFO without blocking.
+static void uart_fill(UART *uart) {
+    if (uart->in_fd < 0 || uart->rx_count == UART_RX_SIZE)
+        return;
+
+    struct pollfd pfd = { .fd = uart->in_fd, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0)
+        return;
+
+    // Read into the contiguous free part of the ring.
+    int tail = (uart->rx_head + uart->rx_count) % UART_RX_SIZE;
+    int room = UART_RX_SIZE - uart->rx_count;
+    if (tail + room > UART_RX_SIZE)
+        room = UART_RX_SIZE - tail;
+
+    ssize_t n = read(uart->in_fd, uart->rx + tail, room);
+    if (n > 0) {
+        uart->rx_count += (int)n;
+    } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+        if (uart->close_in)
+            close(uart->in_fd);
+        uart->in_fd = -1;
+    }
+}
+
+static int uart_open(const char *name, bool input, bool *opened) {
+    *opened = false;
+    if (strcmp(name, "none") == 0)
+        return -1;
+    if (input && strcmp(name, "stdin") == 0)
+        return STDIN_FILENO;
+    if (!input && strcmp(name, "stdout") == 0)
+        return STDOUT_FILENO;
+    if (!input && strcmp(name, "stderr") == 0)
+        return STDERR_FILENO;
+
+    int fd = input ? open(name, O_RDONLY)
+                   : open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        perror(name);
+    *opened = (fd >= 0);
+    return fd;
+}
+
+static void *uart_create(const MMIOHost *host, Word start, Word end,
+                         const char *args) {
+    (void)end;
+
+    char in_name[128] = "stdin";
+    char out_name[128] = "stdout";
+    unsigned long poll_interval = UART_DEFAULT_POLL;
+
+    // args: comma separated key=value pairs
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", args);
+    for (char *opt = strtok(buf, ","); opt; opt = strtok(NULL, ",")) {
+        if (strncmp(opt, "in=", 3) == 0)
+            snprintf(in_name, sizeof(in_name), "%s", opt + 3);
+        else if (strncmp(opt, "out=", 4) == 0)
+            snprintf(out_name, sizeof(out_name), "%s", opt + 4);
+        else if (strncmp(opt, "poll=", 5) == 0)
+            poll_interval = strtoul(opt + 5, NULL, 0);
+        else
+            printf("[UART] unknown option %s\n", opt);
+    }
+
+    UART *uart = calloc(1, sizeof(UART));
+    if (!uart)
+        return NULL;
+
+    uart->host = host;
+    uart->base = start;
+    uart->poll_interval = poll_interval ? poll_interval : 1;
+    uart->in_fd = uart_open(in_name, true, &uart->close_in);
+    uart->out_fd = uart_open(out_name, false, &uart->close_out);
+
+    if (uart->out_fd < 0 && strcmp(out_name, "none") != 0) {
+        if (uart->close_in)
+            close(uart->in_fd);
+        free(uart);
+        return NULL;
+    }
+    return uart;
+}
+
+static void uart_destroy(void *ctx) {
+    UART *uart = ctx;
+
+    if (uart->out_fd >= 0)
+        uart_flush(uart);
+    if (uart->close_in && uart->in_fd >= 0)
+        close(uart->in_fd);
+    if (uart->close_out)
+        close(uart->out_fd);
+    free(uart);
+}
+
+static Byte uart_status(UART *uart) {
+    Byte status = UART_STATUS_TX_READY;
+    if (uart->rx_count > 0)
+        status |= UART_STATUS_RX_READY;
+    if (uart->overrun)
+        status |= UART_STATUS_OVERRUN;
+    if (uart->in_fd < 0 && uart->rx_count == 0)
+        status |= UART_STATUS_CLOSED;
+    if ((uart->control & UART_CONTROL_RX_IRQ) && uart->rx_count > 0)
+        status |= UART_STATUS_IRQ;
+    return status;
+}
+
+static Byte uart_read(void *ctx, Word addr, QWord cycle) {
+    (void)cycle;
+    UART *uart = ctx;
+
+    switch (addr - uart->base) {
+    case UART_REG_DATA: {
+        if (uart->rx_count == 0)
+            return 0;
+        Byte data = uart->rx[uart->rx_head];
+        uart->rx_head = (uart->rx_head + 1) % UART_RX_SIZE;
+        uart->rx_count--;
+        uart_update_irq(uart);
+        return data;
+    }
+    case UART_REG_STATUS: {
+        Byte status = uart_status(uart);
+        uart->overrun = false;
+        return status;
+    }
+    case UART_REG_CONTROL:
+        return uart->control;
+    default:
+        return 0;
+    }
+}
+
+static void uart_write(void *ctx, Word addr, Byte data, QWord cycle) {
+    (void)cycle;
+    UART *uart = ctx;
+
+    switch (addr - uart->base) {
+    case UART_REG_DATA:
+        if (uart->out_fd < 0)
+            return;
+        if (uart->tx_count == UART_TX_SIZE)
+            uart_flush(uart);
+        uart->tx[uart->tx_count++] = data;
+        break;
+    case UART_REG_CONTROL:
+        uart->control = data;
+        uart_update_irq(uart);
+        break;
+    default:
+        break;
+    }
+}
+
+static QWord uart_tick(void *ctx, QWord until_cycle) {
+    UART *uart = ctx;
+
+    // A deadline beyond one interval means the clock was moved back.
+    if (until_cycle >= uart->next_poll
+        || uart->next_poll - until_cycle > uart->poll_interval) {
+        uart_flush(uart);
+        if (uart->rx_count == UART_RX_SIZE && uart->in_fd >= 0)
+            uart->overrun = true; // Host data is waiting and we are full
+        uart_fill(uart);
+        uart_update_irq(uart);
+        uart->next_poll = until_cycle + uart->poll_interval;
+    }
+
+    // Nothing to move until the firmware touches the device again.
+    if (uart->in_fd < 0 && uart->tx_count == 0)
+        return MMIO_NO_EVENT;
+    return uart->next_poll;
+}
+
+/*
+   Saved state: control, overrun and the RX FIFO contents. TX data is
+   flushed first, so it never needs saving; restoring drops whatever was
+   queued since, as it belongs to the abandoned timeline.
+*/
+static size_t uart_save(void *ctx, Byte *buf, size_t size) {
+    UART *uart = ctx;
+    size_t needed = 2 + (size_t)uart->rx_count;
+
+    if (size < needed)
+        return needed;
+
+    uart_flush(uart);
+    buf[0] = uart->control;
+    buf[1] = uart->overrun;
+    for (int i = 0; i < uart->rx_count; i++)
+        buf[2 + i] = uart->rx[(uart->rx_head + i) % UART_RX_SIZE];
+    return needed;
+}
+
+static bool uart_restore(void *ctx, const Byte *buf, size_t size) {
+    UART *uart = ctx;
+
+    if (size < 2)
+        return false;
+
+    int count = (int)size - 2;
+    if (count > UART_RX_SIZE)
+        return false;
+
+    uart->control = buf[0];
+    uart->overrun = buf[1];
+    uart->rx_head = 0;
+    uart->rx_count = count;
+    memcpy(uart->rx, buf + 2, (size_t)count);
+    uart->tx_count = 0;
+    uart->next_poll = 0; // Poll on the next sync, whatever the cycle count
+    uart_update_irq(uart);
+    return true;
+}
+
+static void uart_drain(void *ctx) {
+    UART *uart = ctx;
+    if (uart->out_fd >= 0)
+        uart_flush(uart);
+}
+
+const MMIOPlugin mmio_uart_device = {
+    .abi_version = MMIO_PLUGIN_ABI_VERSION,
+    .name = "uart",
+    .create = uart_create,
+    .destroy = uart_destroy,
+    .read = uart_read,
+    .write = uart_write,
+    .tick = uart_tick,
+    .save = uart_save,
+    .restore = uart_restore,
+    .flush = uart_drain,
+};
@@ -0,0 +1,66 @@
+#include "coverage.h"
+#include <errno.h>
+
+/*
+   COVERAGE - Recorder state and bitmap files
+
+   File layout: "R6502COV" magic, then the executed, taken and not-taken
+   bitmaps, COVERAGE_BITMAP_SIZE bytes each.
+*/
+
+#define COVERAGE_MAGIC "R6502COV"
+
+Byte *coverage_map = NULL;
+CoverageBits *coverage_bits = NULL;
+
+bool
+coverage_bits_merge (CoverageBits *bits, const char *path, bool missing_ok)
+{
+  FILE *f = fopen (path, "rb");
+  if (f == NULL)
+    {
+      if (missing_ok && errno == ENOENT)
+        return true;
+      perror (path);
+      return false;
+    }
+
+  char magic[8];
+  static CoverageBits saved;
+  bool ok = fread (magic, 1, 8, f) == 8
+            && memcmp (magic, COVERAGE_MAGIC, 8) == 0
+            && fread (&saved, sizeof (saved), 1, f) == 1;
+  fclose (f);
+
+  if (!ok)
+    {
+      printf ("[COVERAGE] %s is not a coverage file\n", path);
+      return false;
+    }
+
+  for (int i = 0; i < COVERAGE_BITMAP_SIZE; i++)
+    {
+      bits->executed[i] |= saved.executed[i];
+      bits->taken[i] |= saved.taken[i];
+      bits->not_taken[i] |= saved.not_taken[i];
+    }
+  return true;
+}
+
+bool
+coverage_bits_write (const CoverageBits *bits, const char *path)
+{
+  FILE *f = fopen (path, "wb");
+  if (f == NULL)
+    {
+      perror (path);
+      return false;
+    }
+
+  bool ok = fwrite (COVERAGE_MAGIC, 1, 8, f) == 8
+            && fwrite (bits, sizeof (*bits), 1, f) == 1;
+  ok = fclose (f) == 0 && ok;
+  if (!ok)
+    printf ("[COVERAGE] Cannot write %s\n", path);
+  return ok;
+}
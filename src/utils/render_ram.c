@@ -1,7 +1,165 @@
 #include "render_ram.h"
+#include <pthread.h>
+
+/*
+   RAM viewer (see render_ram.h)
+
+   Two copies of memory are kept on the viewer side: `shadow`, refreshed
+   from the emulator one page at a time, and `shown`, what is currently on
+   screen. A page is copied only when its write counter (MemPage.Writes)
+   moved since the last frame, and a cell is redrawn only when its shadow
+   value differs from the shown one, so a mostly idle memory costs almost
+   nothing to watch.
+*/
+
+atomic_int ram_view_pending;
+
+static const MEM6502 *view_mem;
+static Byte shadow[RAM_SIZE];
+static Byte shown[RAM_SIZE];
+static bool page_changed[PAGE_COUNT];
+static DWord page_seen[PAGE_COUNT];
+static bool primed;
+
+static pthread_mutex_t view_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t view_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t view_thread;
+static bool view_thread_started;
+static bool view_served;  // The emulator answered the last request
+static bool view_done;    // Execution has stopped, memory is stable
+static bool view_paused;  // A prompt holds the emulator, nobody serves
+static int view_interval_ms = 1000 / RAM_VIEW_DEFAULT_HZ;
+
+// Copies the pages written since the last call into the shadow. Mirrors
+// share storage, so a page is stale when any page with the same backing
+// storage was written. Called with view_lock held.
+static void
+copy_changed_pages (const MEM6502 *mem)
+{
+  DWord versions[PAGE_COUNT] = { 0 };
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    versions[mem6502_backing_page (mem, page)] += mem->Pages[page].Writes;
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      DWord version = versions[mem6502_backing_page (mem, page)];
+      if (primed && version == page_seen[page])
+        continue;
+
+      memcpy (&shadow[page * PAGE_SIZE], mem->Pages[page].Backing, PAGE_SIZE);
+      page_seen[page] = version;
+      page_changed[page] = true;
+    }
+  primed = true;
+}
 
 void
-render_ram_matrix (MEM6502 mem)
+ram_view_serve (const MEM6502 *mem)
+{
+  pthread_mutex_lock (&view_lock);
+  copy_changed_pages (mem);
+  atomic_store_explicit (&ram_view_pending, 0, memory_order_relaxed);
+  view_served = true;
+  pthread_cond_signal (&view_cond);
+  pthread_mutex_unlock (&view_lock);
+}
+
+// Brings the shadow up to date. Returns with view_lock held.
+static void
+request_frame (void)
+{
+  pthread_mutex_lock (&view_lock);
+
+  if (!view_done && !view_paused)
+    {
+      view_served = false;
+      atomic_store_explicit (&ram_view_pending, 1, memory_order_relaxed);
+      while (!view_served && !view_done && !view_paused)
+        pthread_cond_wait (&view_cond, &view_lock);
+    }
+
+  // Once execution has stopped nobody writes memory anymore.
+  if (view_done)
+    copy_changed_pages (view_mem);
+}
+
+static void
+draw_cell (int row, int col, int addr)
+{
+  Byte value = shadow[addr];
+
+  // Highlight non-zero memory values
+  if (value != 0)
+    attron (COLOR_PAIR (1));
+
+  mvprintw (row, col, "%02X", value);
+
+  if (value != 0)
+    attroff (COLOR_PAIR (1));
+
+  shown[addr] = value;
+}
+
+static void
+draw_headers (int offset, int display_rows, int max_cols)
+{
+  mvprintw (0, 0, "RAM Viewer - Base offset: 0x%04X %s", offset,
+            view_done     ? "(stopped)"
+            : view_paused ? "(paused)"
+                          : "(running)");
+  clrtoeol ();
+  mvprintw (1, 0,
+            "Arrows: navigate | G: go to address | R: redraw | ESC: exit");
+
+  // Column header (shows hex digits 00 to 1F)
+  attron (COLOR_PAIR (2) | A_BOLD);
+  mvprintw (2, 7, "  ");
+  for (int coluna = 0; coluna < max_cols; coluna++)
+    {
+      mvprintw (2, 10 + coluna * 3, "%02X", coluna);
+    }
+
+  // Row headers: memory address labels
+  for (int linha = 0; linha < display_rows; linha++)
+    {
+      int base_addr = offset + linha * 32;
+      if (base_addr >= 65536)
+        break;
+      mvprintw (linha + 3, 0, "0x%04X:", base_addr);
+    }
+  attroff (COLOR_PAIR (2) | A_BOLD);
+}
+
+// Draws the visible cells: all of them after a layout change, otherwise
+// only those whose value changed since they were last drawn.
+static void
+draw_cells (int offset, int display_rows, int max_cols, bool full)
+{
+  for (int linha = 0; linha < display_rows; linha++)
+    {
+      int base_addr = offset + linha * 32;
+      if (base_addr >= 65536)
+        break;
+
+      for (int coluna = 0; coluna < max_cols; coluna++)
+        {
+          int addr = base_addr + coluna;
+          if (addr >= 65536)
+            continue;
+
+          if (full
+              || (page_changed[addr / PAGE_SIZE]
+                  && shadow[addr] != shown[addr]))
+            draw_cell (linha + 3, 10 + coluna * 3, addr);
+        }
+    }
+
+  memset (page_changed, 0, sizeof (page_changed));
+}
+
+static void
+view_loop (void)
 {
   initscr ();
   start_color ();
@@ -14,7 +172,14 @@ render_ram_matrix (MEM6502 mem)
   keypad (stdscr, TRUE);
   ESCDELAY = 25;
 
+  // getch doubles as the frame timer.
+  timeout (view_interval_ms);
+
   int offset = 0; // Starting address offset for display
+  int last_rows = -1, last_cols = -1, last_offset = -1;
+  bool was_done = false;
+  bool was_paused = false;
+  bool redraw = true;
 
   while (1)
     {
@@ -39,48 +204,26 @@ render_ram_matrix (MEM6502 mem)
       if (max_cols < 1)
         max_cols = 1;
 
-      erase ();
+      request_frame ();
 
-      mvprintw (0, 0, "RAM Viewer - Base offset: 0x%04X", offset);
-      mvprintw (1, 0, "Arrows: navigate | G: go to address | ESC: exit");
-
-      // Column header (shows hex digits 00 to 1F)
-      attron (COLOR_PAIR (2) | A_BOLD);
-      mvprintw (2, 7, "  ");
-      for (int coluna = 0; coluna < max_cols; coluna++)
+      bool full = redraw || rows != last_rows || cols != last_cols
+                  || offset != last_offset || view_done != was_done
+                  || view_paused != was_paused;
+      if (full)
         {
-          mvprintw (2, 10 + coluna * 3, "%02X", coluna);
+          erase ();
+          draw_headers (offset, display_rows, max_cols);
         }
-      attroff (COLOR_PAIR (2) | A_BOLD);
+      draw_cells (offset, display_rows, max_cols, full);
+      was_done = view_done;
+      was_paused = view_paused;
 
-      // Memory rows
-      for (int linha = 0; linha < display_rows; linha++)
-        {
-          int base_addr = offset + linha * 32;
-          if (base_addr >= 65536)
-            break;
-
-          // Row header: memory address label
-          attron (COLOR_PAIR (2) | A_BOLD);
-          mvprintw (linha + 3, 0, "0x%04X:", base_addr);
-          attroff (COLOR_PAIR (2) | A_BOLD);
-
-          for (int coluna = 0; coluna < max_cols; coluna++)
-            {
-              int addr = base_addr + coluna;
-              if (addr >= 65536)
-                continue;
-
-              // Highlight non-zero memory values
-              if (mem.Data[addr] != 0)
-                attron (COLOR_PAIR (1));
-
-              mvprintw (linha + 3, 10 + coluna * 3, "%02X", mem.Data[addr]);
-
-              if (mem.Data[addr] != 0)
-                attroff (COLOR_PAIR (1));
-            }
-        }
+      pthread_mutex_unlock (&view_lock);
+
+      last_rows = rows;
+      last_cols = cols;
+      last_offset = offset;
+      redraw = false;
 
       refresh ();
 
@@ -108,10 +251,15 @@ render_ram_matrix (MEM6502 mem)
           if (offset + max_cols < 65536)
             offset += max_cols;
         }
+      else if (ch == 'r' || ch == 'R') // Repaint over stray output
+        {
+          redraw = true;
+        }
       else if (ch == 'g' || ch == 'G') // Go to specific address
         {
           echo ();
           curs_set (TRUE);
+          timeout (-1);
 
           // Prompt input at the bottom line
           mvprintw (rows - 1, 0, "Go to address (hex, 0x0000 to 0xFFFF): ");
@@ -128,8 +276,69 @@ render_ram_matrix (MEM6502 mem)
 
           noecho ();
           curs_set (FALSE);
+          timeout (view_interval_ms);
+          redraw = true;
         }
     }
 
   endwin ();
 }
+
+static void *
+view_thread_main (void *arg)
+{
+  (void)arg;
+  view_loop ();
+  return NULL;
+}
+
+bool
+ram_view_start (const MEM6502 *mem, int refresh_hz)
+{
+  view_mem = mem;
+  view_done = false;
+  view_paused = false;
+  primed = false;
+  if (refresh_hz > 0)
+    view_interval_ms = refresh_hz >= 1000 ? 1 : 1000 / refresh_hz;
+
+  view_thread_started
+      = pthread_create (&view_thread, NULL, view_thread_main, NULL) == 0;
+  return view_thread_started;
+}
+
+void
+ram_view_pause (const MEM6502 *mem, bool paused)
+{
+  pthread_mutex_lock (&view_lock);
+  // Show memory as of the stop; nothing is copied until the run resumes.
+  if (paused)
+    copy_changed_pages (mem);
+  view_paused = paused;
+  atomic_store_explicit (&ram_view_pending, 0, memory_order_relaxed);
+  pthread_cond_broadcast (&view_cond);
+  pthread_mutex_unlock (&view_lock);
+}
+
+void
+ram_view_finish (void)
+{
+  pthread_mutex_lock (&view_lock);
+  view_done = true;
+  atomic_store_explicit (&ram_view_pending, 0, memory_order_relaxed);
+  pthread_cond_broadcast (&view_cond);
+  pthread_mutex_unlock (&view_lock);
+
+  if (view_thread_started)
+    pthread_join (view_thread, NULL);
+  view_thread_started = false;
+}
+
+void
+render_ram_matrix (const MEM6502 *mem)
+{
+  view_mem = mem;
+  view_done = true;
+  primed = false;
+  view_loop ();
+}
@@ -3,8 +3,51 @@
 
 #include "cpu_exec.h"
 #include <ncurses.h>
+#include <stdatomic.h>
 #include <unistd.h>
 
-extern void render_ram_matrix (MEM6502 mem);
+/*
+   RAM viewer
+
+   The viewer runs in its own thread and never touches emulated memory while
+   the CPU is running. At most `refresh_hz` times per second it raises
+   ram_view_pending; the emulation loop checks it between run slices (main.c
+   calls ram_view_poll every RUN_SLICE instructions) and copies only the
+   pages written since the last frame into the viewer's shadow copy. The
+   viewer then redraws only the cells whose value changed.
+
+   Nothing polls while a breakpoint prompt waits for input, so main.c
+   pauses the viewer around it: the screen keeps the memory of the stop
+   and says so instead of waiting for a frame.
+*/
+
+#define RAM_VIEW_DEFAULT_HZ 20
+
+extern atomic_int ram_view_pending;
+
+// Starts the live viewer. Returns false if the thread cannot be created.
+extern bool ram_view_start (const MEM6502 *mem, int refresh_hz);
+
+// Hands the pages written since the last frame to the viewer.
+extern void ram_view_serve (const MEM6502 *mem);
+
+// While paused the viewer shows the memory as it is now and requests no
+// frames; call with false before running again.
+extern void ram_view_pause (const MEM6502 *mem, bool paused);
+
+// Called once execution has stopped: the viewer keeps showing the final
+// memory until ESC is pressed.
+extern void ram_view_finish (void);
+
+// Blocking viewer for a stopped machine.
+extern void render_ram_matrix (const MEM6502 *mem);
+
+// Cheap check for the emulation loop: one relaxed load per call.
+static inline void
+ram_view_poll (const MEM6502 *mem)
+{
+  if (atomic_load_explicit (&ram_view_pending, memory_order_relaxed))
+    ram_view_serve (mem);
+}
 
 #endif // RENDER_RAM_H
@@ -0,0 +1,264 @@
+#include "snapshot.h"
+
+/*
+   SNAPSHOT - Machine state capture
+
+   File layout (all integers little endian):
+     "R6502SNP"           magic
+     u32                  format version
+     A X Y SP PS          registers, one byte each
+     u16                  PC
+     u64                  total cycles executed
+     MAX_MEM bytes        memory image
+     u32                  device count
+     per device: u32 size, then `size` bytes of saved state
+*/
+
+#define SNAPSHOT_MAGIC "R6502SNP"
+#define SNAPSHOT_VERSION 1
+
+bool
+snapshot_take (Snapshot *snap, const CPU6502 *cpu, const MEM6502 *memory)
+{
+  snap->cpu = *cpu;
+  snap->cycles = total_cycles_executed;
+
+  snap->ram = malloc (MAX_MEM);
+  if (snap->ram == NULL)
+    return false;
+  memcpy (snap->ram, memory->Data, MAX_MEM);
+
+  snap->device_count = mmio_device_count;
+  for (int i = 0; i < mmio_device_count; i++)
+    {
+      MMIODevice *dev = &mmio_devices[i];
+      snap->device_state[i] = NULL;
+      snap->device_size[i] = 0;
+
+      if (dev->plugin == NULL || dev->plugin->save == NULL)
+        continue;
+
+      // Ask for the size first, then fill the buffer.
+      size_t size = dev->plugin->save (dev->ctx, NULL, 0);
+      Byte *state = malloc (size ? size : 1);
+      if (state == NULL)
+        {
+          snapshot_free (snap);
+          return false;
+        }
+      snap->device_size[i] = dev->plugin->save (dev->ctx, state, size);
+      snap->device_state[i] = state;
+    }
+
+  return true;
+}
+
+// Device states are matched by position in mmio.cfg.
+static bool
+devices_match (const Snapshot *snap)
+{
+  if (snap->device_count != mmio_device_count)
+    {
+      printf ("[SNAPSHOT] Device count mismatch (%d saved, %d loaded)\n",
+              snap->device_count, mmio_device_count);
+      return false;
+    }
+  return true;
+}
+
+// Device part of a restore, once memory and registers are back.
+static bool
+restore_devices (const Snapshot *snap)
+{
+  for (int i = 0; i < mmio_device_count; i++)
+    {
+      MMIODevice *dev = &mmio_devices[i];
+
+      if (snap->device_state[i] && dev->plugin && dev->plugin->restore
+          && !dev->plugin->restore (dev->ctx, snap->device_state[i],
+                                    snap->device_size[i]))
+        {
+          printf ("[SNAPSHOT] %s rejected its saved state\n", dev->name);
+          return false;
+        }
+
+      // Devices reschedule themselves against the restored cycle count.
+      if (dev->tick)
+        mmio_sync_device (dev, total_cycles_executed);
+    }
+
+  // Pace from the restored cycle count, not from the original start.
+  clock_init ();
+  return true;
+}
+
+bool
+snapshot_restore (const Snapshot *snap, CPU6502 *cpu, MEM6502 *memory)
+{
+  if (!devices_match (snap))
+    return false;
+
+  *cpu = snap->cpu;
+  total_cycles_executed = snap->cycles;
+  memcpy (memory->Data, snap->ram, MAX_MEM);
+  markMem6502Dirty (memory);
+
+  return restore_devices (snap);
+}
+
+void
+snapshot_mark_clean (const MEM6502 *memory, DWord *seen)
+{
+  for (int page = 0; page < PAGE_COUNT; page++)
+    seen[page] = memory->Pages[page].Writes;
+}
+
+bool
+snapshot_restore_dirty (const Snapshot *snap, CPU6502 *cpu,
+                        MEM6502 *memory, DWord *seen)
+{
+  if (!devices_match (snap))
+    return false;
+
+  *cpu = snap->cpu;
+  total_cycles_executed = snap->cycles;
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      MemPage *p = &memory->Pages[page];
+      if (p->Writes == seen[page])
+        continue;
+
+      size_t offset = (size_t)mem6502_backing_page (memory, page) * PAGE_SIZE;
+      memcpy (memory->Data + offset, snap->ram + offset, PAGE_SIZE);
+      // Other consumers of the counters see the page change too.
+      seen[page] = ++p->Writes;
+    }
+
+  return restore_devices (snap);
+}
+
+void
+snapshot_free (Snapshot *snap)
+{
+  free (snap->ram);
+  for (int i = 0; i < snap->device_count; i++)
+    free (snap->device_state[i]);
+  memset (snap, 0, sizeof (*snap));
+}
+
+static void
+put_le (FILE *f, QWord value, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    fputc ((int)((value >> (8 * i)) & 0xFF), f);
+}
+
+static bool
+get_le (FILE *f, QWord *value, int bytes)
+{
+  *value = 0;
+  for (int i = 0; i < bytes; i++)
+    {
+      int c = fgetc (f);
+      if (c == EOF)
+        return false;
+      *value |= (QWord)c << (8 * i);
+    }
+  return true;
+}
+
+bool
+snapshot_write (const Snapshot *snap, const char *filename)
+{
+  FILE *f = fopen (filename, "wb");
+  if (f == NULL)
+    {
+      perror (filename);
+      return false;
+    }
+
+  fwrite (SNAPSHOT_MAGIC, 1, 8, f);
+  put_le (f, SNAPSHOT_VERSION, 4);
+  put_le (f, snap->cpu.A, 1);
+  put_le (f, snap->cpu.X, 1);
+  put_le (f, snap->cpu.Y, 1);
+  put_le (f, snap->cpu.SP, 1);
+  put_le (f, snap->cpu.PS, 1);
+  put_le (f, snap->cpu.PC, 2);
+  put_le (f, snap->cycles, 8);
+  fwrite (snap->ram, 1, MAX_MEM, f);
+
+  put_le (f, (QWord)snap->device_count, 4);
+  for (int i = 0; i < snap->device_count; i++)
+    {
+      put_le (f, snap->device_size[i], 4);
+      if (snap->device_size[i])
+        fwrite (snap->device_state[i], 1, snap->device_size[i], f);
+    }
+
+  bool ok = !ferror (f);
+  fclose (f);
+  return ok;
+}
+
+bool
+snapshot_read (Snapshot *snap, const char *filename)
+{
+  FILE *f = fopen (filename, "rb");
+  if (f == NULL)
+    {
+      perror (filename);
+      return false;
+    }
+
+  char magic[8];
+  QWord version, a, x, y, sp, ps, pc, count;
+  bool ok = fread (magic, 1, 8, f) == 8
+            && memcmp (magic, SNAPSHOT_MAGIC, 8) == 0
+            && get_le (f, &version, 4) && version == SNAPSHOT_VERSION
+            && get_le (f, &a, 1) && get_le (f, &x, 1) && get_le (f, &y, 1)
+            && get_le (f, &sp, 1) && get_le (f, &ps, 1)
+            && get_le (f, &pc, 2) && get_le (f, &snap->cycles, 8);
+
+  if (ok)
+    {
+      memset (&snap->cpu, 0, sizeof (snap->cpu));
+      snap->cpu.A = (Byte)a;
+      snap->cpu.X = (Byte)x;
+      snap->cpu.Y = (Byte)y;
+      snap->cpu.SP = (Byte)sp;
+      snap->cpu.PS = (Byte)ps;
+      snap->cpu.PC = (Word)pc;
+
+      snap->ram = malloc (MAX_MEM);
+      ok = snap->ram && fread (snap->ram, 1, MAX_MEM, f) == MAX_MEM
+           && get_le (f, &count, 4) && count <= MMIO_MAX_DEVICES;
+    }
+
+  if (ok)
+    {
+      snap->device_count = (int)count;
+      for (int i = 0; ok && i < snap->device_count; i++)
+        {
+          QWord size;
+          ok = get_le (f, &size, 4);
+          snap->device_size[i] = (size_t)size;
+          if (ok && size)
+            {
+              snap->device_state[i] = malloc ((size_t)size);
+              ok = snap->device_state[i]
+                   && fread (snap->device_state[i], 1, (size_t)size, f)
+                          == size;
+            }
+        }
+    }
+
+  fclose (f);
+  if (!ok)
+    {
+      printf ("[SNAPSHOT] %s is not a valid snapshot\n", filename);
+      snapshot_free (snap);
+    }
+  return ok;
+}
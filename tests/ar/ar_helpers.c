@@ -0,0 +1,48 @@
+/*
+ * Testes das instruções ADC/SBC (6502) – modo Immediate
+ */
+
+#include "instructions/ar/ar_helpers.h"
+
+/* value + C dá a volta em 8 bits */
+const ar_case_t adc_carry_cases[]
+    = { { "wrap", false, true, 0x00, 0xFF, 0x00, true },
+        { "wrap+1", false, true, 0x01, 0xFF, 0x01, true } };
+
+const ar_case_t adc_decimal_cases[]
+    = { { "15+27", true, false, 0x15, 0x27, 0x42, false },
+        { "99+01", true, false, 0x99, 0x01, 0x00, true } };
+
+/* value + !C dá a volta em 8 bits */
+const ar_case_t sbc_borrow_cases[]
+    = { { "wrap", false, false, 0x00, 0xFF, 0x00, false },
+        { "wrap+1", false, false, 0x01, 0xFF, 0x01, false } };
+
+const ar_case_t sbc_decimal_cases[]
+    = { { "42-15", true, true, 0x42, 0x15, 0x27, true },
+        { "00-01", true, true, 0x00, 0x01, 0x99, false } };
+
+/* ----------------------------------------------------------
+ * Immediate ($69 / $E9)
+ * ---------------------------------------------------------- */
+void
+test_ar_immediate (Instruction ins, const ar_case_t *cases)
+{
+  for (size_t i = 0; i < AR_CASES; ++i)
+    {
+      cpu.A = cases[i].a;
+      cpu.Flag.C = cases[i].carry;
+      cpu.Flag.D = cases[i].decimal;
+
+      const Byte prog[] = { ins, cases[i].value };
+      load_and_run (prog, sizeof prog, 2); /* #immediato = 2 ciclos */
+
+      char msg[32];
+      sprintf (msg, "AR %s", cases[i].label);
+
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE (cases[i].result, cpu.A, msg);
+      TEST_ASSERT_EQUAL_MESSAGE (cases[i].expectC, cpu.Flag.C, "C flag");
+
+      resetCPU (&cpu, &mem);
+    }
+}
@@ -0,0 +1,35 @@
+/*
+ * Testes dos desvios condicionais (6502) – modo Relative
+ */
+
+#include "instructions/br/br_helpers.h"
+
+static const Byte br_offset = 0x10;
+
+/* ----------------------------------------------------------
+ * Não tomado
+ * ---------------------------------------------------------- */
+void
+test_br_not_taken (Instruction ins, Byte status)
+{
+  cpu.PS = status;
+
+  const Byte prog[] = { ins, br_offset };
+  load_and_run (prog, sizeof prog, 2); /* não tomado = 2 ciclos */
+
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8002, cpu.PC, "not taken PC");
+}
+
+/* ----------------------------------------------------------
+ * Tomado
+ * ---------------------------------------------------------- */
+void
+test_br_taken (Instruction ins, Byte status)
+{
+  cpu.PS = status;
+
+  const Byte prog[] = { ins, br_offset };
+  load_and_run (prog, sizeof prog, 3); /* tomado = 3 ciclos */
+
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8002 + br_offset, cpu.PC, "taken PC");
+}
@@ -0,0 +1,302 @@
+/*
+   rosetta-conformance - Runs 6502 test ROMs through the core at full speed.
+
+   Usage: rosetta-conformance [-s] SUITE [TEST...]
+
+   SUITE lists one test per line (see suite.cfg):
+
+     name  image  load=HEX start=HEX [trap=HEX] [check=HEX:HEX]
+                  [cycles=N] [limit=N]
+
+   The image is loaded at `load` into a flat 64 KB of RAM and run from
+   `start` with the clock unthrottled until it traps (an instruction that
+   jumps to itself, which is how these ROMs report their result), reaches
+   an opcode the core does not implement, or runs `limit` instructions
+   (default 200000000). It passes if it trapped at `trap`, the byte at the
+   `check` address holds the given value and the cycle count equals
+   `cycles`, for the conditions that are given.
+
+   Images are looked up relative to the suite file. A missing image is
+   reported as SKIP, or as a failure with -s. Exits with 1 if a test
+   failed or if none ran, so a checkout without the ROMs does not pass.
+*/
+
+#include "cpu_exec.h"
+#include "disasm.h"
+#include "mem6502.h"
+#include "memory_map.h"
+#include <libgen.h>
+#include <time.h>
+
+#define DEFAULT_LIMIT 200000000ULL
+
+typedef struct
+{
+  char name[32];
+  char image[256];
+  long load;
+  long start;
+  long trap;        // -1: any trap ends the test
+  long check_addr;  // -1: no memory check
+  Byte check_value;
+  QWord cycles;     // 0: not checked
+  QWord limit;
+} Conformance;
+
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+static bool strict; // Missing images fail
+
+static bool
+parse_test (char *line, Conformance *test)
+{
+  char *save;
+  char *name = strtok_r (line, " \t\r\n", &save);
+  char *image = strtok_r (NULL, " \t\r\n", &save);
+
+  if (name == NULL || name[0] == '#')
+    return false;
+  if (image == NULL)
+    {
+      printf ("%s: no image\n", name);
+      return false;
+    }
+
+  memset (test, 0, sizeof (*test));
+  snprintf (test->name, sizeof (test->name), "%s", name);
+  snprintf (test->image, sizeof (test->image), "%s", image);
+  test->load = test->start = test->trap = test->check_addr = -1;
+  test->limit = DEFAULT_LIMIT;
+
+  for (char *opt; (opt = strtok_r (NULL, " \t\r\n", &save)) != NULL;)
+    {
+      unsigned addr, value;
+
+      if (opt[0] == '#')
+        break;
+      if (strncmp (opt, "load=", 5) == 0)
+        test->load = strtol (opt + 5, NULL, 16);
+      else if (strncmp (opt, "start=", 6) == 0)
+        test->start = strtol (opt + 6, NULL, 16);
+      else if (strncmp (opt, "trap=", 5) == 0)
+        test->trap = strtol (opt + 5, NULL, 16);
+      else if (sscanf (opt, "check=%x:%x", &addr, &value) == 2)
+        {
+          test->check_addr = addr & 0xFFFF;
+          test->check_value = (Byte)value;
+        }
+      else if (strncmp (opt, "cycles=", 7) == 0)
+        test->cycles = strtoull (opt + 7, NULL, 0);
+      else if (strncmp (opt, "limit=", 6) == 0)
+        test->limit = strtoull (opt + 6, NULL, 0);
+      else
+        printf ("%s: unknown option %s\n", name, opt);
+    }
+
+  if (test->load < 0 || test->start < 0)
+    {
+      printf ("%s: load= and start= are required\n", name);
+      return false;
+    }
+  return true;
+}
+
+static double
+seconds (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Runs one test. Returns 1 if it passed, 0 if it failed and -1 if its
+// image is missing.
+static int
+run_test (const Conformance *test, const char *dir)
+{
+  char path[512];
+  static Byte image[0x10001];
+
+  if (test->image[0] == '/')
+    snprintf (path, sizeof (path), "%s", test->image);
+  else
+    snprintf (path, sizeof (path), "%s/%s", dir, test->image);
+
+  FILE *f = fopen (path, "rb");
+  if (f == NULL)
+    {
+      printf ("%-12s %s  %s not found\n", test->name,
+              strict ? "FAIL" : "SKIP", path);
+      return -1;
+    }
+  size_t size = fread (image, 1, sizeof (image), f);
+  fclose (f);
+  if (size == 0 || test->load + (long)size > 0x10000)
+    {
+      printf ("%-12s FAIL  %s does not fit at $%04lX\n", test->name, path,
+              (unsigned long)test->load);
+      return 0;
+    }
+
+  memset (mem.Data, 0, MAX_MEM);
+  memcpy (mem.Data + test->load, image, size);
+  markMem6502Dirty (&mem);
+
+  memset (&cpu, 0, sizeof (cpu));
+  cpu.SP = 0xFD;
+  cpu.PS = 0x24;
+  cpu.PC = (Word)test->start;
+  total_cycles_executed = 0;
+
+  const char *stop = "instruction limit reached";
+  QWord executed = 0;
+  double began = seconds ();
+
+  while (executed < test->limit)
+    {
+      Word pc = cpu.PC;
+      if (opcode_info[mem.Data[pc]].mnemonic == NULL)
+        {
+          stop = "unimplemented opcode";
+          break;
+        }
+      run_cpu_instruction (&bus, &mem, &cpu);
+      executed++;
+      if (cpu.PC == pc)
+        {
+          stop = "trap";
+          break;
+        }
+    }
+
+  double elapsed = seconds () - began;
+  bool passed = strcmp (stop, "trap") == 0 || test->trap < 0;
+  char why[128] = "";
+
+  if (test->trap >= 0 && (strcmp (stop, "trap") != 0 || cpu.PC != test->trap))
+    {
+      passed = false;
+      snprintf (why, sizeof (why), "%s at $%04X, expected trap at $%04lX",
+                stop, cpu.PC, (unsigned long)test->trap);
+    }
+  else if (test->trap < 0 && executed == test->limit)
+    {
+      passed = false;
+      snprintf (why, sizeof (why), "%s at $%04X", stop, cpu.PC);
+    }
+  else if (test->check_addr >= 0
+           && mem.Data[test->check_addr] != test->check_value)
+    {
+      passed = false;
+      snprintf (why, sizeof (why), "$%04lX = $%02X, expected $%02X",
+                (unsigned long)test->check_addr, mem.Data[test->check_addr],
+                test->check_value);
+    }
+  else if (test->cycles && total_cycles_executed != test->cycles)
+    {
+      passed = false;
+      snprintf (why, sizeof (why), "%llu cycles, expected %llu",
+                (unsigned long long)total_cycles_executed,
+                (unsigned long long)test->cycles);
+    }
+
+  printf ("%-12s %s  %llu instructions, %llu cycles, %.2f s, "
+          "%.1f M instructions/s\n",
+          test->name, passed ? "PASS" : "FAIL", (unsigned long long)executed,
+          (unsigned long long)total_cycles_executed, elapsed,
+          elapsed > 0 ? executed / elapsed / 1e6 : 0.0);
+
+  if (!passed)
+    {
+      char line[64];
+      Byte bytes[3];
+
+      for (int i = 0; i < 3; i++)
+        bytes[i] = mem.Data[(Word)(cpu.PC + i)];
+      disasm_line (cpu.PC, bytes, line, sizeof (line));
+      printf ("             %s\n", why);
+      printf ("             %s   A=%02X X=%02X Y=%02X SP=%02X P=%02X\n",
+              line, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.PS);
+    }
+  return passed;
+}
+
+static bool
+selected (const char *name, int count, char *names[])
+{
+  if (count == 0)
+    return true;
+  for (int i = 0; i < count; i++)
+    if (strcmp (names[i], name) == 0)
+      return true;
+  return false;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int arg = 1;
+
+  if (arg < argc && strcmp (argv[arg], "-s") == 0)
+    {
+      strict = true;
+      arg++;
+    }
+  if (arg >= argc)
+    {
+      fprintf (stderr, "Usage: %s [-s] SUITE [TEST...]\n", argv[0]);
+      return 2;
+    }
+
+  const char *suite = argv[arg++];
+  FILE *f = fopen (suite, "r");
+  if (f == NULL)
+    {
+      perror (suite);
+      return 2;
+    }
+
+  char suite_copy[512];
+  snprintf (suite_copy, sizeof (suite_copy), "%s", suite);
+  const char *dir = dirname (suite_copy);
+
+  // Test ROMs own the whole address space, vectors included.
+  memory_map_clear ();
+  memory_map_add_region (REGION_RAM, 0x0000, 0xFFFF, 0, 0);
+  initializeMem6502 (&mem);
+  clock_unthrottled = true;
+
+  // The core reports unimplemented opcodes; the summary says it anyway.
+  setvbuf (stdout, NULL, _IOLBF, 0);
+
+  char line[512];
+  int passed = 0, failed = 0, skipped = 0;
+  Conformance test;
+
+  while (fgets (line, sizeof (line), f))
+    {
+      if (!parse_test (line, &test) || !selected (test.name, argc - arg,
+                                                  &argv[arg]))
+        continue;
+
+      int result = run_test (&test, dir);
+      if (result > 0)
+        passed++;
+      else if (result == 0 || strict)
+        failed++;
+      else
+        skipped++;
+    }
+  fclose (f);
+
+  printf ("%d passed, %d failed, %d skipped\n", passed, failed, skipped);
+  freeMem6502 (&mem);
+  if (passed + failed == 0)
+    {
+      fprintf (stderr, "No test ran: see tests/conformance/README.md for "
+                       "the ROMs\n");
+      return 1;
+    }
+  return failed ? 1 : 0;
+}
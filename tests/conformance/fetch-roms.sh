@@ -0,0 +1,95 @@
+# Conformance ROM fetcher
+# Usage:
+#   sh tests/conformance/fetch-roms.sh        # download and verify
+#   sh tests/conformance/fetch-roms.sh -p     # download and pin the sums
+#
+# Downloads Klaus Dormann's test ROMs into roms/ (see README.md) and checks
+# them against tests/conformance/roms.sha256. The functional test comes
+# pre-assembled from bin_files/; the decimal test is fetched as source, to
+# be assembled with as65.
+#
+# Files whose sum is not pinned yet are refused. -p records the sums of
+# what was downloaded instead: check the ROMs pass (make conformance) and
+# match the upstream listings, then commit roms.sha256.
+
+set -e
+
+UPSTREAM="${ROSETTA_ROMS_URL:-https://raw.githubusercontent.com/Klaus2m5/6502_65C02_functional_tests}"
+REF="${ROSETTA_ROMS_REF:-master}"
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+ROOT_DIR="$(cd "$SCRIPT_DIR/../.." && pwd)"
+ROM_DIR="$ROOT_DIR/roms"
+SUMS="$SCRIPT_DIR/roms.sha256"
+
+PIN=0
+if [ "$1" = "-p" ]; then
+    PIN=1
+fi
+
+fetch() {
+    if command -v curl >/dev/null 2>&1; then
+        curl -fsSL "$1" -o "$2"
+    elif command -v wget >/dev/null 2>&1; then
+        wget -q "$1" -O "$2"
+    else
+        echo "Error: neither curl nor wget is installed"
+        exit 1
+    fi
+}
+
+sha256() {
+    if command -v sha256sum >/dev/null 2>&1; then
+        sha256sum "$1" | cut -d' ' -f1
+    else
+        shasum -a 256 "$1" | cut -d' ' -f1
+    fi
+}
+
+# Pinned sum of a file name, empty if none.
+pinned() {
+    grep -v '^#' "$SUMS" 2>/dev/null | awk -v f="$1" '$2 == f { print $1 }'
+}
+
+# Verifies roms/<name>, or records its sum with -p.
+verify() {
+    name="$1"
+    sum="$(sha256 "$ROM_DIR/$name")"
+    want="$(pinned "$name")"
+
+    if [ "$PIN" = 1 ]; then
+        grep -v " $name\$" "$SUMS" > "$SUMS.tmp" || true
+        echo "$sum  $name" >> "$SUMS.tmp"
+        mv "$SUMS.tmp" "$SUMS"
+        echo "Pinned  : $name $sum"
+    elif [ -z "$want" ]; then
+        echo "Error: no pinned sum for $name (got $sum); see -p"
+        rm -f "$ROM_DIR/$name"
+        exit 1
+    elif [ "$sum" != "$want" ]; then
+        echo "Error: $name sum $sum, expected $want"
+        rm -f "$ROM_DIR/$name"
+        exit 1
+    else
+        echo "Verified: $name"
+    fi
+}
+
+mkdir -p "$ROM_DIR"
+echo "Upstream: $UPSTREAM ($REF)"
+
+fetch "$UPSTREAM/$REF/bin_files/6502_functional_test.bin" \
+      "$ROM_DIR/6502_functional_test.bin"
+verify 6502_functional_test.bin
+
+fetch "$UPSTREAM/$REF/6502_decimal_test.a65" "$ROM_DIR/6502_decimal_test.a65"
+verify 6502_decimal_test.a65
+
+# The decimal binary depends on how it was assembled (README.md), so it
+# is only checked once it is there.
+if [ -f "$ROM_DIR/6502_decimal_test.bin" ]; then
+    verify 6502_decimal_test.bin
+else
+    echo "Assemble roms/6502_decimal_test.a65 with as65 into"
+    echo "roms/6502_decimal_test.bin to run the decimal test"
+fi
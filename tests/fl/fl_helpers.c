@@ -0,0 +1,17 @@
+/*
+ * Testes das instruções de flags (6502) – modo Implied
+ */
+
+#include "instructions/fl/fl_helpers.h"
+
+void
+test_fl_implied (Instruction ins, Byte before, Byte mask, bool expected)
+{
+  cpu.PS = before;
+
+  const Byte prog[] = { ins };
+  load_and_run (prog, sizeof prog, 2); /* implied = 2 ciclos */
+
+  TEST_ASSERT_EQUAL_MESSAGE (expected, (cpu.PS & mask) != 0, "flag");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8001, cpu.PC, "implied PC");
+}
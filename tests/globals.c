@@ -5,7 +5,7 @@ Bus6502 bus;
 MEM6502 mem;
 Word cycles;
 
-/* Copia o programa para $8000, ajusta cycles e executa até zerar */
+/* Copia o programa para $8000 e executa expected_cycles ciclos */
 void
 load_and_run (const Byte *prog, size_t len, Word expected_cycles)
 {
@@ -17,9 +17,9 @@ load_and_run (const Byte *prog, size_t len, Word expected_cycles)
 
   memcpy (&mem.Data[0x8000], prog, len);
 
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
   clock_init ();
-  while (1)
-    run_cpu_instruction (&cycles, &bus, &mem, &cpu);
+  run_cycles (&machine, expected_cycles);
 }
 
 void
@@ -0,0 +1,45 @@
+/*
+ * Testes de INC/DEC em memória (6502) – modos: ABS, ABS,X
+ */
+
+#include "instructions/ic/ic_helpers.h"
+
+/* ----------------------------------------------------------
+ * ABS ($EE)
+ * ---------------------------------------------------------- */
+void
+test_ic_abs (Instruction ins, Byte value, Byte expected)
+{
+  const Word addr = 0x0300;
+
+  mem.Data[addr] = value;
+
+  const Byte prog[] = { ins, addr & 0xFF, addr >> 8 };
+  load_and_run (prog, sizeof prog, 6); /* abs = 6 ciclos */
+
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (expected, mem.Data[addr], "ABS mem");
+  TEST_ASSERT_EQUAL_MESSAGE (expected == 0, cpu.Flag.Z, "Z flag");
+  TEST_ASSERT_EQUAL_MESSAGE ((expected & 0x80) != 0, cpu.Flag.N, "N flag");
+}
+
+/* ----------------------------------------------------------
+ * ABS,X ($FE)
+ * ---------------------------------------------------------- */
+void
+test_ic_absx (Instruction ins, Byte value, Byte expected)
+{
+  const Word base = 0x0300;
+  const Byte offset = 0x05;
+  const QWord before = total_cycles_executed;
+
+  cpu.X = offset;
+  mem.Data[base + offset] = value;
+
+  const Byte prog[] = { ins, base & 0xFF, base >> 8 };
+  load_and_run (prog, sizeof prog, 7); /* abs,X = 7 ciclos */
+
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (expected, mem.Data[base + offset],
+                                   "ABSX mem");
+  TEST_ASSERT_EQUAL_MESSAGE (7, total_cycles_executed - before, "cycles");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8003, cpu.PC, "ABSX PC");
+}
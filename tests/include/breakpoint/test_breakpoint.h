@@ -0,0 +1,238 @@
+#ifndef TEST_BREAKPOINT
+#define TEST_BREAKPOINT
+
+#include "breakpoint.h"
+#include "memory_map.h"
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Testes de breakpoints e watchpoints – breakpoint_parse,
+ * condições, bitmaps e debug_page_flags no mapa de páginas
+ * -------------------------------------------------------- */
+
+static const Breakpoint *
+bp_find (int id)
+{
+  for (int i = 0; i < BREAKPOINT_MAX; i++)
+    if (breakpoints[i].id == id)
+      return &breakpoints[i];
+  return NULL;
+}
+
+void
+test_breakpoint_parse (void)
+{
+  breakpoint_clear (&mem);
+
+  const Breakpoint *bp = bp_find (breakpoint_parse (&mem, "8000"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL_MESSAGE (BREAK_EXEC, bp->kind, "default kind");
+  TEST_ASSERT_EQUAL_HEX16 (0x8000, bp->start);
+  TEST_ASSERT_EQUAL_HEX16 (0x8000, bp->end);
+
+  bp = bp_find (breakpoint_parse (&mem, "read:0200-020F"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL (BREAK_READ, bp->kind);
+  TEST_ASSERT_EQUAL_HEX16 (0x0200, bp->start);
+  TEST_ASSERT_EQUAL_HEX16 (0x020F, bp->end);
+
+  bp = bp_find (breakpoint_parse (&mem, "ACCESS:0300"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL_MESSAGE (BREAK_ACCESS, bp->kind, "kind ignores case");
+
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, ""));
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, "8000-"));
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, "read:10000"));
+  TEST_ASSERT_EQUAL_MESSAGE (-1, breakpoint_parse (&mem, "8010-8000"),
+                             "end before start");
+
+  breakpoint_clear (&mem);
+}
+
+void
+test_breakpoint_condition_parse (void)
+{
+  breakpoint_clear (&mem);
+
+  const Breakpoint *bp = bp_find (breakpoint_parse (&mem, "8000:A==0x10"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL (COND_A, bp->test.lhs);
+  TEST_ASSERT_EQUAL (COND_EQ, bp->test.op);
+  TEST_ASSERT_EQUAL_HEX32 (0x10, bp->test.rhs);
+
+  bp = bp_find (breakpoint_parse (&mem, "8000:[0x0200]>=3"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL (COND_MEMORY, bp->test.lhs);
+  TEST_ASSERT_EQUAL_HEX16 (0x0200, bp->test.address);
+  TEST_ASSERT_EQUAL (COND_GE, bp->test.op);
+  TEST_ASSERT_EQUAL_HEX32 (3, bp->test.rhs);
+
+  bp = bp_find (breakpoint_parse (&mem, "write:0200:value&0x80"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL (COND_VALUE, bp->test.lhs);
+  TEST_ASSERT_EQUAL (COND_AND, bp->test.op);
+
+  bp = bp_find (breakpoint_parse (&mem, "8000"));
+  TEST_ASSERT_NOT_NULL (bp);
+  TEST_ASSERT_EQUAL_MESSAGE (COND_ALWAYS, bp->test.lhs, "unconditional");
+
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, "8000:Q==1"));
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, "8000:A=1"));
+  TEST_ASSERT_EQUAL (-1, breakpoint_parse (&mem, "8000:A=="));
+
+  breakpoint_clear (&mem);
+}
+
+/* O bitmap de execução cobre só o intervalo, não a página toda */
+void
+test_breakpoint_exec_map (void)
+{
+  breakpoint_clear (&mem);
+  breakpoint_parse (&mem, "8010-8011");
+  breakpoint_parse (&mem, "8020:X==3");
+
+  TEST_ASSERT_TRUE (debug_page_flags[0x80] & DEBUG_PAGE_EXEC);
+
+  cpu.PC = 0x800F;
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_check_exec (&mem, &cpu), "before");
+  cpu.PC = 0x8011;
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_check_exec (&mem, &cpu), "inside");
+  cpu.PC = 0x8012;
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_check_exec (&mem, &cpu), "after");
+
+  cpu.PC = 0x8020;
+  cpu.X = 2;
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_check_exec (&mem, &cpu), "X == 2");
+  cpu.X = 3;
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_check_exec (&mem, &cpu), "X == 3");
+
+  breakpoint_clear (&mem);
+}
+
+/* Leitura, escrita e acesso usam bitmaps separados */
+void
+test_breakpoint_access_maps (void)
+{
+  breakpoint_clear (&mem);
+  breakpoint_parse (&mem, "read:0200");
+  breakpoint_parse (&mem, "write:0201");
+  breakpoint_parse (&mem, "access:0202");
+
+  breakpoint_check_access (&mem, &cpu, 0x0200, 0, true);
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_stop_pending, "write to read");
+  breakpoint_check_access (&mem, &cpu, 0x0200, 0, false);
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_stop_pending, "read");
+  breakpoint_rearm ();
+
+  breakpoint_check_access (&mem, &cpu, 0x0201, 0, false);
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_stop_pending, "read of write");
+  breakpoint_check_access (&mem, &cpu, 0x0201, 0x42, true);
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_stop_pending, "write");
+  TEST_ASSERT_EQUAL_HEX8 (0x42, breakpoint_last_hit.value);
+  breakpoint_rearm ();
+
+  breakpoint_check_access (&mem, &cpu, 0x0202, 0, false);
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_stop_pending, "access read");
+  breakpoint_rearm ();
+  breakpoint_check_access (&mem, &cpu, 0x0202, 0, true);
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_stop_pending, "access write");
+
+  breakpoint_clear (&mem);
+}
+
+/* Watchpoints tiram o ponteiro direto da página; remover devolve */
+void
+test_breakpoint_page_flags (void)
+{
+  breakpoint_clear (&mem);
+  TEST_ASSERT_NOT_NULL (mem.Pages[0x02].Read);
+  TEST_ASSERT_NOT_NULL (mem.Pages[0x02].Write);
+
+  int read_id = breakpoint_parse (&mem, "read:0210");
+  TEST_ASSERT_EQUAL_HEX8 (DEBUG_PAGE_READ, debug_page_flags[0x02]);
+  TEST_ASSERT_NULL_MESSAGE (mem.Pages[0x02].Read, "read watched");
+  TEST_ASSERT_NOT_NULL_MESSAGE (mem.Pages[0x02].Write, "write direct");
+
+  int write_id = breakpoint_parse (&mem, "write:0220");
+  TEST_ASSERT_NULL_MESSAGE (mem.Pages[0x02].Write, "write watched");
+  TEST_ASSERT_NOT_NULL_MESSAGE (mem.Pages[0x03].Read, "other page");
+
+  /* Um breakpoint de PC não precisa do caminho lento */
+  breakpoint_parse (&mem, "0300");
+  TEST_ASSERT_NOT_NULL_MESSAGE (mem.Pages[0x03].Read, "exec only");
+
+  breakpoint_remove (&mem, read_id);
+  breakpoint_remove (&mem, write_id);
+  TEST_ASSERT_NOT_NULL (mem.Pages[0x02].Read);
+  TEST_ASSERT_NOT_NULL (mem.Pages[0x02].Write);
+
+  breakpoint_clear (&mem);
+}
+
+/* Buscas de opcode e operando não disparam watchpoints de leitura */
+void
+test_breakpoint_fetch (void)
+{
+  const Byte prog[] = {
+    0xEA,             /* NOP       */
+    0xAD, 0x10, 0x80, /* LDA $8010 */
+  };
+  memcpy (&mem.Data[0x8000], prog, sizeof prog);
+  mem.Data[0x8010] = 0x5A;
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+  breakpoint_clear (&mem);
+  breakpoint_parse (&mem, "read:8000-8003");
+  TEST_ASSERT_EQUAL_MESSAGE (STOP_BUDGET, run_instructions (&machine, 2),
+                             "fetches");
+
+  resetCPU (&cpu, &mem);
+  breakpoint_parse (&mem, "read:8010");
+  machine.instructions = 0;
+  TEST_ASSERT_EQUAL_MESSAGE (STOP_BREAKPOINT,
+                             run_instructions (&machine, 2), "data read");
+  TEST_ASSERT_EQUAL_HEX16 (0x8010, breakpoint_last_hit.address);
+  TEST_ASSERT_EQUAL_HEX8 (0x5A, cpu.A);
+
+  breakpoint_clear (&mem);
+}
+
+/* Um acesso pelo espelho dispara o watchpoint da origem */
+void
+test_breakpoint_mirror (void)
+{
+  breakpoint_clear (&mem);
+  memory_map_clear ();
+  memory_map_parse_line ("RAM 0x0000 0x07FF");
+  memory_map_parse_line ("MIRROR 0x0800 0x0FFF 0x0000");
+  memory_map_compile (&mem);
+
+  breakpoint_parse (&mem, "write:0042");
+  TEST_ASSERT_NULL_MESSAGE (mem.Pages[0x08].Write, "mirror watched");
+  TEST_ASSERT_NOT_NULL_MESSAGE (mem.Pages[0x09].Write, "other mirror page");
+
+  cpu_write (&bus, &mem, 0x0843, 0x01, &cpu);
+  TEST_ASSERT_FALSE_MESSAGE (breakpoint_stop_pending, "neighbour");
+  cpu_write (&bus, &mem, 0x0842, 0x01, &cpu);
+  TEST_ASSERT_TRUE_MESSAGE (breakpoint_stop_pending, "through mirror");
+  TEST_ASSERT_EQUAL_HEX16 (0x0842, breakpoint_last_hit.address);
+  TEST_ASSERT_EQUAL_HEX8 (0x01, mem.Data[0x0042]);
+
+  breakpoint_clear (&mem);
+  memory_map_set_defaults ();
+  memory_map_compile (&mem);
+}
+
+void
+test_all_breakpoint (void)
+{
+  RUN_TEST (test_breakpoint_parse);
+  RUN_TEST (test_breakpoint_condition_parse);
+  RUN_TEST (test_breakpoint_exec_map);
+  RUN_TEST (test_breakpoint_access_maps);
+  RUN_TEST (test_breakpoint_page_flags);
+  RUN_TEST (test_breakpoint_fetch);
+  RUN_TEST (test_breakpoint_mirror);
+}
+
+#endif
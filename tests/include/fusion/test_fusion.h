@@ -0,0 +1,243 @@
+#ifndef TEST_FUSION
+#define TEST_FUSION
+
+#include "breakpoint.h"
+#include "coverage.h"
+#include "cpu_exec.h"
+#include "keyboard/test_keyboard.h"
+#include <unistd.h>
+
+/* ----------------------------------------------------------
+ * Testes de pares fundidos – com e sem fusão, as mesmas
+ * chamadas terminam com os mesmos registradores, memória,
+ * ciclos, contagens e motivos de parada
+ * -------------------------------------------------------- */
+
+#define FS_CALLS 400
+
+/* Laço feito dos pares de fused_table.h; a IRQ do teclado
+ * guarda cada byte em $0302 e conta em $0304 */
+static const Byte fs_prog[] = {
+  0x58,             /* 8000 CLI                          */
+  0xA0, 0x00,       /* 8001 LDY #$00                     */
+  0xA2, 0x10,       /* 8003 LDX #$10                     */
+  0xA9, 0x01,       /* 8005 LDA #$01        LDA_IM,STA   */
+  0x8D, 0x01, 0x03, /* 8007 STA $0301                    */
+  0xA5, 0x10,       /* 800A loop: LDA $10   LDA_ZP,STA   */
+  0x8D, 0x00, 0x03, /* 800C STA $0300                    */
+  0xE6, 0x10,       /* 800F INC $10         INC_ZP,BNE   */
+  0xD0, 0x02,       /* 8011 BNE $8015                    */
+  0xE6, 0x11,       /* 8013 INC $11                      */
+  0xAD, 0x02, 0x03, /* 8015 LDA $0302       LDA_ABS,BEQ  */
+  0xF0, 0x04,       /* 8018 BEQ $801E                    */
+  0x29, 0x07,       /* 801A AND #$07        AND_IM,BNE   */
+  0xD0, 0x00,       /* 801C BNE $801E                    */
+  0xBD, 0x00, 0x03, /* 801E LDA $0300,X     LDA_ABSX,STA */
+  0x9D, 0x00, 0x04, /* 8021 STA $0400,X                  */
+  0xB1, 0x12,       /* 8024 LDA ($12),Y     LDA_INDY,STA */
+  0x91, 0x14,       /* 8026 STA ($14),Y     STA_INDY,INY */
+  0xC8,             /* 8028 INY             INY,BNE      */
+  0xD0, 0x01,       /* 8029 BNE $802C                    */
+  0xE8,             /* 802B INX                          */
+  0xC0, 0x80,       /* 802C CPY #$80        CPY,BNE      */
+  0xD0, 0x02,       /* 802E BNE $8032                    */
+  0xA0, 0x00,       /* 8030 LDY #$00                     */
+  0xCA,             /* 8032 DEX             DEX,BNE      */
+  0xD0, 0x02,       /* 8033 BNE $8037                    */
+  0xA2, 0x10,       /* 8035 LDX #$10                     */
+  0xC9, 0x05,       /* 8037 CMP #$05        CMP_IM,BEQ   */
+  0xF0, 0x00,       /* 8039 BEQ $803B                    */
+  0x4C, 0xFD, 0x81, /* 803B JMP tail                     */
+};
+
+/* Par que cruza a página: um breakpoint em $8200 não tira a
+ * fusão da página $81, só a do par */
+static const Byte fs_tail[] = {
+  0xAD, 0x00, 0x03, /* 81FD tail: LDA $0300  LDA_ABS,BEQ */
+  0xF0, 0x00,       /* 8200 BEQ $8202                    */
+  0x4C, 0x0A, 0x80, /* 8202 JMP loop                     */
+};
+
+static const Byte fs_handler[] = {
+  0x48,             /* 8100 PHA       */
+  0xAD, 0x10, 0xD0, /* 8101 LDA $D010 */
+  0x8D, 0x02, 0x03, /* 8104 STA $0302 */
+  0xEE, 0x04, 0x03, /* 8107 INC $0304 */
+  0x68,             /* 810A PLA       */
+  0x40,             /* 810B RTI       */
+};
+
+/* Resultado de uma chamada das funções de execução */
+typedef struct
+{
+  StopReason stop;
+  CPU6502 cpu;
+  QWord cycles;
+  QWord instructions;
+} fs_record_t;
+
+static fs_record_t fs_trace[2][FS_CALLS];
+static Byte fs_ram[2][0x0700];
+
+/* Script com bytes em ciclos espalhados, para que a IRQ caia
+ * entre as duas instruções de um par */
+static void
+fs_write_script (char *path)
+{
+  strcpy (path, "/tmp/rosetta-fusion-XXXXXX");
+  int fd = mkstemp (path);
+  TEST_ASSERT_TRUE (fd >= 0);
+  FILE *f = fdopen (fd, "w");
+  QWord at = 300;
+  for (int i = 0; i < 40; i++)
+    {
+      at += 211 + (QWord)(i * 37) % 97;
+      fprintf (f, "@%llu 0x%02X\n", (unsigned long long)at, i * 29 & 0xFF);
+    }
+  fclose (f);
+}
+
+/* Executa a mesma sequência de chamadas, com fusão (mode 0) ou
+ * sem (mode 1), e grava cada parada */
+static void
+fs_run (int mode, const char *script, const char *const *points)
+{
+  static CoverageBits bits;
+  char args[64];
+  unsigned seed = 5;
+
+  memset (mem.Data, 0, 0x0700);
+  mem.Data[0x13] = 0x05; /* ($12) = $0500 */
+  mem.Data[0x15] = 0x06; /* ($14) = $0600 */
+  memcpy (&mem.Data[0x8000], fs_prog, sizeof fs_prog);
+  memcpy (&mem.Data[0x8100], fs_handler, sizeof fs_handler);
+  memcpy (&mem.Data[0x81FD], fs_tail, sizeof fs_tail);
+  mem.Data[0xFFFE] = 0x00;
+  mem.Data[0xFFFF] = 0x81;
+  resetCPU (&cpu, &mem);
+  total_cycles_executed = 0;
+  clock_init ();
+
+  snprintf (args, sizeof args, "script=%s,irq=1", script);
+  MMIODevice *keyboard = kb_attach (args);
+  TEST_ASSERT_NOT_NULL (keyboard);
+  mmio_sync_device (keyboard, 0);
+
+  breakpoint_clear (&mem);
+  breakpoint_rearm ();
+  for (int i = 0; points[i]; i++)
+    TEST_ASSERT_TRUE (breakpoint_parse (&mem, points[i]) > 0);
+
+  /* coverage_bits desliga a fusão (cpu_exec.c) */
+  coverage_bits = mode ? &bits : NULL;
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  for (int call = 0; call < FS_CALLS; call++)
+    {
+      seed = seed * 1103515245u + 12345u;
+      unsigned r = seed >> 16;
+      StopReason stop;
+
+      if (r % 3 == 0)
+        stop = run_instructions (&machine, 1 + r % 37);
+      else if (r % 3 == 1)
+        stop = run_cycles (&machine, 1 + r % 151);
+      else
+        {
+          RunCondition until = { .on_trap = true,
+                                 .max_cycles = r % 211,
+                                 .max_instructions = r % 23 };
+          if (until.max_cycles == 0 && until.max_instructions == 0)
+            until.max_cycles = 50;
+          stop = run_until (&machine, &until);
+        }
+      if (stop == STOP_BREAKPOINT)
+        breakpoint_resume (&cpu);
+
+      fs_trace[mode][call] = (fs_record_t){ stop, cpu, total_cycles_executed,
+                                            machine.instructions };
+    }
+  coverage_bits = NULL;
+  memcpy (fs_ram[mode], mem.Data, sizeof fs_ram[mode]);
+
+  breakpoint_clear (&mem);
+  kb_detach ();
+}
+
+/* Compara as duas execuções e devolve quantas paradas houve de
+ * cada motivo */
+static void
+fs_compare (const char *const *points, int *counts)
+{
+  char script[32];
+  char label[48];
+
+  fs_write_script (script);
+  fs_run (0, script, points);
+  fs_run (1, script, points);
+  unlink (script);
+
+  for (int call = 0; call < FS_CALLS; call++)
+    {
+      const fs_record_t *fused = &fs_trace[0][call];
+      const fs_record_t *plain = &fs_trace[1][call];
+
+      snprintf (label, sizeof label, "call %d", call);
+      TEST_ASSERT_EQUAL_MESSAGE (plain->stop, fused->stop, label);
+      TEST_ASSERT_EQUAL_UINT64_MESSAGE (plain->cycles, fused->cycles, label);
+      TEST_ASSERT_EQUAL_UINT64_MESSAGE (plain->instructions,
+                                        fused->instructions, label);
+      TEST_ASSERT_EQUAL_HEX16_MESSAGE (plain->cpu.PC, fused->cpu.PC, label);
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (plain->cpu.A, fused->cpu.A, label);
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (plain->cpu.X, fused->cpu.X, label);
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (plain->cpu.Y, fused->cpu.Y, label);
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (plain->cpu.SP, fused->cpu.SP, label);
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (plain->cpu.PS, fused->cpu.PS, label);
+      counts[plain->stop]++;
+    }
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE (fs_ram[1], fs_ram[0], sizeof fs_ram[0],
+                                    "memory");
+}
+
+/* IRQs do teclado no meio dos pares */
+void
+test_fusion_irq (void)
+{
+  static const char *const points[] = { NULL };
+  int counts[STOP_EXIT + 1] = { 0 };
+
+  fs_compare (points, counts);
+  TEST_ASSERT_TRUE_MESSAGE (fs_ram[0][0x0304] > 10, "IRQs taken");
+}
+
+/* Watchpoints na primeira e na segunda instrução de pares */
+void
+test_fusion_watchpoints (void)
+{
+  static const char *const points[]
+      = { "write:0600-0607", "write:0410", "read:0302", NULL };
+  int counts[STOP_EXIT + 1] = { 0 };
+
+  fs_compare (points, counts);
+  TEST_ASSERT_TRUE_MESSAGE (counts[STOP_BREAKPOINT] > 10, "watchpoints hit");
+}
+
+/* Breakpoints de PC na segunda instrução de pares */
+void
+test_fusion_pc_breakpoints (void)
+{
+  static const char *const points[] = { "8200", "8011", "8039", NULL };
+  int counts[STOP_EXIT + 1] = { 0 };
+
+  fs_compare (points, counts);
+  TEST_ASSERT_TRUE_MESSAGE (counts[STOP_BREAKPOINT] > 10, "breakpoints hit");
+}
+
+void
+test_all_fusion (void)
+{
+  RUN_TEST (test_fusion_irq);
+  RUN_TEST (test_fusion_watchpoints);
+  RUN_TEST (test_fusion_pc_breakpoints);
+}
+
+#endif
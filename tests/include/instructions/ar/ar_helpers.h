@@ -0,0 +1,36 @@
+#ifndef AR_HELPERS
+#define AR_HELPERS
+
+/*
+ * Testes das instruções aritméticas ADC/SBC (6502) – modo Immediate
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Casos-de-teste
+ * ---------------------------------------------------------- */
+
+typedef struct
+{
+  const char *label;
+  bool decimal; /* flag D antes da instrução */
+  bool carry;   /* flag C antes da instrução */
+  Byte a;
+  Byte value;
+  Byte result;
+  bool expectC;
+} ar_case_t;
+
+extern const ar_case_t adc_carry_cases[];
+extern const ar_case_t adc_decimal_cases[];
+extern const ar_case_t sbc_borrow_cases[];
+extern const ar_case_t sbc_decimal_cases[];
+#define AR_CASES (2)
+
+/* ----------------------------------------------------------
+ * Immediate ($69 / $E9)
+ * ---------------------------------------------------------- */
+void test_ar_immediate (Instruction ins, const ar_case_t *cases);
+
+#endif // AR_HELPERS
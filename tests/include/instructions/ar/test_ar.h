@@ -0,0 +1,44 @@
+#ifndef TEST_AR
+#define TEST_AR
+
+#include "ar_helpers.h"
+#include "cpu_exec.h"
+
+/* ----------------------------------------------------------
+ * Wrappers para ADC/SBC – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_adc_carry (void)
+{
+  test_ar_immediate (INS_ADC_IM, adc_carry_cases);
+}
+
+void
+test_adc_decimal (void)
+{
+  test_ar_immediate (INS_ADC_IM, adc_decimal_cases);
+}
+
+void
+test_sbc_borrow (void)
+{
+  test_ar_immediate (INS_SBC_IM, sbc_borrow_cases);
+}
+
+void
+test_sbc_decimal (void)
+{
+  test_ar_immediate (INS_SBC_IM, sbc_decimal_cases);
+}
+
+void
+test_all_ar (void)
+{
+  RUN_TEST (test_adc_carry);
+  RUN_TEST (test_adc_decimal);
+  RUN_TEST (test_sbc_borrow);
+  RUN_TEST (test_sbc_decimal);
+}
+
+#endif
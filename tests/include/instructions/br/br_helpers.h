@@ -0,0 +1,20 @@
+#ifndef BR_HELPERS
+#define BR_HELPERS
+
+/*
+ * Testes dos desvios condicionais (6502) – modo Relative
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Não tomado: 2 ciclos, PC pula o operando
+ * ---------------------------------------------------------- */
+void test_br_not_taken (Instruction ins, Byte status);
+
+/* ----------------------------------------------------------
+ * Tomado na mesma página: 3 ciclos
+ * ---------------------------------------------------------- */
+void test_br_taken (Instruction ins, Byte status);
+
+#endif // BR_HELPERS
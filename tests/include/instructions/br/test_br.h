@@ -0,0 +1,71 @@
+#ifndef TEST_BR
+#define TEST_BR
+
+#include "br_helpers.h"
+#include "cpu_exec.h"
+
+/* Bits de P */
+#define BR_Z 0x02
+#define BR_V 0x40
+#define BR_N 0x80
+
+/* ----------------------------------------------------------
+ * Wrappers para os desvios – necessários pois Unity exige funções
+ * void(void)
+ * -------------------------------------------------------- */
+
+void
+test_bne_not_taken (void)
+{
+  test_br_not_taken (INS_BNE, BR_Z);
+}
+
+void
+test_bmi_not_taken (void)
+{
+  test_br_not_taken (INS_BMI, 0);
+}
+
+void
+test_bpl_not_taken (void)
+{
+  test_br_not_taken (INS_BPL, BR_N);
+}
+
+void
+test_bvc_not_taken (void)
+{
+  test_br_not_taken (INS_BVC, BR_V);
+}
+
+void
+test_bvs_not_taken (void)
+{
+  test_br_not_taken (INS_BVS, 0);
+}
+
+void
+test_beq_taken (void)
+{
+  test_br_taken (INS_BEQ, BR_Z);
+}
+
+void
+test_beq_not_taken (void)
+{
+  test_br_not_taken (INS_BEQ, 0);
+}
+
+void
+test_all_br (void)
+{
+  RUN_TEST (test_bne_not_taken);
+  RUN_TEST (test_bmi_not_taken);
+  RUN_TEST (test_bpl_not_taken);
+  RUN_TEST (test_bvc_not_taken);
+  RUN_TEST (test_bvs_not_taken);
+  RUN_TEST (test_beq_taken);
+  RUN_TEST (test_beq_not_taken);
+}
+
+#endif
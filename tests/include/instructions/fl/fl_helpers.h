@@ -0,0 +1,15 @@
+#ifndef FL_HELPERS
+#define FL_HELPERS
+
+/*
+ * Testes das instruções de flags (6502) – modo Implied
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Implied: 2 ciclos, um byte; `mask` é o bit de P alterado
+ * ---------------------------------------------------------- */
+void test_fl_implied (Instruction ins, Byte before, Byte mask, bool expected);
+
+#endif // FL_HELPERS
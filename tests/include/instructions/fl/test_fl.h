@@ -0,0 +1,33 @@
+#ifndef TEST_FL
+#define TEST_FL
+
+#include "cpu_exec.h"
+#include "fl_helpers.h"
+
+/* Bit D de P */
+#define FL_D 0x08
+
+/* ----------------------------------------------------------
+ * Wrappers para SED/CLD – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_sed (void)
+{
+  test_fl_implied (INS_SED, 0, FL_D, true);
+}
+
+void
+test_cld (void)
+{
+  test_fl_implied (INS_CLD, FL_D, FL_D, false);
+}
+
+void
+test_all_fl (void)
+{
+  RUN_TEST (test_sed);
+  RUN_TEST (test_cld);
+}
+
+#endif
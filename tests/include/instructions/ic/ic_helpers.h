@@ -0,0 +1,20 @@
+#ifndef IC_HELPERS
+#define IC_HELPERS
+
+/*
+ * Testes de INC/DEC em memória (6502) – modos: ABS, ABS,X
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * ABS ($EE)
+ * ---------------------------------------------------------- */
+void test_ic_abs (Instruction ins, Byte value, Byte expected);
+
+/* ----------------------------------------------------------
+ * ABS,X ($FE) – 7 ciclos, com ou sem cruzar página
+ * ---------------------------------------------------------- */
+void test_ic_absx (Instruction ins, Byte value, Byte expected);
+
+#endif // IC_HELPERS
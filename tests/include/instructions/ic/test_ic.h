@@ -0,0 +1,37 @@
+#ifndef TEST_IC
+#define TEST_IC
+
+#include "cpu_exec.h"
+#include "ic_helpers.h"
+
+/* ----------------------------------------------------------
+ * Wrappers para INC/DEC – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_inc_abs (void)
+{
+  test_ic_abs (INS_INC_ABS, 0x7F, 0x80);
+}
+
+void
+test_inc_absx (void)
+{
+  test_ic_absx (INS_INC_ABSX, 0xFF, 0x00);
+}
+
+void
+test_dec_absx (void)
+{
+  test_ic_absx (INS_DEC_ABSX, 0x00, 0xFF);
+}
+
+void
+test_all_ic (void)
+{
+  RUN_TEST (test_inc_abs);
+  RUN_TEST (test_inc_absx);
+  RUN_TEST (test_dec_absx);
+}
+
+#endif
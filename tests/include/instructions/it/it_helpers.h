@@ -0,0 +1,15 @@
+#ifndef IT_HELPERS
+#define IT_HELPERS
+
+/*
+ * Testes da interrupção por software BRK (6502)
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * BRK ($00): empilha PC + 2 e P com os bits 4 e 5
+ * ---------------------------------------------------------- */
+void test_it_brk (Byte status);
+
+#endif // IT_HELPERS
@@ -0,0 +1,23 @@
+#ifndef TEST_IT
+#define TEST_IT
+
+#include "cpu_exec.h"
+#include "it_helpers.h"
+
+/* ----------------------------------------------------------
+ * Wrappers para BRK – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_brk (void)
+{
+  test_it_brk (0x81);
+}
+
+void
+test_all_it (void)
+{
+  RUN_TEST (test_brk);
+}
+
+#endif
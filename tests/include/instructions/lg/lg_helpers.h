@@ -0,0 +1,37 @@
+#ifndef LG_HELPERS
+#define LG_HELPERS
+
+/*
+ * Testes das instruções lógicas (6502) – modos: Immediate, ZP
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Casos-de-teste genéricos
+ * ---------------------------------------------------------- */
+
+typedef struct
+{
+  const char *label;
+  Byte a;
+  Byte value;
+  Byte result;
+  bool expectZ;
+  bool expectN;
+} lg_case_t;
+
+extern const lg_case_t eor_cases[];
+#define LG_CASES (3)
+
+/* ----------------------------------------------------------
+ * Immediate ($49)
+ * ---------------------------------------------------------- */
+void test_lg_immediate (Instruction ins, const lg_case_t *cases);
+
+/* ----------------------------------------------------------
+ * Zero Page ($45)
+ * ---------------------------------------------------------- */
+void test_lg_zp (Instruction ins, const lg_case_t *cases);
+
+#endif // LG_HELPERS
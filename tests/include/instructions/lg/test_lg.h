@@ -0,0 +1,30 @@
+#ifndef TEST_LG
+#define TEST_LG
+
+#include "cpu_exec.h"
+#include "lg_helpers.h"
+
+/* ----------------------------------------------------------
+ * Wrappers para EOR – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_eor_immediate (void)
+{
+  test_lg_immediate (INS_EOR_IM, eor_cases);
+}
+
+void
+test_eor_zp (void)
+{
+  test_lg_zp (INS_EOR_ZP, eor_cases);
+}
+
+void
+test_all_lg (void)
+{
+  RUN_TEST (test_eor_immediate);
+  RUN_TEST (test_eor_zp);
+}
+
+#endif
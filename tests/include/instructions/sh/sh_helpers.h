@@ -0,0 +1,31 @@
+#ifndef SH_HELPERS
+#define SH_HELPERS
+
+/*
+ * Testes dos deslocamentos ASL/LSR/ROR (6502) – modos: Accumulator, ZP,
+ * ABS,X e ciclos por modo
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Accumulator ($0A)
+ * ---------------------------------------------------------- */
+void test_sh_acc (Instruction ins, Byte value, Byte expected, bool expectC);
+
+/* ----------------------------------------------------------
+ * Zero Page ($06)
+ * ---------------------------------------------------------- */
+void test_sh_zp (Instruction ins, Byte value, Byte expected, bool expectC);
+
+/* ----------------------------------------------------------
+ * ABS,X ($1E) – 7 ciclos, com ou sem cruzar página
+ * ---------------------------------------------------------- */
+void test_sh_absx (Instruction ins, Byte value, Byte expected, bool expectC);
+
+/* ----------------------------------------------------------
+ * Ciclos gastos por uma instrução de `len` bytes
+ * ---------------------------------------------------------- */
+void test_sh_cycles (Instruction ins, size_t len, Word expected_cycles);
+
+#endif // SH_HELPERS
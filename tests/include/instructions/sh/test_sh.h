@@ -0,0 +1,87 @@
+#ifndef TEST_SH
+#define TEST_SH
+
+#include "cpu_exec.h"
+#include "sh_helpers.h"
+
+/* ----------------------------------------------------------
+ * Wrappers para ASL – necessários pois Unity exige funções void(void)
+ * -------------------------------------------------------- */
+
+void
+test_asl_acc (void)
+{
+  test_sh_acc (INS_ASL_ACC, 0x81, 0x02, true);
+}
+
+void
+test_asl_zp (void)
+{
+  test_sh_zp (INS_ASL_ZP, 0x41, 0x82, false);
+}
+
+void
+test_asl_absx (void)
+{
+  test_sh_absx (INS_ASL_ABSX, 0x81, 0x02, true);
+}
+
+/* ----------------------------------------------------------
+ * LSR
+ * -------------------------------------------------------- */
+
+void
+test_lsr_absx (void)
+{
+  test_sh_absx (INS_LSR_ABSX, 0x81, 0x40, true);
+}
+
+/* ----------------------------------------------------------
+ * ROR – ciclos em cada modo
+ * -------------------------------------------------------- */
+
+void
+test_ror_acc_cycles (void)
+{
+  test_sh_cycles (INS_ROR, 1, 2);
+}
+
+void
+test_ror_zp_cycles (void)
+{
+  test_sh_cycles (INS_ROR_ZP, 2, 5);
+}
+
+void
+test_ror_zpx_cycles (void)
+{
+  test_sh_cycles (INS_ROR_ZPX, 2, 6);
+}
+
+void
+test_ror_abs_cycles (void)
+{
+  test_sh_cycles (INS_ROR_ABS, 3, 6);
+}
+
+void
+test_ror_absx_cycles (void)
+{
+  test_sh_cycles (INS_ROR_ABSX, 3, 7);
+}
+
+void
+test_all_sh (void)
+{
+  RUN_TEST (test_asl_acc);
+  RUN_TEST (test_asl_zp);
+  RUN_TEST (test_asl_absx);
+  RUN_TEST (test_lsr_absx);
+  RUN_TEST (test_ror_acc_cycles);
+  RUN_TEST (test_ror_zp_cycles);
+  RUN_TEST (test_ror_zpx_cycles);
+  RUN_TEST (test_ror_abs_cycles);
+  RUN_TEST (test_ror_absx_cycles);
+}
+
+#endif
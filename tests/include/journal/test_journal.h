@@ -0,0 +1,220 @@
+#ifndef TEST_JOURNAL
+#define TEST_JOURNAL
+
+#include "journal.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "test_config.h"
+#include <unistd.h>
+
+/* ----------------------------------------------------------
+ * Testes do journal – gravar uma execução com leituras do host
+ * e uma IRQ, reproduzi-la e rejeitar um journal adulterado
+ * -------------------------------------------------------- */
+
+#define JN_BASE 0xD020
+#define JN_CYCLES 2000
+
+/* Dispositivo do host: cada leitura devolve um valor novo, e a
+ * IRQ sobe uma vez no ciclo irq_at até uma escrita confirmar */
+typedef struct
+{
+  const MMIOHost *host;
+  Byte next;
+  QWord irq_at;
+  bool fired;
+} jn_device_t;
+
+static jn_device_t jn_state;
+
+static void *
+jn_create (const MMIOHost *host, Word start, Word end, const char *args)
+{
+  (void)start;
+  (void)end;
+  (void)args;
+  jn_state.host = host;
+  return &jn_state;
+}
+
+static Byte
+jn_read (void *ctx, Word addr, QWord cycle)
+{
+  (void)addr;
+  (void)cycle;
+  jn_device_t *dev = ctx;
+  return dev->next++;
+}
+
+static void
+jn_write (void *ctx, Word addr, Byte data, QWord cycle)
+{
+  (void)addr;
+  (void)data;
+  (void)cycle;
+  jn_device_t *dev = ctx;
+  dev->host->set_irq (dev->host->token, false);
+}
+
+static QWord
+jn_tick (void *ctx, QWord until_cycle)
+{
+  jn_device_t *dev = ctx;
+  if (dev->fired)
+    return MMIO_NO_EVENT;
+  if (until_cycle < dev->irq_at)
+    return dev->irq_at;
+  dev->fired = true;
+  dev->host->set_irq (dev->host->token, true);
+  return MMIO_NO_EVENT;
+}
+
+static const MMIOPlugin jn_plugin = {
+  .abi_version = MMIO_PLUGIN_ABI_VERSION,
+  .name = "journal-test",
+  .create = jn_create,
+  .read = jn_read,
+  .write = jn_write,
+  .tick = jn_tick,
+};
+
+/* Programa: copia o dispositivo para $0200,X; a IRQ confirma e
+ * incrementa $10 */
+static void
+jn_load (Byte first_value, QWord irq_at)
+{
+  static const Byte prog[] = {
+    0x58,             /* CLI         */
+    0xAD, 0x20, 0xD0, /* LDA $D020   */
+    0x9D, 0x00, 0x02, /* STA $0200,X */
+    0xE8,             /* INX         */
+    0x4C, 0x01, 0x80, /* JMP $8001   */
+  };
+  static const Byte handler[] = {
+    0x8D, 0x20, 0xD0, /* STA $D020 */
+    0xE6, 0x10,       /* INC $10   */
+    0x40,             /* RTI       */
+  };
+
+  memset (mem.Data, 0, 0x300);
+  memcpy (&mem.Data[0x8000], prog, sizeof prog);
+  memcpy (&mem.Data[0x8100], handler, sizeof handler);
+  mem.Data[0xFFFE] = 0x00;
+  mem.Data[0xFFFF] = 0x81;
+  resetCPU (&cpu, &mem);
+  total_cycles_executed = 0;
+  clock_init ();
+
+  mmio_unload_all ();
+  memset (&jn_state, 0, sizeof jn_state);
+  jn_state.next = first_value;
+  jn_state.irq_at = irq_at;
+  MMIODevice *dev = mmio_add_device ("HOST", JN_BASE, JN_BASE, NULL, NULL,
+                                     NULL);
+  mmio_device_attach (dev, &jn_plugin, "");
+  dev->journal = true;
+  memory_map_compile (&mem);
+  mmio_sync_device (dev, 0);
+}
+
+static void
+jn_unload (void)
+{
+  mmio_unload_all ();
+  memory_map_compile (&mem);
+}
+
+static void
+jn_temp_path (char *path)
+{
+  strcpy (path, "/tmp/rosetta-journal-XXXXXX");
+  int fd = mkstemp (path);
+  if (fd >= 0)
+    close (fd);
+}
+
+/* Grava uma execução e devolve uma cópia da página 2 */
+static void
+jn_record (const char *path, Byte *page)
+{
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+  jn_load (0x40, 300);
+  TEST_ASSERT_TRUE (journal_record (path));
+  run_cycles (&machine, JN_CYCLES);
+  TEST_ASSERT_TRUE_MESSAGE (jn_state.fired, "IRQ raised");
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (1, mem.Data[0x10], "IRQ taken");
+  TEST_ASSERT_TRUE (journal_finish (&cpu, &mem));
+  memcpy (page, &mem.Data[0x0200], 0x100);
+}
+
+/* A reprodução usa os valores e a IRQ gravados, não os do
+ * dispositivo, e o estado final confere com o rodapé */
+void
+test_journal_replay (void)
+{
+  char path[32];
+  Byte recorded[0x100];
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+  jn_temp_path (path);
+  jn_record (path, recorded);
+
+  jn_load (0xC0, MMIO_NO_EVENT); /* A IRQ vem do journal */
+  TEST_ASSERT_TRUE (journal_replay (path));
+  run_cycles (&machine, JN_CYCLES);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (1, mem.Data[0x10], "IRQ replayed");
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE (recorded, &mem.Data[0x0200], 0x100,
+                                    "reads replayed");
+  TEST_ASSERT_TRUE_MESSAGE (journal_finish (&cpu, &mem), "hash matches");
+
+  unlink (path);
+  jn_unload ();
+}
+
+/* Um valor lido adulterado muda o estado final; um cabeçalho
+ * adulterado nem é aceito */
+void
+test_journal_tampered (void)
+{
+  char path[32];
+  Byte recorded[0x100];
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+  jn_temp_path (path);
+  jn_record (path, recorded);
+
+  /* Primeiro bloco: 12 bytes de cabeçalho, contagem em um byte,
+   * depois os valores lidos */
+  FILE *f = fopen (path, "r+b");
+  TEST_ASSERT_NOT_NULL (f);
+  fseek (f, 13, SEEK_SET);
+  int value = fgetc (f);
+  TEST_ASSERT_EQUAL_HEX8 (0x40, value);
+  fseek (f, 13, SEEK_SET);
+  fputc (value ^ 0xFF, f);
+  fclose (f);
+
+  jn_load (0x40, MMIO_NO_EVENT);
+  TEST_ASSERT_TRUE (journal_replay (path));
+  run_cycles (&machine, JN_CYCLES);
+  TEST_ASSERT_FALSE_MESSAGE (journal_finish (&cpu, &mem), "tampered read");
+
+  f = fopen (path, "r+b");
+  TEST_ASSERT_NOT_NULL (f);
+  fputc ('X', f);
+  fclose (f);
+  TEST_ASSERT_FALSE_MESSAGE (journal_replay (path), "tampered magic");
+
+  unlink (path);
+  jn_unload ();
+}
+
+void
+test_all_journal (void)
+{
+  RUN_TEST (test_journal_replay);
+  RUN_TEST (test_journal_tampered);
+}
+
+#endif
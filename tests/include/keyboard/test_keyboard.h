@@ -0,0 +1,71 @@
+#ifndef TEST_KEYBOARD
+#define TEST_KEYBOARD
+
+#include "keyboard.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Testes do teclado roteirizado (device=keyboard)
+ * -------------------------------------------------------- */
+
+#define KB_BASE 0xD010
+
+/* Instala um teclado em $D010 com os args dados */
+static MMIODevice *
+kb_attach (const char *args)
+{
+  MMIODevice *dev = mmio_add_device ("KEYBOARD", KB_BASE, KB_BASE + 1, NULL,
+                                     NULL, NULL);
+  if (dev == NULL || !mmio_device_attach (dev, &mmio_keyboard_device, args))
+    return NULL;
+  memory_map_compile (&mem);
+  return dev;
+}
+
+static void
+kb_detach (void)
+{
+  mmio_unload_all ();
+  memory_map_compile (&mem);
+}
+
+static Byte
+kb_read (Word reg)
+{
+  cpu_read (&bus, &mem, KB_BASE + reg, &cpu);
+  return bus.data;
+}
+
+/* \xHH lê no máximo dois dígitos; escapes simples viram o byte */
+void
+test_keyboard_escapes (void)
+{
+  static const Byte expected[]
+      = { 'A', 'B', 'C', 0x07, 'g', '\n', '\r', '\t', ' ', '\\', 'q' };
+
+  TEST_ASSERT_NOT_NULL (kb_attach ("text=\\x41BC\\x7g\\n\\r\\t\\s\\\\\\q"));
+
+  for (size_t i = 0; i < sizeof expected; i++)
+    {
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (KEYBOARD_STATUS_READY,
+                                      kb_read (KEYBOARD_REG_STATUS),
+                                      "ready");
+      TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected[i], kb_read (KEYBOARD_REG_DATA),
+                                      "byte");
+    }
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (KEYBOARD_STATUS_DONE,
+                                  kb_read (KEYBOARD_REG_STATUS), "done");
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (0, kb_read (KEYBOARD_REG_DATA), "empty");
+
+  kb_detach ();
+}
+
+void
+test_all_keyboard (void)
+{
+  RUN_TEST (test_keyboard_escapes);
+}
+
+#endif
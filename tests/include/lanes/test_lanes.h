@@ -0,0 +1,182 @@
+#ifndef TEST_LANES
+#define TEST_LANES
+
+#include "breakpoint.h"
+#include "keyboard/test_keyboard.h"
+#include "lanes.h"
+#include "run/run_helpers.h"
+#include "snapshot.h"
+
+/* ----------------------------------------------------------
+ * Testes de lanes – cada lane termina com os mesmos
+ * registradores, memória, ciclos e motivo de parada que o
+ * interpretador com a mesma entrada
+ * -------------------------------------------------------- */
+
+#define LN_BUDGET 100000
+
+/* Lê o teclado até acabar; bytes com o bit 7 seguem por um
+ * caminho decimal, os outros por um binário, então as lanes
+ * divergem e voltam a se juntar em store */
+static const Byte ln_prog[] = {
+  0xA2, 0x00,       /* 8000 LDX #$00         */
+  0xAD, 0x11, 0xD0, /* 8002 LDA $D011        */
+  0x29, 0x01,       /* 8005 AND #$01         */
+  0xF0, 0x1A,       /* 8007 BEQ done         */
+  0xAD, 0x10, 0xD0, /* 8009 LDA $D010        */
+  0x30, 0x08,       /* 800C BMI high         */
+  0x0A,             /* 800E ASL A            */
+  0x65, 0x10,       /* 800F ADC $10          */
+  0x85, 0x10,       /* 8011 STA $10          */
+  0x4C, 0x1C, 0x80, /* 8013 JMP store        */
+  0xF8,             /* 8016 high: SED        */
+  0x69, 0x27,       /* 8017 ADC #$27         */
+  0xD8,             /* 8019 CLD              */
+  0x4A,             /* 801A LSR A            */
+  0xA8,             /* 801B TAY              */
+  0x9D, 0x00, 0x02, /* 801C store: STA $0200,X */
+  0xE8,             /* 801F INX              */
+  0x4C, 0x02, 0x80, /* 8020 JMP $8002        */
+  0xA5, 0x10,       /* 8023 done: LDA $10    */
+  0x8D, 0xFF, 0xD0, /* 8025 STA $D0FF        */
+  0x4C, 0x28, 0x80, /* 8028 JMP $8028        */
+};
+
+static Lanes6502 ln_lanes;
+static Byte ln_input[LANES_MAX][24];
+static size_t ln_length[LANES_MAX];
+
+/* Entradas pseudoaleatórias de 0 a 23 bytes, uma por lane */
+static void
+ln_make_inputs (void)
+{
+  unsigned seed = 7;
+  for (int k = 0; k < LANES_MAX; k++)
+    {
+      ln_length[k] = (size_t)(k * 5) % sizeof ln_input[k];
+      for (size_t i = 0; i < ln_length[k]; i++)
+        {
+          seed = seed * 1103515245u + 12345u;
+          ln_input[k][i] = (Byte)(seed >> 16);
+        }
+    }
+}
+
+/* Carrega o programa com teclado e saída e inicia as lanes */
+static MMIODevice *
+ln_boot (Snapshot *boot)
+{
+  MMIODevice *keyboard = kb_attach ("text=");
+  TEST_ASSERT_NOT_NULL (keyboard);
+  run_add_exit_device ();
+  run_load (ln_prog, sizeof ln_prog);
+  resetCPU (&cpu, &mem);
+  TEST_ASSERT_TRUE (snapshot_take (boot, &cpu, &mem));
+
+  TEST_ASSERT_TRUE (lanes_init (&ln_lanes, LANES_MAX, &cpu, &mem, keyboard));
+  ln_make_inputs ();
+  for (int k = 0; k < LANES_MAX; k++)
+    lanes_set_input (&ln_lanes, k, ln_input[k], ln_length[k]);
+  return keyboard;
+}
+
+/* Roda a entrada da lane k no interpretador e compara */
+static void
+ln_compare (MMIODevice *keyboard, const Snapshot *boot, int k,
+            QWord max_cycles)
+{
+  static const StopReason stops[] = {
+    [LANE_BUDGET] = STOP_BUDGET, [LANE_TRAP] = STOP_TRAP,
+    [LANE_BREAKPOINT] = STOP_BREAKPOINT, [LANE_EXIT] = STOP_EXIT,
+  };
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  RunCondition until = { .on_trap = true, .max_cycles = max_cycles };
+  char label[32];
+
+  TEST_ASSERT_TRUE (snapshot_restore (boot, &cpu, &mem));
+  mmio_exit_requested = 0;
+  breakpoint_rearm ();
+  mmio_keyboard_set_input (keyboard, ln_input[k], ln_length[k]);
+  StopReason stop = run_until (&machine, &until);
+
+  snprintf (label, sizeof label, "lane %d", k);
+  TEST_ASSERT_TRUE_MESSAGE (ln_lanes.state[k] <= LANE_EXIT, label);
+  TEST_ASSERT_EQUAL_MESSAGE (stop, stops[ln_lanes.state[k]], label);
+  TEST_ASSERT_EQUAL_UINT64_MESSAGE (total_cycles_executed,
+                                    ln_lanes.cycles[k], label);
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (cpu.PC, ln_lanes.PC[k], label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (cpu.A, ln_lanes.A[k], label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (cpu.X, ln_lanes.X[k], label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (cpu.Y, ln_lanes.Y[k], label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (cpu.SP, ln_lanes.SP[k], label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (cpu.PS, ln_lanes.P[k], label);
+  if (stop == STOP_EXIT)
+    TEST_ASSERT_EQUAL_HEX8_MESSAGE (mmio_exit_code, ln_lanes.exit_code[k],
+                                    label);
+
+  /* No mapa padrão o armazenamento da lane segue o endereço */
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE (
+      mem.Data, ln_lanes.ram + ((size_t)k << 16), 0x300, label);
+}
+
+static void
+ln_finish (Snapshot *boot)
+{
+  lanes_free (&ln_lanes);
+  snapshot_free (boot);
+  breakpoint_clear (&mem);
+  run_remove_devices ();
+}
+
+/* Todas as lanes chegam à saída */
+void
+test_lanes_exit (void)
+{
+  Snapshot boot = { 0 };
+  MMIODevice *keyboard = ln_boot (&boot);
+
+  TEST_ASSERT_EQUAL (LANES_MAX, lanes_run (&ln_lanes, LN_BUDGET));
+  for (int k = 0; k < LANES_MAX; k++)
+    {
+      TEST_ASSERT_EQUAL (LANE_EXIT, ln_lanes.state[k]);
+      ln_compare (keyboard, &boot, k, LN_BUDGET);
+    }
+  TEST_ASSERT_TRUE_MESSAGE (ln_lanes.steps < ln_lanes.instructions,
+                            "lanes share steps");
+
+  ln_finish (&boot);
+}
+
+/* Orçamento curto e breakpoint de PC no caminho decimal: as
+ * lanes param no mesmo ponto que o interpretador */
+void
+test_lanes_budget_and_breakpoint (void)
+{
+  Snapshot boot = { 0 };
+  MMIODevice *keyboard = ln_boot (&boot);
+
+  breakpoint_parse (&mem, "8019");
+  lanes_break (&ln_lanes, 0x8019);
+  lanes_run (&ln_lanes, 150);
+
+  int stopped = 0;
+  for (int k = 0; k < LANES_MAX; k++)
+    {
+      stopped |= 1 << ln_lanes.state[k];
+      ln_compare (keyboard, &boot, k, 150);
+    }
+  TEST_ASSERT_TRUE_MESSAGE (stopped & (1 << LANE_BUDGET), "budget");
+  TEST_ASSERT_TRUE_MESSAGE (stopped & (1 << LANE_BREAKPOINT), "breakpoint");
+  TEST_ASSERT_TRUE_MESSAGE (stopped & (1 << LANE_EXIT), "exit");
+
+  ln_finish (&boot);
+}
+
+void
+test_all_lanes (void)
+{
+  RUN_TEST (test_lanes_exit);
+  RUN_TEST (test_lanes_budget_and_breakpoint);
+}
+
+#endif
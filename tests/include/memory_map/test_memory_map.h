@@ -0,0 +1,114 @@
+#ifndef TEST_MEMORY_MAP
+#define TEST_MEMORY_MAP
+
+#include "memory_map.h"
+#include "mmio.h"
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Testes do mapa de memória – memory_map_parse_line e
+ * memory_map_compile
+ * -------------------------------------------------------- */
+
+static Word mm_last_addr;
+
+static Byte
+mm_read_addr (void *ctx, Word addr, QWord cycle)
+{
+  (void)ctx;
+  (void)cycle;
+  mm_last_addr = addr;
+  return (Byte)addr;
+}
+
+/* Recompila com o mapa padrão e sem dispositivos */
+static void
+mm_restore (void)
+{
+  mmio_unload_all ();
+  memory_map_set_defaults ();
+  memory_map_compile (&mem);
+}
+
+void
+test_memory_map_parse_line (void)
+{
+  memory_map_clear ();
+
+  TEST_ASSERT_TRUE_MESSAGE (memory_map_parse_line ("RAM 0x0000 0x07FF"),
+                            "RAM");
+  TEST_ASSERT_TRUE_MESSAGE (memory_map_parse_line ("ROM 0xE000 0xFFFF"),
+                            "ROM");
+  TEST_ASSERT_TRUE_MESSAGE (
+      memory_map_parse_line ("MIRROR 0x0800 0x1FFF 0x0000"), "MIRROR");
+  TEST_ASSERT_EQUAL_MESSAGE (3, memory_region_count, "region count");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x17FF, memory_regions[2].source_end,
+                                   "mirror source end");
+
+  TEST_ASSERT_FALSE_MESSAGE (memory_map_parse_line ("RAM 0x0010 0x07FF"),
+                             "unaligned start");
+  TEST_ASSERT_FALSE_MESSAGE (memory_map_parse_line ("MIRROR 0x0800 0x1FFF"),
+                             "mirror without source");
+  TEST_ASSERT_FALSE_MESSAGE (memory_map_parse_line ("FLASH 0x0000 0x00FF"),
+                             "unknown kind");
+  TEST_ASSERT_EQUAL_MESSAGE (3, memory_region_count, "rejected lines");
+
+  mm_restore ();
+}
+
+/* O espelho de um espelho declarado depois resolve para a RAM */
+void
+test_memory_map_mirror_chain (void)
+{
+  memory_map_clear ();
+  memory_map_parse_line ("RAM 0x0000 0x07FF");
+  memory_map_parse_line ("MIRROR 0x1000 0x10FF 0x0800 0x08FF");
+  memory_map_parse_line ("MIRROR 0x0800 0x0FFF 0x0000 0x07FF");
+  memory_map_compile (&mem);
+
+  TEST_ASSERT_EQUAL_MESSAGE (REGION_RAM, mem.Pages[0x10].Kind, "kind");
+  TEST_ASSERT_EQUAL_PTR_MESSAGE (&mem.Data[0x0000], mem.Pages[0x10].Backing,
+                                 "backing");
+
+  mem.Data[0x0042] = 0x5A;
+  cpu_read (&bus, &mem, 0x1042, &cpu);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (0x5A, bus.data, "read through chain");
+
+  mm_restore ();
+}
+
+/* O espelho de um dispositivo chega ao dispositivo, com o endereço
+ * de origem */
+void
+test_memory_map_mirror_device (void)
+{
+  mmio_unload_all ();
+  MMIODevice *dev
+      = mmio_add_device ("probe", 0xD000, 0xD00F, mm_read_addr, NULL, NULL);
+  TEST_ASSERT_NOT_NULL (dev);
+
+  memory_map_clear ();
+  memory_map_parse_line ("RAM 0x0000 0xCFFF");
+  memory_map_parse_line ("MIRROR 0xD100 0xD1FF 0xD000 0xD0FF");
+  memory_map_compile (&mem);
+
+  TEST_ASSERT_EQUAL_PTR_MESSAGE (dev, mem.Pages[0xD1].Devices[0x03],
+                                 "mirrored device");
+  TEST_ASSERT_NULL (mem.Pages[0xD1].Read);
+
+  cpu_read (&bus, &mem, 0xD103, &cpu);
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0xD003, mm_last_addr, "device address");
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (0x03, bus.data, "device value");
+
+  mm_restore ();
+}
+
+void
+test_all_memory_map (void)
+{
+  RUN_TEST (test_memory_map_parse_line);
+  RUN_TEST (test_memory_map_mirror_chain);
+  RUN_TEST (test_memory_map_mirror_device);
+}
+
+#endif
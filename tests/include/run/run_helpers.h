@@ -0,0 +1,28 @@
+#ifndef RUN_HELPERS
+#define RUN_HELPERS
+
+/*
+ * Testes das funções de execução – run_cycles, run_instructions e
+ * run_until
+ */
+
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Copia o programa para $8000 e devolve uma máquina com o
+ * contador de instruções zerado
+ * ---------------------------------------------------------- */
+Machine6502 run_load (const Byte *prog, size_t len);
+
+/* ----------------------------------------------------------
+ * Condição de run_until: X chegou a *(Byte *)arg
+ * ---------------------------------------------------------- */
+bool run_x_reaches (const Machine6502 *machine, void *arg);
+
+/* ----------------------------------------------------------
+ * Dispositivo de saída (write=mmio_exit) em $D0FF
+ * ---------------------------------------------------------- */
+void run_add_exit_device (void);
+void run_remove_devices (void);
+
+#endif // RUN_HELPERS
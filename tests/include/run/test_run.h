@@ -0,0 +1,166 @@
+#ifndef TEST_RUN
+#define TEST_RUN
+
+#include "breakpoint.h"
+#include "cpu_exec.h"
+#include "mmio.h"
+#include "run_helpers.h"
+
+/* ----------------------------------------------------------
+ * Motivos de parada de run_cycles, run_instructions e run_until
+ * -------------------------------------------------------- */
+
+/* A última instrução pode passar do orçamento de ciclos */
+void
+test_run_budget_overshoot (void)
+{
+  const Byte prog[] = {
+    0xEA,             /* NOP       2 ciclos */
+    0xAD, 0x00, 0x02, /* LDA $0200 4 ciclos */
+    0xEA,             /* NOP                */
+  };
+  Machine6502 machine = run_load (prog, sizeof prog);
+  QWord start = total_cycles_executed;
+
+  TEST_ASSERT_EQUAL (STOP_BUDGET, run_cycles (&machine, 3));
+  TEST_ASSERT_EQUAL_UINT64_MESSAGE (6, total_cycles_executed - start,
+                                    "cycles");
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+  TEST_ASSERT_EQUAL_HEX16 (0x8004, cpu.PC);
+
+  TEST_ASSERT_EQUAL (STOP_BUDGET, run_instructions (&machine, 1));
+  TEST_ASSERT_EQUAL_UINT64 (3, machine.instructions);
+}
+
+void
+test_run_trap (void)
+{
+  const Byte prog[] = {
+    0xE8,             /* INX       */
+    0x4C, 0x01, 0x80, /* JMP $8001 */
+  };
+  Machine6502 machine = run_load (prog, sizeof prog);
+  RunCondition until = { .on_trap = true, .max_cycles = 1000 };
+
+  TEST_ASSERT_EQUAL (STOP_TRAP, run_until (&machine, &until));
+  TEST_ASSERT_EQUAL_HEX16 (0x8001, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+}
+
+void
+test_run_condition_at_pc (void)
+{
+  const Byte prog[] = { 0xEA, 0xEA, 0xEA, 0xEA }; /* NOP x4 */
+  Machine6502 machine = run_load (prog, sizeof prog);
+  RunCondition until = { .at_pc = true, .pc = 0x8002, .max_cycles = 1000 };
+
+  TEST_ASSERT_EQUAL (STOP_CONDITION, run_until (&machine, &until));
+  TEST_ASSERT_EQUAL_HEX16 (0x8002, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+}
+
+void
+test_run_condition_holds (void)
+{
+  const Byte prog[] = {
+    0xE8,             /* INX       */
+    0x4C, 0x00, 0x80, /* JMP $8000 */
+  };
+  Machine6502 machine = run_load (prog, sizeof prog);
+  Byte target = 3;
+  RunCondition until = { .holds = run_x_reaches, .arg = &target,
+                         .max_cycles = 1000 };
+
+  cpu.X = 0;
+  TEST_ASSERT_EQUAL (STOP_CONDITION, run_until (&machine, &until));
+  TEST_ASSERT_EQUAL_HEX8 (3, cpu.X);
+  TEST_ASSERT_EQUAL_HEX16 (0x8001, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (5, machine.instructions);
+
+  /* O orçamento é verificado antes da condição */
+  until.holds = NULL;
+  until.max_instructions = 4;
+  TEST_ASSERT_EQUAL (STOP_BUDGET, run_until (&machine, &until));
+  TEST_ASSERT_EQUAL_UINT64 (9, machine.instructions);
+}
+
+void
+test_run_exit (void)
+{
+  const Byte prog[] = {
+    0xA9, 0x07,       /* LDA #$07  */
+    0x8D, 0xFF, 0xD0, /* STA $D0FF */
+    0xEA,             /* NOP       */
+  };
+  run_add_exit_device ();
+  Machine6502 machine = run_load (prog, sizeof prog);
+
+  TEST_ASSERT_EQUAL (STOP_EXIT, run_cycles (&machine, 1000));
+  TEST_ASSERT_EQUAL_HEX8 (0x07, mmio_exit_code);
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8005, cpu.PC, "stops after the write");
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+
+  /* O pedido continua pendente até ser esquecido */
+  TEST_ASSERT_EQUAL (STOP_EXIT, run_instructions (&machine, 10));
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+
+  run_remove_devices ();
+}
+
+/* Breakpoint de PC para antes da instrução: ela não é contada */
+void
+test_run_breakpoint_counts_pc (void)
+{
+  const Byte prog[] = { 0xEA, 0xEA, 0xEA, 0xEA }; /* NOP x4 */
+  Machine6502 machine = run_load (prog, sizeof prog);
+
+  breakpoint_clear (&mem);
+  breakpoint_parse (&mem, "8002");
+  TEST_ASSERT_EQUAL (STOP_BREAKPOINT, run_instructions (&machine, 10));
+  TEST_ASSERT_EQUAL_HEX16 (0x8002, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+  TEST_ASSERT_EQUAL (BREAK_EXEC, breakpoint_last_hit.kind);
+
+  /* Retomar passa por cima do breakpoint uma vez */
+  breakpoint_resume (&cpu);
+  TEST_ASSERT_EQUAL (STOP_BUDGET, run_instructions (&machine, 1));
+  TEST_ASSERT_EQUAL_HEX16 (0x8003, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (3, machine.instructions);
+
+  breakpoint_clear (&mem);
+}
+
+/* Watchpoint para depois da instrução: ela é contada */
+void
+test_run_breakpoint_counts_watch (void)
+{
+  const Byte prog[] = {
+    0xEA,             /* NOP       */
+    0x8D, 0x00, 0x02, /* STA $0200 */
+    0xEA,             /* NOP       */
+  };
+  Machine6502 machine = run_load (prog, sizeof prog);
+
+  breakpoint_clear (&mem);
+  breakpoint_parse (&mem, "write:0200");
+  TEST_ASSERT_EQUAL (STOP_BREAKPOINT, run_cycles (&machine, 1000));
+  TEST_ASSERT_EQUAL_HEX16 (0x8004, cpu.PC);
+  TEST_ASSERT_EQUAL_UINT64 (2, machine.instructions);
+  TEST_ASSERT_EQUAL (BREAK_WRITE, breakpoint_last_hit.kind);
+
+  breakpoint_clear (&mem);
+}
+
+void
+test_all_run (void)
+{
+  RUN_TEST (test_run_budget_overshoot);
+  RUN_TEST (test_run_trap);
+  RUN_TEST (test_run_condition_at_pc);
+  RUN_TEST (test_run_condition_holds);
+  RUN_TEST (test_run_exit);
+  RUN_TEST (test_run_breakpoint_counts_pc);
+  RUN_TEST (test_run_breakpoint_counts_watch);
+}
+
+#endif
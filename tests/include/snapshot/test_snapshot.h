@@ -0,0 +1,130 @@
+#ifndef TEST_SNAPSHOT
+#define TEST_SNAPSHOT
+
+#include "keyboard/test_keyboard.h"
+#include "snapshot.h"
+#include "test_config.h"
+
+/* ----------------------------------------------------------
+ * Testes de snapshot – snapshot_take/snapshot_restore e a
+ * restauração só das páginas escritas
+ * -------------------------------------------------------- */
+
+/* Copia o teclado para $0200,X indefinidamente */
+static const Byte sn_prog[] = {
+  0xAD, 0x10, 0xD0, /* LDA $D010   */
+  0x9D, 0x00, 0x02, /* STA $0200,X */
+  0xE8,             /* INX         */
+  0x4C, 0x00, 0x80, /* JMP $8000   */
+};
+
+/* Estado observável da máquina */
+typedef struct
+{
+  CPU6502 cpu;
+  QWord cycles;
+  Byte *ram;
+} sn_state_t;
+
+static void
+sn_capture (sn_state_t *state)
+{
+  state->cpu = cpu;
+  state->cycles = total_cycles_executed;
+  if (state->ram == NULL)
+    state->ram = malloc (MAX_MEM);
+  memcpy (state->ram, mem.Data, MAX_MEM);
+}
+
+static void
+sn_assert_equal (const sn_state_t *expected, const char *label)
+{
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected->cpu.A, cpu.A, label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected->cpu.X, cpu.X, label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected->cpu.Y, cpu.Y, label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected->cpu.SP, cpu.SP, label);
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (expected->cpu.PS, cpu.PS, label);
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (expected->cpu.PC, cpu.PC, label);
+  TEST_ASSERT_EQUAL_UINT64_MESSAGE (expected->cycles, total_cycles_executed,
+                                    label);
+  TEST_ASSERT_EQUAL_MEMORY_MESSAGE (expected->ram, mem.Data, MAX_MEM, label);
+}
+
+/* Tira, executa, restaura: registradores, RAM, ciclos e a posição
+ * de leitura do teclado voltam ao ponto do snapshot */
+void
+test_snapshot_round_trip (void)
+{
+  TEST_ASSERT_NOT_NULL (kb_attach ("text=ABCDEF"));
+  memcpy (&mem.Data[0x8000], sn_prog, sizeof sn_prog);
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  sn_state_t taken = { 0 }, first = { 0 };
+
+  run_instructions (&machine, 4);
+  Snapshot snap = { 0 };
+  TEST_ASSERT_TRUE (snapshot_take (&snap, &cpu, &mem));
+  sn_capture (&taken);
+
+  run_instructions (&machine, 8);
+  sn_capture (&first);
+  TEST_ASSERT_EQUAL_HEX8 ('C', cpu.A);
+
+  TEST_ASSERT_TRUE (snapshot_restore (&snap, &cpu, &mem));
+  sn_assert_equal (&taken, "restored");
+
+  /* O teclado continua do 'B', então a repetição é idêntica */
+  run_instructions (&machine, 8);
+  sn_assert_equal (&first, "replayed");
+  TEST_ASSERT_EQUAL_MEMORY ("ABC", &mem.Data[0x0200], 3);
+
+  snapshot_free (&snap);
+  free (taken.ram);
+  free (first.ram);
+  kb_detach ();
+}
+
+/* snapshot_restore_dirty chega ao mesmo estado que a restauração
+ * completa, incluindo páginas escritas por mem6502_poke */
+void
+test_snapshot_restore_dirty (void)
+{
+  TEST_ASSERT_NOT_NULL (kb_attach ("text=ABCDEF"));
+  memcpy (&mem.Data[0x8000], sn_prog, sizeof sn_prog);
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  sn_state_t full = { 0 };
+  static DWord seen[PAGE_COUNT];
+
+  run_instructions (&machine, 4);
+  Snapshot snap = { 0 };
+  TEST_ASSERT_TRUE (snapshot_take (&snap, &cpu, &mem));
+  snapshot_mark_clean (&mem, seen);
+
+  run_instructions (&machine, 8);
+  mem6502_poke (&mem, 0x3042, 0x99);
+  TEST_ASSERT_TRUE (snapshot_restore (&snap, &cpu, &mem));
+  run_instructions (&machine, 4);
+  sn_capture (&full);
+
+  /* Mesma sequência, agora com a restauração rápida */
+  TEST_ASSERT_TRUE (snapshot_restore (&snap, &cpu, &mem));
+  snapshot_mark_clean (&mem, seen);
+  run_instructions (&machine, 8);
+  mem6502_poke (&mem, 0x3042, 0x99);
+  TEST_ASSERT_TRUE (snapshot_restore_dirty (&snap, &cpu, &mem, seen));
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (0x00, mem.Data[0x3042], "poked page");
+  run_instructions (&machine, 4);
+  sn_assert_equal (&full, "dirty vs full");
+
+  snapshot_free (&snap);
+  free (full.ram);
+  kb_detach ();
+}
+
+void
+test_all_snapshot (void)
+{
+  RUN_TEST (test_snapshot_round_trip);
+  RUN_TEST (test_snapshot_restore_dirty);
+}
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Testes da interrupção por software BRK (6502)
+ */
+
+#include "instructions/it/it_helpers.h"
+
+void
+test_it_brk (Byte status)
+{
+  mem.Data[0xFFFE] = 0x00;
+  mem.Data[0xFFFF] = 0x90;
+  cpu.PS = status;
+
+  const Byte prog[] = { INS_BRK, 0xEA };
+  load_and_run (prog, sizeof prog, 7); /* BRK = 7 ciclos */
+
+  Word pushed_pc = mem.Data[0x01FC] | (mem.Data[0x01FD] << 8);
+
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8002, pushed_pc, "pushed PC");
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (status | 0x30, mem.Data[0x01FB],
+                                  "pushed P");
+  TEST_ASSERT_EQUAL_HEX8_MESSAGE (0xFA, cpu.SP, "SP");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x9000, cpu.PC, "vector");
+  TEST_ASSERT_EQUAL_MESSAGE (1, cpu.Flag.I, "I flag");
+}
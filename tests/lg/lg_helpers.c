@@ -0,0 +1,60 @@
+/*
+ * Testes das instruções lógicas (6502) – modos: Immediate, ZP
+ */
+
+#include "instructions/lg/lg_helpers.h"
+
+const lg_case_t eor_cases[] = { { "positive", 0xF0, 0xFF, 0x0F, false, false },
+                                { "zero", 0x55, 0x55, 0x00, true, false },
+                                { "negative", 0xF0, 0x3C, 0xCC, false, true } };
+
+/* ----------------------------------------------------------
+ * Immediate ($49)
+ * ---------------------------------------------------------- */
+void
+test_lg_immediate (Instruction ins, const lg_case_t *cases)
+{
+  for (size_t i = 0; i < LG_CASES; ++i)
+    {
+      cpu.A = cases[i].a;
+
+      const Byte prog[] = { ins, cases[i].value };
+      load_and_run (prog, sizeof prog, 2); /* #immediato = 2 ciclos */
+
+      char msg[32];
+      sprintf (msg, "IM %s", cases[i].label);
+
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE (cases[i].result, cpu.A, msg);
+      TEST_ASSERT_EQUAL_MESSAGE (cases[i].expectZ, cpu.Flag.Z, "Z flag");
+      TEST_ASSERT_EQUAL_MESSAGE (cases[i].expectN, cpu.Flag.N, "N flag");
+
+      resetCPU (&cpu, &mem);
+    }
+}
+
+/* ----------------------------------------------------------
+ * Zero Page ($45)
+ * ---------------------------------------------------------- */
+void
+test_lg_zp (Instruction ins, const lg_case_t *cases)
+{
+  const Byte zp_addr = 0x81;
+
+  for (size_t i = 0; i < LG_CASES; ++i)
+    {
+      cpu.A = cases[i].a;
+      mem.Data[zp_addr] = cases[i].value;
+
+      const Byte prog[] = { ins, zp_addr };
+      load_and_run (prog, sizeof prog, 3); /* zp = 3 ciclos */
+
+      char msg[32];
+      sprintf (msg, "ZP %s", cases[i].label);
+
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE (cases[i].result, cpu.A, msg);
+      TEST_ASSERT_EQUAL_MESSAGE (cases[i].expectZ, cpu.Flag.Z, "Z flag");
+      TEST_ASSERT_EQUAL_MESSAGE (cases[i].expectN, cpu.Flag.N, "N flag");
+
+      resetCPU (&cpu, &mem);
+    }
+}
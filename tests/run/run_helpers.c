@@ -0,0 +1,39 @@
+/*
+ * Testes das funções de execução – run_cycles, run_instructions e
+ * run_until
+ */
+
+#include "run/run_helpers.h"
+#include "memory_map.h"
+#include "mmio.h"
+
+Machine6502
+run_load (const Byte *prog, size_t len)
+{
+  memcpy (&mem.Data[0x8000], prog, len);
+  clock_init ();
+  return (Machine6502){ &bus, &mem, &cpu, 0 };
+}
+
+bool
+run_x_reaches (const Machine6502 *machine, void *arg)
+{
+  return machine->cpu->X == *(const Byte *)arg;
+}
+
+void
+run_add_exit_device (void)
+{
+  mmio_add_device ("exit", 0xD0FF, 0xD0FF, NULL, mmio_exit, NULL);
+  memory_map_compile (&mem);
+}
+
+/* Remove os dispositivos e esquece o pedido de saída */
+void
+run_remove_devices (void)
+{
+  mmio_unload_all ();
+  mmio_exit_requested = 0;
+  mmio_exit_code = 0;
+  memory_map_compile (&mem);
+}
@@ -0,0 +1,99 @@
+"""End-to-end check of rosetta-server job output.
+
+Usage: python3 tests/server/test_server.py ./rosetta-server
+
+Boots a firmware that prints "HI" through the buffered UART and exits, then
+asserts that every RUN reply carries that output exactly once: bytes still
+in the UART's TX FIFO when a job stops must be in its own reply, not leak
+into the next one.
+"""
+
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+# $E000: print the NUL terminated string at $E020 to the UART, then exit.
+FIRMWARE = bytes([
+    0xA2, 0x00,              # LDX #0
+    0xBD, 0x20, 0xE0,        # LDA $E020,X
+    0xF0, 0x07,              # BEQ $E00E
+    0x8D, 0x00, 0xD0,        # STA UART_DATA
+    0xE8,                    # INX
+    0xD0, 0xF5,              # BNE $E002
+    0xEA,                    # NOP
+    0x8D, 0xFF, 0xD0,        # STA EXIT
+    0x4C, 0x11, 0xE0,        # JMP *
+]).ljust(0x20, b"\xEA") + b"HI\0"
+
+CONFIG = """\
+UART 0xD000 0xD002 device=uart args=in=none,out=stdout
+EXIT 0xD0FF 0xD0FF read=0 write=mmio_exit
+"""
+
+
+def request(connection, line):
+    connection.sendall(line.encode() + b"\n")
+    reply = b""
+    while not reply.endswith(b"\n"):
+        chunk = connection.recv(4096)
+        if not chunk:
+            raise RuntimeError("server closed the connection")
+        reply += chunk
+    return reply.decode().strip()
+
+
+def field(reply, name):
+    for item in reply.split():
+        if item.startswith(name + "="):
+            return item[len(name) + 1:]
+    raise RuntimeError("no %s= in %r" % (name, reply))
+
+
+def main():
+    server = sys.argv[1] if len(sys.argv) > 1 else "./rosetta-server"
+    failed = 0
+
+    with tempfile.TemporaryDirectory() as work:
+        firmware = os.path.join(work, "firmware.bin")
+        config = os.path.join(work, "mmio.cfg")
+        path = os.path.join(work, "socket")
+        with open(firmware, "wb") as f:
+            f.write(FIRMWARE)
+        with open(config, "w") as f:
+            f.write(CONFIG)
+
+        process = subprocess.Popen(
+            [server, "-w", "1", "-m", config, "-s", path, firmware],
+            stdout=subprocess.DEVNULL)
+        try:
+            for _ in range(100):
+                if os.path.exists(path):
+                    break
+                time.sleep(0.05)
+
+            connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            connection.connect(path)
+            for job in range(3):
+                reply = request(connection, "RUN")
+                output = bytes.fromhex(field(reply, "output"))
+                ok = (field(reply, "stop") == "exit"
+                      and output.count(b"HI") == 1)
+                print("job %d: %s %r" % (job, "ok" if ok else "FAILED",
+                                         output))
+                failed += not ok
+            connection.sendall(b"QUIT\n")
+            connection.close()
+        finally:
+            process.terminate()
+            process.wait()
+
+    print("All jobs passed" if failed == 0
+          else "%d job(s) failed" % failed)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
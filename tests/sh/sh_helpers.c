@@ -0,0 +1,79 @@
+/*
+ * Testes dos deslocamentos (6502) – modos: Accumulator, ZP, ABS,X
+ */
+
+#include "instructions/sh/sh_helpers.h"
+
+/* ----------------------------------------------------------
+ * Accumulator ($0A) – não lê operando: PC avança um byte
+ * ---------------------------------------------------------- */
+void
+test_sh_acc (Instruction ins, Byte value, Byte expected, bool expectC)
+{
+  cpu.A = value;
+
+  const Byte prog[] = { ins };
+  load_and_run (prog, sizeof prog, 2); /* acumulador = 2 ciclos */
+
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (expected, cpu.A, "ACC A");
+  TEST_ASSERT_EQUAL_MESSAGE (expectC, cpu.Flag.C, "C flag");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8001, cpu.PC, "ACC PC");
+}
+
+/* ----------------------------------------------------------
+ * Zero Page ($06) – o resultado vai para a memória, A fica intacto
+ * ---------------------------------------------------------- */
+void
+test_sh_zp (Instruction ins, Byte value, Byte expected, bool expectC)
+{
+  const Byte zp_addr = 0x42;
+
+  cpu.A = 0x5A;
+  mem.Data[zp_addr] = value;
+
+  const Byte prog[] = { ins, zp_addr };
+  load_and_run (prog, sizeof prog, 5); /* zp = 5 ciclos */
+
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (expected, mem.Data[zp_addr], "ZP mem");
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (0x5A, cpu.A, "ZP A");
+  TEST_ASSERT_EQUAL_MESSAGE (expectC, cpu.Flag.C, "C flag");
+}
+
+/* ----------------------------------------------------------
+ * ABS,X ($1E)
+ * ---------------------------------------------------------- */
+void
+test_sh_absx (Instruction ins, Byte value, Byte expected, bool expectC)
+{
+  const Word base = 0x0300;
+  const Byte offset = 0x05;
+  const QWord before = total_cycles_executed;
+
+  cpu.X = offset;
+  mem.Data[base + offset] = value;
+
+  const Byte prog[] = { ins, base & 0xFF, base >> 8 };
+  load_and_run (prog, sizeof prog, 7); /* abs,X = 7 ciclos */
+
+  TEST_ASSERT_EQUAL_UINT8_MESSAGE (expected, mem.Data[base + offset],
+                                   "ABSX mem");
+  TEST_ASSERT_EQUAL_MESSAGE (expectC, cpu.Flag.C, "C flag");
+  TEST_ASSERT_EQUAL_MESSAGE (7, total_cycles_executed - before, "cycles");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8003, cpu.PC, "ABSX PC");
+}
+
+/* ----------------------------------------------------------
+ * Ciclos – o operando aponta para $0042 ou $0342
+ * ---------------------------------------------------------- */
+void
+test_sh_cycles (Instruction ins, size_t len, Word expected_cycles)
+{
+  const QWord before = total_cycles_executed;
+
+  const Byte prog[] = { ins, 0x42, 0x03 };
+  load_and_run (prog, len, expected_cycles);
+
+  TEST_ASSERT_EQUAL_MESSAGE (expected_cycles, total_cycles_executed - before,
+                             "cycles");
+  TEST_ASSERT_EQUAL_HEX16_MESSAGE (0x8000 + len, cpu.PC, "PC");
+}
@@ -1,6 +1,21 @@
+#include "breakpoint/test_breakpoint.h"
+#include "fusion/test_fusion.h"
+#include "instructions/ar/test_ar.h"
+#include "instructions/br/test_br.h"
+#include "instructions/fl/test_fl.h"
+#include "instructions/ic/test_ic.h"
+#include "instructions/it/test_it.h"
 #include "instructions/ld/test_ld.h"
+#include "instructions/lg/test_lg.h"
 #include "instructions/rt/test_rt.h"
+#include "instructions/sh/test_sh.h"
 #include "instructions/st/test_st.h"
+#include "journal/test_journal.h"
+#include "keyboard/test_keyboard.h"
+#include "lanes/test_lanes.h"
+#include "memory_map/test_memory_map.h"
+#include "run/test_run.h"
+#include "snapshot/test_snapshot.h"
 #include "test_template.h"
 
 int
@@ -9,6 +24,21 @@ main (void)
   UNITY_BEGIN ();
 
   test_all_rt ();
+  test_all_ar ();
+  test_all_sh ();
+  test_all_lg ();
+  test_all_ic ();
+  test_all_br ();
+  test_all_fl ();
+  test_all_it ();
+  test_all_memory_map ();
+  test_all_breakpoint ();
+  test_all_run ();
+  test_all_keyboard ();
+  test_all_snapshot ();
+  test_all_journal ();
+  test_all_lanes ();
+  test_all_fusion ();
 
   return UNITY_END ();
 }
@@ -0,0 +1,644 @@
+#include "ref6502.h"
+
+/*
+   REF6502 - Reference 6502 core (see ref6502.h)
+
+   Written from the datasheet rather than from src/cpu so the two do not
+   share mistakes. Opcodes are grouped the way the 6502 itself lays them
+   out: the eight ALU instructions share one set of addressing modes, the
+   shifts another, and so on. Dummy reads and the double write of
+   read-modify-write instructions are not modelled: there are no devices to
+   observe them.
+*/
+
+// Documented opcodes, row = high nibble.
+static const Byte legal_opcodes[256] = {
+  /*      0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F */
+  /* 0 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 0, 1, 1, 0,
+  /* 1 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+  /* 2 */ 1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* 3 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+  /* 4 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* 5 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+  /* 6 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* 7 */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+  /* 8 */ 0, 1, 0, 0, 1, 1, 1, 0, 1, 0, 1, 0, 1, 1, 1, 0,
+  /* 9 */ 1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 0, 1, 0, 0,
+  /* A */ 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* B */ 1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* C */ 1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* D */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+  /* E */ 1, 1, 0, 0, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 0,
+  /* F */ 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 0, 0, 0, 1, 1, 0,
+};
+
+bool
+ref6502_legal (Byte opcode)
+{
+  return legal_opcodes[opcode];
+}
+
+/*
+   Memory and stack
+*/
+
+static Byte
+rd (Ref6502 *r, Word addr)
+{
+  return r->mem[addr];
+}
+
+static void
+wr (Ref6502 *r, Word addr, Byte data)
+{
+  r->mem[addr] = data;
+  if (r->write_count < REF6502_MAX_WRITES)
+    {
+      r->writes[r->write_count].addr = addr;
+      r->writes[r->write_count].data = data;
+      r->write_count++;
+    }
+}
+
+static Byte
+fetch (Ref6502 *r)
+{
+  return rd (r, r->PC++);
+}
+
+static Word
+fetch_word (Ref6502 *r)
+{
+  Byte lo = fetch (r);
+  return lo | (fetch (r) << 8);
+}
+
+static void
+push (Ref6502 *r, Byte data)
+{
+  wr (r, 0x0100 | r->SP--, data);
+}
+
+static Byte
+pull (Ref6502 *r)
+{
+  return rd (r, 0x0100 | ++r->SP);
+}
+
+/*
+   Addressing modes. The indexed ones report a page crossing, which costs
+   read instructions one cycle.
+*/
+
+static Word
+ea_zp (Ref6502 *r)
+{
+  return fetch (r);
+}
+
+static Word
+ea_zp_indexed (Ref6502 *r, Byte index)
+{
+  return (Byte)(fetch (r) + index);
+}
+
+static Word
+ea_abs (Ref6502 *r)
+{
+  return fetch_word (r);
+}
+
+static Word
+ea_abs_indexed (Ref6502 *r, Byte index, int *cross)
+{
+  Word base = fetch_word (r);
+  Word addr = base + index;
+  *cross = (base ^ addr) >> 8 != 0;
+  return addr;
+}
+
+static Word
+ea_indx (Ref6502 *r)
+{
+  Byte zp = fetch (r) + r->X;
+  return rd (r, zp) | (rd (r, (Byte)(zp + 1)) << 8);
+}
+
+static Word
+ea_indy (Ref6502 *r, int *cross)
+{
+  Byte zp = fetch (r);
+  Word base = rd (r, zp) | (rd (r, (Byte)(zp + 1)) << 8);
+  Word addr = base + r->Y;
+  *cross = (base ^ addr) >> 8 != 0;
+  return addr;
+}
+
+/*
+   Operations
+*/
+
+static void
+set_flag (Ref6502 *r, Byte flag, bool on)
+{
+  r->P = on ? (r->P | flag) : (r->P & ~flag);
+}
+
+static Byte
+set_nz (Ref6502 *r, Byte value)
+{
+  set_flag (r, REF_Z, value == 0);
+  set_flag (r, REF_N, value & 0x80);
+  return value;
+}
+
+static void
+op_ora (Ref6502 *r, Byte v)
+{
+  r->A = set_nz (r, r->A | v);
+}
+
+static void
+op_and (Ref6502 *r, Byte v)
+{
+  r->A = set_nz (r, r->A & v);
+}
+
+static void
+op_eor (Ref6502 *r, Byte v)
+{
+  r->A = set_nz (r, r->A ^ v);
+}
+
+static void
+op_lda (Ref6502 *r, Byte v)
+{
+  r->A = set_nz (r, v);
+}
+
+static void
+op_ldx (Ref6502 *r, Byte v)
+{
+  r->X = set_nz (r, v);
+}
+
+static void
+op_ldy (Ref6502 *r, Byte v)
+{
+  r->Y = set_nz (r, v);
+}
+
+static void
+compare (Ref6502 *r, Byte reg, Byte v)
+{
+  set_flag (r, REF_C, reg >= v);
+  set_nz (r, (Byte)(reg - v));
+}
+
+static void
+op_cmp (Ref6502 *r, Byte v)
+{
+  compare (r, r->A, v);
+}
+
+static void
+op_bit (Ref6502 *r, Byte v)
+{
+  set_flag (r, REF_Z, (r->A & v) == 0);
+  set_flag (r, REF_N, v & 0x80);
+  set_flag (r, REF_V, v & 0x40);
+}
+
+// NMOS decimal mode: Z comes from the binary sum, N and V from the sum
+// after the low digit is adjusted.
+static void
+op_adc (Ref6502 *r, Byte v)
+{
+  int carry = r->P & REF_C;
+  int sum = r->A + v + carry;
+
+  if (!(r->P & REF_D))
+    {
+      set_flag (r, REF_C, sum > 0xFF);
+      set_flag (r, REF_V, ~(r->A ^ v) & (r->A ^ sum) & 0x80);
+      r->A = set_nz (r, (Byte)sum);
+      return;
+    }
+
+  int lo = (r->A & 0x0F) + (v & 0x0F) + carry;
+  if (lo > 9)
+    lo += 6;
+  int hi = (r->A >> 4) + (v >> 4) + (lo > 0x0F);
+
+  set_flag (r, REF_Z, (Byte)sum == 0);
+  set_flag (r, REF_N, hi & 0x08);
+  set_flag (r, REF_V, ~(r->A ^ v) & (r->A ^ (hi << 4)) & 0x80);
+  if (hi > 9)
+    hi += 6;
+  set_flag (r, REF_C, hi > 0x0F);
+  r->A = (Byte)((hi << 4) | (lo & 0x0F));
+}
+
+// NMOS decimal mode: every flag comes from the binary difference.
+static void
+op_sbc (Ref6502 *r, Byte v)
+{
+  int borrow = !(r->P & REF_C);
+  int diff = r->A - v - borrow;
+
+  set_flag (r, REF_C, diff >= 0);
+  set_flag (r, REF_V, (r->A ^ v) & (r->A ^ diff) & 0x80);
+  set_nz (r, (Byte)diff);
+
+  if (!(r->P & REF_D))
+    {
+      r->A = (Byte)diff;
+      return;
+    }
+
+  int lo = (r->A & 0x0F) - (v & 0x0F) - borrow;
+  int hi = (r->A >> 4) - (v >> 4);
+  if (lo < 0)
+    {
+      lo -= 6;
+      hi--;
+    }
+  if (hi < 0)
+    hi -= 6;
+  r->A = (Byte)((hi << 4) | (lo & 0x0F));
+}
+
+static Byte
+op_asl (Ref6502 *r, Byte v)
+{
+  set_flag (r, REF_C, v & 0x80);
+  return set_nz (r, (Byte)(v << 1));
+}
+
+static Byte
+op_lsr (Ref6502 *r, Byte v)
+{
+  set_flag (r, REF_C, v & 0x01);
+  return set_nz (r, v >> 1);
+}
+
+static Byte
+op_rol (Ref6502 *r, Byte v)
+{
+  Byte carry = r->P & REF_C;
+  set_flag (r, REF_C, v & 0x80);
+  return set_nz (r, (Byte)((v << 1) | carry));
+}
+
+static Byte
+op_ror (Ref6502 *r, Byte v)
+{
+  Byte carry = (r->P & REF_C) << 7;
+  set_flag (r, REF_C, v & 0x01);
+  return set_nz (r, (v >> 1) | carry);
+}
+
+static Byte
+op_inc (Ref6502 *r, Byte v)
+{
+  return set_nz (r, v + 1);
+}
+
+static Byte
+op_dec (Ref6502 *r, Byte v)
+{
+  return set_nz (r, v - 1);
+}
+
+static void
+rmw (Ref6502 *r, Word addr, Byte (*op) (Ref6502 *, Byte))
+{
+  wr (r, addr, op (r, rd (r, addr)));
+}
+
+static int
+branch (Ref6502 *r, bool taken)
+{
+  SignedByte offset = (SignedByte)fetch (r);
+  if (!taken)
+    return 2;
+
+  Word target = r->PC + offset;
+  int cycles = ((target ^ r->PC) >> 8) ? 4 : 3;
+  r->PC = target;
+  return cycles;
+}
+
+/*
+   Opcode groups. Offsets are relative to the first opcode of the group
+   (ORA $00, AND $20, ... for the ALU group).
+*/
+
+#define ALU_GROUP(base, op)                                                   \
+  case base + 0x01:                                                           \
+    op (r, rd (r, ea_indx (r)));                                              \
+    return 6;                                                                 \
+  case base + 0x05:                                                           \
+    op (r, rd (r, ea_zp (r)));                                                \
+    return 3;                                                                 \
+  case base + 0x09:                                                           \
+    op (r, fetch (r));                                                        \
+    return 2;                                                                 \
+  case base + 0x0D:                                                           \
+    op (r, rd (r, ea_abs (r)));                                               \
+    return 4;                                                                 \
+  case base + 0x11:                                                           \
+    op (r, rd (r, ea_indy (r, &cross)));                                      \
+    return 5 + cross;                                                         \
+  case base + 0x15:                                                           \
+    op (r, rd (r, ea_zp_indexed (r, r->X)));                                  \
+    return 4;                                                                 \
+  case base + 0x19:                                                           \
+    op (r, rd (r, ea_abs_indexed (r, r->Y, &cross)));                         \
+    return 4 + cross;                                                         \
+  case base + 0x1D:                                                           \
+    op (r, rd (r, ea_abs_indexed (r, r->X, &cross)));                         \
+    return 4 + cross;
+
+#define RMW_GROUP(base, op)                                                   \
+  case base + 0x06:                                                           \
+    rmw (r, ea_zp (r), op);                                                   \
+    return 5;                                                                 \
+  case base + 0x0E:                                                           \
+    rmw (r, ea_abs (r), op);                                                  \
+    return 6;                                                                 \
+  case base + 0x16:                                                           \
+    rmw (r, ea_zp_indexed (r, r->X), op);                                     \
+    return 6;                                                                 \
+  case base + 0x1E:                                                           \
+    rmw (r, ea_abs_indexed (r, r->X, &cross), op);                            \
+    return 7;
+
+int
+ref6502_step (Ref6502 *r)
+{
+  Byte opcode = rd (r, r->PC);
+  int cross = 0;
+  Word addr;
+
+  if (!legal_opcodes[opcode])
+    return 0;
+
+  r->write_count = 0;
+  r->PC++;
+
+  switch (opcode)
+    {
+      ALU_GROUP (0x00, op_ora)
+      ALU_GROUP (0x20, op_and)
+      ALU_GROUP (0x40, op_eor)
+      ALU_GROUP (0x60, op_adc)
+      ALU_GROUP (0xA0, op_lda)
+      ALU_GROUP (0xC0, op_cmp)
+      ALU_GROUP (0xE0, op_sbc)
+
+      RMW_GROUP (0x00, op_asl)
+      RMW_GROUP (0x20, op_rol)
+      RMW_GROUP (0x40, op_lsr)
+      RMW_GROUP (0x60, op_ror)
+      RMW_GROUP (0xC0, op_dec)
+      RMW_GROUP (0xE0, op_inc)
+
+    case 0x0A:
+      r->A = op_asl (r, r->A);
+      return 2;
+    case 0x2A:
+      r->A = op_rol (r, r->A);
+      return 2;
+    case 0x4A:
+      r->A = op_lsr (r, r->A);
+      return 2;
+    case 0x6A:
+      r->A = op_ror (r, r->A);
+      return 2;
+
+    // Stores
+    case 0x81:
+      wr (r, ea_indx (r), r->A);
+      return 6;
+    case 0x85:
+      wr (r, ea_zp (r), r->A);
+      return 3;
+    case 0x8D:
+      wr (r, ea_abs (r), r->A);
+      return 4;
+    case 0x91:
+      wr (r, ea_indy (r, &cross), r->A);
+      return 6;
+    case 0x95:
+      wr (r, ea_zp_indexed (r, r->X), r->A);
+      return 4;
+    case 0x99:
+      wr (r, ea_abs_indexed (r, r->Y, &cross), r->A);
+      return 5;
+    case 0x9D:
+      wr (r, ea_abs_indexed (r, r->X, &cross), r->A);
+      return 5;
+    case 0x86:
+      wr (r, ea_zp (r), r->X);
+      return 3;
+    case 0x96:
+      wr (r, ea_zp_indexed (r, r->Y), r->X);
+      return 4;
+    case 0x8E:
+      wr (r, ea_abs (r), r->X);
+      return 4;
+    case 0x84:
+      wr (r, ea_zp (r), r->Y);
+      return 3;
+    case 0x94:
+      wr (r, ea_zp_indexed (r, r->X), r->Y);
+      return 4;
+    case 0x8C:
+      wr (r, ea_abs (r), r->Y);
+      return 4;
+
+    // LDX, LDY, CPX, CPY, BIT
+    case 0xA2:
+      op_ldx (r, fetch (r));
+      return 2;
+    case 0xA6:
+      op_ldx (r, rd (r, ea_zp (r)));
+      return 3;
+    case 0xB6:
+      op_ldx (r, rd (r, ea_zp_indexed (r, r->Y)));
+      return 4;
+    case 0xAE:
+      op_ldx (r, rd (r, ea_abs (r)));
+      return 4;
+    case 0xBE:
+      op_ldx (r, rd (r, ea_abs_indexed (r, r->Y, &cross)));
+      return 4 + cross;
+    case 0xA0:
+      op_ldy (r, fetch (r));
+      return 2;
+    case 0xA4:
+      op_ldy (r, rd (r, ea_zp (r)));
+      return 3;
+    case 0xB4:
+      op_ldy (r, rd (r, ea_zp_indexed (r, r->X)));
+      return 4;
+    case 0xAC:
+      op_ldy (r, rd (r, ea_abs (r)));
+      return 4;
+    case 0xBC:
+      op_ldy (r, rd (r, ea_abs_indexed (r, r->X, &cross)));
+      return 4 + cross;
+    case 0xE0:
+      compare (r, r->X, fetch (r));
+      return 2;
+    case 0xE4:
+      compare (r, r->X, rd (r, ea_zp (r)));
+      return 3;
+    case 0xEC:
+      compare (r, r->X, rd (r, ea_abs (r)));
+      return 4;
+    case 0xC0:
+      compare (r, r->Y, fetch (r));
+      return 2;
+    case 0xC4:
+      compare (r, r->Y, rd (r, ea_zp (r)));
+      return 3;
+    case 0xCC:
+      compare (r, r->Y, rd (r, ea_abs (r)));
+      return 4;
+    case 0x24:
+      op_bit (r, rd (r, ea_zp (r)));
+      return 3;
+    case 0x2C:
+      op_bit (r, rd (r, ea_abs (r)));
+      return 4;
+
+    // Branches: bits 7-6 select the flag, bit 5 the value that branches.
+    case 0x10:
+      return branch (r, !(r->P & REF_N));
+    case 0x30:
+      return branch (r, r->P & REF_N);
+    case 0x50:
+      return branch (r, !(r->P & REF_V));
+    case 0x70:
+      return branch (r, r->P & REF_V);
+    case 0x90:
+      return branch (r, !(r->P & REF_C));
+    case 0xB0:
+      return branch (r, r->P & REF_C);
+    case 0xD0:
+      return branch (r, !(r->P & REF_Z));
+    case 0xF0:
+      return branch (r, r->P & REF_Z);
+
+    // Jumps and subroutines
+    case 0x4C:
+      r->PC = fetch_word (r);
+      return 3;
+    case 0x6C:
+      // The pointer's high byte is read without carrying into its page.
+      addr = fetch_word (r);
+      r->PC = rd (r, addr)
+              | (rd (r, (addr & 0xFF00) | (Byte)(addr + 1)) << 8);
+      return 5;
+    case 0x20:
+      addr = fetch_word (r);
+      r->PC--;
+      push (r, r->PC >> 8);
+      push (r, r->PC & 0xFF);
+      r->PC = addr;
+      return 6;
+    case 0x60:
+      addr = pull (r);
+      r->PC = (addr | (pull (r) << 8)) + 1;
+      return 6;
+    case 0x00:
+      r->PC++;
+      push (r, r->PC >> 8);
+      push (r, r->PC & 0xFF);
+      push (r, r->P | REF_B | REF_U);
+      r->P |= REF_I;
+      r->PC = rd (r, 0xFFFE) | (rd (r, 0xFFFF) << 8);
+      return 7;
+    case 0x40:
+      r->P = (pull (r) & ~REF_B) | REF_U;
+      addr = pull (r);
+      r->PC = addr | (pull (r) << 8);
+      return 6;
+
+    // Stack
+    case 0x48:
+      push (r, r->A);
+      return 3;
+    case 0x08:
+      push (r, r->P | REF_B | REF_U);
+      return 3;
+    case 0x68:
+      r->A = set_nz (r, pull (r));
+      return 4;
+    case 0x28:
+      r->P = (pull (r) & ~REF_B) | REF_U;
+      return 4;
+
+    // Registers
+    case 0xAA:
+      r->X = set_nz (r, r->A);
+      return 2;
+    case 0xA8:
+      r->Y = set_nz (r, r->A);
+      return 2;
+    case 0x8A:
+      r->A = set_nz (r, r->X);
+      return 2;
+    case 0x98:
+      r->A = set_nz (r, r->Y);
+      return 2;
+    case 0xBA:
+      r->X = set_nz (r, r->SP);
+      return 2;
+    case 0x9A:
+      r->SP = r->X;
+      return 2;
+    case 0xE8:
+      r->X = set_nz (r, r->X + 1);
+      return 2;
+    case 0xC8:
+      r->Y = set_nz (r, r->Y + 1);
+      return 2;
+    case 0xCA:
+      r->X = set_nz (r, r->X - 1);
+      return 2;
+    case 0x88:
+      r->Y = set_nz (r, r->Y - 1);
+      return 2;
+
+    // Flags
+    case 0x18:
+      r->P &= ~REF_C;
+      return 2;
+    case 0x38:
+      r->P |= REF_C;
+      return 2;
+    case 0x58:
+      r->P &= ~REF_I;
+      return 2;
+    case 0x78:
+      r->P |= REF_I;
+      return 2;
+    case 0xB8:
+      r->P &= ~REF_V;
+      return 2;
+    case 0xD8:
+      r->P &= ~REF_D;
+      return 2;
+    case 0xF8:
+      r->P |= REF_D;
+      return 2;
+
+    case 0xEA:
+      return 2;
+    }
+
+  return 0; // Not reached: every documented opcode is handled above
+}
@@ -0,0 +1,57 @@
+#ifndef REF6502_H
+#define REF6502_H
+
+#include "config.h"
+
+/*
+   REF6502 - Reference 6502 core for differential testing
+
+   A deliberately plain NMOS 6502 written independently of the interpreter
+   in src/cpu: one switch over the documented opcodes, a flat 64 KB address
+   space, decimal mode and the documented cycle counts (page crossings and
+   taken branches included). It is slow and has no devices; its only job is
+   to be easy to check against the datasheet so other backends can be
+   checked against it (see tools/rosetta-diff.c).
+
+   Every store of an instruction is logged in `writes` so callers can
+   compare memory writes per instruction without scanning memory.
+*/
+
+#define REF6502_MAX_WRITES 4 // BRK and JSR push three bytes
+
+// Status register bits.
+#define REF_C 0x01
+#define REF_Z 0x02
+#define REF_I 0x04
+#define REF_D 0x08
+#define REF_B 0x10
+#define REF_U 0x20
+#define REF_V 0x40
+#define REF_N 0x80
+
+typedef struct
+{
+  Word addr;
+  Byte data;
+} RefWrite;
+
+typedef struct
+{
+  Byte A, X, Y, SP, P;
+  Word PC;
+  QWord cycles;
+
+  int write_count; // Stores made by the last ref6502_step
+  RefWrite writes[REF6502_MAX_WRITES];
+
+  Byte mem[0x10000];
+} Ref6502;
+
+// True for the 151 documented opcodes.
+bool ref6502_legal (Byte opcode);
+
+// Executes one instruction. Returns its cycle count, or 0 (and changes
+// nothing) if the opcode at PC is undocumented.
+int ref6502_step (Ref6502 *r);
+
+#endif // REF6502_H
@@ -0,0 +1,329 @@
+/*
+   rosetta-aot - Translates a 6502 ROM image into C.
+
+   Usage: rosetta-aot [-o ORIGIN] [-e ADDR]... [-c output.c] image.bin
+
+   The image is placed at ORIGIN as by rosetta-dis. Code is found from the
+   NMI, reset and IRQ vectors, the start of the image (the loader points
+   the reset vector there), the -e entry points (hex; jump table targets,
+   for instance), and from there every JSR, JMP and branch target and
+   every fall-through. Each basic block becomes one C function calling
+   the instruction handlers through the helpers of aot.h. Blocks end after
+   a control transfer, before the start of another block, and before an
+   unknown opcode or the end of the image.
+
+   The output (stdout by default) is compiled with optimization, so the
+   handlers are inlined, and linked with the core: `make native
+   ROM=image.bin` does both.
+*/
+
+#include "../src/cpu/Instructions/dispatch.h"
+#include "disasm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *const opcode_name[256] = {
+#define X(name, opcode, mnemonic, mode, kind, cycles) [opcode] = #name,
+  OPCODE_TABLE (X)
+#undef X
+};
+
+#define STRINGIFY(text) STRINGIFY_ (text)
+#define STRINGIFY_(text) #text
+
+static const char *const handler_call[256] = {
+#define X(name, opcode, mnemonic, mode, kind, cycles)                         \
+  [opcode] = STRINGIFY (INSTRUCTION_CALL (kind, mnemonic, mode)),
+  OPCODE_TABLE (X)
+#undef X
+};
+
+// One spare page so operands of the last instruction read as zero.
+static Byte image[0x10000 + 3];
+static long origin = -1;
+static unsigned long size;
+
+static bool leader[0x10000];      // A block starts here
+static bool instruction[0x10000]; // Decoded as an instruction
+
+static Word worklist[0x10000];
+static int pending;
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-o ORIGIN] [-e ADDR]... [-c output.c] image.bin\n",
+           prog);
+  exit (2);
+}
+
+static inline bool
+in_image (unsigned long address)
+{
+  return address >= (unsigned long)origin && address < origin + size;
+}
+
+static inline const Byte *
+bytes_at (Word address)
+{
+  return &image[address - origin];
+}
+
+// Length of the known instruction at `address` that fits in the image,
+// or 0.
+static int
+instruction_length (Word address)
+{
+  Byte opcode = *bytes_at (address);
+  int length = disasm_length (opcode);
+
+  if (opcode_info[opcode].mnemonic == NULL
+      || !in_image ((unsigned long)address + length - 1))
+    return 0;
+  return length;
+}
+
+static void
+add_entry (unsigned long address)
+{
+  if (!in_image (address) || leader[address])
+    return;
+  leader[address] = true;
+  worklist[pending++] = (Word)address;
+}
+
+// Whether control never falls through to the next instruction.
+static bool
+ends_block (Byte opcode)
+{
+  return (opcode & 0x1F) == 0x10 // Branches
+         || opcode == 0x4C || opcode == 0x6C || opcode == 0x20
+         || opcode == 0x60 || opcode == 0x40 || opcode == 0x00;
+}
+
+// Decodes the code reachable from `address`.
+static void
+explore (Word address)
+{
+  for (;;)
+    {
+      if (instruction[address])
+        return;
+      int length = instruction_length (address);
+      if (length == 0)
+        return;
+      instruction[address] = true;
+
+      const Byte *bytes = bytes_at (address);
+      Word next = address + length;
+      Word operand = bytes[1] | bytes[2] << 8;
+
+      switch (bytes[0])
+        {
+        case 0x4C: // JMP abs
+          add_entry (operand);
+          return;
+        case 0x20: // JSR: the subroutine returns after it
+          add_entry (operand);
+          add_entry (next);
+          return;
+        case 0x6C: // JMP ind, RTS, RTI, BRK: only known at run time
+        case 0x60:
+        case 0x40:
+        case 0x00:
+          return;
+        }
+      if ((bytes[0] & 0x1F) == 0x10)
+        {
+          add_entry ((Word)(next + (int8_t)bytes[1]));
+          add_entry (next);
+          return;
+        }
+      if (next < address)
+        return;
+      address = next;
+    }
+}
+
+static void
+write_image (FILE *out)
+{
+  fprintf (out, "static const Byte image[%lu] = {", size);
+  for (unsigned long i = 0; i < size; i++)
+    fprintf (out, "%s0x%02X,", i % 12 ? " " : "\n  ", image[i]);
+  fprintf (out, "\n};\n");
+}
+
+// Writes the block starting at `start`. Returns its last byte.
+static Word
+write_block (FILE *out, Word start)
+{
+  char text[64];
+  bool uses_bus = false, uses_memory = false, uses_cpu = false;
+  Word address = start, end;
+
+  // The handler calls name `bus`, `memory` and `cpu`; only those used are
+  // declared.
+  for (;;)
+    {
+      const char *call = handler_call[*bytes_at (address)];
+      uses_bus |= strstr (call, "bus") != NULL;
+      uses_memory |= strstr (call, "memory") != NULL;
+      uses_cpu |= strstr (call, "cpu") != NULL;
+      Word next = address + instruction_length (address);
+      if (ends_block (*bytes_at (address)) || next < address
+          || !instruction[next] || leader[next])
+        break;
+      address = next;
+    }
+  end = address + instruction_length (address) - 1;
+
+  fprintf (out, "\nstatic bool\nblock_%04X (AotRun *run)\n{\n", start);
+  if (uses_bus)
+    fprintf (out, "  Bus6502 *bus = run->machine->bus;\n");
+  if (uses_memory)
+    fprintf (out, "  MEM6502 *memory = run->machine->memory;\n");
+  if (uses_cpu)
+    fprintf (out, "  CPU6502 *cpu = run->machine->cpu;\n");
+  for (address = start;; address += instruction_length (address))
+    {
+      const Byte *bytes = bytes_at (address);
+
+      if (address != start)
+        fprintf (out, "  if (!aot_continue (run, 0x%04X))\n"
+                      "    return true;\n",
+                 address);
+      disasm_instruction (address, bytes, text, sizeof (text));
+      fprintf (out, "\n  // %04X  %s\n  aot_fetch (run, %s);\n  %s;\n"
+                    "  if (!aot_finish ())\n    return false;\n",
+               address, text, opcode_name[bytes[0]], handler_call[bytes[0]]);
+      if (address + instruction_length (address) - 1 == end)
+        break;
+    }
+  fprintf (out, "  return true;\n}\n");
+  return end;
+}
+
+static bool
+translate (FILE *out, const char *name)
+{
+  static Word ends[0x10000];
+  int count = 0;
+
+  fprintf (out, "// Translated from %s by rosetta-aot. Do not edit.\n\n"
+                "#include \"aot.h\"\n\n",
+           name);
+  write_image (out);
+  for (unsigned long address = origin; address < origin + size; address++)
+    if (leader[address] && instruction[address])
+      {
+        ends[address] = write_block (out, (Word)address);
+        count++;
+      }
+  if (count == 0)
+    {
+      fprintf (stderr, "%s: no code found\n", name);
+      return false;
+    }
+
+  fprintf (out, "\nstatic const AotBlock blocks[] = {\n");
+  for (unsigned long address = origin; address < origin + size; address++)
+    if (leader[address] && instruction[address])
+      fprintf (out, "  { 0x%04lX, 0x%04X, block_%04lX },\n", address,
+               ends[address], address);
+  fprintf (out, "};\n\n"
+                "__attribute__ ((constructor)) static void\n"
+                "register_image (void)\n"
+                "{\n"
+                "  static const AotImage translated\n"
+                "      = { 0x%04lX, sizeof (image), image, blocks,\n"
+                "          sizeof (blocks) / sizeof (blocks[0]) };\n"
+                "  aot_register (&translated);\n"
+                "}\n",
+           (unsigned long)origin);
+
+  fprintf (stderr, "%s: %d blocks\n", name, count);
+  return true;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static unsigned long entries[256];
+  int entry_count = 0;
+  const char *output = NULL;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "o:e:c:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'o':
+          origin = strtol (optarg, NULL, 16);
+          break;
+        case 'e':
+          if (entry_count == 256)
+            usage (argv[0]);
+          entries[entry_count++] = strtoul (optarg, NULL, 16);
+          break;
+        case 'c':
+          output = optarg;
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind != argc - 1)
+    usage (argv[0]);
+
+  FILE *f = fopen (argv[optind], "rb");
+  if (f == NULL)
+    {
+      perror (argv[optind]);
+      return 1;
+    }
+  size = fread (image, 1, 0x10001, f);
+  fclose (f);
+
+  if (size == 0 || size > 0x10000)
+    {
+      fprintf (stderr, "%s: image must be 1 to 65536 bytes\n", argv[optind]);
+      return 1;
+    }
+  if (origin < 0)
+    origin = 0x10000 - (long)size;
+  if (origin + (long)size > 0x10000)
+    {
+      fprintf (stderr, "%s: image does not fit at $%04lX\n", argv[optind],
+               (unsigned long)origin);
+      return 1;
+    }
+
+  // NMI, reset and IRQ.
+  for (Word vector = 0xFFFA; vector >= 0xFFFA; vector += 2)
+    if (in_image (vector) && in_image (vector + 1))
+      add_entry (*bytes_at (vector) | *bytes_at (vector + 1) << 8);
+  add_entry (origin);
+  for (int i = 0; i < entry_count; i++)
+    add_entry (entries[i]);
+
+  while (pending > 0)
+    explore (worklist[--pending]);
+
+  FILE *out = output ? fopen (output, "w") : stdout;
+  if (out == NULL)
+    {
+      perror (output);
+      return 1;
+    }
+  bool ok = translate (out, argv[optind]);
+  if (out != stdout && fclose (out) != 0)
+    {
+      perror (output);
+      return 1;
+    }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,388 @@
+/*
+   rosetta-cov - Turns coverage files into an lcov report.
+
+   Usage: rosetta-cov [-o report.info] firmware.dbg coverage.bin...
+
+   Coverage files are written by `main --coverage` (coverage.h) and merged.
+   firmware.dbg is the ld65 debug info (--dbgfile) of the same build: its
+   `line` records tie source lines to spans of a segment, and so to
+   addresses. A line is code when one of its spans carries no data type;
+   it is hit when the instruction at the start of such a span was fetched.
+   Branch lines get two lcov branches, taken and not taken. Branches are
+   told apart by their opcode, read from the image named by the segment
+   (oname, ooffs); without it only branches that ran are reported.
+
+   The report has one SF record per source file, ready for genhtml.
+*/
+
+#include "coverage.h"
+#include "disasm.h"
+#include <libgen.h>
+#include <unistd.h>
+
+typedef struct
+{
+  char *name;
+} DbgFile;
+
+typedef struct
+{
+  long start;
+  Byte *bytes; // Segment contents from the image, or NULL
+  long size;
+} DbgSeg;
+
+typedef struct
+{
+  int seg;
+  long start, size;
+  bool data;
+} DbgSpan;
+
+typedef struct
+{
+  int file, line;
+  char *spans; // "3+7+12"
+} DbgLine;
+
+// Records are stored by id; ids are dense from 0.
+static DbgFile *files;
+static DbgSeg *segs;
+static DbgSpan *spans;
+static DbgLine *lines;
+static int file_count, seg_count, span_count, line_count;
+
+static CoverageBits bits;
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-o report.info] firmware.dbg coverage.bin...\n",
+           prog);
+  exit (2);
+}
+
+// Grows `*array` so that index `id` exists; new entries are zeroed.
+static void *
+record (void *array, int *count, size_t size, long id)
+{
+  void **slots = array;
+
+  if (id < 0 || id > 0xFFFFF)
+    return NULL;
+  if (id >= *count)
+    {
+      void *grown = realloc (*slots, (id + 1) * size);
+      if (grown == NULL)
+        return NULL;
+      memset ((char *)grown + *count * size, 0, (id + 1 - *count) * size);
+      *slots = grown;
+      *count = id + 1;
+    }
+  return (char *)*slots + id * size;
+}
+
+// Value of `key=` in a record, or NULL (same rules as symbols.c).
+static const char *
+field (const char *line, const char *key)
+{
+  size_t len = strlen (key);
+
+  for (const char *p = line; (p = strstr (p, key)) != NULL; p += len)
+    if ((p == line || p[-1] == '\t' || p[-1] == ',') && p[len] == '=')
+      return p + len + 1;
+  return NULL;
+}
+
+static long
+number (const char *line, const char *key, long missing)
+{
+  const char *value = field (line, key);
+  return value ? strtol (value, NULL, 0) : missing;
+}
+
+// Copy of a quoted string value, or NULL.
+static char *
+string (const char *line, const char *key)
+{
+  const char *value = field (line, key);
+  if (value == NULL || *value != '"')
+    return NULL;
+  value++;
+  return strndup (value, strcspn (value, "\""));
+}
+
+// A relative path in the .dbg is relative to where ld65 ran, which
+// build.sh makes the firmware directory.
+static char *
+resolve (const char *dir, char *path)
+{
+  if (path == NULL || path[0] == '/')
+    return path;
+  char *full = malloc (strlen (dir) + strlen (path) + 2);
+  if (full != NULL)
+    sprintf (full, "%s/%s", dir, path);
+  free (path);
+  return full;
+}
+
+static void
+load_segment (DbgSeg *seg, const char *image, long offset)
+{
+  FILE *f = image ? fopen (image, "rb") : NULL;
+
+  if (f != NULL && seg->size > 0 && fseek (f, offset, SEEK_SET) == 0)
+    {
+      seg->bytes = malloc (seg->size);
+      if (seg->bytes
+          && fread (seg->bytes, 1, seg->size, f) != (size_t)seg->size)
+        {
+          free (seg->bytes);
+          seg->bytes = NULL;
+        }
+    }
+  if (f != NULL)
+    fclose (f);
+}
+
+static bool
+load_dbg (const char *path)
+{
+  FILE *f = fopen (path, "r");
+  if (f == NULL)
+    {
+      perror (path);
+      return false;
+    }
+
+  char *copy = strdup (path);
+  const char *dir = dirname (copy);
+  char text[4096];
+
+  while (fgets (text, sizeof (text), f))
+    {
+      const char *fields = strchr (text, '\t');
+      long id = number (text, "id", -1);
+      if (fields == NULL)
+        continue;
+      fields++;
+
+      if (strncmp (text, "file\t", 5) == 0)
+        {
+          DbgFile *file = record (&files, &file_count, sizeof (*file), id);
+          if (file)
+            file->name = resolve (dir, string (fields, "name"));
+        }
+      else if (strncmp (text, "seg\t", 4) == 0)
+        {
+          DbgSeg *seg = record (&segs, &seg_count, sizeof (*seg), id);
+          if (seg == NULL)
+            continue;
+          seg->start = number (fields, "start", 0);
+          seg->size = number (fields, "size", 0);
+          char *image = resolve (dir, string (fields, "oname"));
+          load_segment (seg, image, number (fields, "ooffs", 0));
+          free (image);
+        }
+      else if (strncmp (text, "span\t", 5) == 0)
+        {
+          DbgSpan *span = record (&spans, &span_count, sizeof (*span), id);
+          if (span == NULL)
+            continue;
+          span->seg = number (fields, "seg", -1);
+          span->start = number (fields, "start", 0);
+          span->size = number (fields, "size", 0);
+          span->data = field (fields, "type") != NULL;
+        }
+      else if (strncmp (text, "line\t", 5) == 0)
+        {
+          // Lines of C sources (type=1) and macro bodies (type=2) share
+          // spans with the assembler lines that produced them.
+          const char *spans_field = field (fields, "span");
+          if (spans_field == NULL || number (fields, "type", 0) != 0)
+            continue;
+          DbgLine *line = record (&lines, &line_count, sizeof (*line), id);
+          if (line == NULL)
+            continue;
+          line->file = number (fields, "file", -1);
+          line->line = number (fields, "line", 0);
+          line->spans = strndup (spans_field, strcspn (spans_field, ",\r\n"));
+        }
+    }
+  fclose (f);
+  free (copy);
+
+  if (line_count == 0)
+    {
+      fprintf (stderr, "%s: no line information (assemble with ca65 -g)\n",
+               path);
+      return false;
+    }
+  return true;
+}
+
+typedef struct
+{
+  int line;
+  bool code, hit;
+  bool branch, branch_hit, taken, not_taken;
+} SourceLine;
+
+static int
+compare_lines (const void *a, const void *b)
+{
+  const SourceLine *x = a, *y = b;
+  return x->line - y->line;
+}
+
+// Collects what the spans of `line` say about it.
+static void
+measure (const DbgLine *line, SourceLine *out)
+{
+  for (const char *p = line->spans; *p != '\0';)
+    {
+      char *end;
+      long id = strtol (p, &end, 10);
+      if (end == p)
+        break;
+      p = *end == '+' ? end + 1 : end;
+
+      if (id < 0 || id >= span_count || spans[id].data || spans[id].size == 0
+          || spans[id].seg < 0 || spans[id].seg >= seg_count)
+        continue;
+      const DbgSpan *span = &spans[id];
+      const DbgSeg *seg = &segs[span->seg];
+      Word address = (Word)(seg->start + span->start);
+
+      bool executed = coverage_bit (bits.executed, address);
+      bool taken = coverage_bit (bits.taken, address);
+      bool not_taken = coverage_bit (bits.not_taken, address);
+      bool branch = taken || not_taken;
+      if (seg->bytes && span->start < seg->size)
+        branch = span->size == 2 && (seg->bytes[span->start] & 0x1F) == 0x10;
+
+      out->code = true;
+      out->hit |= executed;
+      if (branch)
+        {
+          out->branch = true;
+          out->branch_hit |= executed;
+          out->taken |= taken;
+          out->not_taken |= not_taken;
+        }
+    }
+}
+
+static void
+report_file (FILE *out, int file)
+{
+  SourceLine *found = calloc (line_count, sizeof (SourceLine));
+  int count = 0;
+
+  if (found == NULL)
+    return;
+  for (int i = 0; i < line_count; i++)
+    {
+      if (lines[i].spans == NULL || lines[i].file != file)
+        continue;
+      SourceLine entry = { .line = lines[i].line };
+      measure (&lines[i], &entry);
+      if (entry.code)
+        found[count++] = entry;
+    }
+  if (count == 0)
+    {
+      free (found);
+      return;
+    }
+  qsort (found, count, sizeof (SourceLine), compare_lines);
+
+  // A source line assembled more than once (.repeat, includes) is one
+  // lcov line.
+  int merged = 0;
+  for (int i = 0; i < count; i++)
+    {
+      if (merged > 0 && found[merged - 1].line == found[i].line)
+        {
+          SourceLine *line = &found[merged - 1];
+          line->hit |= found[i].hit;
+          line->branch |= found[i].branch;
+          line->branch_hit |= found[i].branch_hit;
+          line->taken |= found[i].taken;
+          line->not_taken |= found[i].not_taken;
+        }
+      else
+        found[merged++] = found[i];
+    }
+
+  int hit = 0, branches = 0, branches_hit = 0;
+  fprintf (out, "TN:\nSF:%s\n", files[file].name);
+  for (int i = 0; i < merged; i++)
+    {
+      const SourceLine *line = &found[i];
+      if (!line->branch)
+        continue;
+      if (line->branch_hit)
+        fprintf (out, "BRDA:%d,0,0,%d\nBRDA:%d,0,1,%d\n", line->line,
+                 line->taken, line->line, line->not_taken);
+      else
+        fprintf (out, "BRDA:%d,0,0,-\nBRDA:%d,0,1,-\n", line->line,
+                 line->line);
+      branches += 2;
+      branches_hit += line->taken + line->not_taken;
+    }
+  for (int i = 0; i < merged; i++)
+    {
+      fprintf (out, "DA:%d,%d\n", found[i].line, found[i].hit);
+      hit += found[i].hit;
+    }
+  fprintf (out, "BRF:%d\nBRH:%d\nLF:%d\nLH:%d\nend_of_record\n", branches,
+           branches_hit, merged, hit);
+  fprintf (stderr, "%s: %d of %d lines, %d of %d branches\n",
+           files[file].name, hit, merged, branches_hit, branches);
+  free (found);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *output = NULL;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "o:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'o':
+          output = optarg;
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (argc - optind < 2)
+    usage (argv[0]);
+
+  if (!load_dbg (argv[optind]))
+    return 1;
+  for (int i = optind + 1; i < argc; i++)
+    if (!coverage_bits_merge (&bits, argv[i], false))
+      return 1;
+
+  FILE *out = output ? fopen (output, "w") : stdout;
+  if (out == NULL)
+    {
+      perror (output);
+      return 1;
+    }
+  for (int i = 0; i < file_count; i++)
+    if (files[i].name != NULL)
+      report_file (out, i);
+  if (out != stdout && fclose (out) != 0)
+    {
+      perror (output);
+      return 1;
+    }
+  return 0;
+}
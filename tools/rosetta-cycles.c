@@ -0,0 +1,221 @@
+/*
+   rosetta-cycles - Per-opcode cycle check and microbenchmark.
+
+   Usage: rosetta-cycles [-m] [-s] [-n ITERATIONS]
+
+   Every documented opcode is executed once per addressing-mode edge case:
+   indexed modes with an index that stays on the page (or in the zero
+   page) and one that crosses it (or wraps), branches not taken, taken and
+   taken to another page. The cycles the interpreter charges are compared
+   with the reference core (tools/ref6502.c), which carries the datasheet
+   table, and the case is then run ITERATIONS times (default 100000) to
+   time the handler in host nanoseconds per execution, including the
+   dispatch overhead of run_cpu_instruction.
+
+   The matrix lists one case per line; -m lists only cycle mismatches and
+   -s sorts by time, slowest first. Exits with 1 if any case mismatched.
+*/
+
+#include "cpu_exec.h"
+#include "disasm.h"
+#include "mem6502.h"
+#include "memory_map.h"
+#include "ref6502.h"
+#include <time.h>
+#include <unistd.h>
+
+#define CODE 0x0400
+#define CODE_CROSS 0x04F0 // Branches from here land on the next page
+#define FILL 0x20         // Every other byte, so pointers read $2020
+#define MAX_CASES 512
+
+typedef struct
+{
+  Byte opcode;
+  const char *edge;
+  char text[24];
+  int expected; // Reference core
+  int charged;  // Interpreter
+  double ns;
+} Case;
+
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+static Ref6502 ref;
+
+static Case cases[MAX_CASES];
+static int case_count;
+
+static double
+seconds (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Places the instruction at `pc` in both memories with the same registers.
+static void
+setup (Word pc, const Byte *bytes, Byte index, Byte status)
+{
+  memset (mem.Data, FILL, MAX_MEM);
+  memcpy (mem.Data + pc, bytes, 3);
+  markMem6502Dirty (&mem);
+  memcpy (ref.mem, mem.Data, sizeof (ref.mem));
+
+  memset (&cpu, 0, sizeof (cpu));
+  cpu.A = 0x40;
+  cpu.X = cpu.Y = index;
+  cpu.SP = 0xFD;
+  cpu.PS = status;
+  cpu.PC = pc;
+
+  ref.A = cpu.A;
+  ref.X = ref.Y = index;
+  ref.SP = cpu.SP;
+  ref.P = status;
+  ref.PC = pc;
+}
+
+static void
+measure (Byte opcode, const char *edge, Word pc, const Byte *bytes,
+         Byte index, Byte status, long iterations)
+{
+  Case *c = &cases[case_count++];
+
+  c->opcode = opcode;
+  c->edge = edge;
+  disasm_instruction (pc, bytes, c->text, sizeof (c->text));
+
+  setup (pc, bytes, index, status);
+  c->expected = ref6502_step (&ref);
+
+  QWord before = total_cycles_executed;
+  CPU6502 initial = cpu;
+  run_cpu_instruction (&bus, &mem, &cpu);
+  c->charged = (int)(total_cycles_executed - before);
+
+  double began = seconds ();
+  for (long i = 0; i < iterations; i++)
+    {
+      cpu = initial;
+      run_cpu_instruction (&bus, &mem, &cpu);
+    }
+  c->ns = (seconds () - began) * 1e9 / iterations;
+}
+
+// Status that makes the branch `opcode` taken or not. Bits 7-6 of a
+// branch opcode select N, V, C or Z and bit 5 the value that branches.
+static Byte
+branch_status (Byte opcode, bool taken)
+{
+  static const Byte flags[4] = { REF_N, REF_V, REF_C, REF_Z };
+  Byte flag = flags[opcode >> 6];
+  bool set = ((opcode >> 5) & 1) == taken;
+
+  return REF_U | (set ? flag : 0);
+}
+
+static void
+measure_opcode (Byte opcode, long iterations)
+{
+  Byte bytes[3] = { opcode, 0x10, 0x20 }; // $10 or $2010
+  Byte status = REF_U | REF_I;
+
+  switch (opcode_info[opcode].mode)
+    {
+    case AM_REL:
+      bytes[1] = 0x10;
+      measure (opcode, "not taken", CODE, bytes, 0,
+               branch_status (opcode, false), iterations);
+      measure (opcode, "taken", CODE, bytes, 0, branch_status (opcode, true),
+               iterations);
+      measure (opcode, "page cross", CODE_CROSS, bytes, 0,
+               branch_status (opcode, true), iterations);
+      break;
+    case AM_ABSX:
+    case AM_ABSY:
+    case AM_INDY:
+      measure (opcode, "same page", CODE, bytes, 0x01, status, iterations);
+      measure (opcode, "page cross", CODE, bytes, 0xFF, status, iterations);
+      break;
+    case AM_ZPX:
+    case AM_ZPY:
+    case AM_INDX:
+      measure (opcode, "", CODE, bytes, 0x01, status, iterations);
+      measure (opcode, "zp wrap", CODE, bytes, 0xFF, status, iterations);
+      break;
+    default:
+      measure (opcode, "", CODE, bytes, 0x01, status, iterations);
+      break;
+    }
+}
+
+static int
+slowest_first (const void *a, const void *b)
+{
+  double ns_a = ((const Case *)a)->ns, ns_b = ((const Case *)b)->ns;
+  return (ns_a < ns_b) - (ns_a > ns_b);
+}
+
+int
+main (int argc, char *argv[])
+{
+  bool mismatches_only = false, sort = false;
+  long iterations = 100000;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "msn:")) != -1)
+    switch (opt)
+      {
+      case 'm':
+        mismatches_only = true;
+        break;
+      case 's':
+        sort = true;
+        break;
+      case 'n':
+        iterations = strtol (optarg, NULL, 0);
+        break;
+      default:
+        fprintf (stderr, "Usage: %s [-m] [-s] [-n ITERATIONS]\n", argv[0]);
+        return 2;
+      }
+  if (iterations < 1)
+    iterations = 1;
+
+  memory_map_clear ();
+  memory_map_add_region (REGION_RAM, 0x0000, 0xFFFF, 0, 0);
+  initializeMem6502 (&mem);
+  clock_unthrottled = true;
+
+  for (int op = 0; op < 256; op++)
+    if (ref6502_legal ((Byte)op))
+      measure_opcode ((Byte)op, iterations);
+
+  if (sort)
+    qsort (cases, case_count, sizeof (Case), slowest_first);
+
+  int mismatched = 0;
+  double total_ns = 0;
+
+  printf ("op  instruction      case        ref  interp  ns/exec\n");
+  for (int i = 0; i < case_count; i++)
+    {
+      const Case *c = &cases[i];
+      bool bad = c->charged != c->expected;
+
+      mismatched += bad;
+      total_ns += c->ns;
+      if (mismatches_only && !bad)
+        continue;
+      printf ("%02X  %-16s %-10s  %3d  %6d  %7.1f%s\n", c->opcode, c->text,
+              c->edge, c->expected, c->charged, c->ns, bad ? "  <<" : "");
+    }
+
+  printf ("%d cases, %d cycle mismatches, %.1f ns/exec on average\n",
+          case_count, mismatched, total_ns / case_count);
+  freeMem6502 (&mem);
+  return mismatched ? 1 : 0;
+}
@@ -0,0 +1,453 @@
+/*
+   rosetta-diff - Runs the interpreter and the reference core in lock step.
+
+   Usage: rosetta-diff [-j JOBS] [-n LIMIT] [-b BLOCK] [-o ORIGIN]
+                       [-s START] [-c] [-x CONTEXT] image.bin...
+
+   Each image is loaded into a flat 64 KB of RAM at ORIGIN (hex, default:
+   ending at $FFFF) and both cores start at START (hex, default: the reset
+   vector) with the same registers. After every instruction, or every BLOCK
+   instructions in fast mode, the registers and every page either core
+   wrote to are compared; -c compares the cycle count of each instruction
+   too. A run ends after LIMIT instructions (default 10000000), when the
+   program traps (an instruction that jumps to itself, as test suites do
+   to report their result) or at an undocumented opcode.
+
+   The first divergence is reported with the last CONTEXT instructions
+   (default 8), both register sets and the differing bytes; in fast mode
+   the image is rerun instruction by instruction to find it. Images are
+   checked by up to JOBS worker processes at once (default: one per CPU);
+   the interpreter keeps its state in globals, so workers are processes
+   rather than threads. Exits with 1 if any image diverged.
+*/
+
+#include "cpu_exec.h"
+#include "disasm.h"
+#include "mem6502.h"
+#include "memory_map.h"
+#include "ref6502.h"
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MAX_CONTEXT 64
+#define MAX_REPORTED_BYTES 8
+
+typedef enum
+{
+  END_LIMIT,
+  END_TRAP,
+  END_OPCODE,
+  END_DIVERGED
+} EndReason;
+
+typedef struct
+{
+  Word pc;
+  Byte bytes[3];
+} TraceEntry;
+
+static long origin = -1;
+static long start = -1;
+static QWord limit = 10000000;
+static QWord block = 1;
+static bool check_cycles = false;
+static int context = 8;
+
+// Both machines of the current worker.
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+static Ref6502 ref;
+
+static DWord seen_writes[PAGE_COUNT]; // MemPage.Writes at the last check
+static Byte ref_dirty[PAGE_COUNT];    // Pages the reference wrote since then
+static TraceEntry trace[MAX_CONTEXT];
+static QWord cycles_interp, cycles_ref; // Of the last instruction
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-j JOBS] [-n LIMIT] [-b BLOCK] [-o ORIGIN] "
+           "[-s START] [-c] [-x CONTEXT] image.bin...\n",
+           prog);
+  exit (2);
+}
+
+/*
+   One image
+*/
+
+static void
+setup (const Byte *image, size_t size, Word at)
+{
+  memset (mem.Data, 0, MAX_MEM);
+  memcpy (mem.Data + at, image, size);
+  for (int page = 0; page < PAGE_COUNT; page++)
+    seen_writes[page] = mem.Pages[page].Writes;
+
+  memset (&ref, 0, sizeof (ref));
+  memcpy (ref.mem + at, image, size);
+  memset (ref_dirty, 0, sizeof (ref_dirty));
+
+  ref.PC = start >= 0 ? (Word)start : ref.mem[0xFFFC] | (ref.mem[0xFFFD] << 8);
+  ref.SP = 0xFD;
+  ref.P = REF_I | REF_U;
+
+  cpu.A = cpu.X = cpu.Y = 0;
+  cpu.SP = ref.SP;
+  cpu.PS = ref.P;
+  cpu.PC = ref.PC;
+  total_cycles_executed = 0;
+}
+
+static bool
+registers_match (void)
+{
+  // B and bit 5 are not stored by the CPU, only pushed.
+  Byte mask = (Byte)~(REF_B | REF_U);
+
+  return cpu.A == ref.A && cpu.X == ref.X && cpu.Y == ref.Y
+         && cpu.SP == ref.SP && cpu.PC == ref.PC
+         && (cpu.PS & mask) == (ref.P & mask);
+}
+
+// Compares every page written by either core since the last check.
+static bool
+memory_matches (void)
+{
+  bool match = true;
+
+  for (int page = 0; page < PAGE_COUNT; page++)
+    {
+      if (mem.Pages[page].Writes == seen_writes[page] && !ref_dirty[page])
+        continue;
+      if (memcmp (mem.Data + page * PAGE_SIZE, ref.mem + page * PAGE_SIZE,
+                  PAGE_SIZE)
+          != 0)
+        match = false;
+      seen_writes[page] = mem.Pages[page].Writes;
+      ref_dirty[page] = 0;
+    }
+  return match;
+}
+
+static EndReason
+run (QWord max, QWord every, QWord *executed)
+{
+  QWord n;
+
+  for (n = 0; n < max; n++)
+    {
+      Word pc = ref.PC;
+      TraceEntry *entry = &trace[n % MAX_CONTEXT];
+
+      if (!ref6502_legal (ref.mem[pc]))
+        break;
+      entry->pc = pc;
+      for (int i = 0; i < 3; i++)
+        entry->bytes[i] = ref.mem[(Word)(pc + i)];
+
+      QWord before = total_cycles_executed;
+      run_cpu_instruction (&bus, &mem, &cpu);
+      cycles_interp = total_cycles_executed - before;
+      cycles_ref = ref6502_step (&ref);
+      ref.cycles += cycles_ref;
+
+      for (int i = 0; i < ref.write_count; i++)
+        ref_dirty[ref.writes[i].addr >> 8] = 1;
+
+      bool trapped = ref.PC == pc && cpu.PC == pc;
+      bool check = (n + 1) % every == 0 || trapped || n + 1 == max;
+      if ((check_cycles && cycles_interp != cycles_ref)
+          || (check && !(registers_match () & memory_matches ())))
+        {
+          *executed = n + 1;
+          return END_DIVERGED;
+        }
+      if (trapped)
+        {
+          *executed = n + 1;
+          return END_TRAP;
+        }
+    }
+
+  *executed = n;
+  if (n < max)
+    return !(registers_match () & memory_matches ()) ? END_DIVERGED
+                                                     : END_OPCODE;
+  return END_LIMIT;
+}
+
+static void
+print_registers (FILE *out, const char *name, Word pc, Byte a, Byte x, Byte y,
+                 Byte sp, Byte p, QWord cycles)
+{
+  fprintf (out, "  %-8s %04X  %02X %02X %02X %02X %02X  %llu\n", name, pc, a,
+           x, y, sp, p & (Byte)~(REF_B | REF_U), (unsigned long long)cycles);
+}
+
+static void
+report_divergence (FILE *out, const char *path, QWord executed)
+{
+  char line[128];
+
+  fprintf (out, "%s: DIVERGED at instruction %llu\n", path,
+           (unsigned long long)executed);
+
+  QWord first = executed > (QWord)context ? executed - context : 0;
+  for (QWord n = first; n < executed; n++)
+    {
+      const TraceEntry *entry = &trace[n % MAX_CONTEXT];
+      disasm_line (entry->pc, entry->bytes, line, sizeof (line));
+      fprintf (out, "  %c %s\n", n + 1 == executed ? '>' : ' ', line);
+    }
+
+  fprintf (out, "           PC    A  X  Y  SP P   cycles\n");
+  print_registers (out, "interp", cpu.PC, cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.PS,
+                   total_cycles_executed);
+  print_registers (out, "ref", ref.PC, ref.A, ref.X, ref.Y, ref.SP, ref.P,
+                   ref.cycles);
+  if (cycles_interp != cycles_ref)
+    fprintf (out, "  last instruction took %llu cycles, reference %llu\n",
+             (unsigned long long)cycles_interp,
+             (unsigned long long)cycles_ref);
+
+  int shown = 0;
+  for (DWord addr = 0; addr < 0x10000; addr++)
+    {
+      if (mem.Data[addr] == ref.mem[addr])
+        continue;
+      if (shown++ == MAX_REPORTED_BYTES)
+        {
+          fprintf (out, "  ...\n");
+          break;
+        }
+      fprintf (out, "  $%04X    interp %02X  ref %02X\n", addr,
+               mem.Data[addr], ref.mem[addr]);
+    }
+}
+
+// Checks one image and writes a report to `out`. Returns 0 if both cores
+// agree, 1 on a divergence and 2 if the image cannot be used.
+static int
+diff_image (const char *path, FILE *out)
+{
+  static Byte image[0x10001];
+  FILE *f = fopen (path, "rb");
+
+  if (f == NULL)
+    {
+      fprintf (out, "%s: cannot open\n", path);
+      return 2;
+    }
+  size_t size = fread (image, 1, sizeof (image), f);
+  fclose (f);
+
+  long at = origin >= 0 ? origin : 0x10000 - (long)size;
+  if (size == 0 || at + (long)size > 0x10000)
+    {
+      fprintf (out, "%s: image does not fit at $%04lX\n", path,
+               (unsigned long)at);
+      return 2;
+    }
+
+  QWord executed;
+  setup (image, size, (Word)at);
+  EndReason end = run (limit, block, &executed);
+
+  // Fast mode only knows the block: redo it one instruction at a time.
+  if (end == END_DIVERGED && block > 1)
+    {
+      setup (image, size, (Word)at);
+      end = run (executed, 1, &executed);
+    }
+
+  switch (end)
+    {
+    case END_DIVERGED:
+      report_divergence (out, path, executed);
+      return 1;
+    case END_TRAP:
+      fprintf (out, "%s: OK, %llu instructions, trapped at $%04X\n", path,
+               (unsigned long long)executed, ref.PC);
+      break;
+    case END_OPCODE:
+      fprintf (out,
+               "%s: OK, %llu instructions, undocumented opcode $%02X at "
+               "$%04X\n",
+               path, (unsigned long long)executed, ref.mem[ref.PC], ref.PC);
+      break;
+    case END_LIMIT:
+      fprintf (out, "%s: OK, %llu instructions\n", path,
+               (unsigned long long)executed);
+      break;
+    }
+  return 0;
+}
+
+/*
+   Worker processes. Reports are printed in command line order.
+*/
+
+typedef struct
+{
+  pid_t pid;
+  int fd;
+  char *text;
+  size_t length;
+  bool done;
+  int status;
+} Job;
+
+static void
+start_job (Job *job, const char *path)
+{
+  int fds[2];
+
+  if (pipe (fds) != 0 || (job->pid = fork ()) < 0)
+    {
+      perror ("rosetta-diff");
+      exit (2);
+    }
+
+  if (job->pid == 0)
+    {
+      close (fds[0]);
+      FILE *out = fdopen (fds[1], "w");
+
+      // The interpreter reports unhandled opcodes on stdout.
+      if (freopen ("/dev/null", "w", stdout) == NULL)
+        _exit (2);
+
+      int status = diff_image (path, out);
+      fclose (out);
+      _exit (status);
+    }
+
+  close (fds[1]);
+  job->fd = fds[0];
+}
+
+static void
+read_job (Job *job)
+{
+  char buffer[4096];
+  ssize_t n = read (job->fd, buffer, sizeof (buffer));
+
+  if (n > 0)
+    {
+      job->text = realloc (job->text, job->length + n);
+      memcpy (job->text + job->length, buffer, n);
+      job->length += n;
+      return;
+    }
+
+  close (job->fd);
+  job->fd = -1;
+  waitpid (job->pid, &job->status, 0);
+  job->done = true;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int max_jobs = (int)sysconf (_SC_NPROCESSORS_ONLN);
+  int opt;
+
+  while ((opt = getopt (argc, argv, "j:n:b:o:s:cx:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'j':
+          max_jobs = atoi (optarg);
+          break;
+        case 'n':
+          limit = strtoull (optarg, NULL, 0);
+          break;
+        case 'b':
+          block = strtoull (optarg, NULL, 0);
+          break;
+        case 'o':
+          origin = strtol (optarg, NULL, 16);
+          break;
+        case 's':
+          start = strtol (optarg, NULL, 16);
+          break;
+        case 'c':
+          check_cycles = true;
+          break;
+        case 'x':
+          context = atoi (optarg);
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind == argc || max_jobs < 1 || block < 1 || context < 0
+      || context > MAX_CONTEXT)
+    usage (argv[0]);
+
+  // One flat RAM: the reference core has no memory map.
+  memory_map_clear ();
+  memory_map_add_region (REGION_RAM, 0x0000, 0xFFFF, 0, 0);
+  initializeMem6502 (&mem);
+  clock_unthrottled = true;
+
+  int count = argc - optind;
+  Job *jobs = calloc (count, sizeof (Job));
+  struct pollfd *fds = calloc (count, sizeof (struct pollfd));
+  int *owner = calloc (count, sizeof (int));
+  int next = 0, running = 0, printed = 0, failed = 0;
+
+  while (printed < count)
+    {
+      while (running < max_jobs && next < count)
+        {
+          fflush (stdout);
+          start_job (&jobs[next], argv[optind + next]);
+          next++;
+          running++;
+        }
+
+      int polled = 0;
+      for (int i = printed; i < next; i++)
+        if (!jobs[i].done)
+          {
+            fds[polled].fd = jobs[i].fd;
+            fds[polled].events = POLLIN;
+            owner[polled++] = i;
+          }
+      if (polled > 0 && poll (fds, polled, -1) < 0)
+        continue;
+
+      for (int i = 0; i < polled; i++)
+        if (fds[i].revents)
+          {
+            read_job (&jobs[owner[i]]);
+            if (jobs[owner[i]].done)
+              running--;
+          }
+
+      for (; printed < next && jobs[printed].done; printed++)
+        {
+          Job *job = &jobs[printed];
+          fwrite (job->text, 1, job->length, stdout);
+          if (WIFSIGNALED (job->status))
+            printf ("%s: worker killed by signal %d\n",
+                    argv[optind + printed], WTERMSIG (job->status));
+          if (!WIFEXITED (job->status) || WEXITSTATUS (job->status) != 0)
+            failed++;
+          free (job->text);
+        }
+    }
+
+  printf ("%d image%s, %d failed\n", count, count == 1 ? "" : "s", failed);
+
+  free (owner);
+  free (fds);
+  free (jobs);
+  freeMem6502 (&mem);
+  return failed ? 1 : 0;
+}
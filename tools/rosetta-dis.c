@@ -0,0 +1,128 @@
+/*
+   rosetta-dis - Disassembles a 6502 ROM image.
+
+   Usage: rosetta-dis [-o ORIGIN] [-s SYMBOLS]... [-r START-END] image.bin
+
+   The image is placed at ORIGIN (hex, default: ending at $FFFF, which is
+   where the emulator maps firmware ROMs). SYMBOLS are cc65 debug, VICE
+   label or ld65 map files (see symbols.h); labels are printed on their own
+   line and used for operands. -r limits the listing to an address range.
+*/
+
+#include "disasm.h"
+#include "symbols.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-o ORIGIN] [-s SYMBOLS]... [-r START-END] image.bin\n",
+           prog);
+  exit (2);
+}
+
+static bool
+parse_range (const char *text, unsigned long *start, unsigned long *end)
+{
+  char *p;
+
+  *start = strtoul (text, &p, 16);
+  if (p == text || *p != '-')
+    return false;
+  text = p + 1;
+  *end = strtoul (text, &p, 16);
+  return p != text && *p == '\0' && *start <= *end && *end <= 0xFFFF;
+}
+
+int
+main (int argc, char *argv[])
+{
+  long origin = -1;
+  unsigned long first = 0, last = 0xFFFF;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "o:s:r:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'o':
+          origin = strtol (optarg, NULL, 16);
+          break;
+        case 's':
+          if (!symbols_load (optarg))
+            return 1;
+          break;
+        case 'r':
+          if (!parse_range (optarg, &first, &last))
+            usage (argv[0]);
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind != argc - 1)
+    usage (argv[0]);
+
+  FILE *f = fopen (argv[optind], "rb");
+  if (f == NULL)
+    {
+      perror (argv[optind]);
+      return 1;
+    }
+
+  // One spare page so operands of the last instruction read as zero.
+  static Byte image[0x10000 + 3];
+  size_t size = fread (image, 1, 0x10001, f);
+  fclose (f);
+
+  if (size == 0 || size > 0x10000)
+    {
+      fprintf (stderr, "%s: image must be 1 to 65536 bytes\n", argv[optind]);
+      return 1;
+    }
+  if (origin < 0)
+    origin = 0x10000 - (long)size;
+  if (origin + (long)size > 0x10000)
+    {
+      fprintf (stderr, "%s: image does not fit at $%04lX\n", argv[optind],
+               (unsigned long)origin);
+      return 1;
+    }
+
+  // Large listings are written in big blocks rather than line by line.
+  static char out_buffer[1 << 16];
+  setvbuf (stdout, out_buffer, _IOFBF, sizeof (out_buffer));
+
+  unsigned long pc = (unsigned long)origin;
+  unsigned long end = (unsigned long)origin + size;
+  char line[128];
+
+  while (pc < end)
+    {
+      const Byte *bytes = &image[pc - origin];
+      int length = disasm_length (bytes[0]);
+
+      if (pc >= first && pc <= last)
+        {
+          const char *label = symbols_lookup ((Word)pc);
+          if (label)
+            printf ("%s:\n", label);
+
+          // An instruction cut off by the end of the image is data.
+          if (pc + length > end)
+            snprintf (line, sizeof (line), "%04lX  %02X        .byte $%02X",
+                      pc, bytes[0], bytes[0]);
+          else
+            disasm_line ((Word)pc, bytes, line, sizeof (line));
+          printf ("%s\n", line);
+        }
+
+      pc += (pc + length > end) ? 1 : length;
+    }
+
+  symbols_clear ();
+  return 0;
+}
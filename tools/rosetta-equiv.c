@@ -0,0 +1,433 @@
+/*
+   rosetta-equiv - Checks the run loops' fast paths against single steps.
+
+   Usage: rosetta-equiv [-n IMAGES] [-s SEED] [-c CALLS] [-d]
+          rosetta-equiv -w rom.bin [-s SEED]
+
+   Fused pairs (cpu_exec.c) and translated blocks (aot.h) must leave the
+   machine exactly as single steps do. Each image is random documented
+   code, with the pairs of fused_table.h planted often, on a board with RAM
+   at $0000-$0FFF and $1100-$7FFF, ROM at $8000-$FFFF, a keyboard raising
+   timed IRQs at $1010 (the handler at $9000 reads it) and an exit device
+   at $10FF. The same sequence of
+   run_instructions, run_cycles and run_until calls with random budgets
+   runs twice from the same state: with the fast paths, then with
+   coverage_bits set, which turns them off. Every call must end with the
+   same stop reason, registers, cycle count and instruction count, and
+   memory must match at the end. Each image runs four times: plain, with a
+   few PC breakpoint ranges, a write watchpoint and a read watchpoint.
+
+   Images are numbered from SEED (default 1). With -w the ROM half of
+   image SEED is written for rosetta-aot instead; `make check-aot` links
+   the translation into this tool and checks it (blocks only run in the
+   image they were translated from).
+
+   -d prints a digest of the registers, cycles and memory after every call
+   of the fast run instead of comparing, so that two builds can be diffed.
+   Exits with 1 on any mismatch.
+*/
+
+#include "aot.h"
+#include "breakpoint.h"
+#include "coverage.h"
+#include "cpu_exec.h"
+#include "disasm.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "snapshot.h"
+#include "../src/cpu/Instructions/fused_table.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MAX_CALLS 20000
+#define VARIANTS 4
+
+#define KEYBOARD_BASE 0x1010
+#define EXIT_ADDRESS 0x10FF
+
+typedef struct
+{
+  StopReason stop;
+  CPU6502 cpu;
+  QWord cycles;
+  QWord instructions;
+} Record;
+
+static const Byte fused_pairs[][2] = {
+#define X(first, second) { first, second },
+  FUSED_TABLE (X)
+#undef X
+};
+#define PAIR_COUNT (int)(sizeof fused_pairs / sizeof fused_pairs[0])
+
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+
+static int calls = 3000;
+static bool digest = false;
+
+static Record trace[2][MAX_CALLS];
+static int traced[2];
+static Byte image[0x10000];
+static Byte memory_after[0x10000];
+static FILE *report;
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-n IMAGES] [-s SEED] [-c CALLS] [-d]\n"
+           "       %s -w rom.bin [-s SEED]\n",
+           prog, prog);
+  exit (2);
+}
+
+static unsigned
+next_random (unsigned *seed)
+{
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 16;
+}
+
+// Operands point mostly at the first pages, so code reads and writes
+// zero page, the stack and itself.
+static void
+fill_operands (unsigned *seed, unsigned address, Byte opcode)
+{
+  int length = disasm_length (opcode);
+
+  for (int k = 1; k < length && address + k < 0x10000; k++)
+    image[address + k] = next_random (seed) % 4 ? next_random (seed) % 0x40
+                                                : next_random (seed);
+  if ((opcode & 0x1F) == 0x10 && address + 1 < 0x10000) // Short branches
+    image[address + 1] = next_random (seed) % 2
+                             ? (Byte)(0xF0 + next_random (seed) % 16)
+                             : next_random (seed) % 16;
+  if ((opcode == 0x4C || opcode == 0x20) && address + 2 < 0x10000)
+    image[address + 2] = 0x80 + next_random (seed) % 0x80; // Into ROM
+}
+
+static void
+make_image (unsigned number)
+{
+  unsigned seed = number * 2654435761u;
+
+  for (unsigned address = 0; address < 0x10000;)
+    {
+      Byte run[2];
+      int count = 1;
+
+      if (next_random (&seed) % 3 == 0)
+        {
+          const Byte *pair = fused_pairs[next_random (&seed) % PAIR_COUNT];
+          run[0] = pair[0];
+          run[1] = pair[1];
+          count = 2;
+        }
+      else
+        do
+          run[0] = next_random (&seed);
+        while (opcode_info[run[0]].mnemonic == NULL || run[0] == 0x00
+               || run[0] == 0x78 || run[0] == 0x28 // SEI, PLP: keep IRQs on
+               || (next_random (&seed) % 4
+                   && (run[0] == 0x6C || run[0] == 0x40 || run[0] == 0x60)));
+
+      for (int i = 0; i < count && address < 0x10000; i++)
+        {
+          image[address] = run[i];
+          fill_operands (&seed, address, run[i]);
+          address += disasm_length (run[i]);
+        }
+    }
+
+  // Devices page, then reset to $8000 and IRQ to $9000, where reading the
+  // keyboard drops the line so that interrupts keep arriving.
+  static const Byte handler[] = {
+    0x48,             // PHA
+    0xAD, 0x10, 0x10, // LDA $1010
+    0x68,             // PLA
+    0x40,             // RTI
+  };
+  memset (&image[0x1000], 0xEA, 0x100);
+  memcpy (&image[0x9000], handler, sizeof handler);
+  image[0xFFFC] = 0x00;
+  image[0xFFFD] = 0x80;
+  image[0xFFFE] = 0x00;
+  image[0xFFFF] = 0x90;
+}
+
+// Fresh devices for every image, so the keyboard script starts over.
+static void
+attach_devices (const char *script)
+{
+  char args[64];
+
+  mmio_unload_all ();
+  snprintf (args, sizeof args, "script=%s,irq=1", script);
+  MMIODevice *keyboard = mmio_add_device ("KEYBOARD", KEYBOARD_BASE,
+                                          KEYBOARD_BASE + 1, NULL, NULL, NULL);
+  if (keyboard == NULL
+      || !mmio_device_attach (keyboard, &mmio_keyboard_device, args)
+      || mmio_add_device ("EXIT", EXIT_ADDRESS, EXIT_ADDRESS, NULL, mmio_exit,
+                          NULL)
+             == NULL)
+    exit (2);
+  memory_map_compile (&mem);
+  mmio_sync_device (keyboard, 0);
+}
+
+// Keyboard bytes every few hundred cycles, each holding the IRQ line
+// until the handler (or random code) reads it.
+static void
+write_script (char *path)
+{
+  strcpy (path, "/tmp/rosetta-equiv-XXXXXX");
+  int fd = mkstemp (path);
+  FILE *f = fd >= 0 ? fdopen (fd, "w") : NULL;
+  if (f == NULL)
+    {
+      perror ("rosetta-equiv: script");
+      exit (2);
+    }
+
+  unsigned seed = 3;
+  QWord at = 0;
+  for (int i = 0; i < 4000; i++)
+    {
+      at += 200 + next_random (&seed) % 2000;
+      fprintf (f, "@%llu 0x%02X\n", (unsigned long long)at,
+               next_random (&seed) & 0xFF);
+    }
+  fclose (f);
+}
+
+static unsigned long
+memory_hash (void)
+{
+  unsigned long hash = 1469598103934665603UL;
+  for (int i = 0; i < 0x10000; i++)
+    hash = (hash ^ mem.Data[i]) * 1099511628211UL;
+  return hash;
+}
+
+// Runs the calls of one variant, with the fast paths (mode 0) or without.
+static void
+run_variant (int mode, const Snapshot *boot, unsigned seed, int variant,
+             unsigned number)
+{
+  static CoverageBits bits;
+  Machine6502 machine = { &bus, &mem, &cpu, 0 };
+  Word at = 0x8000 + seed % 0x7000;
+
+  snapshot_restore (boot, &cpu, &mem);
+  mmio_exit_requested = 0;
+  breakpoint_clear (&mem);
+  breakpoint_rearm ();
+  if (variant == 1)
+    {
+      // Also the starts of pages, where a pair may begin on an unwatched
+      // page and end on a watched one.
+      breakpoint_add (&mem, BREAK_EXEC, at, at + 40, NULL);
+      for (int page = 0x80 + seed % 4; page < 0x100; page += 4)
+        breakpoint_add (&mem, BREAK_EXEC, page << 8, (page << 8) + 2, NULL);
+    }
+  else if (variant == 2)
+    breakpoint_add (&mem, BREAK_WRITE, seed % 0x40, seed % 0x40 + 3, NULL);
+  else if (variant == 3)
+    breakpoint_add (&mem, BREAK_READ, seed % 0x40, seed % 0x40 + 3, NULL);
+  cpu.PS = next_random (&seed);
+  cpu.Flag.I = 0;
+  coverage_bits = mode ? &bits : NULL;
+
+  traced[mode] = 0;
+  for (int call = 0; call < calls && !mmio_exit_requested; call++)
+    {
+      unsigned r = next_random (&seed) % 3;
+      StopReason stop;
+
+      if (r == 0)
+        stop = run_instructions (&machine, 1 + next_random (&seed) % 40);
+      else if (r == 1)
+        stop = run_cycles (&machine, 1 + next_random (&seed) % 200);
+      else
+        {
+          RunCondition until = {
+            .on_trap = next_random (&seed) % 2,
+            .max_cycles = next_random (&seed) % 300,
+            .max_instructions = next_random (&seed) % 30,
+          };
+          if (until.max_cycles == 0 && until.max_instructions == 0)
+            until.max_cycles = 50;
+          stop = run_until (&machine, &until);
+        }
+      if (stop == STOP_TRAP)
+        cpu.PC += 2; // Out of the jump to itself
+      else if (stop == STOP_BREAKPOINT)
+        breakpoint_resume (&cpu);
+
+      trace[mode][traced[mode]++]
+          = (Record){ stop, cpu, total_cycles_executed, machine.instructions };
+      if (digest && mode == 0)
+        fprintf (report, "%u %d %d %s PC=%04X A=%02X X=%02X Y=%02X SP=%02X P=%02X "
+                "cycles=%llu instructions=%llu memory=%016lx\n",
+                number, variant, call, stop_reason_name (stop), cpu.PC,
+                cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.PS,
+                (unsigned long long)total_cycles_executed,
+                (unsigned long long)machine.instructions, memory_hash ());
+    }
+  coverage_bits = NULL;
+}
+
+static void
+print_record (const char *label, const Record *record)
+{
+  fprintf (report, "  %-5s %-10s PC=%04X A=%02X X=%02X Y=%02X SP=%02X P=%02X "
+          "cycles=%llu instructions=%llu\n",
+          label, stop_reason_name (record->stop), record->cpu.PC,
+          record->cpu.A, record->cpu.X, record->cpu.Y, record->cpu.SP,
+          record->cpu.PS, (unsigned long long)record->cycles,
+          (unsigned long long)record->instructions);
+}
+
+// Returns the number of variants of image `number` that differ.
+static int
+check_image (unsigned number, const char *script)
+{
+  static const char *const variant_name[VARIANTS]
+      = { "plain", "PC breakpoint", "write watchpoint", "read watchpoint" };
+  Snapshot boot = { 0 };
+  int failed = 0;
+
+  make_image (number);
+  memcpy (mem.Data, image, 0x10000);
+  markMem6502Dirty (&mem);
+  total_cycles_executed = 0;
+  attach_devices (script);
+  resetCPU (&cpu, &mem);
+  if (!snapshot_take (&boot, &cpu, &mem))
+    exit (2);
+
+  for (int variant = 0; variant < VARIANTS; variant++)
+    {
+      unsigned seed = number * 7 + variant;
+
+      run_variant (0, &boot, seed, variant, number);
+      if (digest)
+        continue;
+      memcpy (memory_after, mem.Data, 0x10000);
+      run_variant (1, &boot, seed, variant, number);
+
+      int call = 0;
+      while (call < traced[0] && call < traced[1]
+             && trace[0][call].stop == trace[1][call].stop
+             && trace[0][call].cycles == trace[1][call].cycles
+             && trace[0][call].instructions == trace[1][call].instructions
+             && memcmp (&trace[0][call].cpu, &trace[1][call].cpu,
+                        sizeof (CPU6502))
+                    == 0)
+        call++;
+
+      if (call < traced[0] || call < traced[1])
+        {
+          fprintf (report, "image %u, %s: call %d differs\n", number,
+                  variant_name[variant], call);
+          if (call < traced[0])
+            print_record ("fast", &trace[0][call]);
+          if (call < traced[1])
+            print_record ("steps", &trace[1][call]);
+          failed++;
+        }
+      else if (memcmp (memory_after, mem.Data, 0x10000) != 0)
+        {
+          fprintf (report, "image %u, %s: memory differs\n", number,
+                  variant_name[variant]);
+          failed++;
+        }
+    }
+
+  snapshot_free (&boot);
+  breakpoint_clear (&mem);
+  return failed;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *rom = NULL;
+  unsigned first = 1;
+  int images = 50;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:s:c:dw:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'n':
+          images = atoi (optarg);
+          break;
+        case 's':
+          first = strtoul (optarg, NULL, 0);
+          break;
+        case 'c':
+          calls = atoi (optarg);
+          break;
+        case 'd':
+          digest = true;
+          break;
+        case 'w':
+          rom = optarg;
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind != argc || images < 1 || calls < 1 || calls > MAX_CALLS)
+    usage (argv[0]);
+
+  if (rom != NULL)
+    {
+      make_image (first);
+      FILE *f = fopen (rom, "wb");
+      if (f == NULL || fwrite (&image[0x8000], 1, 0x8000, f) != 0x8000)
+        {
+          perror (rom);
+          return 2;
+        }
+      fclose (f);
+      return 0;
+    }
+
+  char script[32];
+  write_script (script);
+
+  // The interpreter reports unhandled opcodes, ROM writes and unmapped
+  // accesses as they happen, and random code makes plenty.
+  int null = open ("/dev/null", O_WRONLY);
+  report = fdopen (dup (STDOUT_FILENO), "w");
+  if (null < 0 || report == NULL)
+    return 2;
+  fflush (stdout);
+  dup2 (null, STDOUT_FILENO);
+  dup2 (null, STDERR_FILENO);
+  close (null);
+  memory_map_clear ();
+  memory_map_add_region (REGION_RAM, 0x0000, 0x0FFF, 0, 0);
+  memory_map_add_region (REGION_RAM, 0x1100, 0x7FFF, 0, 0);
+  memory_map_add_region (REGION_ROM, 0x8000, 0xFFFF, 0, 0);
+  initializeMem6502 (&mem);
+  clock_unthrottled = true;
+
+  int failed = 0;
+  for (int i = 0; i < images; i++)
+    failed += check_image (first + i, script);
+  unlink (script);
+
+  if (!digest)
+    fprintf (report, "%d image%s, %d variant%s differ%s%s\n", images,
+            images == 1 ? "" : "s", failed, failed == 1 ? "" : "s",
+            failed == 1 ? "s" : "", aot_blocks ? " (translated blocks)" : "");
+  fclose (report);
+  freeMem6502 (&mem);
+  return failed ? 1 : 0;
+}
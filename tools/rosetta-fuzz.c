@@ -0,0 +1,381 @@
+/*
+   rosetta-fuzz - In-process fuzzing of firmware input parsers.
+
+   The firmware is booted once, up to the instruction that first reads the
+   input device, and snapshotted. Every input then restores the pages written by the
+   previous one (snapshot_restore_dirty), is handed to the input device
+   (device=keyboard) and runs until the firmware exits, traps or uses up
+   its cycle budget. Edges of the emulated code are recorded in a coverage
+   map (coverage.h) that the fuzzer reads:
+
+     libFuzzer  make CC=clang rosetta-fuzz-libfuzzer
+                The map is an extra-counters section.
+     AFL++      make CC=afl-clang-fast rosetta-fuzz
+                Persistent mode with a shared-memory test case; the map is
+                AFL's own, so only instrument this file
+                (AFL_LLVM_ALLOWLIST) to keep host edges out of it.
+     standalone rosetta-fuzz [-b COUNT | -l COUNT] [INPUT...]
+                Runs the given inputs and reports how each ended, or
+                benchmarks COUNT random inputs, one at a time (-b) or
+                LANES_MAX at once in lock step (-l, lanes.h). -l checks
+                every lane against the interpreter afterwards.
+
+   The fuzzer owns the command line, so the target is set in the
+   environment:
+
+     ROSETTA_FUZZ_FIRMWARE  image, loaded at the start of ROM (required)
+     ROSETTA_FUZZ_CONFIG    mmio.cfg with the input device (required)
+     ROSETTA_FUZZ_DEVICE    name of the input device (KEYBOARD)
+     ROSETTA_FUZZ_CYCLES    cycle budget per input (100000)
+     ROSETTA_FUZZ_CRASH     comma separated addresses (hex or symbols)
+                            whose execution is a crash
+     ROSETTA_FUZZ_VERBOSE   keep the firmware's and devices' output
+
+   A crash address reached aborts the process, which is how both fuzzers
+   expect findings to be reported.
+*/
+
+#include "breakpoint.h"
+#include "coverage.h"
+#include "cpu_exec.h"
+#include "lanes.h"
+#include "loader.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "snapshot.h"
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_CYCLES 100000
+#define BOOT_CYCLES 100000000 // Until the first read of the input device
+#define MAX_INPUT 65536
+
+#ifdef ROSETTA_FUZZ_LIBFUZZER
+__attribute__ ((used, section ("__libfuzzer_extra_counters")))
+#endif
+static Byte edges[COVERAGE_MAP_SIZE];
+
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+static Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+static Snapshot boot;
+static DWord seen[PAGE_COUNT];
+static MMIODevice *input;
+static QWord cycle_budget = DEFAULT_CYCLES;
+
+static const char *
+require (const char *name)
+{
+  const char *value = getenv (name);
+  if (value == NULL || *value == '\0')
+    {
+      fprintf (stderr, "rosetta-fuzz: %s is not set\n", name);
+      exit (2);
+    }
+  return value;
+}
+
+static void
+add_crash_addresses (const char *list)
+{
+  char copy[256];
+
+  if (list == NULL)
+    return;
+  snprintf (copy, sizeof (copy), "%s", list);
+  for (char *spec = strtok (copy, ","); spec; spec = strtok (NULL, ","))
+    if (breakpoint_parse (&mem, spec) < 0)
+      {
+        fprintf (stderr, "rosetta-fuzz: bad crash address %s\n", spec);
+        exit (2);
+      }
+}
+
+static void
+setup (void)
+{
+  const char *firmware = require ("ROSETTA_FUZZ_FIRMWARE");
+  const char *config = require ("ROSETTA_FUZZ_CONFIG");
+  const char *device = getenv ("ROSETTA_FUZZ_DEVICE");
+  const char *cycles = getenv ("ROSETTA_FUZZ_CYCLES");
+
+  if (cycles)
+    cycle_budget = strtoull (cycles, NULL, 0);
+
+  initializeMem6502 (&mem);
+  mmio_load_config (config);
+  memory_map_compile (&mem);
+
+  input = mmio_find_device_by_name (device ? device : "KEYBOARD");
+  if (input == NULL || !mmio_keyboard_set_input (input, NULL, 0))
+    {
+      fprintf (stderr, "rosetta-fuzz: no keyboard device %s in %s\n",
+               device ? device : "KEYBOARD", config);
+      exit (2);
+    }
+
+  Word start = memory_map_rom_start ();
+  if (!load_binary_to_memory (&mem, firmware, start))
+    exit (2);
+  set_reset_vector (&mem, start);
+  resetCPU (&cpu, &mem);
+  clock_unthrottled = true;
+
+  // Boot up to the instruction that first reads the input device. The
+  // watchpoint fires after that read, so the boot is replayed from reset
+  // and stopped one instruction earlier.
+  Snapshot reset;
+  if (!snapshot_take (&reset, &cpu, &mem))
+    exit (2);
+  breakpoint_add (&mem, BREAK_READ, input->start, input->end, NULL);
+  RunCondition until_input = { .max_cycles = BOOT_CYCLES };
+  if (run_until (&machine, &until_input) != STOP_BREAKPOINT)
+    {
+      fprintf (stderr, "rosetta-fuzz: firmware never reads %s\n",
+               input->name);
+      exit (2);
+    }
+  breakpoint_clear (&mem);
+  breakpoint_rearm ();
+
+  QWord boot_instructions = machine.instructions - 1;
+  snapshot_restore (&reset, &cpu, &mem);
+  snapshot_free (&reset);
+  machine.instructions = 0;
+  run_instructions (&machine, boot_instructions);
+  add_crash_addresses (getenv ("ROSETTA_FUZZ_CRASH"));
+
+  if (!snapshot_take (&boot, &cpu, &mem))
+    exit (2);
+  snapshot_mark_clean (&mem, seen);
+
+  if (getenv ("ROSETTA_FUZZ_VERBOSE") == NULL)
+    {
+      int null = open ("/dev/null", O_WRONLY);
+      fflush (stdout);
+      dup2 (null, STDOUT_FILENO);
+      close (null);
+    }
+}
+
+// Runs one input from the boot snapshot.
+static StopReason
+run_input (const Byte *data, size_t size)
+{
+  snapshot_restore_dirty (&boot, &cpu, &mem, seen);
+  mmio_exit_requested = 0;
+  breakpoint_rearm ();
+  mmio_keyboard_set_input (input, data, size);
+
+  RunCondition until = { .on_trap = true, .max_cycles = cycle_budget };
+  StopReason stop = run_until (&machine, &until);
+
+  if (stop == STOP_BREAKPOINT)
+    {
+      fprintf (stderr, "rosetta-fuzz: crash address $%04X reached\n",
+               breakpoint_last_hit.address);
+      abort ();
+    }
+  return stop;
+}
+
+int LLVMFuzzerInitialize (int *argc, char ***argv);
+int LLVMFuzzerTestOneInput (const uint8_t *data, size_t size);
+
+int
+LLVMFuzzerInitialize (int *argc, char ***argv)
+{
+  (void)argc;
+  (void)argv;
+  setup ();
+  coverage_map = edges;
+  return 0;
+}
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size)
+{
+  run_input (data, size);
+  return 0;
+}
+
+#ifndef ROSETTA_FUZZ_LIBFUZZER
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+__AFL_FUZZ_INIT ();
+extern unsigned char *__afl_area_ptr;
+#endif
+
+static int
+count_edges (void)
+{
+  int count = 0;
+  for (int i = 0; i < COVERAGE_MAP_SIZE; i++)
+    count += edges[i] != 0;
+  return count;
+}
+
+static void
+run_file (const char *path)
+{
+  static Byte data[MAX_INPUT];
+  FILE *f = fopen (path, "rb");
+
+  if (f == NULL)
+    {
+      perror (path);
+      return;
+    }
+  size_t size = fread (data, 1, sizeof (data), f);
+  fclose (f);
+
+  memset (edges, 0, sizeof (edges));
+  StopReason stop = run_input (data, size);
+  fprintf (stderr, "%s: %zu bytes, %s after %llu cycles, %d edges\n", path,
+           size, stop_reason_name (stop),
+           (unsigned long long)(total_cycles_executed - boot.cycles),
+           count_edges ());
+}
+
+static double
+seconds (void)
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Fills `data` with 1 to 64 random bytes and returns the length.
+static size_t
+random_input (unsigned *seed, Byte *data)
+{
+  size_t size = 1 + (*seed = *seed * 1103515245 + 12345) % 64;
+  for (size_t j = 0; j < size; j++)
+    data[j] = (Byte)((*seed = *seed * 1103515245 + 12345) >> 16);
+  return size;
+}
+
+static void
+benchmark (long count)
+{
+  Byte data[64];
+  unsigned seed = 1;
+  double began = seconds ();
+
+  for (long i = 0; i < count; i++)
+    {
+      size_t size = random_input (&seed, data);
+      run_input (data, size);
+    }
+
+  double elapsed = seconds () - began;
+  fprintf (stderr, "%ld inputs in %.2f s: %.0f execs/s, %d edges\n", count,
+           elapsed, count / elapsed, count_edges ());
+}
+
+// Same inputs as benchmark, LANES_MAX at a time. Only lanes_run is timed.
+static void
+benchmark_lanes (long count)
+{
+  static Lanes6502 lanes;
+  static const StopReason stops[] = {
+    [LANE_BUDGET] = STOP_BUDGET, [LANE_TRAP] = STOP_TRAP,
+    [LANE_BREAKPOINT] = STOP_BREAKPOINT, [LANE_EXIT] = STOP_EXIT,
+  };
+  Byte data[LANES_MAX][64];
+  size_t size[LANES_MAX];
+  unsigned seed = 1;
+  long mismatched = 0;
+  double elapsed = 0;
+
+  snapshot_restore_dirty (&boot, &cpu, &mem, seen);
+  if (!lanes_init (&lanes, LANES_MAX, &cpu, &mem, input))
+    exit (2);
+  for (int b = 0; b < BREAKPOINT_MAX; b++)
+    if (breakpoints[b].id && breakpoints[b].kind == BREAK_EXEC)
+      for (DWord a = breakpoints[b].start; a <= breakpoints[b].end; a++)
+        lanes_break (&lanes, (Word)a);
+
+  for (long done = 0; done < count; done += LANES_MAX)
+    {
+      int n = count - done < LANES_MAX ? (int)(count - done) : LANES_MAX;
+
+      for (int k = 0; k < LANES_MAX; k++)
+        {
+          lanes_reset (&lanes, k);
+          size[k] = k < n ? random_input (&seed, data[k]) : 0;
+          lanes_set_input (&lanes, k, data[k], size[k]);
+          lanes.coverage[k] = edges;
+          if (k >= n)
+            lanes.state[k] = LANE_BUDGET; // Nothing to run
+        }
+
+      double began = seconds ();
+      lanes_run (&lanes, cycle_budget);
+      elapsed += seconds () - began;
+
+      // The interpreter aborts on the first crash address reached.
+      for (int k = 0; k < n; k++)
+        {
+          StopReason stop = run_input (data[k], size[k]);
+          bool same = lanes.state[k] <= LANE_EXIT
+                      && stops[lanes.state[k]] == stop
+                      && lanes.cycles[k] == total_cycles_executed
+                      && lanes.PC[k] == cpu.PC && lanes.A[k] == cpu.A
+                      && lanes.X[k] == cpu.X && lanes.Y[k] == cpu.Y
+                      && lanes.SP[k] == cpu.SP && lanes.P[k] == cpu.PS;
+
+          if (!same && mismatched++ < 8)
+            fprintf (stderr, "input %ld: lane %s at $%04X, interpreter %s "
+                     "at $%04X\n", done + k,
+                     lane_state_name (lanes.state[k]), lanes.PC[k],
+                     stop_reason_name (stop), cpu.PC);
+        }
+    }
+
+  fprintf (stderr, "%ld inputs in %.2f s: %.0f execs/s, %.1f lanes per "
+           "step, %ld differ from the interpreter\n", count, elapsed,
+           count / elapsed, (double)lanes.instructions / lanes.steps,
+           mismatched);
+  lanes_free (&lanes);
+}
+
+int
+main (int argc, char *argv[])
+{
+  LLVMFuzzerInitialize (&argc, &argv);
+
+#ifdef __AFL_FUZZ_TESTCASE_LEN
+  coverage_map = __afl_area_ptr;
+  __AFL_INIT ();
+  Byte *data = __AFL_FUZZ_TESTCASE_BUF;
+  while (__AFL_LOOP (100000))
+    run_input (data, __AFL_FUZZ_TESTCASE_LEN);
+  return 0;
+#endif
+
+  if (argc > 2 && strcmp (argv[1], "-b") == 0)
+    {
+      benchmark (strtol (argv[2], NULL, 0));
+      return 0;
+    }
+  if (argc > 2 && strcmp (argv[1], "-l") == 0)
+    {
+      benchmark_lanes (strtol (argv[2], NULL, 0));
+      return 0;
+    }
+  if (argc < 2)
+    {
+      fprintf (stderr, "Usage: %s [-b COUNT | -l COUNT] [INPUT...]\n",
+               argv[0]);
+      return 2;
+    }
+  for (int i = 1; i < argc; i++)
+    run_file (argv[i]);
+  return 0;
+}
+
+#endif // ROSETTA_FUZZ_LIBFUZZER
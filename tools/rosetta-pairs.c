@@ -0,0 +1,236 @@
+/*
+   rosetta-pairs - Profiles the opcode pairs a firmware executes.
+
+   Usage: rosetta-pairs [-n COUNT] [-c CYCLES] [-o fused_table.h]
+                        firmware.bin mmio.cfg [firmware.bin mmio.cfg]...
+
+   Each firmware is loaded at the start of ROM and run from reset, as
+   `main -b` does, until it exits or has run CYCLES (default 100000000).
+   Every instruction that falls through to the next one (no jump, branch,
+   call, return or interrupt in between) counts one for the pair of their
+   opcodes. The most frequent pairs are listed on stderr; with -o the
+   COUNT best (default 16) are written as fused_table.h, the table of
+   pairs the run loops fuse (cpu_exec.c).
+*/
+
+#include "cpu_exec.h"
+#include "disasm.h"
+#include "loader.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include <unistd.h>
+
+#define DEFAULT_CYCLES 100000000
+#define DEFAULT_COUNT 16
+#define LISTED 40
+
+static const char *const opcode_name[256] = {
+#define X(name, opcode, mnemonic, mode, kind, cycles) [opcode] = #name,
+  OPCODE_TABLE (X)
+#undef X
+};
+
+static QWord counts[256][256];
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-n COUNT] [-c CYCLES] [-o fused_table.h]\n"
+           "       firmware.bin mmio.cfg [firmware.bin mmio.cfg]...\n",
+           prog);
+  exit (2);
+}
+
+// Opcodes after which the next instruction is not the following bytes.
+static bool
+transfers_control (Byte opcode)
+{
+  switch (opcode)
+    {
+    case INS_BRK:
+    case INS_JMP_ABS:
+    case INS_JMP_IND:
+    case INS_JSR:
+    case INS_RTS:
+    case INS_RTI:
+      return true;
+    default:
+      return (opcode & 0x1F) == 0x10; // Branches
+    }
+}
+
+// Runs one firmware and adds its pairs to `counts`.
+static bool
+profile (const char *firmware, const char *config, QWord cycles)
+{
+  static CPU6502 cpu;
+  static MEM6502 mem;
+  static Bus6502 bus;
+
+  mmio_unload_all ();
+  memory_map_clear ();
+  if (mem.Data == NULL)
+    initializeMem6502 (&mem);
+  mmio_load_config (config);
+  memory_map_compile (&mem);
+  memset (mem.Data, 0, MAX_MEM);
+  markMem6502Dirty (&mem);
+
+  Word start = memory_map_rom_start ();
+  if (!load_binary_to_memory (&mem, firmware, start))
+    return false;
+  set_reset_vector (&mem, start);
+  resetCPU (&cpu, &mem);
+  total_cycles_executed = 0;
+  mmio_exit_requested = 0;
+
+  int previous = -1; // Opcode of the last instruction, if it falls through
+
+  while (total_cycles_executed < cycles && !mmio_exit_requested)
+    {
+      bool interrupt = mmio_irq_lines && !cpu.Flag.I;
+      Byte opcode = mem6502_peek (&mem, cpu.PC);
+      if (!run_cpu_instruction (&bus, &mem, &cpu))
+        break;
+
+      // The step took an interrupt instead of running `opcode`.
+      if (interrupt)
+        {
+          previous = -1;
+          continue;
+        }
+      if (previous >= 0)
+        counts[previous][opcode]++;
+      previous = opcode_info[opcode].mnemonic && !transfers_control (opcode)
+                     ? opcode
+                     : -1;
+    }
+  return true;
+}
+
+typedef struct
+{
+  Byte first, second;
+  QWord count;
+} Pair;
+
+static int
+compare_pairs (const void *a, const void *b)
+{
+  const Pair *x = a, *y = b;
+  if (x->count != y->count)
+    return x->count < y->count ? 1 : -1;
+  return (x->first << 8 | x->second) - (y->first << 8 | y->second);
+}
+
+static bool
+write_table (const char *path, const Pair *pairs, int count)
+{
+  FILE *out = fopen (path, "w");
+  if (out == NULL)
+    {
+      perror (path);
+      return false;
+    }
+
+  fputs ("#ifndef FUSED_TABLE_H\n"
+         "#define FUSED_TABLE_H\n"
+         "\n"
+         "/*\n"
+         "   FUSED_TABLE - Opcode pairs the run loops dispatch as one step.\n"
+         "\n"
+         "   Each line names two opcodes that firmware commonly executes "
+         "back to\n"
+         "   back. cpu_exec.c expands every pair into one case holding "
+         "both\n"
+         "   handlers, so the second instruction needs no dispatch of its "
+         "own (see\n"
+         "   \"Superinstructions\" there). The first opcode must fall "
+         "through to the\n"
+         "   next instruction: no jumps, branches, calls or returns.\n"
+         "\n"
+         "   `make fused-table PROFILE=\"firmware.bin mmio.cfg\"` rewrites "
+         "this file\n"
+         "   with the most frequent pairs of a profiled run "
+         "(tools/rosetta-pairs.c).\n"
+         "\n"
+         "   Usage: define X (first, second) and expand FUSED_TABLE (X).\n"
+         "*/\n"
+         "\n"
+         "#define FUSED_TABLE(X)            \\\n",
+         out);
+  for (int i = 0; i < count; i++)
+    {
+      char line[64];
+      snprintf (line, sizeof (line), "  X (%s,%*s%s)",
+                opcode_name[pairs[i].first],
+                (int)(13 - strlen (opcode_name[pairs[i].first])), "",
+                opcode_name[pairs[i].second]);
+      if (i + 1 < count)
+        fprintf (out, "%-34s\\\n", line);
+      else
+        fprintf (out, "%s\n", line);
+    }
+  fputs ("\n#endif // FUSED_TABLE_H\n", out);
+  return fclose (out) == 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *output = NULL;
+  QWord cycles = DEFAULT_CYCLES;
+  int count = DEFAULT_COUNT;
+  int opt;
+
+  while ((opt = getopt (argc, argv, "n:c:o:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'n':
+          count = atoi (optarg);
+          break;
+        case 'c':
+          cycles = strtoull (optarg, NULL, 0);
+          break;
+        case 'o':
+          output = optarg;
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind == argc || (argc - optind) % 2 != 0 || count < 1)
+    usage (argv[0]);
+
+  clock_unthrottled = true;
+  for (int i = optind; i < argc; i += 2)
+    if (!profile (argv[i], argv[i + 1], cycles))
+      return 1;
+
+  static Pair pairs[256 * 256];
+  int found = 0;
+  QWord total = 0;
+  for (int a = 0; a < 256; a++)
+    for (int b = 0; b < 256; b++)
+      if (counts[a][b])
+        {
+          pairs[found++] = (Pair){ (Byte)a, (Byte)b, counts[a][b] };
+          total += counts[a][b];
+        }
+  if (found == 0)
+    {
+      fprintf (stderr, "rosetta-pairs: no instructions ran\n");
+      return 1;
+    }
+  qsort (pairs, found, sizeof (Pair), compare_pairs);
+
+  for (int i = 0; i < found && i < LISTED; i++)
+    fprintf (stderr, "%6.2f%%  %-13s %s\n", 100.0 * pairs[i].count / total,
+             opcode_name[pairs[i].first], opcode_name[pairs[i].second]);
+
+  if (count > found)
+    count = found;
+  return output && !write_table (output, pairs, count) ? 1 : 0;
+}
@@ -0,0 +1,484 @@
+/*
+   rosetta-server - Runs jobs on pre-booted machines over a UNIX socket.
+
+   Usage: rosetta-server [-w WORKERS] [-r READY] [-k DEVICE] [-c CYCLES]
+                         [-S SYMBOLS] -m mmio.cfg -s SOCKET firmware.bin
+
+   The firmware is loaded and booted once, up to READY:
+
+     pc=ADDR       PC reaches ADDR (hex or a symbol from -S)
+     read=DEVICE   just before the first read of DEVICE
+     write=DEVICE  just after the first write to DEVICE
+
+   (reset when -r is not given) and snapshotted. The server then forks
+   WORKERS processes (default: one per CPU) that share the listening socket.
+   Each holds a copy-on-write clone of the booted machine and, for every
+   job, restores the pages the previous job wrote (snapshot_restore_dirty),
+   so a job costs its own instructions plus a few microseconds. Workers
+   that die are replaced.
+
+   The protocol is line based; a connection may send any number of
+   requests and gets one reply line for each:
+
+     RUN [cycles=N] [input=HEX]
+       Runs from the ready point with HEX bytes queued on the keyboard
+       device DEVICE (default KEYBOARD; empty without input=) until the
+       firmware exits, traps, hits a breakpoint or has run N cycles
+       (default CYCLES, 10000000).
+       OK stop=exit exit=04 cycles=N pc=E012 a=00 x=00 y=00 sp=FD p=24
+          output=HEX
+       cycles counts from the ready point; output is what the firmware's
+       devices printed.
+     PEEK ADDR LENGTH
+       OK data=HEX, memory after the last run (no device side effects).
+     QUIT
+
+   Malformed requests get "ERR message".
+*/
+
+#include "breakpoint.h"
+#include "cpu_exec.h"
+#include "loader.h"
+#include "memory_map.h"
+#include "mmio.h"
+#include "snapshot.h"
+#include "symbols.h"
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DEFAULT_CYCLES 10000000
+#define BOOT_CYCLES 100000000 // Until the ready point
+#define MAX_WORKERS 256
+#define MAX_LINE 262144       // A request with 128 KB of input
+#define MAX_OUTPUT 65536      // Bytes of output returned per job
+
+static CPU6502 cpu;
+static MEM6502 mem;
+static Bus6502 bus;
+static Machine6502 machine = { &bus, &mem, &cpu, 0 };
+
+static Snapshot ready;
+static DWord seen[PAGE_COUNT];
+static MMIODevice *input;
+static QWord cycle_budget = DEFAULT_CYCLES;
+
+static volatile sig_atomic_t stopping;
+
+static void
+usage (const char *prog)
+{
+  fprintf (stderr,
+           "Usage: %s [-w WORKERS] [-r READY] [-k DEVICE] [-c CYCLES]\n"
+           "       [-S SYMBOLS] -m mmio.cfg -s SOCKET firmware.bin\n",
+           prog);
+  exit (2);
+}
+
+static bool
+parse_address (const char *text, Word *address)
+{
+  char *end;
+  unsigned long value = strtoul (text, &end, 16);
+
+  if (end != text && *end == '\0' && value <= 0xFFFF)
+    {
+      *address = (Word)value;
+      return true;
+    }
+  return symbols_find (text, address);
+}
+
+// Boots from reset to the ready point. Returns false if it is never
+// reached.
+static bool
+boot (const char *spec)
+{
+  RunCondition until = { .max_cycles = BOOT_CYCLES };
+  const char *value = spec ? strchr (spec, '=') : NULL;
+
+  if (spec == NULL)
+    return true;
+  if (value == NULL)
+    return false;
+  value++;
+
+  if (strncmp (spec, "pc=", 3) == 0)
+    {
+      until.at_pc = true;
+      if (!parse_address (value, &until.pc))
+        return false;
+      return cpu.PC == until.pc
+             || run_until (&machine, &until) == STOP_CONDITION;
+    }
+
+  bool on_read = strncmp (spec, "read=", 5) == 0;
+  if (!on_read && strncmp (spec, "write=", 6) != 0)
+    return false;
+  MMIODevice *device = mmio_find_device_by_name (value);
+  if (device == NULL)
+    return false;
+
+  Snapshot reset = { 0 };
+  if (on_read && !snapshot_take (&reset, &cpu, &mem))
+    return false;
+  breakpoint_add (&mem, on_read ? BREAK_READ : BREAK_WRITE, device->start,
+                  device->end, NULL);
+  StopReason stop = run_until (&machine, &until);
+  breakpoint_clear (&mem);
+  breakpoint_rearm ();
+
+  // A watchpoint fires after the access; a read must still happen in the
+  // job, so the boot is replayed one instruction short of it.
+  if (stop == STOP_BREAKPOINT && on_read)
+    {
+      QWord instructions = machine.instructions - 1;
+      snapshot_restore (&reset, &cpu, &mem);
+      machine.instructions = 0;
+      run_instructions (&machine, instructions);
+    }
+  snapshot_free (&reset);
+  return stop == STOP_BREAKPOINT;
+}
+
+static int
+hex_value (char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  c |= 0x20;
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// Decodes `length` hex digits into `out`. Returns the byte count or -1.
+static long
+hex_decode (const char *text, size_t length, Byte *out)
+{
+  if (length % 2)
+    return -1;
+  for (size_t i = 0; i < length; i += 2)
+    {
+      int high = hex_value (text[i]), low = hex_value (text[i + 1]);
+      if (high < 0 || low < 0)
+        return -1;
+      out[i / 2] = (Byte)(high << 4 | low);
+    }
+  return length / 2;
+}
+
+static void
+hex_write (FILE *out, const Byte *data, size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    fprintf (out, "%02X", data[i]);
+}
+
+// Takes what the devices printed since the last call. Workers point
+// stdout at an unlinked temporary file; devices that buffer output are
+// drained into it first.
+static size_t
+take_output (Byte *out)
+{
+  mmio_flush_devices ();
+  fflush (stdout);
+  off_t size = lseek (STDOUT_FILENO, 0, SEEK_CUR);
+  ssize_t got = pread (STDOUT_FILENO, out,
+                       size < MAX_OUTPUT ? (size_t)size : MAX_OUTPUT, 0);
+  if (ftruncate (STDOUT_FILENO, 0) != 0)
+    perror ("rosetta-server: output");
+  lseek (STDOUT_FILENO, 0, SEEK_SET);
+  return got > 0 ? (size_t)got : 0;
+}
+
+static void
+run_job (FILE *reply, char *args)
+{
+  static Byte data[MAX_LINE / 2];
+  static Byte output[MAX_OUTPUT];
+  QWord budget = cycle_budget;
+  long length = 0;
+
+  for (char *arg = strtok (args, " \t\r\n"); arg;
+       arg = strtok (NULL, " \t\r\n"))
+    {
+      if (strncmp (arg, "cycles=", 7) == 0)
+        budget = strtoull (arg + 7, NULL, 0);
+      else if (strncmp (arg, "input=", 6) == 0)
+        {
+          length = hex_decode (arg + 6, strlen (arg + 6), data);
+          if (length < 0)
+            {
+              fprintf (reply, "ERR bad input\n");
+              return;
+            }
+          if (input == NULL)
+            {
+              fprintf (reply, "ERR no keyboard device\n");
+              return;
+            }
+        }
+      else
+        {
+          fprintf (reply, "ERR unknown argument %s\n", arg);
+          return;
+        }
+    }
+
+  snapshot_restore_dirty (&ready, &cpu, &mem, seen);
+  mmio_exit_requested = 0;
+  mmio_exit_code = 0;
+  breakpoint_rearm ();
+  if (input)
+    mmio_keyboard_set_input (input, data, length);
+
+  RunCondition until = { .on_trap = true, .max_cycles = budget };
+  StopReason stop = run_until (&machine, &until);
+  size_t printed = take_output (output);
+
+  fprintf (reply,
+           "OK stop=%s exit=%02X cycles=%llu pc=%04X a=%02X x=%02X y=%02X "
+           "sp=%02X p=%02X output=",
+           stop_reason_name (stop), mmio_exit_code,
+           (unsigned long long)(total_cycles_executed - ready.cycles), cpu.PC,
+           cpu.A, cpu.X, cpu.Y, cpu.SP, cpu.PS);
+  hex_write (reply, output, printed);
+  fputc ('\n', reply);
+}
+
+static void
+peek (FILE *reply, const char *args)
+{
+  static Byte data[0x10000];
+  unsigned long address, length;
+
+  if (sscanf (args, "%lx %lu", &address, &length) != 2 || address > 0xFFFF
+      || length > sizeof (data))
+    {
+      fprintf (reply, "ERR usage: PEEK ADDR LENGTH\n");
+      return;
+    }
+  for (unsigned long i = 0; i < length; i++)
+    data[i] = mem6502_peek (&mem, (Word)(address + i));
+  fprintf (reply, "OK data=");
+  hex_write (reply, data, length);
+  fputc ('\n', reply);
+}
+
+static void
+serve (int connection)
+{
+  static char line[MAX_LINE];
+  FILE *in = fdopen (connection, "r");
+  FILE *reply = fdopen (dup (connection), "w");
+
+  if (in == NULL || reply == NULL)
+    {
+      perror ("rosetta-server: connection");
+      if (in)
+        fclose (in);
+      else
+        close (connection);
+      if (reply)
+        fclose (reply);
+      return;
+    }
+
+  while (fgets (line, sizeof (line), in))
+    {
+      if (strchr (line, '\n') == NULL && !feof (in))
+        {
+          fprintf (reply, "ERR request too long\n");
+          break;
+        }
+      if (strncmp (line, "RUN", 3) == 0 && strchr (" \t\r\n", line[3]))
+        run_job (reply, line + 3);
+      else if (strncmp (line, "PEEK ", 5) == 0)
+        peek (reply, line + 5);
+      else if (strncmp (line, "QUIT", 4) == 0)
+        break;
+      else
+        fprintf (reply, "ERR unknown request\n");
+      if (fflush (reply) != 0)
+        break;
+    }
+  fclose (in);
+  fclose (reply);
+}
+
+static void
+worker (int listener)
+{
+  FILE *capture = tmpfile ();
+  if (capture == NULL)
+    {
+      perror ("rosetta-server: tmpfile");
+      _exit (1);
+    }
+  dup2 (fileno (capture), STDOUT_FILENO);
+  signal (SIGPIPE, SIG_IGN);
+
+  for (;;)
+    {
+      int connection = accept (listener, NULL, NULL);
+      if (connection < 0)
+        {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          perror ("rosetta-server: accept");
+          _exit (1);
+        }
+      serve (connection);
+    }
+}
+
+static pid_t
+spawn (int listener)
+{
+  fflush (stdout); // Or the child prints the boot log again
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      signal (SIGINT, SIG_DFL);
+      signal (SIGTERM, SIG_DFL);
+      worker (listener);
+    }
+  if (pid < 0)
+    perror ("rosetta-server: fork");
+  return pid;
+}
+
+static void
+on_signal (int sig)
+{
+  (void)sig;
+  stopping = 1;
+}
+
+static int
+listen_on (const char *path)
+{
+  struct sockaddr_un address = { .sun_family = AF_UNIX };
+  int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+
+  if (strlen (path) >= sizeof (address.sun_path))
+    {
+      fprintf (stderr, "rosetta-server: socket path too long\n");
+      return -1;
+    }
+  strcpy (address.sun_path, path);
+  unlink (path);
+  if (fd < 0 || bind (fd, (struct sockaddr *)&address, sizeof (address)) < 0
+      || listen (fd, 128) < 0)
+    {
+      perror (path);
+      return -1;
+    }
+  return fd;
+}
+
+int
+main (int argc, char *argv[])
+{
+  const char *config = NULL, *socket_path = NULL, *ready_spec = NULL;
+  const char *device = "KEYBOARD";
+  long workers = sysconf (_SC_NPROCESSORS_ONLN);
+  int opt;
+
+  while ((opt = getopt (argc, argv, "w:r:k:c:S:m:s:h")) != -1)
+    {
+      switch (opt)
+        {
+        case 'w':
+          workers = strtol (optarg, NULL, 0);
+          break;
+        case 'r':
+          ready_spec = optarg;
+          break;
+        case 'k':
+          device = optarg;
+          break;
+        case 'c':
+          cycle_budget = strtoull (optarg, NULL, 0);
+          break;
+        case 'S':
+          if (!symbols_load (optarg))
+            return 1;
+          break;
+        case 'm':
+          config = optarg;
+          break;
+        case 's':
+          socket_path = optarg;
+          break;
+        default:
+          usage (argv[0]);
+        }
+    }
+  if (optind != argc - 1 || config == NULL || socket_path == NULL
+      || workers < 1 || workers > MAX_WORKERS)
+    usage (argv[0]);
+
+  initializeMem6502 (&mem);
+  mmio_load_config (config);
+  memory_map_compile (&mem);
+  input = mmio_find_device_by_name (device);
+  if (input && !mmio_keyboard_set_input (input, NULL, 0))
+    input = NULL;
+
+  Word start = memory_map_rom_start ();
+  if (!load_binary_to_memory (&mem, argv[optind], start))
+    return 1;
+  set_reset_vector (&mem, start);
+  resetCPU (&cpu, &mem);
+  clock_unthrottled = true;
+
+  if (!boot (ready_spec))
+    {
+      fprintf (stderr, "rosetta-server: ready point %s not reached\n",
+               ready_spec);
+      return 1;
+    }
+  if (!snapshot_take (&ready, &cpu, &mem))
+    return 1;
+  snapshot_mark_clean (&mem, seen);
+
+  int listener = listen_on (socket_path);
+  if (listener < 0)
+    return 1;
+
+  struct sigaction action = { .sa_handler = on_signal };
+  sigaction (SIGINT, &action, NULL);
+  sigaction (SIGTERM, &action, NULL);
+
+  static pid_t pids[MAX_WORKERS];
+  for (long i = 0; i < workers; i++)
+    pids[i] = spawn (listener);
+  fprintf (stderr, "rosetta-server: %ld workers on %s, ready at PC $%04X\n",
+           workers, socket_path, cpu.PC);
+
+  while (!stopping)
+    {
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0 && errno == ECHILD)
+        break;
+      for (long i = 0; i < workers; i++)
+        if (pids[i] == pid && !stopping)
+          {
+            fprintf (stderr, "rosetta-server: worker %d died, restarting\n",
+                     (int)pid);
+            pids[i] = spawn (listener);
+          }
+    }
+
+  for (long i = 0; i < workers; i++)
+    if (pids[i] > 0)
+      kill (pids[i], SIGTERM);
+  while (wait (NULL) > 0)
+    ;
+  unlink (socket_path);
+  return 0;
+}